@@ -5,6 +5,10 @@
 #include <ppp/coroutines/asio/asio.h>
 #include <ppp/threading/Executors.h>
 
+#if defined(_LINUX)
+#include <netinet/tcp.h>
+#endif
+
 #if defined(_WIN32)
 #define IPTOS_TOS_MASK      0x1E
 #define IPTOS_TOS(tos)      ((tos) & IPTOS_TOS_MASK)
@@ -124,21 +128,20 @@ namespace aggligator
             uint32_t                                                    seq    = 0;
             int                                                         length = 0;
             std::shared_ptr<Byte>                                       packet;
-            boost::asio::ip::udp::endpoint                              dst;
         };
 
         queue<send_packet>                                              send_queue_;
-        queue<recv_packet>                                              recv_queue_;
+        vector<recv_packet>                                             recv_ring_;
+        uint32_t                                                        recv_mask_      = 0;
         uint32_t                                                        seq_no_         = 0;
         uint32_t                                                        ack_no_         = 1;
-        bool                                                            wraparound_     = false;
         int                                                             rq_congestions_ = 0;
+        uint64_t                                                        rq_wait_        = 0;
         std::shared_ptr<client>                                         client_;
         std::shared_ptr<aggligator>                                     app_;
 
         convergence(const std::shared_ptr<aggligator>& aggligator, const std::shared_ptr<client>& client) noexcept
-            : wraparound_(false)
-            , rq_congestions_(0)
+            : rq_congestions_(0)
             , client_(client)
             , app_(aggligator)
         {
@@ -151,95 +154,88 @@ namespace aggligator
         }
 
         void                                                            close() noexcept;
-        void                                                            emplace_wraparound(ppp::list<recv_packet>& queue, const recv_packet& packet) noexcept
+        std::shared_ptr<Byte>                                           pack(Byte* packet, int packet_length, uint32_t seq, int& out) noexcept;
+        bool                                                            process(Byte* packet, int packet_length, bool dont_control) noexcept
         {
-            for (;;)
+            bool ok = output(packet, packet_length);
+            if (ok && !dont_control)
             {
-                auto tail = queue.begin();
-                if (tail == queue.end())
-                {
-                    queue.emplace_back(packet);
-                    break;
-                }
-
-                auto position = std::upper_bound(queue.rbegin(), queue.rend(), packet,
-                    [this](const recv_packet& lhs, const recv_packet& rhs) noexcept
-                    {
-                        return after(lhs.seq, rhs.seq);
-                    });
-
-                queue.emplace(position.base(), packet);
-                break;
+                ack_no_++;
             }
+
+            return ok;
         }
-        void                                                            emplace(ppp::list<recv_packet>& queue, const recv_packet& packet) noexcept
+        bool                                                            drain(uint64_t now) noexcept
         {
-            for (;;)
+            while (rq_congestions_ > 0)
             {
-                auto tail = queue.begin();
-                if (tail == queue.end())
+                recv_packet& slot = recv_ring_[ack_no_ & recv_mask_];
+                if (NULL == slot.packet || slot.seq != ack_no_)
                 {
-                    queue.emplace_back(packet);
-                    break;
+                    rq_wait_ = now;
+                    return true;
                 }
 
-                if (tail->seq > packet.seq)
-                {
-                    queue.emplace_front(packet);
-                    break;
-                }
+                std::shared_ptr<Byte> packet = std::move(slot.packet);
+                slot.packet.reset();
+                rq_congestions_--;
 
-                auto rtail = queue.rbegin();
-                if (rtail->seq <= packet.seq)
+                if (!process(packet.get(), slot.length, false))
                 {
-                    queue.emplace_back(packet);
-                    break;
+                    return false;
                 }
+            }
 
-                if ((packet.seq - tail->seq) > (rtail->seq - packet.seq))
+            rq_wait_ = 0;
+            return true;
+        }
+        bool                                                            skip(uint32_t seq, uint64_t now) noexcept
+        {
+            // Give up on every sequence before seq, whatever was buffered in between is still delivered in order.
+            uint32_t distance = seq - ack_no_;
+            uint32_t capacity = recv_mask_ + 1;
+            for (uint32_t i = 0; i < distance && i < capacity && rq_congestions_ > 0; i++)
+            {
+                recv_packet& slot = recv_ring_[ack_no_ & recv_mask_];
+                if (NULL != slot.packet && slot.seq == ack_no_)
                 {
-                    auto position = std::upper_bound(queue.rbegin(), queue.rend(), packet,
-                        [](const recv_packet& lhs, const recv_packet& rhs) noexcept
-                        {
-                            return lhs.seq > rhs.seq;
-                        });
+                    std::shared_ptr<Byte> packet = std::move(slot.packet);
+                    slot.packet.reset();
+                    rq_congestions_--;
 
-                    queue.emplace(position.base(), packet);
+                    if (!process(packet.get(), slot.length, false))
+                    {
+                        return false;
+                    }
                 }
                 else
                 {
-                    auto position = std::lower_bound(queue.begin(), queue.end(), packet,
-                        [](const recv_packet& lhs, const recv_packet& rhs) noexcept
-                        {
-                            return lhs.seq < rhs.seq;
-                        });
-
-                    queue.emplace(position, packet);
+                    ack_no_++;
                 }
-
-                break;
             }
+
+            ack_no_ = seq;
+            return drain(now);
         }
-        std::shared_ptr<Byte>                                           pack(Byte* packet, int packet_length, uint32_t seq, int& out) noexcept;
-        bool                                                            process(Byte* packet, int packet_length, bool dont_control) noexcept
+        bool                                                            expire(uint64_t now) noexcept
         {
-            bool ok = output(packet, packet_length);
-            if (ok)
+            if (rq_congestions_ < 1 || now < (rq_wait_ + AGGLIGATOR_REORDER_TIMEOUT))
             {
-                if (dont_control)
-                {
-                    return true;
-                }
+                return true;
+            }
 
-                if (++ack_no_ == 0)
+            // The gap at ack_no_ waited long enough, jump to the oldest packet that did arrive.
+            uint32_t seq = ack_no_;
+            for (uint32_t i = 0; i <= recv_mask_; i++, seq++)
+            {
+                recv_packet& slot = recv_ring_[seq & recv_mask_];
+                if (NULL != slot.packet && slot.seq == seq)
                 {
-                    wraparound_ = false;
+                    break;
                 }
-
-                return rq_congestions_-- > 0;
             }
 
-            return false;
+            return skip(seq, now);
         }
         bool                                                            input(Byte* packet, int packet_length) noexcept;
         bool                                                            output(Byte* packet, int packet_length) noexcept;
@@ -317,6 +313,7 @@ namespace aggligator
             }
 
             auto self = shared_from_this();
+            sent_at_ = ppp::GetTickCount(true);
             boost::asio::async_write(*socket, boost::asio::buffer(packet.get(), length),
                 [self, this, packet, length](boost::system::error_code ec, std::size_t sz) noexcept
                 {
@@ -328,6 +325,8 @@ namespace aggligator
                         ptr aggligator = app_;
                         if (aggligator)
                         {
+                            sample(sz);
+                            tx_ += sz;
                             aggligator->tx_ += sz;
                             aggligator->tx_pps_++;
                             processed = next();
@@ -409,6 +408,7 @@ namespace aggligator
                         return false;
                     }
 
+                    rx_ += sz;
                     aggligator->rx_ += sz;
                     if (sz != 2)
                     {
@@ -450,6 +450,7 @@ namespace aggligator
                                 return false;
                             }
 
+                            rx_ += sz;
                             aggligator->rx_ += sz;
                             if (length != sz)
                             {
@@ -585,8 +586,50 @@ namespace aggligator
             return true;
         }
         bool                                                            establish(const boost::asio::yield_context& y, const ppp::function<void(connection*)>& established) noexcept;
+        void                                                            sample(std::size_t sz) noexcept
+        {
+            // Time from handing a frame to the socket until it is fully written, a link whose send buffer
+            // Backs up or whose window is closed takes longer here, which is what the scheduler has to avoid.
+            uint64_t elapsed = ppp::GetTickCount(true) - sent_at_;
+            if (elapsed < 1)
+            {
+                elapsed = 1;
+            }
+
+            uint64_t bandwidth = (uint64_t)sz * 1000000 / elapsed;
+            bandwidth_ = bandwidth_ == 0 ? bandwidth : (bandwidth_ * 7 + bandwidth) >> 3;
+
+            if (!kernel_rtt_)
+            {
+                srtt_ = srtt_ == 0 ? elapsed : (srtt_ * 7 + elapsed) >> 3;
+            }
+        }
+        uint64_t                                                        score(int length) noexcept
+        {
+            if (bandwidth_ == 0)
+            {
+                return srtt_;
+            }
+
+            return srtt_ + (uint64_t)length * 1000000 / bandwidth_;
+        }
         bool                                                            update(uint32_t now) noexcept
         {
+#if defined(_LINUX)
+            // Prefer the kernel's smoothed round trip when it is available, the write latency only sees the local side.
+            std::shared_ptr<boost::asio::ip::tcp::socket> socket = socket_;
+            if (NULL != socket && socket->is_open())
+            {
+                struct tcp_info ti;
+                socklen_t len = sizeof(ti);
+                if (getsockopt(socket->native_handle(), IPPROTO_TCP, TCP_INFO, &ti, &len) == 0 && ti.tcpi_rtt > 0)
+                {
+                    srtt_ = ti.tcpi_rtt;
+                    kernel_rtt_ = true;
+                }
+            }
+#endif
+
             std::shared_ptr<Byte> packet;
             if (next_ == 0)
             {
@@ -637,6 +680,12 @@ namespace aggligator
         std::shared_ptr<boost::asio::ip::tcp::socket>                   socket_;
         bool                                                            sending_;
         uint32_t                                                        next_;
+        bool                                                            kernel_rtt_ = false;
+        uint64_t                                                        sent_at_    = 0;
+        uint64_t                                                        srtt_       = 0;
+        uint64_t                                                        bandwidth_  = 0;
+        uint64_t                                                        rx_         = 0;
+        uint64_t                                                        tx_         = 0;
         std::shared_ptr<Byte>                                           next_packet_;
 #if defined(_WIN32)
         std::shared_ptr<QoSS>                                           qoss_;
@@ -760,6 +809,38 @@ namespace aggligator
         return nawait_timeout();
     }
 
+    void aggligator::reorder(uint64_t now) noexcept
+    {
+        list<client_ptr> releases;
+        auto expire = 
+            [&releases, now](const client_ptr& pclient) noexcept
+            {
+                convergence_ptr pconvergence = pclient->convergence_;
+                if (pconvergence && !pconvergence->expire(now))
+                {
+                    releases.emplace_back(pclient);
+                }
+            };
+
+        if (client_ptr pclient = client_; pclient)
+        {
+            expire(pclient);
+        }
+
+        if (server_ptr pserver = server_; pserver)
+        {
+            for (auto&& kv : pserver->clients_)
+            {
+                expire(kv.second);
+            }
+        }
+
+        for (client_ptr& pclient : releases)
+        {
+            pclient->close();
+        }
+    }
+
     bool aggligator::nawait_timeout() noexcept
     {
         deadline_timer t = timeout_;
@@ -780,6 +861,8 @@ namespace aggligator
                     uint32_t now_seconds = (uint32_t)(now / 1000);
 
                     now_ = now;
+                    reorder(now);
+
                     if (last_ != now_seconds)
                     {
                         last_ = now_seconds;
@@ -1478,14 +1561,23 @@ namespace aggligator
                 return true;
             }
 
+            // Of the idle links take the one expected to deliver this message first, links without samples yet score zero
+            // So each gets probed, a busy link picks up the queue by itself as soon as its write completes.
             connection_ptr connection;
+            uint64_t connection_score = UINT64_MAX;
             for (; tail != endl; tail++)
             {
                 connection_ptr& i = *tail;
-                if (!i->sending_)
+                if (i->sending_)
+                {
+                    continue;
+                }
+
+                uint64_t score = i->score(sqt->length);
+                if (score < connection_score)
                 {
                     connection = i;
-                    break;
+                    connection_score = score;
                 }
             }
 
@@ -1494,19 +1586,7 @@ namespace aggligator
                 send_packet messages = *sqt;
                 send_queue.erase(sqt);
 
-                bool ok = connection->sent(messages.packet, messages.length);
-                if (ok)
-                {
-                    if (connection->sending_ && connections_num_ > 1)
-                    {
-                        connections_.erase(tail);
-                        connections_.emplace_back(connection);
-                    }
-
-                    return true;
-                }
-
-                return false;
+                return connection->sent(messages.packet, messages.length);
             }
             else
             {
@@ -1771,75 +1851,75 @@ namespace aggligator
         {
             return process(packet, packet_length, true);
         }
-        else
+        elif(before(seq, ack_no_))
         {
-            if (seq < ack_no_)
-            {
-                wraparound_ = before(ack_no_, seq);
-                if (!wraparound_)
-                {
-                    return true;
-                }
-            }
-
-            if (++rq_congestions_ > max_congestions)
-            {
-                return false;
-            }
+            return true;
         }
 
-        if (ack_no_ == seq)
+        if (recv_ring_.empty())
         {
-            if (!process(packet, packet_length, false))
+            uint32_t capacity = 1;
+            while ((int64_t)capacity << 1 <= max_congestions && capacity < (1 << 16))
             {
-                return false;
+                capacity <<= 1;
             }
 
-            auto tail = recv_queue_.begin();
-            auto endl = recv_queue_.end();
-            while (tail != endl)
-            {
-                if (ack_no_ != tail->seq)
-                {
-                    break;
-                }
-                else
-                {
-                    recv_packet& pr = *tail;
-                    if (!process(pr.packet.get(), pr.length, false))
-                    {
-                        return false;
-                    }
-                }
-
-                tail = recv_queue_.erase(tail);
-            }
+            recv_ring_.resize(capacity);
+            recv_mask_ = capacity - 1;
+        }
 
+        uint64_t now = aggligator->now();
+        if (!expire(now))
+        {
+            return false;
+        }
+        elif(before(seq, ack_no_))
+        {
             return true;
         }
 
-        recv_packet r;
-        r.seq = seq;
-        r.length = packet_length;
-        r.packet = aggligator->make_shared_bytes(packet_length);
-        if (r.packet)
+        uint32_t distance = seq - ack_no_;
+        if (distance > recv_mask_)
         {
-            memcpy(r.packet.get(), packet, packet_length);
-            if (wraparound_)
+            if (!skip(seq - recv_mask_, now))
             {
-                emplace_wraparound(recv_queue_, r);
+                return false;
             }
-            else
+            elif(before(seq, ack_no_))
             {
-                emplace(recv_queue_, r);
+                return true;
             }
 
+            distance = seq - ack_no_;
+        }
+
+        if (distance == 0)
+        {
+            return process(packet, packet_length, false) && drain(now);
+        }
+
+        recv_packet& slot = recv_ring_[seq & recv_mask_];
+        if (NULL != slot.packet)
+        {
             return true;
         }
-        else
+
+        slot.packet = aggligator->make_shared_bytes(packet_length);
+        if (NULL == slot.packet)
         {
             return false;
         }
+
+        slot.seq = seq;
+        slot.length = packet_length;
+        memcpy(slot.packet.get(), packet, packet_length);
+
+        if (rq_congestions_++ == 0)
+        {
+            rq_wait_ = now;
+        }
+
+        return true;
     }
 
     void aggligator::convergence::close() noexcept
@@ -1851,7 +1931,8 @@ namespace aggligator
         app_.reset();
 
         send_queue_.clear();
-        recv_queue_.clear();
+        recv_ring_.clear();
+        rq_congestions_ = 0;
 
         if (client)
         {
@@ -1979,6 +2060,30 @@ namespace aggligator
 
     bool aggligator::info(information& i) noexcept
     {
+        auto client_links = 
+            [&i](const client_ptr& client) noexcept
+            {
+                for (connection_ptr& pconnection : client->connections_)
+                {
+                    std::shared_ptr<boost::asio::ip::tcp::socket> socket = pconnection->socket_;
+                    if (NULL == socket)
+                    {
+                        continue;
+                    }
+
+                    boost::system::error_code ec;
+                    link_information link;
+                    link.remote_endpoint = socket->remote_endpoint(ec);
+                    link.rx = pconnection->rx_;
+                    link.tx = pconnection->tx_;
+                    link.srtt = pconnection->srtt_;
+                    link.bandwidth = pconnection->bandwidth_;
+                    link.sending = pconnection->sending_;
+                    i.links.emplace_back(link);
+                }
+            };
+
+        i.links.clear();
         i.server_endpoints.clear();
         i.bind_ports.clear();
         i.client_count = 0;
@@ -2004,10 +2109,13 @@ namespace aggligator
                 client_ptr& pclient = kv.second;
                 i.establish_count += pclient->established_num_;
                 i.connection_count += pclient->connections_num_;
+                client_links(pclient);
             }
         }
         elif(client)
         {
+            client_links(client);
+
             boost::asio::ip::udp::socket& dgram_socket = client->socket_;
             if (dgram_socket.is_open())
             {
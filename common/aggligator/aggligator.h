@@ -36,6 +36,7 @@ namespace aggligator
     static constexpr int AGGLIGATOR_RECONNECT_TIMEOUT                           = 5;
     static constexpr int AGGLIGATOR_CONNECT_TIMEOUT                             = 5;
     static constexpr int AGGLIGATOR_INACTIVE_TIMEOUT                            = 72;
+    static constexpr int AGGLIGATOR_REORDER_TIMEOUT                             = 200;
 
     class aggligator : public std::enable_shared_from_this<aggligator>
     {
@@ -60,6 +61,17 @@ namespace aggligator
         };
 
     public:
+        class link_information final
+        {
+        public:
+            boost::asio::ip::tcp::endpoint                                      remote_endpoint;
+            uint64_t                                                            rx;
+            uint64_t                                                            tx;
+            uint64_t                                                            srtt;
+            uint64_t                                                            bandwidth;
+            bool                                                                sending;
+        };
+
         class information final
         {
         public:
@@ -72,6 +84,7 @@ namespace aggligator
             uint32_t                                                            establish_count;
             unordered_set<int>                                                  bind_ports;
             unordered_set<boost::asio::ip::tcp::endpoint>                       server_endpoints;
+            vector<link_information>                                            links;
         };
 
     public:
@@ -154,6 +167,7 @@ namespace aggligator
         bool                                                                    server_accept(const std::shared_ptr<boost::asio::ip::tcp::socket>& socket, YieldContext& y) noexcept;
         bool                                                                    create_timeout() noexcept;
         bool                                                                    nawait_timeout() noexcept;
+        void                                                                    reorder(uint64_t now) noexcept;
 
     private:
         boost::asio::io_context&                                                context_;
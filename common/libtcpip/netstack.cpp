@@ -44,6 +44,7 @@ namespace lwip {
     public:
         typedef struct {
             std::shared_ptr<char>                       p;
+            std::shared_ptr<struct pbuf>                chain;
             int                                         sz;
         }                                               buffer_chunk;
 
@@ -62,8 +63,11 @@ namespace lwip {
         }                                               ENETSTACK_TCP_SENT_BUFS;
 
     public:
+        // The lwIP half (pcb, sents[ENETSTACK_TCP_SENT_LWIP]) is only touched on netstack::Executor, the socket half (socket, open,
+        // sents[ENETSTACK_TCP_SENT_SOCK]) only on the flow's own context, the two sides hand work to each other by posting.
         ppp::list<send_context_ptr>                     sents[ENETSTACK_TCP_SENT_MAX];
         std::shared_ptr<boost::asio::ip::tcp::socket>   socket;
+        std::shared_ptr<boost::asio::io_context>        context;
         bool                                            open;
         int                                             pnat;
 
@@ -73,7 +77,6 @@ namespace lwip {
         u16_t                                           local_port;
         ip_addr_t                                       remote_ip;
         u16_t                                           remote_port;
-        u8_t                                            buf[1400];
 
     public:
         netstack_tcp_socket() noexcept;
@@ -85,6 +88,15 @@ namespace lwip {
     typedef ppp::unordered_map<int, NetstackSocket>     Nat2Socket;
     typedef std::mutex                                  SynchronizedObject;
     typedef std::lock_guard<SynchronizedObject>         SynchronizedObjectScope;
+    typedef struct {
+        SynchronizedObject                              syncobj;
+        Ptr2Socket                                      p2ss;
+        Nat2Socket                                      n2ss;
+    }                                                   NetstackShard;
+
+    static constexpr int                                NETSTACK_SHARDS = 16;
+    // One socket read is handed to tcp_write whole, so it has to stay well below the send buffer or it could never be queued.
+    static constexpr int                                NETSTACK_TCP_READ_SIZE = LWIP_MAX(TCP_MSS, LWIP_MIN(0xffff, (TCP_SND_BUF) / 4));
 
     LIBTCPIP_CLOSE_EVENT                                netstack::close_event = NULL;
     LIBTCPIP_IPV4_OUTPUT                                netstack::output      = NULL;
@@ -97,9 +109,7 @@ namespace lwip {
     static std::shared_ptr<boost::asio::deadline_timer> timeout_;
     static struct netif*                                netif_              = NULL;
     static struct tcp_pcb*                              pcb_                = NULL;
-    static Ptr2Socket                                   p2ss_;
-    static Nat2Socket                                   n2ss_;
-    static SynchronizedObject                           lockobj_;
+    static NetstackShard                                shards_[NETSTACK_SHARDS];
     class NetstackInternal final {
     public:
         static void                                     run() noexcept;
@@ -108,10 +118,12 @@ namespace lwip {
 
     static bool                                         netstack_socket_connect(const std::shared_ptr<netstack_tcp_socket>& socket_, const boost::asio::ip::tcp::endpoint& remoteEP_) noexcept;
     static bool                                         netstack_tunnel_open(const std::shared_ptr<netstack_tcp_socket>& socket_, boost::asio::ip::tcp::endpoint& remoteEP_) noexcept;
-    static bool                                         netstack_tunnel_send(const std::shared_ptr<netstack_tcp_socket>& socket_, void* data, int len, bool unsafe_) noexcept;
+    static bool                                         netstack_tunnel_send(const std::shared_ptr<netstack_tcp_socket>& socket_, const std::shared_ptr<struct pbuf>& chain, int len) noexcept;
+    static bool                                         netstack_tunnel_dorecv(const std::shared_ptr<netstack_tcp_socket>& socket_) noexcept;
     static err_t                                        netstack_tcp_closesocket(struct tcp_pcb* pcb) noexcept;
     static bool                                         netstack_tcp_closesocket(netstack_tcp_socket* socket_) noexcept;
-    static inline bool                                  netstack_tcp_closesocket(const std::shared_ptr<netstack_tcp_socket>& socket_) noexcept { return netstack_tcp_closesocket(socket_.get()); }
+    static bool                                         netstack_tcp_closesocket(const std::shared_ptr<netstack_tcp_socket>& socket_) noexcept;
+    static void                                         netstack_tunnel_close(netstack_tcp_socket* socket_) noexcept;
 
     void netstack_cctor() noexcept {
         std::shared_ptr<boost::asio::io_context> context = ppp::make_shared_object<boost::asio::io_context>();
@@ -143,13 +155,36 @@ namespace lwip {
         context.stop();
     }
 
+    static NetstackShard& netstack_tcp_getshard(uint64_t key) noexcept {
+        uint64_t h = key * 0x9E3779B97F4A7C15ULL;
+        return shards_[static_cast<std::size_t>(h >> 32) & (NETSTACK_SHARDS - 1)];
+    }
+
+    // Every flow keeps its socket on the worker picked by its 4-tuple, so the copies and syscalls of the proxied streams are spread over
+    // All cores while lwIP itself stays on netstack::Executor. Without worker threads the flow simply stays on the lwIP thread.
+    static std::shared_ptr<boost::asio::io_context> netstack_tcp_getcontext(struct tcp_pcb* pcb) noexcept {
+        ppp::vector<ppp::threading::Executors::ContextPtr> contexts;
+        ppp::threading::Executors::GetAllContexts(contexts);
+
+        std::size_t count = contexts.size();
+        if (count < 1 || (count == 1 && contexts[0] == ppp::threading::Executors::GetDefault())) {
+            return netstack::Executor;
+        }
+
+        uint64_t h = ((uint64_t)ip_addr_get_ip4_u32(&pcb->remote_ip) << 32) | ip_addr_get_ip4_u32(&pcb->local_ip);
+        h ^= ((uint64_t)pcb->remote_port << 16 | pcb->local_port) * 0xC2B2AE3D27D4EB4FULL;
+        h *= 0x9E3779B97F4A7C15ULL;
+        return contexts[static_cast<std::size_t>(h >> 32) % count];
+    }
+
     static void* netstack_tcp_linksocket(struct tcp_pcb* pcb, const std::shared_ptr<netstack_tcp_socket>& socket) noexcept {
         if (!pcb || !socket) {
             return NULL;
         }
 
-        SynchronizedObjectScope scope_(lockobj_);
-        std::pair<Ptr2Socket::iterator, bool> r_ = p2ss_.emplace(pcb, socket);
+        NetstackShard& shard_ = netstack_tcp_getshard((uint64_t)(uintptr_t)pcb);
+        SynchronizedObjectScope scope_(shard_.syncobj);
+        std::pair<Ptr2Socket::iterator, bool> r_ = shard_.p2ss.emplace(pcb, socket);
         return r_.second ? pcb : NULL;
     }
 
@@ -158,21 +193,23 @@ namespace lwip {
             return NULL;
         }
 
-        SynchronizedObjectScope scope_(lockobj_);
-        Ptr2Socket::iterator tail_ = p2ss_.find(p);
-        Ptr2Socket::iterator endl_ = p2ss_.end();
+        NetstackShard& shard_ = netstack_tcp_getshard((uint64_t)(uintptr_t)p);
+        SynchronizedObjectScope scope_(shard_.syncobj);
+        Ptr2Socket::iterator tail_ = shard_.p2ss.find(p);
+        Ptr2Socket::iterator endl_ = shard_.p2ss.end();
         return tail_ != endl_ ? tail_->second : NULL;
     }
 
     static std::shared_ptr<netstack_tcp_socket> netstack_tcp_releasesocket(void* p) noexcept {
         std::shared_ptr<netstack_tcp_socket> socket; 
         if (p) {
-            SynchronizedObjectScope scope_(lockobj_);
-            Ptr2Socket::iterator tail_ = p2ss_.find(p);
-            Ptr2Socket::iterator endl_ = p2ss_.end();
+            NetstackShard& shard_ = netstack_tcp_getshard((uint64_t)(uintptr_t)p);
+            SynchronizedObjectScope scope_(shard_.syncobj);
+            Ptr2Socket::iterator tail_ = shard_.p2ss.find(p);
+            Ptr2Socket::iterator endl_ = shard_.p2ss.end();
             if (tail_ != endl_) {
                 socket = std::move(tail_->second);
-                p2ss_.erase(tail_);
+                shard_.p2ss.erase(tail_);
             }
         }
         return socket;
@@ -183,8 +220,9 @@ namespace lwip {
             return 0;
         }
 
-        SynchronizedObjectScope scope_(lockobj_);
-        std::pair<Nat2Socket::iterator, bool> r_ = n2ss_.emplace(nat, socket);
+        NetstackShard& shard_ = netstack_tcp_getshard(nat);
+        SynchronizedObjectScope scope_(shard_.syncobj);
+        std::pair<Nat2Socket::iterator, bool> r_ = shard_.n2ss.emplace(nat, socket);
         return r_.second ? nat : 0;
     }
 
@@ -193,9 +231,10 @@ namespace lwip {
             return NULL;
         }
 
-        SynchronizedObjectScope scope_(lockobj_);
-        Nat2Socket::iterator tail_ = n2ss_.find(nat);
-        Nat2Socket::iterator endl_ = n2ss_.end();
+        NetstackShard& shard_ = netstack_tcp_getshard(nat);
+        SynchronizedObjectScope scope_(shard_.syncobj);
+        Nat2Socket::iterator tail_ = shard_.n2ss.find(nat);
+        Nat2Socket::iterator endl_ = shard_.n2ss.end();
         return tail_ != endl_ ? tail_->second : NULL;
     }
 
@@ -205,18 +244,19 @@ namespace lwip {
         }
 
         std::shared_ptr<netstack_tcp_socket> socket; {
-            SynchronizedObjectScope scope_(lockobj_);
-            Nat2Socket::iterator tail_ = n2ss_.find(nat);
-            Nat2Socket::iterator endl_ = n2ss_.end();
+            NetstackShard& shard_ = netstack_tcp_getshard(nat);
+            SynchronizedObjectScope scope_(shard_.syncobj);
+            Nat2Socket::iterator tail_ = shard_.n2ss.find(nat);
+            Nat2Socket::iterator endl_ = shard_.n2ss.end();
             if (tail_ != endl_) {
                 socket = std::move(tail_->second);
-                n2ss_.erase(tail_);
+                shard_.n2ss.erase(tail_);
             }
         } 
         return socket;
     }
 
-    static err_t netstack_tcp_send(struct tcp_pcb* pcb, void* data, u16_t len, const ppp::function<void(struct tcp_pcb*)>& callback) noexcept {
+    static err_t netstack_tcp_send(struct tcp_pcb* pcb, const std::shared_ptr<char>& chunk_, u16_t len, const ppp::function<void(struct tcp_pcb*)>& callback) noexcept {
         if (!pcb) {
             return ERR_ARG;
         }
@@ -226,27 +266,20 @@ namespace lwip {
             return ERR_ABRT;
         }
 
-        if (!data || !len) {
+        if (!chunk_ || !len) {
             return ERR_ARG;
         }
 
+        // The chunk was read for this flow alone, so the backlog keeps it as is instead of copying it once more.
         static auto tcp_enqueue_ =
-            [](netstack_tcp_socket* socket_, struct tcp_pcb* pcb, void* data, u16_t len, const ppp::function<void(struct tcp_pcb*)>& callback) noexcept {
-                std::shared_ptr<char> chunk_ = std::shared_ptr<char>((char*)lwip_netstack_malloc(len), lwip_netstack_free);
-                if (!chunk_) {
-                    return ERR_MEM;
-                }
-                else {
-                    memcpy(chunk_.get(), data, len);
-                }
-
+            [](netstack_tcp_socket* socket_, struct tcp_pcb* pcb, const std::shared_ptr<char>& chunk_, u16_t len, const ppp::function<void(struct tcp_pcb*)>& callback) noexcept {
                 netstack_tcp_socket::send_context_ptr context =
                     ppp::make_shared_object<netstack_tcp_socket::send_context>();
                 if (!context) {
                     return ERR_MEM;
                 }
 
-                context->buf.p = std::move(chunk_);
+                context->buf.p = chunk_;
                 context->buf.sz = len;
                 context->cb = callback;
                 socket_->sents[netstack_tcp_socket::ENETSTACK_TCP_SENT_LWIP].emplace_back(std::move(context));
@@ -254,10 +287,10 @@ namespace lwip {
             };
 
         if (!socket_->sents[netstack_tcp_socket::ENETSTACK_TCP_SENT_LWIP].empty()) {
-            return tcp_enqueue_(socket_.get(), pcb, data, len, callback);
+            return tcp_enqueue_(socket_.get(), pcb, chunk_, len, callback);
         }
 
-        err_t err = tcp_write(pcb, data, len, TCP_WRITE_FLAG_COPY);
+        err_t err = tcp_write(pcb, chunk_.get(), len, TCP_WRITE_FLAG_COPY);
         if (err == ERR_OK) {
             tcp_output(pcb);
             if (callback) {
@@ -266,7 +299,7 @@ namespace lwip {
             return err;
         }
         else if (err == ERR_MEM) {
-            return tcp_enqueue_(socket_.get(), pcb, data, len, callback);
+            return tcp_enqueue_(socket_.get(), pcb, chunk_, len, callback);
         }
         return err;
     }
@@ -286,37 +319,70 @@ namespace lwip {
         }
     }
 
-    static bool netstack_tcp_closesocket(netstack_tcp_socket* socket_) noexcept {
-        if (!socket_) {
-            return false;
-        }
-
+    static void netstack_tunnel_close(netstack_tcp_socket* socket_) noexcept {
         std::shared_ptr<boost::asio::ip::tcp::socket> socket = std::move(socket_->socket);
         if (socket) {
             socket_->socket = NULL;
             ppp::net::Socket::Closesocket(socket);
         }
 
-        for (int i = netstack_tcp_socket::ENETSTACK_TCP_SENT_LWIP; i < netstack_tcp_socket::ENETSTACK_TCP_SENT_MAX; i++) {
-            socket_->sents[i].clear();
+        socket_->sents[netstack_tcp_socket::ENETSTACK_TCP_SENT_SOCK].clear();
+    }
+
+    static bool netstack_tcp_closesocket(netstack_tcp_socket* socket_) noexcept {
+        if (!socket_) {
+            return false;
         }
 
+        socket_->sents[netstack_tcp_socket::ENETSTACK_TCP_SENT_LWIP].clear();
+
         struct tcp_pcb* pcb = socket_->pcb;
         if (pcb) {
             socket_->pcb = NULL;
             netstack_tcp_releasesocket(pcb->callback_arg);
         }
 
-        for (ppp::list<netstack_tcp_socket::send_context_ptr>& sents : socket_->sents) {
-            sents.clear();
-        }
-
         netstack_tcp_releasesocket(socket_->pnat);
         netstack_tcp_closesocket(pcb);
 
         return true;
     }
 
+    static bool netstack_tcp_closesocket(const std::shared_ptr<netstack_tcp_socket>& socket_) noexcept {
+        if (!socket_) {
+            return false;
+        }
+
+        // The pcb is torn down on the lwIP thread and the socket on its own context, whichever side asked for the close.
+        std::shared_ptr<boost::asio::io_context> executor = netstack::Executor;
+        if (NULL == executor) {
+            return false;
+        }
+        else if (!executor->get_executor().running_in_this_thread()) {
+            std::shared_ptr<netstack_tcp_socket> socket__ = socket_;
+            boost::asio::post(*executor, 
+                [socket__]() noexcept {
+                    netstack_tcp_closesocket(socket__);
+                });
+            return true;
+        }
+
+        netstack_tcp_closesocket(socket_.get());
+
+        std::shared_ptr<boost::asio::io_context> context = socket_->context;
+        if (NULL == context || context == executor) {
+            netstack_tunnel_close(socket_.get());
+        }
+        else {
+            std::shared_ptr<netstack_tcp_socket> socket__ = socket_;
+            boost::asio::post(*context, 
+                [socket__]() noexcept {
+                    netstack_tunnel_close(socket__.get());
+                });
+        }
+        return true;
+    }
+
     static err_t netstack_tcp_closesocket(struct tcp_pcb* pcb) noexcept {
         if (!pcb) {
             return ERR_ARG;
@@ -366,6 +432,7 @@ namespace lwip {
     }
 
     netstack_tcp_socket::~netstack_tcp_socket() noexcept {
+        netstack_tunnel_close(this);
         netstack_tcp_closesocket(this);
     }
 
@@ -384,26 +451,41 @@ namespace lwip {
         }
     }
 
+    // Lets a received chain travel to the flow's socket without being copied, the last owner hands it back to the lwIP thread to be freed.
+    // Once that thread is gone or its context stopped nothing would run the handler, the chain is then freed right away.
+    static std::shared_ptr<struct pbuf> netstack_pbuf_share(struct pbuf* buf) noexcept {
+        return std::shared_ptr<struct pbuf>(buf, 
+            [](struct pbuf* buf) noexcept {
+                std::shared_ptr<boost::asio::io_context> executor = netstack::Executor;
+                if (NULL == executor || executor->stopped()) {
+                    netstack_pbuf_free(buf);
+                }
+                else {
+                    boost::asio::dispatch(*executor, 
+                        [buf]() noexcept {
+                            netstack_pbuf_free(buf);
+                        });
+                }
+            });
+    }
+
     static err_t netstack_tcp_dorecv(void* arg, struct tcp_pcb* pcb, struct pbuf* p, err_t err) noexcept {
         LWIP_UNUSED_ARG(arg);
 
         while (p) {
-            if (p->len > 0) {
+            if (p->tot_len > 0) {
                 std::shared_ptr<netstack_tcp_socket> socket = netstack_tcp_getsocket(pcb->callback_arg);
-                if (socket) {
-                    bool ok = true;
-                    for (struct pbuf* q = p; q; q = q->next) {
-                        bool sent = netstack_tunnel_send(socket, q->payload, q->len, true);
-                        if (!sent) {
-                            ok = false;
-                            break;
-                        }
-                    }
-
-                    if (ok) {
-                        netstack_pbuf_free(p);
-                        return ERR_OK;
-                    }
+                std::shared_ptr<boost::asio::io_context> context = socket ? socket->context : NULL;
+                if (context) {
+                    int len = p->tot_len;
+                    std::shared_ptr<struct pbuf> chain = netstack_pbuf_share(p);
+                    boost::asio::dispatch(*context, 
+                        [socket, chain, len]() noexcept {
+                            if (!netstack_tunnel_send(socket, chain, len)) {
+                                netstack_tcp_closesocket(socket);
+                            }
+                        });
+                    return ERR_OK;
                 }
             }
 
@@ -456,15 +538,10 @@ namespace lwip {
     }
 
     static err_t netstack_tcp_dopoll(void* arg, struct tcp_pcb* pcb) noexcept {
+        // The socket belongs to another thread, but a dead socket always tears its pcb down through netstack_tcp_closesocket.
         std::shared_ptr<netstack_tcp_socket> socket = netstack_tcp_getsocket(pcb->callback_arg);
         if (socket) {
-            std::shared_ptr<boost::asio::ip::tcp::socket> p = socket->socket;
-            if (p) {
-                if (p->is_open()) {
-                    return ERR_OK;
-                }
-            }
-            return ERR_ABRT;
+            return ERR_OK;
         }
         else {
             tcp_abort(pcb);
@@ -476,13 +553,17 @@ namespace lwip {
         LWIP_UNUSED_ARG(arg);
         LWIP_UNUSED_ARG(err);
 
-        boost::asio::io_context& context = *netstack::Executor;
+        std::shared_ptr<boost::asio::io_context> context = netstack_tcp_getcontext(pcb);
+        if (!context) {
+            return ERR_MEM;
+        }
+
         std::shared_ptr<netstack_tcp_socket> socket_ = ppp::make_shared_object<netstack_tcp_socket>();
         if (!socket_) {
             return ERR_MEM;
         }
 
-        std::shared_ptr<boost::asio::ip::tcp::socket> socket = ppp::make_shared_object<boost::asio::ip::tcp::socket>(context);
+        std::shared_ptr<boost::asio::ip::tcp::socket> socket = ppp::make_shared_object<boost::asio::ip::tcp::socket>(*context);
         if (!socket) {
             return ERR_MEM;
         }
@@ -492,6 +573,7 @@ namespace lwip {
         socket_->pnat = ppp::net::IPEndPoint::MinPort;
         socket_->open = false;
         socket_->socket = socket;
+        socket_->context = context;
         socket_->local_ip = pcb->remote_ip;
         socket_->local_port = pcb->remote_port;
         socket_->remote_ip = pcb->local_ip;
@@ -517,8 +599,36 @@ namespace lwip {
         }
     }
 
-    static bool netstack_tunnel_send(const std::shared_ptr<netstack_tcp_socket>& socket_, void* data, int len, bool unsafe_) noexcept {
-        if (!socket_ || !data || len < 1) {
+    static void netstack_tcp_recved(const std::shared_ptr<netstack_tcp_socket>& socket_, size_t sz, const std::shared_ptr<struct pbuf>& chain) noexcept {
+        std::shared_ptr<boost::asio::io_context> executor = netstack::Executor;
+        if (NULL == executor) {
+            return;
+        }
+
+        // The chain rides along so that its last reference, and with it pbuf_free, goes away on the lwIP thread.
+        boost::asio::dispatch(*executor, 
+            [socket_, sz, chain]() noexcept {
+                struct tcp_pcb* pcb = socket_->pcb;
+                if (NULL != pcb) {
+                    size_t by = sz;
+                    while (by > 0) {
+                        u16_t len = (u16_t)by;
+                        if (by < UINT16_MAX) {
+                            by = 0;
+                        }
+                        else {
+                            by -= UINT16_MAX;
+                            len = UINT16_MAX;
+                        }
+
+                        tcp_recved(pcb, len);
+                    }
+                }
+            });
+    }
+
+    static bool netstack_tunnel_send(const std::shared_ptr<netstack_tcp_socket>& socket_, const std::shared_ptr<struct pbuf>& chain, int len) noexcept {
+        if (!socket_ || !chain || len < 1) {
             return false;
         }
 
@@ -528,60 +638,32 @@ namespace lwip {
         }
         
         if (!socket_->open) {
-            std::shared_ptr<char> chunk_ = std::shared_ptr<char>((char*)lwip_netstack_malloc(len), lwip_netstack_free);
-            if (!chunk_) {
-                return false;
-            }
-
             netstack_tcp_socket::send_context_ptr context =
                 ppp::make_shared_object<netstack_tcp_socket::send_context>();
             if (!context) {
                 return false;
             }
-            else {
-                memcpy(chunk_.get(), data, len);
-            }
 
-            context->buf.p = std::move(chunk_);
+            context->buf.chain = chain;
             context->buf.sz = len;
 
             socket_->sents[netstack_tcp_socket::ENETSTACK_TCP_SENT_SOCK].emplace_back(std::move(context));
             return true;
         }
 
-        std::shared_ptr<char> chunk_;
-        if (unsafe_) {
-            chunk_ = std::shared_ptr<char>((char*)lwip_netstack_malloc(len), lwip_netstack_free);
-            if (!chunk_) {
-                return false;
+        // Gather write straight out of the pbuf payloads.
+        ppp::vector<boost::asio::const_buffer> buffers;
+        for (struct pbuf* q = chain.get(); NULL != q; q = q->next) {
+            if (q->len > 0) {
+                buffers.emplace_back(q->payload, q->len);
             }
-
-            memcpy(chunk_.get(), data, len);
-        }
-        else {
-            chunk_ = *(std::shared_ptr<char>*)data;
         }
 
         std::shared_ptr<netstack_tcp_socket> socket__ = socket_;
-        boost::asio::async_write(*socket, boost::asio::buffer(chunk_.get(), len), 
-            [socket__, chunk_](const boost::system::error_code& ec, size_t sz) noexcept {
+        boost::asio::async_write(*socket, buffers, 
+            [socket__, chain](const boost::system::error_code& ec, size_t sz) noexcept {
                 if (ec == boost::system::errc::success) {
-                    struct tcp_pcb* pcb = socket__->pcb;
-                    if (NULL != pcb) {
-                        size_t by = sz;
-                        while (by > 0) {
-                            u16_t len = (u16_t)by;
-                            if (by < UINT16_MAX) {
-                                by = 0;
-                            }
-                            else {
-                                by -= UINT16_MAX;
-                                len = UINT16_MAX;
-                            }
-
-                            tcp_recved(pcb, len);
-                        }
-                    }
+                    netstack_tcp_recved(socket__, sz, chain);
                 }
                 else {
                     netstack_tcp_closesocket(socket__);
@@ -600,17 +682,34 @@ namespace lwip {
             return false;
         }
 
+        // Every read gets its own chunk, which then moves on to tcp_write or to the lwIP backlog without another copy.
+        std::shared_ptr<char> chunk_ = std::shared_ptr<char>((char*)lwip_netstack_malloc(NETSTACK_TCP_READ_SIZE), lwip_netstack_free);
+        if (!chunk_) {
+            return false;
+        }
+
         std::shared_ptr<netstack_tcp_socket> socket__ = socket_;
-        socket->async_read_some(boost::asio::buffer(socket_->buf, sizeof(socket_->buf)), 
-            [socket__](const boost::system::error_code& ec, size_t sz) noexcept {
+        socket->async_read_some(boost::asio::buffer(chunk_.get(), NETSTACK_TCP_READ_SIZE), 
+            [socket__, chunk_](const boost::system::error_code& ec, size_t sz) noexcept {
                 int by = std::max<int>(-1, ec ? -1 : static_cast<int>(sz));
-                if (by < 1) {
+                std::shared_ptr<boost::asio::io_context> executor = netstack::Executor;
+                if (by < 1 || NULL == executor || executor->stopped()) {
                     netstack_tcp_closesocket(socket__);
                 }
                 else {
-                    netstack_tcp_send(socket__->pcb, socket__->buf, by, 
-                        [socket__](struct tcp_pcb*) noexcept {
-                            netstack_tunnel_dorecv(socket__);
+                    boost::asio::dispatch(*executor, 
+                        [socket__, chunk_, by]() noexcept {
+                            err_t err = netstack_tcp_send(socket__->pcb, chunk_, by, 
+                                [socket__](struct tcp_pcb*) noexcept {
+                                    std::shared_ptr<boost::asio::io_context> context = socket__->context;
+                                    boost::asio::dispatch(*context, 
+                                        [socket__]() noexcept {
+                                            netstack_tunnel_dorecv(socket__);
+                                        });
+                                });
+                            if (err != ERR_OK) {
+                                netstack_tcp_closesocket(socket__);
+                            }
                         });
                 }
             });
@@ -627,7 +726,7 @@ namespace lwip {
             netstack_tcp_socket::send_context_ptr context = sents.front();
             sents.pop_front();
 
-            netstack_tunnel_send(socket_, std::addressof(context->buf.p), context->buf.sz, false);
+            netstack_tunnel_send(socket_, context->buf.chain, context->buf.sz);
         }
         return true;
     }
@@ -863,10 +962,14 @@ namespace lwip {
                     ppp::net::Socket::Cancel(*timeout);
                 }
 
-                Ptr2Socket sockets; {
-                    SynchronizedObjectScope scope_(lockobj_);
-                    sockets = std::move(p2ss_);
-                    p2ss_.clear();
+                Ptr2Socket sockets;
+                for (NetstackShard& shard_ : shards_) {
+                    SynchronizedObjectScope scope_(shard_.syncobj);
+                    for (auto&& kv : shard_.p2ss) {
+                        sockets.emplace(kv);
+                    }
+
+                    shard_.p2ss.clear();
                 }
 
                 for (auto&& kv : sockets) {
@@ -72,7 +72,9 @@
 #define LWIP_CHECKSUM_ON_COPY 1
 
 #define MEMP_NUM_TCP_PCB_LISTEN 1
+#ifndef MEMP_NUM_TCP_PCB
 #define MEMP_NUM_TCP_PCB 16
+#endif
 #define MEMP_NUM_UDP_PCB 1
 
 /*
@@ -85,12 +87,43 @@
 #define TCP_MSS 1460
 #endif
 
-#define TCP_WND 32 * 1024
+// high-throughput profile (-DLWIP_HIGH_THROUGHPUT): window scaling and SACK
+// so that one flow is not capped at 32 KB per round trip on long fat links,
+// every size below can still be overridden from the compiler command line.
+// the pools are served by the heap (MEMP_MEM_MALLOC), so their counts are
+// not hard limits, memory grows with what the flows actually keep in flight.
+#if defined(LWIP_HIGH_THROUGHPUT)
+#ifndef TCP_RCV_SCALE
+#define TCP_RCV_SCALE 5
+#endif
+#ifndef TCP_WND
+#define TCP_WND (1024 * 1024)
+#endif
+#ifndef TCP_SND_BUF
 #define TCP_SND_BUF (TCP_WND)
+#endif
+#ifndef MEM_SIZE
+#define MEM_SIZE (4 * 1024 * 1024)
+#endif
+#ifndef TCP_SNDLOWAT
+#define TCP_SNDLOWAT (32 * 1024)
+#endif
+#define LWIP_WND_SCALE 1
+#define LWIP_TCP_SACK_OUT 1
+#else
+#ifndef TCP_WND
+#define TCP_WND (32 * 1024)
+#endif
+#ifndef TCP_SND_BUF
+#define TCP_SND_BUF (TCP_WND)
+#endif
+#ifndef MEM_SIZE
+#define MEM_SIZE (128 * 1024)
+#endif
+#endif
 
 #define MEM_LIBC_MALLOC 1
 #define MEMP_MEM_MALLOC 1
-#define MEM_SIZE 128 * 1024
 
 #define SYS_LIGHTWEIGHT_PROT 0
 #define LWIP_DONT_PROVIDE_BYTEORDER_FUNCTIONS
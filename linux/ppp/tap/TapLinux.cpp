@@ -85,29 +85,38 @@ namespace ppp {
         class SsmtThreadLocalTls final {
         public:
             SsmtThreadLocalTls() noexcept
-                : tun_fd_(-1) {
+                : tun_queue_(NULL) {
                 
             }
 
         public:
-            int                                 tun_fd_;
+            void*                               tun_queue_; // The TapLinux::SsmtQueuePtr whose packet is being delivered on this thread.
         };
 
         static thread_local SsmtThreadLocalTls  ssmt_tls_;
         static bool                             ifc_ctl_sock_compatible_route = false;
+        static bool                             ifc_ctl_tun_offload           = false;
+
+        // Offload mode reads a whole GSO packet behind its virtio header, the second half of the buffer is where it gets split.
+        static constexpr int                    TAP_LINUX_VNET_BUFFER_SIZE    = ppp::tap::vnet::VNET_HDR_SIZE + ppp::tap::vnet::VNET_MAX_PACKET;
 
         TapLinux::TapLinux(const std::shared_ptr<boost::asio::io_context>& context, const ppp::string& dev, void* tun, uint32_t address, uint32_t gw, uint32_t mask, bool hosted_network)
             : ITap(context, dev, tun, address, gw, mask, hosted_network)
             , promisc_(false)
             , disposed_(FALSE) {
-
+            tun_queue_ = make_shared_object<SsmtQueue>();
+            if (NULL != tun_queue_) {
+                tun_queue_->Handle = static_cast<int>(reinterpret_cast<std::intptr_t>(tun));
+                tun_queue_->Stream = GetStream();
+                tun_queue_->Context = GetContext();
+            }
         }
 
         TapLinux::~TapLinux() noexcept {
             Finalize();
         }
 
-        int TapLinux::OpenDriver(const char* ifrName) noexcept {
+        int TapLinux::OpenDriver(const char* ifrName, bool& offload) noexcept {
             if (NULL == ifrName || *ifrName == '\x0') {
                 ifrName = "tun%d";
             }
@@ -136,16 +145,25 @@ namespace ppp {
             // https://www.kernel.org/doc/Documentation/networking/tuntap.txt
             strncpy(ifr.ifr_name, ifrName, IFNAMSIZ);
 
+            short tun_flags = IFF_TUN | IFF_NO_PI;
+#if defined(IFF_VNET_HDR)
+            if (offload) {
+                tun_flags |= IFF_VNET_HDR;
+            }
+#else
+            offload = false;
+#endif
+
 #if defined(IFF_MULTI_QUEUE)
-            ifr.ifr_flags = IFF_TUN | IFF_NO_PI | IFF_MULTI_QUEUE;
+            ifr.ifr_flags = tun_flags | IFF_MULTI_QUEUE;
 
             bool fails = ioctl(tun, TUNSETIFF, &ifr) < 0;
             if (fails) {
-                ifr.ifr_flags = IFF_TUN | IFF_NO_PI;
+                ifr.ifr_flags = tun_flags;
                 fails = ioctl(tun, TUNSETIFF, &ifr) < 0;
             }
 #else
-            ifr.ifr_flags = IFF_TUN | IFF_NO_PI;
+            ifr.ifr_flags = tun_flags;
             bool fails = ioctl(tun, TUNSETIFF, &ifr) < 0;
 #endif
 
@@ -153,15 +171,36 @@ namespace ppp {
                 ::close(tun);
                 return -1;
             }
-            else {
-                return tun;
+
+#if defined(IFF_VNET_HDR)
+            // Let the kernel hand over TCP/UDP super packets with partial checksums, UDP segmentation offload needs Linux 6.2,
+            // Older kernels reject the unknown flags and still get TSO.
+            if (offload) {
+                int vnet_hdr_size = ppp::tap::vnet::VNET_HDR_SIZE;
+                offload = ioctl(tun, TUNSETVNETHDRSZ, &vnet_hdr_size) > -1;
+                if (offload) {
+                    unsigned int offloads = TUN_F_CSUM | TUN_F_TSO4 | TUN_F_TSO6;
+#if defined(TUN_F_USO4) && defined(TUN_F_USO6)
+                    if (ioctl(tun, TUNSETOFFLOAD, offloads | TUN_F_USO4 | TUN_F_USO6) < 0) {
+                        ioctl(tun, TUNSETOFFLOAD, offloads);
+                    }
+#else
+                    ioctl(tun, TUNSETOFFLOAD, offloads);
+#endif
+                }
             }
+#endif
+            return tun;
         }
 
         void TapLinux::CompatibleRoute(bool compatible) noexcept {
             ifc_ctl_sock_compatible_route = compatible;
         }
 
+        void TapLinux::Offload(bool offload) noexcept {
+            ifc_ctl_tun_offload = offload;
+        }
+
         bool TapLinux::SetIPAddress(const ppp::string& ifrName, const ppp::string& addressIP, const ppp::string& mask) noexcept {
             if (ifrName.empty()) {
                 return false;
@@ -761,19 +800,43 @@ namespace ppp {
                 SetNetifUp(false);
             }
 
-            stl::remove_reference<decltype(tun_ssmt_sds_)>::type tun_ssmt_sds;
+            SsmtQueueListPtr queues;
             if (Ssmt()) {
                 SynchronizedObjectScope scope(syncobj_);
-                tun_ssmt_sds = std::move(tun_ssmt_sds_);
-                tun_ssmt_sds_.clear();
+                queues = std::atomic_exchange(&tun_ssmt_queues_, SsmtQueueListPtr());
                 tun_ssmt_fds_size_ = 0;
             }
 
-            for (std::shared_ptr<boost::asio::posix::stream_descriptor>& sd : tun_ssmt_sds) {
-                Socket::Closestream(sd);
+            if (NULL != queues) {
+                for (SsmtQueuePtr& queue : *queues) {
+                    Socket::Closestream(queue->Stream);
+                }
             }
         }
 
+        static uint32_t TapLinux_FlowHash(const void* packet, int packet_size) noexcept {
+            using ppp::net::native::ip_hdr;
+
+            struct ip_hdr* iphdr = (struct ip_hdr*)packet;
+            if (packet_size < (int)sizeof(struct ip_hdr) || ip_hdr::IPH_V(iphdr) != 4) {
+                return 0;
+            }
+
+            // Both directions of a flow hash alike, fragments after the first carry no ports and fall back to the addresses.
+            uint32_t ports = 0;
+            int proto = ip_hdr::IPH_PROTO(iphdr);
+            int iphdr_hlen = ip_hdr::IPH_HL(iphdr) << 2;
+            if ((proto == ip_hdr::IP_PROTO_TCP || proto == ip_hdr::IP_PROTO_UDP) && packet_size >= iphdr_hlen + 4) {
+                if ((ntohs(ip_hdr::IPH_OFFSET(iphdr)) & ip_hdr::IP_OFFMASK) == 0) {
+                    const uint16_t* pp = (const uint16_t*)((const Byte*)packet + iphdr_hlen);
+                    ports = pp[0] ^ pp[1];
+                }
+            }
+
+            uint64_t t = MAKE_QWORD(iphdr->src ^ iphdr->dest, ports | (uint32_t)proto << 16);
+            return (uint32_t)GetHashCode((char*)&t, sizeof(t));
+        }
+
         bool TapLinux::Output(const std::shared_ptr<Byte>& packet, int packet_size) noexcept {
             return Output(packet.get(), packet_size);
         }
@@ -791,17 +854,162 @@ namespace ppp {
                 return false;
             }
             
-            // https://man7.org/linux/man-pages/man2/write.2.html
-            int tun = static_cast<int>(reinterpret_cast<std::intptr_t>(GetHandle()));
+            // Replies produced while a queue delivers a packet go back out through that queue, anything written from other threads
+            // Is spread over all queues by flow, so a flow keeps its order and no single queue becomes the bottleneck.
+            const SsmtQueuePtr* current = static_cast<const SsmtQueuePtr*>(ssmt_tls_.tun_queue_);
+            if (NULL != current) {
+                return Output(*current, packet, packet_size);
+            }
+
             if (Ssmt()) {
-                int fd = ssmt_tls_.tun_fd_;
-                if (fd != -1) {
-                    tun = fd;
+                SsmtQueueListPtr queues = std::atomic_load(&tun_ssmt_queues_);
+                if (NULL != queues && !queues->empty()) {
+                    std::size_t index = TapLinux_FlowHash(packet, packet_size) % (queues->size() + 1);
+                    if (index > 0) {
+                        return Output((*queues)[index - 1], packet, packet_size);
+                    }
+                }
+            }
+
+            return Output(tun_queue_, packet, packet_size);
+        }
+
+        bool TapLinux::Output(const SsmtQueuePtr& queue, const void* packet, int packet_size) noexcept {
+            if (NULL == queue) {
+                return false;
+            }
+
+            if (!offload_) {
+                // https://man7.org/linux/man-pages/man2/write.2.html
+                ssize_t bytes_transferred = ::write(queue->Handle, (void*)packet, (size_t)packet_size);
+                if (bytes_transferred < 0) {
+                    queue->OutgoingDrops.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+
+                queue->OutgoingPackets.fetch_add(1, std::memory_order_relaxed);
+                queue->OutgoingBytes.fetch_add(bytes_transferred, std::memory_order_relaxed);
+                return true;
+            }
+
+            // TCP segments are held back and merged into one GSO packet, the queue's reader flushes them once the packet it 
+            // Is delivering has been handled, writes from any other thread are flushed by a handler posted to the queue's context.
+            SynchronizedObjectScope scope(queue->Lock);
+            ppp::tap::vnet::Coalescer& coalescer = queue->Coalescer;
+            if (!coalescer.Append((Byte*)packet, packet_size)) {
+                Flush(queue.get());
+                if (!coalescer.Append((Byte*)packet, packet_size)) {
+                    if (!ppp::tap::vnet::Write(queue->Handle, packet, packet_size)) {
+                        queue->OutgoingDrops.fetch_add(1, std::memory_order_relaxed);
+                        return false;
+                    }
+
+                    queue->OutgoingPackets.fetch_add(1, std::memory_order_relaxed);
+                    queue->OutgoingBytes.fetch_add(packet_size, std::memory_order_relaxed);
+                    return true;
+                }
+            }
+
+            queue->PendingBytes += packet_size;
+            if (coalescer.IsClosed()) {
+                return Flush(queue.get());
+            }
+
+            const SsmtQueuePtr* current = static_cast<const SsmtQueuePtr*>(ssmt_tls_.tun_queue_);
+            if (NULL != current && current->get() == queue.get()) {
+                return true;
+            }
+
+            if (!queue->Flushing) {
+                std::shared_ptr<boost::asio::io_context> context = queue->Context;
+                if (NULL == context) {
+                    return Flush(queue.get());
+                }
+
+                std::shared_ptr<ITap> self = shared_from_this();
+                queue->Flushing = true;
+                boost::asio::post(*context, 
+                    [self, this, queue]() noexcept {
+                        SynchronizedObjectScope scope(queue->Lock);
+                        queue->Flushing = false;
+                        Flush(queue.get());
+                    });
+            }
+            return true;
+        }
+
+        bool TapLinux::Flush(SsmtQueue* queue) noexcept {
+            ppp::tap::vnet::Coalescer& coalescer = queue->Coalescer;
+            int segments = coalescer.GetSegments();
+            if (segments < 1) {
+                return true;
+            }
+
+            int bytes = queue->PendingBytes;
+            queue->PendingBytes = 0;
+
+            if (!coalescer.Flush(queue->Handle)) {
+                queue->OutgoingDrops.fetch_add(segments, std::memory_order_relaxed);
+                return false;
+            }
+
+            queue->OutgoingPackets.fetch_add(segments, std::memory_order_relaxed);
+            queue->OutgoingBytes.fetch_add(bytes, std::memory_order_relaxed);
+            return true;
+        }
+
+        void TapLinux::OnInput(PacketInputEventArgs& e) noexcept {
+            const SsmtQueuePtr* current = static_cast<const SsmtQueuePtr*>(ssmt_tls_.tun_queue_);
+            SsmtQueue* queue = NULL != current ? current->get() : tun_queue_.get();
+            if (NULL != queue) {
+                queue->IncomingPackets.fetch_add(1, std::memory_order_relaxed);
+                queue->IncomingBytes.fetch_add(e.PacketLength, std::memory_order_relaxed);
+            }
+
+            ITap::OnInput(e);
+        }
+
+        bool TapLinux::IsReady() noexcept {
+            return NULL != tun_queue_ && ITap::IsReady();
+        }
+
+        bool TapLinux::AsynchronousReadPacketLoops() noexcept {
+            if (!offload_) {
+                return ITap::AsynchronousReadPacketLoops();
+            }
+
+            std::shared_ptr<Byte> buffer = make_shared_alloc<Byte>(TAP_LINUX_VNET_BUFFER_SIZE << 1);
+            if (NULL == buffer) {
+                return false;
+            }
+
+            return Ssmt(tun_queue_, buffer);
+        }
+
+        bool TapLinux::GetSsmtQueueStatistics(ppp::vector<SsmtQueueStatistics>& statistics) noexcept {
+            auto snapshot = 
+                [&statistics](const SsmtQueuePtr& queue) noexcept {
+                    if (NULL != queue) {
+                        statistics.emplace_back(SsmtQueueStatistics{ 
+                            queue->IncomingPackets.load(std::memory_order_relaxed),
+                            queue->IncomingBytes.load(std::memory_order_relaxed),
+                            queue->OutgoingPackets.load(std::memory_order_relaxed),
+                            queue->OutgoingBytes.load(std::memory_order_relaxed),
+                            queue->OutgoingDrops.load(std::memory_order_relaxed) });
+                    }
+                };
+
+            statistics.clear();
+            snapshot(tun_queue_);
+
+            SsmtQueueListPtr queues = std::atomic_load(&tun_ssmt_queues_);
+            if (NULL != queues) {
+                for (SsmtQueuePtr& queue : *queues) {
+                    snapshot(queue);
                 }
             }
 
-            ssize_t bytes_transferred = ::write(tun, (void*)packet, (size_t)packet_size);
-            return bytes_transferred > -1;
+            return true;
         }
 
         bool TapLinux::Ssmt(const std::shared_ptr<boost::asio::io_context>& context) noexcept {
@@ -815,16 +1023,32 @@ namespace ppp {
                 return false;
             }
 
-            std::shared_ptr<Byte> buffer = make_shared_alloc<Byte>(ITap::Mtu);
+            std::shared_ptr<Byte> buffer = make_shared_alloc<Byte>(offload_ ? TAP_LINUX_VNET_BUFFER_SIZE << 1 : ITap::Mtu);
             if (NULL == buffer) {
                 return false;
             }
 
+            SsmtQueuePtr queue = make_shared_object<SsmtQueue>();
+            if (NULL == queue) {
+                return false;
+            }
+
+            SsmtQueueListPtr queues = make_shared_object<SsmtQueueList>();
+            if (NULL == queues) {
+                return false;
+            }
+
+            // Every queue of a device has to be opened with the same flags.
             SynchronizedObjectScope scope(syncobj_);
-            int tun = OpenDriver(dev.data());
+            bool offload = offload_;
+            int tun = OpenDriver(dev.data(), offload);
             if (tun == -1) {
                 return false;
             }
+            elif(offload != offload_) {
+                ::close(tun);
+                return false;
+            }
 
             std::shared_ptr<boost::asio::posix::stream_descriptor> sd = make_shared_object<boost::asio::posix::stream_descriptor>(*context, tun);
             if (NULL == sd) {
@@ -832,40 +1056,74 @@ namespace ppp {
                 return false;
             }
             
-            tun_ssmt_fds_size_++;
-            if (Ssmt(tun, buffer, sd)) {
-                return true;
+            queue->Handle = tun;
+            queue->Stream = sd;
+            queue->Context = context;
+            if (!Ssmt(queue, buffer)) {
+                ppp::net::Socket::Closestream(sd);
+                return false;
             }
 
-            ppp::net::Socket::Closestream(sd);
-            return false;
+            SsmtQueueListPtr current = std::atomic_load(&tun_ssmt_queues_);
+            if (NULL != current) {
+                *queues = *current;
+            }
+
+            queues->emplace_back(queue);
+            std::atomic_store(&tun_ssmt_queues_, queues);
+            tun_ssmt_fds_size_++;
+            return true;
         }
 
-        bool TapLinux::Ssmt(int fd, const std::shared_ptr<Byte>& buffer, const std::shared_ptr<boost::asio::posix::stream_descriptor>& sd) noexcept {
+        bool TapLinux::Ssmt(const SsmtQueuePtr& queue, const std::shared_ptr<Byte>& buffer) noexcept {
             int disposed = disposed_.load();
             if (disposed != FALSE) {
                 return false;
             }   
 
+            if (NULL == queue) {
+                return false;
+            }
+
+            std::shared_ptr<boost::asio::posix::stream_descriptor> sd = queue->Stream;
+            if (NULL == sd) {
+                return false;
+            }
+
             bool opened = sd->is_open();
             if (!opened) {
                 return false;
             }
 
             std::shared_ptr<ITap> self = shared_from_this();
-            sd->async_read_some(boost::asio::buffer(buffer.get(), ITap::Mtu), 
-                [self, this, buffer, sd, fd](const boost::system::error_code& ec, std::size_t sz) noexcept {
+            sd->async_read_some(boost::asio::buffer(buffer.get(), offload_ ? TAP_LINUX_VNET_BUFFER_SIZE : ITap::Mtu), 
+                [self, this, buffer, queue](const boost::system::error_code& ec, std::size_t sz) noexcept {
                     if (ec != boost::system::errc::operation_canceled) {
                         int len = std::max<int>(ec ? -1 : sz, -1);
                         if (len > 0) {
-                            PacketInputEventArgs e{ buffer.get(), len };
-                            int* tun = &ssmt_tls_.tun_fd_;
-                            *tun = fd;
-                            OnInput(e);
-                            *tun = -1;
+                            void** tls = &ssmt_tls_.tun_queue_;
+                            *tls = (void*)&queue;
+
+                            if (offload_) {
+                                ppp::tap::vnet::Segment(buffer.get(), len, buffer.get() + TAP_LINUX_VNET_BUFFER_SIZE, 
+                                    [this](Byte* packet, int packet_length) noexcept {
+                                        PacketInputEventArgs e{ packet, packet_length };
+                                        OnInput(e);
+                                    });
+
+                                // Whatever the packet made us send back goes out now, merged as far as possible.
+                                SynchronizedObjectScope scope(queue->Lock);
+                                Flush(queue.get());
+                            }
+                            else {
+                                PacketInputEventArgs e{ buffer.get(), len };
+                                OnInput(e);
+                            }
+
+                            *tls = NULL;
                         }
 
-                        Ssmt(fd, buffer, sd);
+                        Ssmt(queue, buffer);
                     }
                 });
             return true;
@@ -1006,7 +1264,8 @@ namespace ppp {
                 return NULL;
             }
 
-            int tun = OpenDriver(dev.data());
+            bool offload = ifc_ctl_tun_offload;
+            int tun = OpenDriver(dev.data(), offload);
             if (tun == -1) {
                 return NULL;
             }
@@ -1018,7 +1277,12 @@ namespace ppp {
             ppp::vector<boost::asio::ip::address> dns_servers;
             Ipep::ToAddresses(dns_addresses, dns_servers);
 
-            return CreateInternal(context, ip, gw, mask, promisc, hosted_network, tun, dev, dns_servers);
+            std::shared_ptr<TapLinux> tap = CreateInternal(context, ip, gw, mask, promisc, hosted_network, tun, dev, dns_servers);
+            if (NULL != tap) {
+                tap->offload_ = offload;
+            }
+
+            return tap;
         }
 
         static bool DeleteAddAllRoutes(const ppp::function<ppp::string(ppp::net::native::RouteEntry&)>& interface_name, std::shared_ptr<ppp::net::native::RouteInformationTable> rib, bool delete_or_add_operate) noexcept {
@@ -6,6 +6,7 @@
 #include <ppp/net/Socket.h>
 #include <ppp/net/IPEndPoint.h>
 #include <ppp/net/native/rib.h>
+#include <linux/ppp/tap/vnet.h>
 
 namespace ppp
 {
@@ -17,6 +18,17 @@ namespace ppp
             typedef std::mutex                                                      SynchronizedObject;
             typedef std::lock_guard<SynchronizedObject>                             SynchronizedObjectScope;
 
+        public:
+            // Counters of one tun queue, the first entry is the queue opened with the device, the others are the ssmt queues.
+            typedef struct
+            {
+                uint64_t                                                            IncomingPackets;
+                uint64_t                                                            IncomingBytes;
+                uint64_t                                                            OutgoingPackets;
+                uint64_t                                                            OutgoingBytes;
+                uint64_t                                                            OutgoingDrops;
+            }                                                                       SsmtQueueStatistics;
+
         public:
             TapLinux(const std::shared_ptr<boost::asio::io_context>& context, const ppp::string& dev, void* tun, uint32_t address, uint32_t gw, uint32_t mask, bool hosted_network);
             virtual ~TapLinux() noexcept;
@@ -37,10 +49,13 @@ namespace ppp
             static std::shared_ptr<TapLinux>                                        Create(const std::shared_ptr<boost::asio::io_context>& context, const ppp::string& dev, uint32_t ip, uint32_t gw, uint32_t mask, bool promisc, bool hosted_network, const ppp::vector<uint32_t>& dns_addresses) noexcept;
             virtual void                                                            Dispose() noexcept override;
             virtual bool                                                            SetInterfaceMtu(int mtu) noexcept override;
+            virtual bool                                                            IsReady() noexcept override;
 
         public: 
             bool                                                                    Ssmt() noexcept { return tun_ssmt_fds_size_ > 0; }
             bool                                                                    Ssmt(const std::shared_ptr<boost::asio::io_context>& context) noexcept;
+            bool                                                                    IsOffload() noexcept { return offload_; }
+            bool                                                                    GetSsmtQueueStatistics(ppp::vector<SsmtQueueStatistics>& statistics) noexcept;
 
         public: 
             virtual bool                                                            Output(const std::shared_ptr<Byte>& packet, int packet_size) noexcept override;
@@ -50,6 +65,7 @@ namespace ppp
             static bool                                                             GetDefaultGateway(char* ifrName, UInt32* address) noexcept;
             static bool                                                             GetDefaultGateway(UInt32* address, const ppp::function<bool(const char*, uint32_t ip, uint32_t gw, uint32_t mask, int metric)>& predicate) noexcept;
             static void                                                             CompatibleRoute(bool compatible) noexcept;
+            static void                                                             Offload(bool offload) noexcept;
             static bool                                                             SetIPAddress(
                 const ppp::string&                                                  ifrName,
                 const ppp::string&                                                  addressIP,
@@ -74,6 +90,31 @@ namespace ppp
             static std::shared_ptr<ITap>                                            From(const std::shared_ptr<boost::asio::io_context>& context, const ppp::string& id, void* tun, uint32_t address, uint32_t gw, uint32_t mask, bool promisc, bool hosted_network) noexcept;
 #endif  
 
+        protected:
+            virtual void                                                            OnInput(PacketInputEventArgs& e) noexcept override;
+            virtual bool                                                            AsynchronousReadPacketLoops() noexcept override;
+
+        private:
+            class SsmtQueue final
+            {
+            public:
+                int                                                                 Handle          = -1;
+                std::shared_ptr<boost::asio::posix::stream_descriptor>              Stream;
+                std::shared_ptr<boost::asio::io_context>                            Context;
+                SynchronizedObject                                                  Lock;           // Offload mode only, guards the fields below.
+                ppp::tap::vnet::Coalescer                                           Coalescer;
+                int                                                                 PendingBytes    = 0;
+                bool                                                                Flushing        = false;
+                std::atomic<uint64_t>                                               IncomingPackets = 0;
+                std::atomic<uint64_t>                                               IncomingBytes   = 0;
+                std::atomic<uint64_t>                                               OutgoingPackets = 0;
+                std::atomic<uint64_t>                                               OutgoingBytes   = 0;
+                std::atomic<uint64_t>                                               OutgoingDrops   = 0;
+            };
+            typedef std::shared_ptr<SsmtQueue>                                      SsmtQueuePtr;
+            typedef ppp::vector<SsmtQueuePtr>                                       SsmtQueueList;
+            typedef std::shared_ptr<SsmtQueueList>                                  SsmtQueueListPtr;
+
         private:    
             static void                                                             InitialSockAddrIn(struct sockaddr* sa, in_addr_t addr) noexcept;
             static int                                                              SetRoute(int action, const ppp::string& ifrName, struct in_addr dst, int prefix, struct in_addr gw) noexcept;
@@ -82,16 +123,20 @@ namespace ppp
             static std::shared_ptr<TapLinux>                                        CreateInternal(const std::shared_ptr<boost::asio::io_context>& context, uint32_t ip, uint32_t gw, uint32_t mask, bool promisc, bool hosted_network, int tun, ppp::string interface_name, const ppp::vector<boost::asio::ip::address>& dns_addresses) noexcept;
 
         private:    
-            static int                                                              OpenDriver(const char* ifrName) noexcept;
+            static int                                                              OpenDriver(const char* ifrName, bool& offload) noexcept;
             void                                                                    Finalize() noexcept;
-            bool                                                                    Ssmt(int fd, const std::shared_ptr<Byte>& buffer, const std::shared_ptr<boost::asio::posix::stream_descriptor>& sd) noexcept;
+            bool                                                                    Ssmt(const SsmtQueuePtr& queue, const std::shared_ptr<Byte>& buffer) noexcept;
+            bool                                                                    Output(const SsmtQueuePtr& queue, const void* packet, int packet_size) noexcept;
+            bool                                                                    Flush(SsmtQueue* queue) noexcept;
 
         private:    
             SynchronizedObject                                                      syncobj_;
             bool                                                                    promisc_            = false;
+            bool                                                                    offload_            = false;
             std::atomic<int>                                                        disposed_           = FALSE; 
             ppp::vector<boost::asio::ip::address>                                   dns_addresses_;
-            ppp::vector<std::shared_ptr<boost::asio::posix::stream_descriptor>/**/> tun_ssmt_sds_;
+            SsmtQueuePtr                                                            tun_queue_;
+            SsmtQueueListPtr                                                        tun_ssmt_queues_;   // Published with std::atomic_store, Output reads it from any thread.
             int                                                                     tun_ssmt_fds_size_  = 0;
         };
     }
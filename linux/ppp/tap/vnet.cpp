@@ -0,0 +1,341 @@
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <linux/ppp/tap/vnet.h>
+
+namespace ppp {
+    namespace tap {
+        namespace vnet {
+            // <linux/virtio_net.h> cannot be included from C++ (it has a member named class), the layout is mirrored here.
+#pragma pack(push, 1)
+            struct virtio_net_hdr {
+                uint8_t                         flags;
+                uint8_t                         gso_type;
+                uint16_t                        hdr_len;
+                uint16_t                        gso_size;
+                uint16_t                        csum_start;
+                uint16_t                        csum_offset;
+            };
+#pragma pack(pop)
+
+            static_assert(sizeof(struct virtio_net_hdr) == VNET_HDR_SIZE, "virtio_net_hdr size mismatch");
+
+            static constexpr int                VIRTIO_NET_HDR_F_NEEDS_CSUM     = 1;
+            static constexpr int                VIRTIO_NET_HDR_GSO_NONE         = 0;
+            static constexpr int                VIRTIO_NET_HDR_GSO_TCPV4        = 1;
+            static constexpr int                VIRTIO_NET_HDR_GSO_ECN          = 0x80;
+
+            static constexpr int                VNET_PROTO_TCP  = 6;
+            static constexpr int                VNET_PROTO_UDP  = 17;
+            static constexpr Byte               VNET_TCP_FIN    = 0x01;
+            static constexpr Byte               VNET_TCP_PSH    = 0x08;
+            static constexpr Byte               VNET_TCP_ACK    = 0x10;
+            static constexpr Byte               VNET_TCP_CWR    = 0x80;
+
+            static inline uint32_t vnet_get32(const Byte* p) noexcept {
+                return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+            }
+
+            static inline int vnet_get16(const Byte* p) noexcept {
+                return p[0] << 8 | p[1];
+            }
+
+            static inline void vnet_put32(Byte* p, uint32_t v) noexcept {
+                p[0] = (Byte)(v >> 24);
+                p[1] = (Byte)(v >> 16);
+                p[2] = (Byte)(v >> 8);
+                p[3] = (Byte)v;
+            }
+
+            static inline void vnet_put16(Byte* p, int v) noexcept {
+                p[0] = (Byte)(v >> 8);
+                p[1] = (Byte)v;
+            }
+
+            // Ones' complement sum of big endian 16 bit words, folded by vnet_fold.
+            static inline uint64_t vnet_sum(const Byte* p, int len, uint64_t acc) noexcept {
+                for (; len > 1; p += 2, len -= 2) {
+                    acc += (uint32_t)(p[0] << 8 | p[1]);
+                }
+
+                if (len > 0) {
+                    acc += (uint32_t)(p[0] << 8);
+                }
+
+                return acc;
+            }
+
+            static inline int vnet_fold(uint64_t acc) noexcept {
+                while (acc >> 16) {
+                    acc = (acc & 0xffff) + (acc >> 16);
+                }
+
+                return (int)acc;
+            }
+
+            static inline uint64_t vnet_pseudo_sum(const Byte* ip, int version, int proto, int l4_length) noexcept {
+                uint64_t acc = (uint64_t)proto + (uint64_t)l4_length;
+                if (version == 4) {
+                    return vnet_sum(ip + 12, 8, acc);
+                }
+                else {
+                    return vnet_sum(ip + 8, 32, acc);
+                }
+            }
+
+            bool Segment(Byte* packet, int packet_size, Byte* scratch, const ppp::function<void(Byte*, int)>& output) noexcept {
+                if (NULL == packet || packet_size <= VNET_HDR_SIZE) {
+                    return false;
+                }
+
+                struct virtio_net_hdr hdr;
+                memcpy(&hdr, packet, sizeof(hdr));
+
+                Byte* ip = packet + VNET_HDR_SIZE;
+                int length = packet_size - VNET_HDR_SIZE;
+                int gso_type = hdr.gso_type & ~VIRTIO_NET_HDR_GSO_ECN;
+                if (gso_type == VIRTIO_NET_HDR_GSO_NONE) {
+                    if (hdr.flags & VIRTIO_NET_HDR_F_NEEDS_CSUM) {
+                        int csum_start = hdr.csum_start;
+                        int csum_field = csum_start + hdr.csum_offset;
+                        if (csum_field + 2 > length) {
+                            return false;
+                        }
+
+                        // The checksum field already holds the pseudo header sum, only the data has to be added.
+                        vnet_put16(ip + csum_field, ~vnet_fold(vnet_sum(ip + csum_start, length - csum_start, 0)) & 0xffff);
+                    }
+
+                    output(ip, length);
+                    return true;
+                }
+
+                int version = ip[0] >> 4;
+                int iphdr_hlen;
+                int proto;
+                if (version == 4) {
+                    iphdr_hlen = (ip[0] & 0x0f) << 2;
+                    proto = ip[9];
+                }
+                elif(version == 6) {
+                    iphdr_hlen = 40;
+                    proto = ip[6];
+                }
+                else {
+                    return false;
+                }
+
+                int l4_hlen;
+                int csum_offset;
+                if (length < iphdr_hlen + 20) {
+                    return false;
+                }
+                elif(proto == VNET_PROTO_TCP) {
+                    l4_hlen = (ip[iphdr_hlen + 12] >> 4) << 2;
+                    csum_offset = 16;
+                }
+                elif(proto == VNET_PROTO_UDP) {
+                    l4_hlen = 8;
+                    csum_offset = 6;
+                }
+                else {
+                    return false;
+                }
+
+                int hlen = iphdr_hlen + l4_hlen;
+                int mss = hdr.gso_size;
+                if (l4_hlen < 8 || hlen > length || mss < 1) {
+                    return false;
+                }
+
+                int payload_length = length - hlen;
+                uint32_t seq = proto == VNET_PROTO_TCP ? vnet_get32(ip + iphdr_hlen + 4) : 0;
+                int id = version == 4 ? vnet_get16(ip + 4) : 0;
+
+                // Each segment gets a copy of the headers with its own lengths, sequence number and ip id,
+                // The checksums are computed in full since the kernel left them partial.
+                for (int offset = 0, index = 0; offset < payload_length || index == 0; index++) {
+                    int segment_length = std::min<int>(mss, payload_length - offset);
+                    bool last = offset + segment_length >= payload_length;
+
+                    Byte* segment = scratch;
+                    memcpy(segment, ip, hlen);
+                    memcpy(segment + hlen, ip + hlen + offset, segment_length);
+
+                    int total_length = hlen + segment_length;
+                    if (version == 4) {
+                        vnet_put16(segment + 2, total_length);
+                        vnet_put16(segment + 4, id + index);
+                        vnet_put16(segment + 10, 0);
+                        vnet_put16(segment + 10, ~vnet_fold(vnet_sum(segment, iphdr_hlen, 0)) & 0xffff);
+                    }
+                    else {
+                        vnet_put16(segment + 4, total_length - iphdr_hlen);
+                    }
+
+                    Byte* l4 = segment + iphdr_hlen;
+                    int l4_length = total_length - iphdr_hlen;
+                    if (proto == VNET_PROTO_TCP) {
+                        Byte flags = l4[13];
+                        if (!last) {
+                            flags &= ~(VNET_TCP_FIN | VNET_TCP_PSH);
+                        }
+
+                        if (index > 0) {
+                            flags &= ~VNET_TCP_CWR;
+                        }
+
+                        l4[13] = flags;
+                        vnet_put32(l4 + 4, seq + offset);
+                    }
+                    else {
+                        vnet_put16(l4 + 4, l4_length);
+                    }
+
+                    vnet_put16(l4 + csum_offset, 0);
+
+                    int checksum = ~vnet_fold(vnet_sum(l4, l4_length, vnet_pseudo_sum(segment, version, proto, l4_length))) & 0xffff;
+                    if (checksum == 0 && proto == VNET_PROTO_UDP) {
+                        checksum = 0xffff;
+                    }
+
+                    vnet_put16(l4 + csum_offset, checksum);
+                    output(segment, total_length);
+
+                    offset += segment_length;
+                }
+                return true;
+            }
+
+            static bool vnet_writev(int fd, const struct virtio_net_hdr& hdr, const void* packet, int packet_size) noexcept {
+                struct iovec iov[2];
+                iov[0].iov_base = (void*)&hdr;
+                iov[0].iov_len = sizeof(hdr);
+                iov[1].iov_base = (void*)packet;
+                iov[1].iov_len = packet_size;
+
+                // https://man7.org/linux/man-pages/man2/writev.2.html
+                ssize_t bytes_transferred = ::writev(fd, iov, arraysizeof(iov));
+                return bytes_transferred > -1;
+            }
+
+            bool Write(int fd, const void* packet, int packet_size) noexcept {
+                struct virtio_net_hdr hdr;
+                memset(&hdr, 0, sizeof(hdr));
+
+                return vnet_writev(fd, hdr, packet, packet_size);
+            }
+
+            bool Coalescer::Append(const Byte* packet, int packet_size) noexcept {
+                // Plain IPv4 without options, unfragmented, TCP carrying data with nothing but ACK and PSH set.
+                if (NULL == packet || packet_size < 40 || packet[0] != 0x45 || packet[9] != VNET_PROTO_TCP) {
+                    return false;
+                }
+
+                if ((vnet_get16(packet + 6) & 0x3fff) != 0 || vnet_get16(packet + 2) != packet_size) {
+                    return false;
+                }
+
+                const Byte* l4 = packet + 20;
+                int l4_hlen = (l4[12] >> 4) << 2;
+                int hlen = 20 + l4_hlen;
+                int payload_length = packet_size - hlen;
+                if (l4_hlen < 20 || payload_length < 1) {
+                    return false;
+                }
+
+                Byte flags = l4[13];
+                if ((flags & ~(VNET_TCP_ACK | VNET_TCP_PSH)) != 0 || (flags & VNET_TCP_ACK) == 0) {
+                    return false;
+                }
+
+                uint32_t seq = vnet_get32(l4 + 4);
+                if (segments_ < 1) {
+                    if (NULL == buffer_) {
+                        buffer_ = make_shared_alloc<Byte>(VNET_MAX_PACKET);
+                        if (NULL == buffer_) {
+                            return false;
+                        }
+                    }
+
+                    memcpy(buffer_.get(), packet, packet_size);
+                    length_ = packet_size;
+                    hlen_ = hlen;
+                    mss_ = payload_length;
+                    next_seq_ = seq + payload_length;
+                    segments_ = 1;
+                    closed_ = (flags & VNET_TCP_PSH) != 0;
+                    return true;
+                }
+
+                if (closed_ || hlen != hlen_ || payload_length > mss_ || seq != next_seq_ || length_ + payload_length > VNET_MAX_PACKET) {
+                    return false;
+                }
+
+                // Everything but the lengths, ip id, sequence number, PSH and the checksums has to be identical.
+                Byte* buffer = buffer_.get();
+                Byte* tail = buffer + 20;
+                if (packet[1] != buffer[1] || vnet_get16(packet + 6) != vnet_get16(buffer + 6) || packet[8] != buffer[8]) {
+                    return false;
+                }
+
+                if (memcmp(packet + 12, buffer + 12, 8) != 0 || memcmp(l4, tail, 4) != 0 || memcmp(l4 + 8, tail + 8, 5) != 0) {
+                    return false;
+                }
+
+                if ((flags & ~VNET_TCP_PSH) != tail[13] || memcmp(l4 + 14, tail + 14, 2) != 0 || memcmp(l4 + 18, tail + 18, l4_hlen - 18) != 0) {
+                    return false;
+                }
+
+                memcpy(buffer + length_, packet + hlen, payload_length);
+                length_ += payload_length;
+                next_seq_ += payload_length;
+                segments_++;
+
+                // A short segment or a push ends the run, anything after it would no longer be a whole number of segments.
+                if (flags & VNET_TCP_PSH) {
+                    tail[13] |= VNET_TCP_PSH;
+                    closed_ = true;
+                }
+                elif(payload_length < mss_) {
+                    closed_ = true;
+                }
+                return true;
+            }
+
+            bool Coalescer::Flush(int fd) noexcept {
+                if (segments_ < 1) {
+                    return true;
+                }
+
+                Byte* buffer = buffer_.get();
+                struct virtio_net_hdr hdr;
+                memset(&hdr, 0, sizeof(hdr));
+
+                // A single segment still carries its own checksums and goes out unchanged.
+                if (segments_ > 1) {
+                    vnet_put16(buffer + 2, length_);
+                    vnet_put16(buffer + 10, 0);
+                    vnet_put16(buffer + 10, ~vnet_fold(vnet_sum(buffer, 20, 0)) & 0xffff);
+
+                    // The kernel completes the checksum of every segment, it expects the pseudo header sum in the field.
+                    int l4_length = length_ - 20;
+                    vnet_put16(buffer + 20 + 16, vnet_fold(vnet_pseudo_sum(buffer, 4, VNET_PROTO_TCP, l4_length)));
+
+                    hdr.flags = VIRTIO_NET_HDR_F_NEEDS_CSUM;
+                    hdr.gso_type = VIRTIO_NET_HDR_GSO_TCPV4;
+                    hdr.hdr_len = hlen_;
+                    hdr.gso_size = mss_;
+                    hdr.csum_start = 20;
+                    hdr.csum_offset = 16;
+                }
+
+                bool ok = vnet_writev(fd, hdr, buffer, length_);
+                length_ = 0;
+                segments_ = 0;
+                closed_ = false;
+                return ok;
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <ppp/stdafx.h>
+
+namespace ppp
+{
+    namespace tap
+    {
+        namespace vnet
+        {
+            // Framing of tun devices opened with IFF_VNET_HDR: every packet is preceded by a struct virtio_net_hdr,
+            // Which lets the kernel hand over and accept TCP/UDP super packets of up to 64 KB (GSO) with partial checksums.
+            static constexpr int                                            VNET_HDR_SIZE   = 10; // sizeof(struct virtio_net_hdr)
+            static constexpr int                                            VNET_MAX_PACKET = 65535;
+
+            // Splits a packet read from the device (header included) into wire sized IP packets, finishing partial checksums.
+            // Scratch must hold VNET_MAX_PACKET bytes, the segments are built there one at a time and only live until output returns.
+            bool                                                            Segment(Byte* packet, int packet_size, Byte* scratch, const ppp::function<void(Byte*, int)>& output) noexcept;
+
+            // Writes a single IP packet behind an empty header.
+            bool                                                            Write(int fd, const void* packet, int packet_size) noexcept;
+
+            // Merges consecutive in-order TCP/IPv4 data segments of one flow into a single GSO packet, so a burst of segments
+            // Costs one write. The caller serializes access and flushes whatever is pending when it cannot wait any longer.
+            class Coalescer final
+            {
+            public:
+                // Absorbs the segment into the pending packet, or starts a new one when nothing is pending.
+                // False means the segment cannot be merged and the pending packet has to be flushed first.
+                bool                                                        Append(const Byte* packet, int packet_size) noexcept;
+                bool                                                        Flush(int fd) noexcept;
+                bool                                                        IsEmpty() noexcept { return segments_ < 1; }
+                bool                                                        IsClosed() noexcept { return closed_; }
+                int                                                         GetSegments() noexcept { return segments_; }
+
+            private:
+                std::shared_ptr<Byte>                                       buffer_;
+                int                                                         length_   = 0;
+                int                                                         hlen_     = 0;
+                int                                                         mss_      = 0;
+                int                                                         segments_ = 0;
+                uint32_t                                                    next_seq_ = 0;
+                bool                                                        closed_   = false;
+            };
+        }
+    }
+}
\ No newline at end of file
@@ -4,6 +4,10 @@
 #include <ppp/tap/ITap.h>
 #include <ppp/net/Ipep.h>
 #include <ppp/net/IPEndPoint.h>
+#include <ppp/net/asio/DatagramBatch.h>
+#include <ppp/net/asio/IAsynchronousWriteIoQueue.h>
+#include <ppp/transmissions/ITcpipTransmission.h>
+#include <ppp/ssl/SSL.h>
 #include <ppp/auxiliary/StringAuxiliary.h>
 #include <ppp/diagnostics/Stopwatch.h>
 #include <ppp/diagnostics/PreventReturn.h>
@@ -11,8 +15,10 @@
 #include <ppp/threading/Thread.h>
 #include <ppp/threading/Executors.h>
 #include <ppp/threading/BufferswapAllocator.h>
+#include <ppp/coroutines/StackAllocator.h>
 #include <ppp/app/server/VirtualEthernetSwitcher.h>
 #include <ppp/app/server/VirtualEthernetManagedServer.h>
+#include <ppp/app/server/VirtualEthernetNamespaceCache.h>
 #include <ppp/app/client/VEthernetExchanger.h>
 #include <ppp/app/client/VEthernetNetworkSwitcher.h>
 
@@ -151,6 +157,7 @@ public:
 public:
     void                                            PrintHelpInformation() noexcept;
     void                                            PullIPList(const ppp::string& command) noexcept;
+    bool                                            ReloadFirewall() noexcept;
     int                                             PreparedArgumentEnvironment(int argc, const char* argv[]) noexcept;
 
 protected:
@@ -337,6 +344,54 @@ bool PppApplication::PrintEnvironmentInformation() noexcept
     printfn("%s", section_separator.data());
     printfn("%s", "Application started. Press Ctrl+C to shut down.");
     printfn("Max Concurrent        : %d", configuration_->concurrent);
+
+    // Print how many objects each worker context has been handed by Executors::GetExecutor, to verify an even spread.
+    if (configuration_->concurrent > 1)
+    {
+        ppp::vector<Executors::ExecutorLoad> executor_loads;
+        Executors::GetExecutorLoads(executor_loads);
+
+        ppp::string executor_loads_string;
+        for (const Executors::ExecutorLoad& load : executor_loads)
+        {
+            if (executor_loads_string.size() > 0)
+            {
+                executor_loads_string += "/";
+            }
+
+            executor_loads_string += stl::to_string<ppp::string>(load.Assigned);
+        }
+
+        printfn("Executor Loads        : %s", executor_loads_string.data());
+    }
+
+    // Print the hit rate of the per-thread buffer magazines in front of the virtual memory allocator.
+    if (std::shared_ptr<BufferswapAllocator> allocator = GetBufferAllocator(); NULL != allocator)
+    {
+        BufferswapAllocator::MagazineStatistics magazine_statistics;
+        allocator->GetMagazineStatistics(magazine_statistics);
+
+        printfn("Buffer Magazines      : %llu hits, %llu misses, %llu refills, %llu spills",
+            (unsigned long long)magazine_statistics.Hits,
+            (unsigned long long)magazine_statistics.Misses,
+            (unsigned long long)magazine_statistics.Refills,
+            (unsigned long long)magazine_statistics.Spills);
+    }
+
+    // Coroutine stacks, the high-water mark is the deepest a coroutine has gone into its stack so far.
+    for (ppp::coroutines::StackAllocator::StackStatistics stack_statistics;;)
+    {
+        ppp::coroutines::StackAllocator::GetStatistics(stack_statistics);
+        printfn("Coroutine Stacks      : %lld live, %lld peak, %lld pooled, %lld guarded, %lld refused, %s mapped, %s high-water",
+            (long long)stack_statistics.Live,
+            (long long)stack_statistics.Peak,
+            (long long)stack_statistics.Pooled,
+            (long long)stack_statistics.Guarded,
+            (long long)stack_statistics.Refused,
+            ppp::StrFormatByteSize(stack_statistics.Mapped).data(),
+            ppp::StrFormatByteSize(stack_statistics.HighWater).data());
+        break;
+    }
     printfn("Process               : %d", ppp::GetCurrentProcessId());
     printfn("Triplet               : %s:%s", ppp::GetSystemCode(), ppp::GetPlatformCode());
     printfn("Cwd                   : %s", ppp::GetCurrentDirectoryPath().data());
@@ -406,6 +461,17 @@ bool PppApplication::PrintEnvironmentInformation() noexcept
             printfn(st.proxy, address_string.data());
         }
 
+        // Displays how many dns rules the suffix index holds, its size and how long parsing and compiling them took.
+        VEthernetNetworkSwitcher::DnsRulesStatistics dns_rules_statistics;
+        client->GetDnsRulesStatistics(dns_rules_statistics);
+        if (dns_rules_statistics.Rules > 0)
+        {
+            printfn("DNS Rules             : %lld rules, %s, loaded in %.2f ms",
+                (long long)dns_rules_statistics.Rules,
+                ppp::StrFormatByteSize(dns_rules_statistics.MemorySize).data(),
+                dns_rules_statistics.Elapsed / 1000.0);
+        }
+
 #if defined(_WIN32)
         // Displays the open status of the current paper Airplane session layer plugins.
         printfn("P/A Controller        : %s", client->GetPaperAirplaneController() ? "on" : "off");
@@ -424,6 +490,20 @@ bool PppApplication::PrintEnvironmentInformation() noexcept
             printfn("Interface IP          : %s", configuration->ip.interface_.data());
         }
 
+        // Displays how many firewall rules are in force, the size of their compiled snapshot and how long loading them took.
+        if (std::shared_ptr<ppp::net::Firewall> firewall = server->GetFirewall(); NULL != firewall)
+        {
+            ppp::net::Firewall::LoadStatistics firewall_statistics;
+            firewall->GetLoadStatistics(firewall_statistics);
+            if (firewall_statistics.Rules > 0)
+            {
+                printfn("Firewall Rules        : %lld rules, %s, loaded in %.2f ms",
+                    (long long)firewall_statistics.Rules,
+                    ppp::StrFormatByteSize(firewall_statistics.MemorySize).data(),
+                    firewall_statistics.Elapsed / 1000.0);
+            }
+        }
+
         // Displays the port numbers of various server public service addresses that are currently monitored.
         const char* categories[] = { "ppp+tcp", "ppp+udp", "ppp+ws", "ppp+wss", "cdn+1", "cdn+2" };
         VirtualEthernetSwitcher::NetworkAcceptorCategories categoriess[] = 
@@ -531,11 +611,45 @@ bool PppApplication::PrintEnvironmentInformation() noexcept
 
                     printfn("TCP/IP CC             : %s", client->IsLwip() ? "lwip" : "ctcp");
                     printfn("Block QUIC            : %s", client->IsBlockQUIC() ? "blocked" : "unblocked");
+#if defined(_LINUX)
+
+                    // Packets moved by every queue of the multi-queue tun, the primary queue comes first.
+                    if (auto tap = std::dynamic_pointer_cast<ppp::tap::TapLinux>(client->GetTap()); NULL != tap)
+                    {
+                        ppp::vector<ppp::tap::TapLinux::SsmtQueueStatistics> queue_statistics;
+                        if (tap->GetSsmtQueueStatistics(queue_statistics) && queue_statistics.size() > 1)
+                        {
+                            for (std::size_t i = 0, l = queue_statistics.size(); i < l; i++)
+                            {
+                                const ppp::tap::TapLinux::SsmtQueueStatistics& queue = queue_statistics[i];
+                                ppp::string tmp = "TUN Queue " + stl::to_string<ppp::string>(i);
+                                tmp = ppp::PaddingRight(tmp, 22, ' ');
+                                printfn("%s: %llu rx (%s), %llu tx (%s), %llu dropped", tmp.data(),
+                                    (unsigned long long)queue.IncomingPackets,
+                                    ppp::StrFormatByteSize(queue.IncomingBytes).data(),
+                                    (unsigned long long)queue.OutgoingPackets,
+                                    ppp::StrFormatByteSize(queue.OutgoingBytes).data(),
+                                    (unsigned long long)queue.OutgoingDrops);
+                            }
+                        }
+                    }
+#endif
 
                     if (std::shared_ptr<VEthernetExchanger> exchanger = client->GetExchanger(); NULL != exchanger)
                     {
                         const char* network_states[] = { "connecting", "established", "reconnecting" };
                         printfn("Link State            : %s", network_states[(int)exchanger->GetNetworkState()]);
+
+                        // Mean setup time of the tcp flows, pooled mux streams against flows that opened a link of their own.
+                        VEthernetExchanger::ConnectStatistics connect_statistics;
+                        exchanger->GetConnectStatistics(connect_statistics);
+
+                        printfn("Mux Links             : %d links, %d streams", connect_statistics.MuxLinks, connect_statistics.MuxStreams);
+                        printfn("Connect Latency       : mux %.2f ms (%llu), direct %.2f ms (%llu)",
+                            connect_statistics.MuxConnects > 0 ? (double)connect_statistics.MuxLatency / connect_statistics.MuxConnects / 1000 : 0.0,
+                            (unsigned long long)connect_statistics.MuxConnects,
+                            connect_statistics.DirectConnects > 0 ? (double)connect_statistics.DirectLatency / connect_statistics.DirectConnects / 1000 : 0.0,
+                            (unsigned long long)connect_statistics.DirectConnects);
                     }
                     else
                     {
@@ -579,6 +693,21 @@ bool PppApplication::PrintEnvironmentInformation() noexcept
     if (NULL != server) 
     {
         printfn("Sessions              : %s", stl::to_string<ppp::string>(server->GetAllExchangerNumber()).data());
+        if (std::shared_ptr<ppp::app::server::VirtualEthernetNamespaceCache> cache = server->GetNamespaceCache(); NULL != cache)
+        {
+            ppp::app::server::VirtualEthernetNamespaceCache::NamespaceStatistics dns_statistics;
+            cache->GetStatistics(dns_statistics);
+
+            uint64_t lookups = dns_statistics.hits + dns_statistics.misses + dns_statistics.refreshes;
+            printfn("DNS Cache             : %d records, %.2f%% hits, %llu coalesced, %llu refreshed",
+                dns_statistics.count,
+                lookups > 0 ? (double)dns_statistics.hits * 100 / lookups : 0.0,
+                (unsigned long long)dns_statistics.coalesced,
+                (unsigned long long)dns_statistics.refreshes);
+            printfn("DNS Upstream          : %llu queries, %.2f qps", 
+                (unsigned long long)dns_statistics.upstream, 
+                stopwatch_.ElapsedMilliseconds() > 0 ? (double)dns_statistics.upstream * 1000 / stopwatch_.ElapsedMilliseconds() : 0.0);
+        }
     }
 
     printfn("TX                    : %s", ppp::StrFormatByteSize(TransmissionStatistics.outgoing_traffic).data());
@@ -589,6 +718,52 @@ bool PppApplication::PrintEnvironmentInformation() noexcept
         printfn("OUT                   : %s", ppp::StrFormatByteSize(statistics->OutgoingTraffic).data());
     }
 
+    // Datagrams moved per system call by the udp batches, GRO/GSO count the datagrams carried inside super packets.
+    for (ppp::net::asio::DatagramBatch::Statistics batch_statistics;;)
+    {
+        ppp::net::asio::DatagramBatch::GetStatistics(batch_statistics);
+        if (batch_statistics.Receives > 0 || batch_statistics.Sends > 0)
+        {
+            printfn("UDP Batch             : %llu rx (%.2f/call), %llu tx (%.2f/call), %llu gro, %llu gso, %llu dropped",
+                (unsigned long long)batch_statistics.ReceivedPackets,
+                batch_statistics.Receives > 0 ? (double)batch_statistics.ReceivedPackets / batch_statistics.Receives : 0.0,
+                (unsigned long long)batch_statistics.SentPackets,
+                batch_statistics.Sends > 0 ? (double)batch_statistics.SentPackets / batch_statistics.Sends : 0.0,
+                (unsigned long long)batch_statistics.Coalesced,
+                (unsigned long long)batch_statistics.Segmented,
+                (unsigned long long)batch_statistics.Dropped);
+        }
+        break;
+    }
+
+    // Frames the tcp transmissions decoded per socket read, above one the read-ahead buffers are serving bursts.
+    for (ppp::UInt64 receives = 0, bytes = 0, frames = 0;;)
+    {
+        ppp::transmissions::ITcpipTransmission::GetReceiveStatistics(receives, bytes, frames);
+        if (receives > 0)
+        {
+            printfn("TCP Reads             : %llu reads, %.2f frames/read, %s",
+                (unsigned long long)receives,
+                (double)frames / receives,
+                ppp::StrFormatByteSize(bytes).data());
+        }
+        break;
+    }
+
+    // Packets and bytes the write queues gathered into each socket write.
+    for (ppp::net::asio::IAsynchronousWriteIoQueue::WriteStatistics write_statistics;;)
+    {
+        ppp::net::asio::IAsynchronousWriteIoQueue::GetWriteStatistics(write_statistics);
+        if (write_statistics.Writes > 0)
+        {
+            printfn("TCP Writes            : %llu writes, %.2f pkts/write, %s/write",
+                (unsigned long long)write_statistics.Writes,
+                (double)write_statistics.Packets / write_statistics.Writes,
+                ppp::StrFormatByteSize(write_statistics.Bytes / write_statistics.Writes).data());
+        }
+        break;
+    }
+
     // Print text to the console window screen, or on Linux to the _tty of the shell-terminal.
     fprintf(stdout, "%s", console_window_content.data());
     return true;
@@ -877,6 +1052,7 @@ void PppApplication::PrintHelpInformation() noexcept
 #if defined(_LINUX)
     messages += "        --tun-ssmt=[[4]/[mq]] \\\r\n";
     messages += "        --tun-route=[yes|no] \\\r\n";
+    messages += "        --tun-offload=[yes|no] \\\r\n";
 #else
     messages += "        --tun-ssmt=[4] \\\r\n";
 #endif
@@ -1062,6 +1238,12 @@ std::shared_ptr<NetworkInterface> PppApplication::GetNetworkInterface(int argc,
         {
             ppp::tap::TapLinux::CompatibleRoute(true);
         }
+
+        // Open the tun device with virtio headers, so the kernel exchanges 64 KB TCP/UDP super packets instead of single segments.
+        if (ppp::ToBoolean(ppp::GetCommandArgument("--tun-offload", argc, argv).data())) 
+        {
+            ppp::tap::TapLinux::Offload(true);
+        }
         
         ni->SsmtMQ = false;
         ni->Ssmt = 0;
@@ -1075,6 +1257,10 @@ std::shared_ptr<NetworkInterface> PppApplication::GetNetworkInterface(int argc,
             }
 
             ni->Ssmt = std::max<int>(0, atoi(ssmt.data()));
+            if (ni->SsmtMQ && ni->Ssmt < 1) {
+                // "--tun-ssmt=mq" without a count opens one tun queue, and one reader, per core.
+                ni->Ssmt = std::max<int>(1, std::thread::hardware_concurrency());
+            }
         }
 #elif defined(_MACOS)
         ni->Ssmt = std::max<int>(0, atoi(ppp::GetCommandArgument("--tun-ssmt", argc, argv).data()));
@@ -1258,6 +1444,30 @@ std::shared_ptr<VirtualEthernetSwitcher> PppApplication::GetServer() noexcept
     return server_;
 }
 
+bool PppApplication::ReloadFirewall() noexcept
+{
+    std::shared_ptr<VirtualEthernetSwitcher> server = server_;
+    if (NULL == server)
+    {
+        return false;
+    }
+
+    std::shared_ptr<NetworkInterface> network_interface = network_interface_;
+    if (NULL == network_interface)
+    {
+        return false;
+    }
+
+    std::shared_ptr<ppp::net::Firewall> firewall = server->GetFirewall();
+    if (NULL == firewall)
+    {
+        return false;
+    }
+
+    // Read the rules file given by --firewall-rules again and swap the compiled rules in, sessions keep their firewall instance.
+    return firewall->ReloadWithFile(network_interface->FirewallRules);
+}
+
 std::shared_ptr<VEthernetNetworkSwitcher> PppApplication::GetClient() noexcept
 {
     return client_;
@@ -1346,6 +1556,53 @@ std::shared_ptr<AppConfiguration> PppApplication::LoadConfiguration(int argc, co
     return NULL;
 }
 
+#if !defined(_WIN32) && defined(SIGHUP)
+// SIGHUP reloads the certificates of the TLS listeners, handshakes after it read them from disk again, and the server firewall rules.
+// The signal is awaited through a signal_set on the default executor, so the reload runs there and not inside a signal handler.
+static bool ReloadSslContextsOnSignal(const std::shared_ptr<boost::asio::signal_set>& signals) noexcept
+{
+    signals->async_wait(
+        [signals](const boost::system::error_code& ec, int signo) noexcept
+        {
+            if (ec == boost::system::errc::success)
+            {
+                ppp::ssl::SSL::ReloadSslContexts();
+                if (std::shared_ptr<PppApplication> app = PPP_APPLICATION_DEFAULT_APP_DOMAIN; NULL != app)
+                {
+                    app->ReloadFirewall();
+                }
+
+                ReloadSslContextsOnSignal(signals);
+            }
+        });
+    return true;
+}
+
+static bool ReloadSslContextsOnSignal() noexcept
+{
+    std::shared_ptr<boost::asio::io_context> context = Executors::GetDefault();
+    if (NULL == context)
+    {
+        return false;
+    }
+
+    std::shared_ptr<boost::asio::signal_set> signals = ppp::make_shared_object<boost::asio::signal_set>(*context);
+    if (NULL == signals)
+    {
+        return false;
+    }
+
+    boost::system::error_code ec;
+    signals->add(SIGHUP, ec);
+    if (ec)
+    {
+        return false;
+    }
+
+    return ReloadSslContextsOnSignal(signals);
+}
+#endif
+
 bool PppApplication::AddShutdownApplicationEventHandler() noexcept
 {
     auto f = []() noexcept
@@ -1390,7 +1647,11 @@ bool PppApplication::AddShutdownApplicationEventHandler() noexcept
 #if defined(_WIN32)
     return ppp::win32::Win32Native::AddShutdownApplicationEventHandler(f);
 #else
-    return ppp::unix__::UnixAfx::AddShutdownApplicationEventHandler(f);
+    bool ok = ppp::unix__::UnixAfx::AddShutdownApplicationEventHandler(f);
+#if defined(SIGHUP)
+    ReloadSslContextsOnSignal();
+#endif
+    return ok;
 #endif
 }
 
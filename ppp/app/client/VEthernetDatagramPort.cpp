@@ -36,6 +36,7 @@ namespace ppp {
 
 #if defined(_ANDROID)
                 buffer_ = Executors::GetCachedBuffer(context_);
+                batch_ = make_shared_object<ppp::net::asio::DatagramBatch>(socket_, configuration_->udp.batch, buffer_);
                 ProtectorNetwork = switcher_->GetProtectorNetwork();
 #endif
             }
@@ -118,13 +119,7 @@ namespace ppp {
                         // If the socket is currently open, send data directly.
                         SynchronizedObjectScope scope(syncobj_);
                         if (opened_ > 1) {
-                            boost::system::error_code ec;
-                            socket_.send_to(boost::asio::buffer(packet, packet_length), 
-                                destinationEP, boost::asio::socket_base::message_end_of_record, ec);
-
-                            if (ec == boost::system::errc::success) {
-                                ok = true;
-                            }
+                            ok = batch_->SendTo(shared_from_this(), packet, packet_length, destinationEP);
                         }
                         else {
                             // If you are not currently opening a physical network socket, try to open the socket.
@@ -258,31 +253,27 @@ namespace ppp {
                     return false;
                 }
 
-                if (!socket_.is_open()) {
+                if (!socket_.is_open() || NULL == batch_) {
                     return false;
                 }
 
                 auto self = shared_from_this();
-                socket_.async_receive_from(boost::asio::buffer(buffer_.get(), PPP_BUFFER_SIZE), remoteEP_,
-                    [self, this](const boost::system::error_code& ec, std::size_t sz) noexcept {
-                        bool disposing = false;
-                        if (ec == boost::system::errc::success) {
-                            if (sz > 0) {
-                                OnMessage(buffer_.get(), sz, remoteEP_);
-                            }
-                        }
-                        elif(ec == boost::system::errc::operation_canceled) {
-                            disposing = true;
+                return batch_->ReceiveFrom(
+                    [self, this](Byte* packet, int packet_length, const boost::asio::ip::udp::endpoint& remoteEP) noexcept {
+                        if (packet_length > 0) {
+                            OnMessage(packet, packet_length, remoteEP);
                         }
 
-                        if (disposing) {
+                        return true;
+                    },
+                    [self, this](const boost::system::error_code& ec) noexcept {
+                        if (ec == boost::system::errc::operation_canceled) {
                             Dispose();
                         }
                         else {
                             Loopback();
                         }
                     });
-                return true;
             }
 #endif
         }
@@ -6,6 +6,7 @@
 #include <ppp/transmissions/ITransmission.h>
 
 #if defined(_ANDROID)
+#include <ppp/net/asio/DatagramBatch.h>
 #include <linux/ppp/net/ProtectorNetwork.h>
 #endif
 
@@ -105,7 +106,7 @@ namespace ppp {
                 int                                                     opened_   = 0;
                 boost::asio::ip::udp::socket                            socket_;
                 std::shared_ptr<Byte>                                   buffer_;
-                boost::asio::ip::udp::endpoint                          remoteEP_;
+                std::shared_ptr<ppp::net::asio::DatagramBatch>          batch_;
 #endif
             };
         }
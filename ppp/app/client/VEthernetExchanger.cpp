@@ -53,6 +53,8 @@ namespace ppp {
                 , sekap_next_(0)
                 , switcher_(switcher)
                 , network_state_(NetworkState_Connecting)
+                , mux_opening_(0)
+                , mux_unsupported_(false)
                 , static_echo_input_(false)
                 , static_echo_timeout_(UINT64_MAX)
                 , static_echo_session_id_(0)
@@ -80,6 +82,8 @@ namespace ppp {
                 VEthernetDatagramPortTable datagrams;
                 ITransmissionPtr transmission;
                 DeadlineTimerTable deadline_timers;
+                TimingWheelEntryTable wheel_timers;
+                ppp::vector<VirtualEthernetMuxPtr> muxes;
 
                 for (;;) {
                     SynchronizedObjectScope scope(syncobj_);
@@ -95,6 +99,12 @@ namespace ppp {
 
                     deadline_timers = std::move(deadline_timers_);
                     deadline_timers_.clear();
+
+                    wheel_timers = std::move(wheel_timers_);
+                    wheel_timers_.clear();
+
+                    muxes = std::move(muxes_);
+                    muxes_.clear();
                     break;
                 }
 
@@ -103,11 +113,20 @@ namespace ppp {
                     transmission->Dispose();
                 }
 
+                for (VirtualEthernetMuxPtr& mux : muxes) {
+                    mux->Dispose();
+                }
+
                 disposed_ = true;
                 for (auto&& [_, deadline_timer] : deadline_timers) {
                     ppp::net::Socket::Cancel(*deadline_timer);
                 }
 
+                // Notified cancellation, a sleeping coroutine resumes with false just as with an aborted deadline timer.
+                for (auto&& [_, wheel_timer] : wheel_timers) {
+                    wheel_timer->first->Cancel(wheel_timer->second, true);
+                }
+
                 Dictionary::ReleaseAllObjects(mappings);
                 Dictionary::ReleaseAllObjects(datagrams);
             }
@@ -360,6 +379,14 @@ namespace ppp {
                     return NULL;
                 }
 
+                AppConfigurationPtr configuration = GetConfiguration();
+                if (configuration->tcp.mux.connections > 0) {
+                    ITransmissionPtr stream = ConnectMuxTransmission(context, strand, y);
+                    if (NULL != stream) {
+                        return stream;
+                    }
+                }
+
                 ITransmissionPtr transmission = OpenTransmission(context, strand, y);
                 if (NULL == transmission) {
                     return NULL;
@@ -374,6 +401,166 @@ namespace ppp {
                 return transmission;
             }
 
+            VEthernetExchanger::ITransmissionPtr VEthernetExchanger::ConnectMuxTransmission(const ContextPtr& context, const StrandPtr& strand, YieldContext& y) noexcept {
+                AppConfigurationPtr configuration = GetConfiguration();
+                VirtualEthernetMuxPtr mux;
+                bool opening = false;
+                bool warming = false;
+
+                for (;;) {
+                    SynchronizedObjectScope scope(syncobj_);
+                    if (disposed_ || mux_unsupported_) {
+                        return NULL;
+                    }
+
+                    // Forget the links that broke or ran out of stream ids and ride the one carrying the fewest streams.
+                    int streams = INT_MAX;
+                    for (auto tail = muxes_.begin(); tail != muxes_.end();) {
+                        const VirtualEthernetMuxPtr& link = *tail;
+                        if (!link->IsAvailable()) {
+                            tail = muxes_.erase(tail);
+                            continue;
+                        }
+
+                        int count = link->GetStreamCount();
+                        if (count < streams) {
+                            streams = count;
+                            mux = link;
+                        }
+
+                        tail++;
+                    }
+
+                    if (static_cast<int>(muxes_.size()) + mux_opening_ < configuration->tcp.mux.connections) {
+                        mux_opening_++;
+                        if (NULL != mux) {
+                            warming = true;
+                        }
+                        else {
+                            opening = true;
+                        }
+                    }
+                    break;
+                }
+
+                if (opening) {
+                    mux = OpenMux(context, strand, y);
+                }
+                elif(warming) {
+                    // The pool is not full yet, grow it in the background while this flow rides an existing link.
+                    auto self = shared_from_this();
+                    auto allocator = configuration->GetBufferAllocator();
+                    ContextPtr executor = GetContext();
+
+                    bool spawned = YieldContext::Spawn(allocator.get(), *executor,
+                        [self, this, executor](YieldContext& y) noexcept {
+                            StrandPtr strand;
+                            OpenMux(executor, strand, y);
+                        });
+                    if (!spawned) {
+                        SynchronizedObjectScope scope(syncobj_);
+                        mux_opening_--;
+                    }
+                }
+
+                if (NULL == mux) {
+                    return NULL;
+                }
+
+                return mux->Open(context, strand);
+            }
+
+            VEthernetExchanger::VirtualEthernetMuxPtr VEthernetExchanger::OpenMux(const ContextPtr& context, const StrandPtr& strand, YieldContext& y) noexcept {
+                VirtualEthernetMuxPtr mux;
+                bool supported = true;
+
+                ITransmissionPtr transmission = OpenTransmission(context, strand, y);
+                if (NULL != transmission) {
+                    if (transmission->HandshakeServer(y, GetId(), false)) {
+                        mux = make_shared_object<VirtualEthernetMux>(transmission, GetId(), false);
+                        if (NULL != mux && !mux->Handshake(y, supported)) {
+                            mux.reset();
+                        }
+                    }
+
+                    if (NULL == mux) {
+                        transmission->Dispose();
+                    }
+                }
+
+                // The link is read on the context and strand its transmission was opened on.
+                if (NULL != mux) {
+                    auto allocator = transmission->BufferAllocator;
+                    bool spawned = YieldContext::Spawn(allocator.get(), *context, strand.get(),
+                        [mux](YieldContext& y) noexcept {
+                            mux->Loopback(y);
+                        });
+                    if (!spawned) {
+                        mux->Dispose();
+                        mux.reset();
+                    }
+                }
+
+                bool disposing = false;
+                for (;;) {
+                    SynchronizedObjectScope scope(syncobj_);
+                    mux_opening_--;
+
+                    // Only a server that answered the MUX frame with something else turns mux off, a broken or silent link is retried.
+                    if (!supported) {
+                        mux_unsupported_ = true;
+                    }
+
+                    if (NULL != mux) {
+                        if (disposed_) {
+                            disposing = true;
+                        }
+                        else {
+                            muxes_.emplace_back(mux);
+                        }
+                    }
+                    break;
+                }
+
+                if (disposing) {
+                    mux->Dispose();
+                    return NULL;
+                }
+
+                return mux;
+            }
+
+            void VEthernetExchanger::AddConnectLatency(const ITransmissionPtr& transmission, UInt64 begin) noexcept {
+                UInt64 now = ppp::GetTickCount(true);
+                UInt64 elapsed = now > begin ? now - begin : 0;
+
+                if (dynamic_cast<ppp::app::protocol::VirtualEthernetMuxStream*>(transmission.get())) {
+                    mux_connects_++;
+                    mux_latency_ += elapsed;
+                }
+                else {
+                    direct_connects_++;
+                    direct_latency_ += elapsed;
+                }
+            }
+
+            void VEthernetExchanger::GetConnectStatistics(ConnectStatistics& statistics) noexcept {
+                statistics.MuxLinks = 0;
+                statistics.MuxStreams = 0;
+                statistics.MuxConnects = mux_connects_.load(std::memory_order_relaxed);
+                statistics.MuxLatency = mux_latency_.load(std::memory_order_relaxed);
+                statistics.DirectConnects = direct_connects_.load(std::memory_order_relaxed);
+                statistics.DirectLatency = direct_latency_.load(std::memory_order_relaxed);
+
+                SynchronizedObjectScope scope(syncobj_);
+                for (VirtualEthernetMuxPtr& mux : muxes_) {
+                    if (mux->IsAvailable()) {
+                        statistics.MuxLinks++;
+                        statistics.MuxStreams += mux->GetStreamCount();
+                    }
+                }
+            }
+
 #if defined(_ANDROID)
             bool VEthernetExchanger::AwaitJniAttachThread(const ContextPtr& context, YieldContext& y) noexcept {
                 // On the Android platform, when the VPN tunnel transport layer is enabled, 
@@ -458,6 +645,21 @@ namespace ppp {
                 return true;
             }
 
+            bool VEthernetExchanger::ReleaseDeadlineTimer(void* key) noexcept {
+                if (NULL == key) {
+                    return false;
+                }
+
+                SynchronizedObjectScope scope(syncobj_);
+                auto tail = wheel_timers_.find(key);
+                if (tail == wheel_timers_.end()) {
+                    return false;
+                }
+
+                wheel_timers_.erase(tail);
+                return true;
+            }
+
             bool VEthernetExchanger::NewDeadlineTimer(const ContextPtr& context, int64_t timeout, const ppp::function<void(bool)>& event) noexcept {
                 if (timeout < 1) {
                     SynchronizedObjectScope scope(syncobj_);
@@ -473,6 +675,41 @@ namespace ppp {
                     return true;
                 }
 
+                TimingWheelPtr wheel = Executors::GetTimingWheel(context.get());
+                if (NULL != wheel) {
+                    using TimingWheel = ppp::threading::TimingWheel;
+
+                    // The slot is registered under the same lock the handler takes to unregister it, so a timeout firing on another
+                    // Thread right after Schedule still finds it.
+                    std::shared_ptr<TimingWheelEntry> slot = make_shared_object<TimingWheelEntry>();
+                    if (NULL == slot) {
+                        return false;
+                    }
+
+                    SynchronizedObjectScope scope(syncobj_);
+                    if (disposed_) {
+                        return false;
+                    }
+
+                    auto self = shared_from_this();
+                    void* key = slot.get();
+
+                    TimingWheel::EntryPtr entry = wheel->Schedule((int)std::min<int64_t>(timeout, INT32_MAX),
+                        [self, this, key, event](bool expired) noexcept {
+                            ReleaseDeadlineTimer(key);
+                            event(expired);
+                        });
+                    if (NULL == entry) {
+                        return false;
+                    }
+
+                    slot->first = std::move(wheel);
+                    slot->second = std::move(entry);
+
+                    auto r = wheel_timers_.emplace(key, std::move(slot));
+                    return r.second;
+                }
+
                 std::shared_ptr<boost::asio::deadline_timer> t = make_shared_object<boost::asio::deadline_timer>(*context);
                 if (NULL == t) {
                     return false;
@@ -517,6 +754,10 @@ namespace ppp {
                 sekap_last_ = Executors::GetTickCount();
                 sekap_next_ = now + RandomNext(SEND_ECHO_KEEP_ALIVE_PACKET_MIN_TIMEOUT, SEND_ECHO_KEEP_ALIVE_PACKET_MAX_TIMEOUT);
                 network_state_.exchange(NetworkState_Established);
+
+                // The server may have been upgraded while the link was down, give mux another try.
+                SynchronizedObjectScope scope(syncobj_);
+                mux_unsupported_ = false;
             }
 
             void VEthernetExchanger::ExchangeToConnectingState() noexcept {
@@ -1386,6 +1627,12 @@ namespace ppp {
                         return false;
                     }
 
+                    std::shared_ptr<ppp::net::packet::BufferSegment> messages = frame->Payload;
+                    if (frame->Source.Port == PPP_DNS_SYS_PORT && NULL != messages) {
+                        boost::asio::ip::udp::endpoint serverEP = IPEndPoint::ToEndPoint<boost::asio::ip::udp>(frame->Source);
+                        switcher_->AddNamespaceCache(serverEP.address(), messages->Buffer.get(), messages->Length);
+                    }
+
                     return switcher_->Output(ip.get());
                 }
                 elif(packet->Protocol == ppp::net::native::ip_hdr::IP_PROTO_IP) {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <ppp/app/protocol/VirtualEthernetLinklayer.h>
+#include <ppp/app/protocol/VirtualEthernetMux.h>
 #include <ppp/app/protocol/VirtualEthernetMappingPort.h>
 #include <ppp/app/protocol/VirtualEthernetPacket.h>
 #include <ppp/cryptography/Ciphertext.h>
@@ -36,6 +37,19 @@ namespace ppp {
                 typedef ppp::threading::Executors::StrandPtr                            StrandPtr;
                 typedef std::mutex                                                      SynchronizedObject;
                 typedef std::lock_guard<SynchronizedObject>                             SynchronizedObjectScope;
+                typedef ppp::app::protocol::VirtualEthernetMux                          VirtualEthernetMux;
+                typedef std::shared_ptr<VirtualEthernetMux>                             VirtualEthernetMuxPtr;
+
+                // Setup latency of the tcp flows in microseconds, from asking for a transmission to the server's SYNOK,
+                // Split by whether the flow rode a pooled mux link or opened a transmission of its own.
+                typedef struct {
+                    int                                                                 MuxLinks;
+                    int                                                                 MuxStreams;
+                    UInt64                                                              MuxConnects;
+                    UInt64                                                              MuxLatency;
+                    UInt64                                                              DirectConnects;
+                    UInt64                                                              DirectLatency;
+                }                                                                       ConnectStatistics;
 
             private:
                 typedef ppp::unordered_map<boost::asio::ip::udp::endpoint,
@@ -47,6 +61,10 @@ namespace ppp {
                 typedef std::shared_ptr<Ciphertext>                                     CiphertextPtr;
                 typedef std::shared_ptr<boost::asio::deadline_timer>                    DeadlineTimerPtr;
                 typedef ppp::unordered_map<void*, DeadlineTimerPtr>                     DeadlineTimerTable;
+                typedef std::shared_ptr<ppp::threading::TimingWheel>                    TimingWheelPtr;
+                typedef std::pair<TimingWheelPtr, ppp::threading::TimingWheel::EntryPtr>
+                                                                                        TimingWheelEntry;
+                typedef ppp::unordered_map<void*, std::shared_ptr<TimingWheelEntry>>    TimingWheelEntryTable;
 
             public:
                 VEthernetExchanger(
@@ -72,6 +90,8 @@ namespace ppp {
                 virtual std::shared_ptr<VirtualEthernetInformation>                     GetInformation() noexcept { return information_; }
                 virtual ITransmissionPtr                                                GetTransmission() noexcept { return transmission_; }
                 virtual ITransmissionPtr                                                ConnectTransmission(const ContextPtr& context, const StrandPtr& strand, YieldContext& y) noexcept;
+                void                                                                    AddConnectLatency(const ITransmissionPtr& transmission, UInt64 begin) noexcept;
+                void                                                                    GetConnectStatistics(ConnectStatistics& statistics) noexcept;
                 
             public:
                 template <typename F>
@@ -146,6 +166,8 @@ namespace ppp {
                 bool                                                                    SendEchoKeepAlivePacket(UInt64 now, bool immediately) noexcept;
                 bool                                                                    ReceiveFromDestination(const boost::asio::ip::udp::endpoint& sourceEP, const boost::asio::ip::udp::endpoint& destinationEP, Byte* packet, int packet_length) noexcept;
                 VEthernetDatagramPortPtr                                                AddNewDatagramPort(const ITransmissionPtr& transmission, const boost::asio::ip::udp::endpoint& sourceEP) noexcept;
+                ITransmissionPtr                                                        ConnectMuxTransmission(const ContextPtr& context, const StrandPtr& strand, YieldContext& y) noexcept;
+                VirtualEthernetMuxPtr                                                   OpenMux(const ContextPtr& context, const StrandPtr& strand, YieldContext& y) noexcept;
 
             private:
                 template <typename TTransmission>
@@ -171,6 +193,7 @@ namespace ppp {
                 void                                                                    UnregisterAllMappingPorts() noexcept;
                 bool                                                                    RegisterAllMappingPorts() noexcept;
                 bool                                                                    ReleaseDeadlineTimer(const boost::asio::deadline_timer* deadline_timer) noexcept;
+                bool                                                                    ReleaseDeadlineTimer(void* key) noexcept;
                 bool                                                                    NewDeadlineTimer(const ContextPtr& context, int64_t timeout, const ppp::function<void(bool)>& event) noexcept;
                 bool                                                                    Sleep(int64_t timeout, const ContextPtr& context, YieldContext& y) noexcept;
 #if defined(_ANDROID)
@@ -230,6 +253,14 @@ namespace ppp {
                 std::atomic<NetworkState>                                               network_state_ = NetworkState_Connecting;
                 VirtualEthernetMappingPortTable                                         mappings_;
                 DeadlineTimerTable                                                      deadline_timers_;
+                TimingWheelEntryTable                                                   wheel_timers_;
+                ppp::vector<VirtualEthernetMuxPtr>                                      muxes_;
+                int                                                                     mux_opening_     = 0;
+                bool                                                                    mux_unsupported_ = false;
+                std::atomic<UInt64>                                                     mux_connects_    = 0;
+                std::atomic<UInt64>                                                     mux_latency_     = 0;
+                std::atomic<UInt64>                                                     direct_connects_ = 0;
+                std::atomic<UInt64>                                                     direct_latency_  = 0;
 
                 struct {
                     boost::asio::ip::tcp::endpoint                                      remoteEP;
@@ -68,6 +68,11 @@ namespace ppp {
                 static_mode_ = false;
                 block_quic_ = false;
                 icmppackets_aid_ = RandomNext();
+
+                int dns_ttl = configuration->udp.dns.ttl;
+                if (dns_ttl > 0) {
+                    dns_cache_ = make_shared_object<DNSCache>(dns_ttl);
+                }
             }
 
             VEthernetNetworkSwitcher::~VEthernetNetworkSwitcher() noexcept {
@@ -205,6 +210,10 @@ namespace ppp {
                 // Check whether dns resolution packets need to be redirected.
                 int destinationPort = frame->Destination.Port;
                 if (destinationPort == PPP_DNS_SYS_PORT) {
+                    if (NamespaceCacheOutput(packet, frame, messages)) {
+                        return true;
+                    }
+
                     if (RedirectDnsServer(exchanger, packet, frame, messages)) {
                         return true;
                     }
@@ -528,6 +537,10 @@ namespace ppp {
             }
 
             bool VEthernetNetworkSwitcher::DatagramOutput(const boost::asio::ip::udp::endpoint& sourceEP, const boost::asio::ip::udp::endpoint& destinationEP, void* packet, int packet_size) noexcept {
+                return DatagramOutput(sourceEP, destinationEP, packet, packet_size, true);
+            }
+
+            bool VEthernetNetworkSwitcher::DatagramOutput(const boost::asio::ip::udp::endpoint& sourceEP, const boost::asio::ip::udp::endpoint& destinationEP, void* packet, int packet_size, bool caching) noexcept {
                 if (NULL == packet || packet_size < 1) {
                     return false;
                 }
@@ -538,6 +551,10 @@ namespace ppp {
 
                 boost::asio::ip::udp::endpoint remoteEP = Ipep::V6ToV4(destinationEP);
                 boost::asio::ip::address address = remoteEP.address();
+                if (caching && remoteEP.port() == PPP_DNS_SYS_PORT) {
+                    AddNamespaceCache(address, reinterpret_cast<Byte*>(packet), packet_size);
+                }
+
                 if (address.is_v4()) {
                     std::shared_ptr<BufferSegment> messages = make_shared_object<BufferSegment>();
                     if (NULL == messages) {
@@ -1852,6 +1869,7 @@ namespace ppp {
                 // To clean up the managed and unmanaged data currently held by the class, 
                 // You need to go through the complete construct fill process again after the Release of this function.
                 dns_rules_.clear();
+                dns_rules_index_.Clear();
                 ribs_.reset(); 
                 preferred_nic_.clear();
                 server_ru_.clear(); 
@@ -1920,6 +1938,7 @@ namespace ppp {
                     return false;
                 }
 
+                UInt64 load_begin = ppp::GetTickCount(true);
                 int events = 0;
                 if (load_file_or_string) {
                     events = ppp::app::client::dns::Rule::LoadFile(rules, dns_rules_);
@@ -1928,9 +1947,28 @@ namespace ppp {
                     events = ppp::app::client::dns::Rule::Load(rules, dns_rules_);
                 }
 
+                if (events > 0) {
+                    dns_rules_index_.Compile(dns_rules_);
+
+                    // Cached answers came from the servers of the previous rules.
+                    if (std::shared_ptr<DNSCache> cache = dns_cache_; NULL != cache) {
+                        cache->Clear();
+                    }
+
+                    SynchronizedObjectScope scope(GetSynchronizedObject());
+                    dns_rules_statistics_.Rules = (int64_t)dns_rules_index_.GetCount();
+                    dns_rules_statistics_.MemorySize = (int64_t)dns_rules_index_.GetMemorySize();
+                    dns_rules_statistics_.Elapsed = (int64_t)(ppp::GetTickCount(true) - load_begin);
+                }
+
                 return events > 0;
             }
 
+            void VEthernetNetworkSwitcher::GetDnsRulesStatistics(DnsRulesStatistics& statistics) noexcept {
+                SynchronizedObjectScope scope(GetSynchronizedObject());
+                statistics = dns_rules_statistics_;
+            }
+
             bool VEthernetNetworkSwitcher::AddRemoteEndPointToIPList(const boost::asio::ip::address& gw) noexcept {
                 using ProtocolType = VEthernetExchanger::ProtocolType;
 
@@ -2183,7 +2221,7 @@ namespace ppp {
                     return false;
                 }
 
-                ppp::app::client::dns::Rule::Ptr rulePtr = ppp::app::client::dns::Rule::Get(hostDomain, dns_rules_);
+                ppp::app::client::dns::Rule::Ptr rulePtr = ppp::app::client::dns::Rule::Get(hostDomain, dns_rules_index_);
                 if (NULL == rulePtr) {
                     return false;
                 }
@@ -2217,6 +2255,74 @@ namespace ppp {
                     });
             }
 
+            ppp::string VEthernetNetworkSwitcher::NamespaceCacheKey(const boost::asio::ip::address& serverIP, const Byte* packet, int packet_size) noexcept {
+                uint16_t queries_type = 0;
+                uint16_t queries_clazz = 0;
+                ppp::string domain = ppp::net::native::dns::ExtractHostY(packet, packet_size,
+                    [&queries_type, &queries_clazz](ppp::net::native::dns::dns_hdr* h, ppp::string& domain, uint16_t type, uint16_t clazz) noexcept -> bool {
+                        queries_type = type;
+                        queries_clazz = clazz;
+                        return true;
+                    });
+
+                if (domain.empty()) {
+                    return ppp::string();
+                }
+
+                using namespace ppp::net::native::dns;
+                if ((queries_type != DNS_TYPE_A && queries_type != DNS_TYPE_AAAA) || queries_clazz != DNS_CLASS_IN) {
+                    return ppp::string();
+                }
+
+                // A name matched by dns-rules.txt is resolved by the rule's server, whatever server the application asked.
+                ppp::app::client::dns::Rule::Ptr rulePtr = ppp::app::client::dns::Rule::Get(domain, dns_rules_index_);
+                if (NULL != rulePtr) {
+                    return DNSCache::Key(rulePtr->Server, queries_type, queries_clazz, domain);
+                }
+                else {
+                    return DNSCache::Key(serverIP, queries_type, queries_clazz, domain);
+                }
+            }
+
+            bool VEthernetNetworkSwitcher::NamespaceCacheOutput(const std::shared_ptr<IPFrame>& packet, const std::shared_ptr<UdpFrame>& frame, const std::shared_ptr<BufferSegment>& messages) noexcept {
+                std::shared_ptr<DNSCache> cache = dns_cache_;
+                if (NULL == cache || messages->Length < sizeof(ppp::net::native::dns::dns_hdr)) {
+                    return false;
+                }
+
+                boost::asio::ip::address destinationIP = Ipep::ToAddress(packet->Destination);
+                ppp::string key = NamespaceCacheKey(destinationIP, messages->Buffer.get(), messages->Length);
+                if (key.empty()) {
+                    return false;
+                }
+
+                std::shared_ptr<Byte> response;
+                int response_length = 0;
+
+                uint16_t trans_id = ((ppp::net::native::dns::dns_hdr*)messages->Buffer.get())->usTransID;
+                if (!cache->Get(key, trans_id, response, response_length)) {
+                    return false;
+                }
+
+                boost::asio::ip::udp::endpoint sourceEP = IPEndPoint::ToEndPoint<boost::asio::ip::udp>(frame->Source);
+                boost::asio::ip::udp::endpoint destinationEP = IPEndPoint::ToEndPoint<boost::asio::ip::udp>(frame->Destination);
+                return DatagramOutput(sourceEP, destinationEP, response.get(), response_length, false);
+            }
+
+            bool VEthernetNetworkSwitcher::AddNamespaceCache(const boost::asio::ip::address& serverIP, const Byte* packet, int packet_size) noexcept {
+                std::shared_ptr<DNSCache> cache = dns_cache_;
+                if (NULL == cache || NULL == packet || packet_size < sizeof(ppp::net::native::dns::dns_hdr)) {
+                    return false;
+                }
+
+                ppp::string key = NamespaceCacheKey(serverIP, packet, packet_size);
+                if (key.empty()) {
+                    return false;
+                }
+
+                return cache->Add(key, packet, packet_size);
+            }
+
             bool VEthernetNetworkSwitcher::StaticMode(bool* static_mode) noexcept {
                 SynchronizedObjectScope scope(GetSynchronizedObject());
                 bool snow = static_mode_;
@@ -2233,6 +2339,11 @@ namespace ppp {
                     if (NULL != exchanger) {
                         exchanger->StaticEchoSwapAsynchronousSocket();
                     }
+
+                    std::shared_ptr<DNSCache> cache = dns_cache_;
+                    if (NULL != cache) {
+                        cache->Update(now);
+                    }
                 }
 
                 return false;
@@ -14,6 +14,7 @@
 #include <ppp/app/protocol/VirtualEthernetLinklayer.h>
 #include <ppp/app/protocol/VirtualEthernetInformation.h>
 #include <ppp/app/client/dns/Rule.h>
+#include <ppp/app/client/dns/Cache.h>
 #include <ppp/app/client/proxys/VEthernetHttpProxySwitcher.h>
 #include <ppp/app/client/proxys/VEthernetSocksProxySwitcher.h>
 
@@ -46,6 +47,8 @@ namespace ppp {
                 typedef ppp::unordered_map<int, VEthernetIcmpPacket>                VEthernetIcmpPacketTable;
                 typedef ppp::app::client::dns::Rule::Ptr                            DNSRulePtr;
                 typedef ppp::unordered_map<ppp::string, DNSRulePtr>                 DNSRuleTable;
+                typedef ppp::app::client::dns::Rule::Index                          DNSRuleIndex;
+                typedef ppp::app::client::dns::Cache                                DNSCache;
                 typedef ppp::threading::Timer                                       Timer;
                 typedef std::weak_ptr<Timer::TimeoutEventHandler>                   TimeoutEventHandlerWeakPtr;
                 typedef ppp::unordered_map<void*, TimeoutEventHandlerWeakPtr>       TimeoutEventHandlerTable;
@@ -65,6 +68,13 @@ namespace ppp {
                 typedef ppp::function<void(VEthernetNetworkSwitcher*, UInt64)>      VEthernetTickEventHandler;
                 typedef ppp::transmissions::ITransmissionStatistics                 ITransmissionStatistics;
                 typedef std::shared_ptr<ITransmissionStatistics>                    ITransmissionStatisticsPtr;
+                // What the last dns rules load produced, for the console.
+                class DnsRulesStatistics {
+                public:
+                    int64_t                                                         Rules      = 0;
+                    int64_t                                                         MemorySize = 0; /* Bytes held by the compiled suffix index. */
+                    int64_t                                                         Elapsed    = 0; /* Microseconds to parse the rules and build the index. */
+                };
                 class NetworkInterface {    
                 public: 
                     ppp::string                                                     Name;
@@ -133,6 +143,7 @@ namespace ppp {
 
             public: 
                 virtual bool                                                        LoadAllDnsRules(const ppp::string& rules, bool load_file_or_string) noexcept;
+                void                                                                GetDnsRulesStatistics(DnsRulesStatistics& statistics) noexcept;
                 bool                                                                StaticMode(bool* static_mode) noexcept;
 #if defined(_ANDROID) || defined(_IPHONE)   
                 void                                                                SetBypassIpList(ppp::string&& bypass_ip_list) noexcept;
@@ -198,6 +209,10 @@ namespace ppp {
                     const std::shared_ptr<ppp::net::packet::BufferSegment>&         messages,
                     const std::shared_ptr<boost::asio::io_context>&                 context,
                     const boost::asio::ip::address&                                 destinationIP) noexcept;
+                bool                                                                DatagramOutput(const boost::asio::ip::udp::endpoint& sourceEP, const boost::asio::ip::udp::endpoint& destinationEP, void* packet, int packet_size, bool caching) noexcept;
+                ppp::string                                                         NamespaceCacheKey(const boost::asio::ip::address& serverIP, const Byte* packet, int packet_size) noexcept;
+                bool                                                                NamespaceCacheOutput(const std::shared_ptr<IPFrame>& packet, const std::shared_ptr<UdpFrame>& frame, const std::shared_ptr<ppp::net::packet::BufferSegment>& messages) noexcept;
+                bool                                                                AddNamespaceCache(const boost::asio::ip::address& serverIP, const Byte* packet, int packet_size) noexcept;
                 bool                                                                EmplaceTimeout(void* k, const std::shared_ptr<ppp::threading::Timer::TimeoutEventHandler>& timeout) noexcept;
                 bool                                                                DeleteTimeout(void* k) noexcept;
 
@@ -249,6 +264,9 @@ namespace ppp {
                 VEthernetSocksProxySwitcherPtr                                      socks_proxy_;
                 TimeoutEventHandlerTable                                            timeouts_;
                 DNSRuleTable                                                        dns_rules_;
+                DNSRuleIndex                                                        dns_rules_index_;
+                DnsRulesStatistics                                                  dns_rules_statistics_;
+                std::shared_ptr<DNSCache>                                           dns_cache_;
                 RouteInformationTablePtr                                            rib_;
                 ForwardInformationTablePtr                                          fib_;
                 ppp::string                                                         server_ru_;
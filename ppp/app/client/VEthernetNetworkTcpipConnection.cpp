@@ -109,6 +109,7 @@ namespace ppp {
                         return rinetd_status == 0;
                     }
 
+                    UInt64 connect_begin = ppp::GetTickCount(true);
                     std::shared_ptr<ppp::transmissions::ITransmission> transmission = exchanger_->ConnectTransmission(context, strand, y);
                     if (NULL == transmission) {
                         return false;
@@ -134,6 +135,8 @@ namespace ppp {
                         return false;
                     }
 
+                    exchanger_->AddConnectLatency(transmission, connect_begin);
+
                     connection_ = std::move(connection);
                 } while (false);
                 return true;
@@ -0,0 +1,181 @@
+#include <ppp/app/client/dns/Cache.h>
+#include <ppp/net/native/checksum.h>
+#include <ppp/threading/Executors.h>
+
+namespace ppp
+{
+    namespace app
+    {
+        namespace client
+        {
+            namespace dns
+            {
+                Cache::Cache(int ttl) noexcept
+                    : ttl_(std::max<int>(1, ttl))
+                {
+
+                }
+
+                ppp::string Cache::Key(const boost::asio::ip::address& server, uint16_t type, uint16_t clazz, const ppp::string& domain) noexcept
+                {
+                    ppp::string key;
+                    key.reserve(domain.size() + 21);
+                    if (server.is_v4())
+                    {
+                        boost::asio::ip::address_v4::bytes_type bytes = server.to_v4().to_bytes();
+                        key.append((char*)bytes.data(), bytes.size());
+                    }
+                    else
+                    {
+                        boost::asio::ip::address_v6::bytes_type bytes = server.to_v6().to_bytes();
+                        key.append((char*)bytes.data(), bytes.size());
+                    }
+
+                    key.push_back((char)(type >> 8));
+                    key.push_back((char)(type));
+                    key.push_back((char)(clazz >> 8));
+                    key.push_back((char)(clazz));
+
+                    // Names compare case-insensitively and the trailing root dot is optional.
+                    std::size_t length = domain.size();
+                    while (length > 0 && domain[length - 1] == '.')
+                    {
+                        length--;
+                    }
+
+                    for (std::size_t i = 0; i < length; i++)
+                    {
+                        char ch = domain[i];
+                        key.push_back(ch >= 'A' && ch <= 'Z' ? (char)(ch - 'A' + 'a') : ch);
+                    }
+
+                    return key;
+                }
+
+                bool Cache::Add(const ppp::string& key, const Byte* response, int response_length) noexcept
+                {
+                    if (key.empty() || NULL == response || response_length < (int)sizeof(ppp::net::native::dns::dns_hdr))
+                    {
+                        return false;
+                    }
+
+                    Record record;
+                    bool negative = false;
+
+                    int ttl = ppp::net::native::dns::ExtractTTL(response, response_length, NEGATIVE_TTL, &negative, &record.ttl_offsets);
+                    if (negative)
+                    {
+                        ttl = std::min<int>(ttl, NEGATIVE_TTL);
+                    }
+
+                    ttl = std::min<int>(ttl, ttl_);
+                    if (ttl < 1)
+                    {
+                        return false;
+                    }
+
+                    record.response = make_shared_alloc<Byte>(response_length);
+                    if (NULL == record.response)
+                    {
+                        return false;
+                    }
+
+                    memcpy(record.response.get(), response, response_length);
+                    record.response_length = response_length;
+                    record.expired_time = ppp::threading::Executors::GetTickCount() + static_cast<uint64_t>(ttl) * 1000ULL;
+
+                    std::lock_guard<std::mutex> scope(syncobj_);
+                    if (records_.size() >= MAX_RECORDS && records_.find(key) == records_.end())
+                    {
+                        // Full of live records, give up an arbitrary one rather than growing without bound.
+                        records_.erase(records_.begin());
+                    }
+
+                    records_[key] = std::move(record);
+                    return true;
+                }
+
+                bool Cache::Get(const ppp::string& key, uint16_t trans_id, std::shared_ptr<Byte>& response, int& response_length) noexcept
+                {
+                    if (key.empty())
+                    {
+                        return false;
+                    }
+
+                    uint64_t now = ppp::threading::Executors::GetTickCount();
+                    uint64_t expired_time = 0;
+                    std::shared_ptr<Byte> cached;
+                    ppp::vector<uint16_t> ttl_offsets;
+
+                    for (std::lock_guard<std::mutex> scope(syncobj_);;)
+                    {
+                        auto tail = records_.find(key);
+                        if (tail == records_.end())
+                        {
+                            return false;
+                        }
+
+                        Record& record = tail->second;
+                        if (now >= record.expired_time)
+                        {
+                            records_.erase(tail);
+                            return false;
+                        }
+
+                        expired_time = record.expired_time;
+                        cached = record.response;
+                        response_length = record.response_length;
+                        ttl_offsets = record.ttl_offsets;
+                        break;
+                    }
+
+                    response = make_shared_alloc<Byte>(response_length);
+                    if (NULL == response)
+                    {
+                        return false;
+                    }
+
+                    // The answer goes back with the id of this query and the TTLs counted down to what is left of the record.
+                    memcpy(response.get(), cached.get(), response_length);
+                    ((ppp::net::native::dns::dns_hdr*)response.get())->usTransID = trans_id;
+
+                    uint32_t remaining = htonl(static_cast<uint32_t>((expired_time - now + 999) / 1000));
+                    for (uint16_t offset : ttl_offsets)
+                    {
+                        memcpy(response.get() + offset, &remaining, sizeof(remaining));
+                    }
+
+                    return true;
+                }
+
+                void Cache::Update(uint64_t now) noexcept
+                {
+                    std::lock_guard<std::mutex> scope(syncobj_);
+                    for (auto tail = records_.begin(); tail != records_.end();)
+                    {
+                        if (now < tail->second.expired_time)
+                        {
+                            tail++;
+                        }
+                        else
+                        {
+                            tail = records_.erase(tail);
+                        }
+                    }
+                }
+
+                void Cache::Clear() noexcept
+                {
+                    std::lock_guard<std::mutex> scope(syncobj_);
+                    records_.clear();
+                }
+
+                int Cache::GetCount() noexcept
+                {
+                    std::lock_guard<std::mutex> scope(syncobj_);
+                    return static_cast<int>(records_.size());
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <ppp/stdafx.h>
+
+namespace ppp
+{
+    namespace app
+    {
+        namespace client
+        {
+            namespace dns
+            {
+                // Answers of the A/AAAA queries leaving the TUN device, so a name resolved a moment ago is answered locally instead of
+                // Costing a round trip to the VPN server. Records live for their smallest TTL capped by udp.dns.ttl.
+                class Cache final
+                {
+                public:
+                    static constexpr int                        NEGATIVE_TTL = 30;      /* seconds, names without an address of the queried family */
+                    static constexpr int                        MAX_RECORDS  = 4096;
+
+                public:
+                    Cache(int ttl) noexcept;
+
+                public:
+                    // The resolver the query is routed to is part of the key, a rule in dns-rules.txt sends a name to its own server.
+                    static ppp::string                          Key(const boost::asio::ip::address& server, uint16_t type, uint16_t clazz, const ppp::string& domain) noexcept;
+
+                public:
+                    bool                                        Add(const ppp::string& key, const Byte* response, int response_length) noexcept;
+                    bool                                        Get(const ppp::string& key, uint16_t trans_id, std::shared_ptr<Byte>& response, int& response_length) noexcept;
+                    void                                        Update(uint64_t now) noexcept;
+                    void                                        Clear() noexcept;
+                    int                                         GetCount() noexcept;
+
+                private:
+                    struct Record
+                    {
+                        uint64_t                                expired_time = 0;
+                        std::shared_ptr<Byte>                   response;
+                        int                                     response_length = 0;
+                        ppp::vector<uint16_t>                   ttl_offsets;
+                    };
+
+                private:
+                    std::mutex                                  syncobj_;
+                    int                                         ttl_ = 0;
+                    ppp::unordered_map<ppp::string, Record>     records_;
+                };
+            }
+        }
+    }
+}
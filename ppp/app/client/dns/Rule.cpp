@@ -124,6 +124,59 @@ namespace ppp
                     return rules.size() - length;
                 }
 
+                bool Rule::Index::Compile(const ppp::unordered_map<ppp::string, Ptr>& rules) noexcept
+                {
+                    trie_ = ppp::net::DomainTrie();
+                    rules_.clear();
+                    rules_.reserve(rules.size());
+
+                    for (auto&& [host, rule] : rules)
+                    {
+                        if (NULL != rule && trie_.Add(host, (int)rules_.size()))
+                        {
+                            rules_.emplace_back(rule);
+                        }
+                    }
+
+                    trie_.Compile();
+                    rules_.shrink_to_fit();
+                    return !rules_.empty();
+                }
+
+                void Rule::Index::Clear() noexcept
+                {
+                    trie_ = ppp::net::DomainTrie();
+                    rules_.clear();
+                }
+
+                Rule::Ptr Rule::Index::Get(const ppp::string& s) const noexcept
+                {
+                    if (s.empty() || rules_.empty())
+                    {
+                        return NULL;
+                    }
+
+                    std::string_view host = ppp::net::DomainTrie::Trim(s);
+                    if (host.empty())
+                    {
+                        return NULL;
+                    }
+
+                    boost::asio::ip::address ip;
+                    if (ppp::net::DomainTrie::TryParseAddress(host, ip))
+                    {
+                        return NULL;
+                    }
+
+                    int index = trie_.Lookup(host);
+                    if (index < 0)
+                    {
+                        return NULL;
+                    }
+
+                    return rules_[index];
+                }
+
                 Rule::Ptr Rule::Get(const ppp::string& s, const ppp::unordered_map<ppp::string, Ptr>& rules) noexcept
                 {
                     if (s.empty() || rules.empty())
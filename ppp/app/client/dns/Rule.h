@@ -1,6 +1,7 @@
 #pragma once
 
 #include <ppp/stdafx.h>
+#include <ppp/net/DomainTrie.h>
 
 namespace ppp
 {
@@ -20,8 +21,24 @@ namespace ppp
                 public:
                     typedef std::shared_ptr<Rule>       Ptr;
 
+                    // Domain suffix index over a loaded rule table, rebuilt after every load.
+                    class Index final
+                    {
+                    public:
+                        bool                            Compile(const ppp::unordered_map<ppp::string, Ptr>& rules) noexcept;
+                        void                            Clear() noexcept;
+                        Rule::Ptr                       Get(const ppp::string& s) const noexcept;
+                        std::size_t                     GetMemorySize() const noexcept { return trie_.GetMemorySize() + rules_.capacity() * sizeof(Ptr); }
+                        std::size_t                     GetCount() const noexcept      { return rules_.size(); }
+
+                    private:
+                        ppp::net::DomainTrie            trie_;
+                        ppp::vector<Ptr>                rules_;
+                    };
+
                 public:
                     static Rule::Ptr                    Get(const ppp::string& s, const ppp::unordered_map<ppp::string, Ptr>& rules) noexcept;
+                    static Rule::Ptr                    Get(const ppp::string& s, const Index& rules) noexcept { return rules.Get(s); }
 
                 public:
                     static int                          Load(const ppp::string& s, ppp::unordered_map<ppp::string, Ptr>& rules) noexcept;
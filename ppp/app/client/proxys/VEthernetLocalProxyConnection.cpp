@@ -183,6 +183,7 @@ namespace ppp {
                         }
                     }
 
+                    UInt64 connect_begin = ppp::GetTickCount(true);
                     std::shared_ptr<ppp::transmissions::ITransmission> transmission = exchanger_->ConnectTransmission(context_, strand_, y);
                     if (NULL == transmission) {
                         return false;
@@ -208,6 +209,8 @@ namespace ppp {
                         return false;
                     }
 
+                    exchanger_->AddConnectLatency(transmission, connect_begin);
+
                     this->connection_ = std::move(connection);
                     return true;
                 }
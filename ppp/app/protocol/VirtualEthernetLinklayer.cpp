@@ -560,6 +560,21 @@ namespace ppp {
                         }
                     }
                 }
+                elif(packet_action == PacketAction_MUX) {
+                    int window = global::PACKET_Dword(p, packet_length);
+                    if (window > 0) {
+                        return OnMux(transmission, window, y);
+                    }
+                }
+                elif(packet_action == PacketAction_MUXACK) {
+                    int connection_id = global::PACKET_ConnectId(p, packet_length);
+                    if (connection_id) {
+                        int credit = global::PACKET_Dword(p, packet_length);
+                        if (credit > 0) {
+                            return OnMuxAck(transmission, connection_id, credit, y);
+                        }
+                    }
+                }
                 return false;
             }
 
@@ -664,6 +679,30 @@ namespace ppp {
                 return false;
             }
 
+            bool VirtualEthernetLinklayer::DoMux(const ITransmissionPtr& transmission, int window, YieldContext& y) noexcept {
+                MemoryStream ms;
+                if (ms.WriteByte(PacketAction_MUX)) {
+                    if (global::PACKET_Dword(ms, window)) {
+                        std::shared_ptr<Byte> buffer = ms.GetBuffer();
+                        return transmission->Write(y, buffer.get(), ms.GetPosition());
+                    }
+                }
+
+                return false;
+            }
+
+            bool VirtualEthernetLinklayer::DoMuxAck(const ITransmissionPtr& transmission, int connection_id, int credit, YieldContext& y) noexcept {
+                MemoryStream ms;
+                if (global::PACKET_ConnectId(ms, PacketAction_MUXACK, connection_id, NULL, 0)) {
+                    if (global::PACKET_Dword(ms, credit)) {
+                        std::shared_ptr<Byte> buffer = ms.GetBuffer();
+                        return transmission->Write(y, buffer.get(), ms.GetPosition());
+                    }
+                }
+
+                return false;
+            }
+
             bool VirtualEthernetLinklayer::DoFrpEntry(const ITransmissionPtr& transmission, bool tcp, bool in, int remote_port, YieldContext& y) noexcept {
                 MemoryStream ms;
                 if (ms.WriteByte((Byte)PacketAction_FRP_ENTRY)) {
@@ -58,6 +58,10 @@ namespace ppp {
                     PacketAction_ECHOACK                                    = 0x30,
                     PacketAction_STATIC                                     = 0x31,
                     PacketAction_STATICACK                                  = 0x32,
+
+                    // MUX
+                    PacketAction_MUX                                        = 0x33,
+                    PacketAction_MUXACK                                     = 0x34,
                 }                                                           PacketAction;
 
             public:
@@ -106,6 +110,8 @@ namespace ppp {
                 virtual bool                                                DoSendTo(const ITransmissionPtr& transmission, const boost::asio::ip::udp::endpoint& sourceEP, const boost::asio::ip::udp::endpoint& destinationEP, Byte* packet, int packet_length, YieldContext& y) noexcept;
                 virtual bool                                                DoStatic(const ITransmissionPtr& transmission, YieldContext& y) noexcept;
                 virtual bool                                                DoStatic(const ITransmissionPtr& transmission, int session_id, int remote_port, YieldContext& y) noexcept;
+                virtual bool                                                DoMux(const ITransmissionPtr& transmission, int window, YieldContext& y) noexcept;
+                virtual bool                                                DoMuxAck(const ITransmissionPtr& transmission, int connection_id, int credit, YieldContext& y) noexcept;
 
             public:
                 virtual bool                                                DoFrpEntry(const ITransmissionPtr& transmission, bool tcp, bool in, int remote_port, YieldContext& y) noexcept;
@@ -136,6 +142,8 @@ namespace ppp {
                 virtual bool                                                OnSendTo(const ITransmissionPtr& transmission, const boost::asio::ip::udp::endpoint& sourceEP, const boost::asio::ip::udp::endpoint& destinationEP, Byte* packet, int packet_length, YieldContext& y) noexcept { return true; }
                 virtual bool                                                OnStatic(const ITransmissionPtr& transmission, YieldContext& y) noexcept { return true; }
                 virtual bool                                                OnStatic(const ITransmissionPtr& transmission, int session_id, int remote_port, YieldContext& y) noexcept { return true; }
+                virtual bool                                                OnMux(const ITransmissionPtr& transmission, int window, YieldContext& y) noexcept { return false; }
+                virtual bool                                                OnMuxAck(const ITransmissionPtr& transmission, int connection_id, int credit, YieldContext& y) noexcept { return false; }
 
             protected:
                 virtual bool                                                OnPreparedConnect(const ITransmissionPtr& transmission, int connection_id, const ppp::string& destinationHost, const boost::asio::ip::tcp::endpoint& destinationEP, YieldContext& y) noexcept { return true; }
@@ -426,8 +426,35 @@ namespace ppp {
                 }
 
                 std::shared_ptr<IAsynchronousWriteIoQueue> self = shared_from_this();
-                boost::asio::async_write(*socket_, boost::asio::buffer((Byte*)packet.get() + offset, packet_length),
-                    [self, this, packet, packet_length, cb](const boost::system::error_code& ec, std::size_t sz) noexcept {
+                boost::asio::async_write(*socket, boost::asio::buffer((Byte*)packet.get() + offset, packet_length),
+                    [self, this, socket, packet, packet_length, cb](const boost::system::error_code& ec, std::size_t sz) noexcept {
+                        bool ok = ec == boost::system::errc::success;
+                        if (cb) {
+                            cb(ok);
+                        }
+                    });
+                return true;
+            }
+
+            bool VirtualEthernetMappingPort::Server::Connection::DoWriteBuffers(const ConstBufferSequencePtr& buffers, int buffers_length, const AsynchronousWriteBytesCallback& cb) noexcept {
+                int connection_state = connection_stated_.load();
+                if (connection_state != 3) {
+                    return false;
+                }
+
+                std::shared_ptr<boost::asio::ip::tcp::socket> socket = socket_;
+                if (NULL == socket) {
+                    return false;
+                }
+
+                bool opened = socket->is_open();
+                if (!opened) {
+                    return false;
+                }
+
+                std::shared_ptr<IAsynchronousWriteIoQueue> self = shared_from_this();
+                boost::asio::async_write(*socket, *buffers,
+                    [self, this, socket, buffers, cb](const boost::system::error_code& ec, std::size_t sz) noexcept {
                         bool ok = ec == boost::system::errc::success;
                         if (cb) {
                             cb(ok);
@@ -1110,8 +1137,35 @@ namespace ppp {
                 }
 
                 std::shared_ptr<IAsynchronousWriteIoQueue> self = shared_from_this();
-                boost::asio::async_write(*socket_, boost::asio::buffer((Byte*)packet.get() + offset, packet_length),
-                    [self, this, packet, packet_length, cb](const boost::system::error_code& ec, std::size_t sz) noexcept {
+                boost::asio::async_write(*socket, boost::asio::buffer((Byte*)packet.get() + offset, packet_length),
+                    [self, this, socket, packet, packet_length, cb](const boost::system::error_code& ec, std::size_t sz) noexcept {
+                        bool ok = ec == boost::system::errc::success;
+                        if (cb) {
+                            cb(ok);
+                        }
+                    });
+                return true;
+            }
+
+            bool VirtualEthernetMappingPort::Client::Connection::DoWriteBuffers(const ConstBufferSequencePtr& buffers, int buffers_length, const AsynchronousWriteBytesCallback& cb) noexcept {
+                int connection_state = connection_stated_.load();
+                if (connection_state != 3) {
+                    return false;
+                }
+
+                std::shared_ptr<boost::asio::ip::tcp::socket> socket = socket_;
+                if (NULL == socket) {
+                    return false;
+                }
+
+                bool opened = socket->is_open();
+                if (!opened) {
+                    return false;
+                }
+
+                std::shared_ptr<IAsynchronousWriteIoQueue> self = shared_from_this();
+                boost::asio::async_write(*socket, *buffers,
+                    [self, this, socket, buffers, cb](const boost::system::error_code& ec, std::size_t sz) noexcept {
                         bool ok = ec == boost::system::errc::success;
                         if (cb) {
                             cb(ok);
@@ -107,6 +107,7 @@ namespace ppp {
                         void                                                                Finalize(bool disconnect) noexcept;
                         bool                                                                ForwardFrpUserToFrpClient() noexcept;
                         virtual bool                                                        DoWriteBytes(std::shared_ptr<Byte> packet, int offset, int packet_length, const AsynchronousWriteBytesCallback& cb) noexcept;
+                        virtual bool                                                        DoWriteBuffers(const ConstBufferSequencePtr& buffers, int buffers_length, const AsynchronousWriteBytesCallback& cb) noexcept override;
 
                     private:
                         std::atomic<int>                                                    connection_stated_;
@@ -165,6 +166,7 @@ namespace ppp {
                         void                                                                Finalize(bool disconnect) noexcept;
                         bool                                                                Loopback() noexcept;
                         virtual bool                                                        DoWriteBytes(std::shared_ptr<Byte> packet, int offset, int packet_length, const AsynchronousWriteBytesCallback& cb) noexcept;
+                        virtual bool                                                        DoWriteBuffers(const ConstBufferSequencePtr& buffers, int buffers_length, const AsynchronousWriteBytesCallback& cb) noexcept override;
 
                     private:
                         std::atomic<int>                                                    connection_stated_ = FALSE;
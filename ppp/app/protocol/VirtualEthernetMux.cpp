@@ -0,0 +1,631 @@
+#include <ppp/app/protocol/VirtualEthernetMux.h>
+#include <ppp/threading/Timer.h>
+#include <ppp/threading/Executors.h>
+#include <ppp/threading/BufferswapAllocator.h>
+
+namespace ppp {
+    namespace app {
+        namespace protocol {
+            typedef ppp::threading::Timer                               Timer;
+            typedef ppp::threading::Executors                           Executors;
+            typedef ppp::threading::BufferswapAllocator                 BufferswapAllocator;
+            typedef VirtualEthernetMux::AsynchronousWriteCallback       AsynchronousWriteCallback;
+
+            VirtualEthernetMux::VirtualEthernetMux(const ITransmissionPtr& transmission, const Int128& id, bool server) noexcept
+                : VirtualEthernetLinklayer(transmission->GetConfiguration(), transmission->GetContext(), id)
+                , disposed_(false)
+                , handshaked_(false)
+                , server_(server)
+                , window_(0)
+                , last_id_(0)
+                , strand_(transmission->GetStrand())
+                , transmission_(transmission) {
+
+            }
+
+            VirtualEthernetMux::~VirtualEthernetMux() noexcept {
+                Finalize();
+            }
+
+            bool VirtualEthernetMux::IsMux(const void* packet, int packet_length) noexcept {
+                /* ACTION(1BYTE) WINDOW(4BYTE) */
+                if (NULL == packet || packet_length < 5) {
+                    return false;
+                }
+
+                return *(Byte*)packet == PacketAction_MUX;
+            }
+
+            bool VirtualEthernetMux::IsAvailable() noexcept {
+                SynchronizedObjectScope scope(syncobj_);
+                return !disposed_ && handshaked_ && last_id_ < MAX_STREAM_ID;
+            }
+
+            // The flags share one byte, so even reading one of them takes the lock the writers hold.
+            bool VirtualEthernetMux::IsDisposed() noexcept {
+                SynchronizedObjectScope scope(syncobj_);
+                return disposed_;
+            }
+
+            bool VirtualEthernetMux::IsHandshaked() noexcept {
+                SynchronizedObjectScope scope(syncobj_);
+                return handshaked_;
+            }
+
+            int VirtualEthernetMux::GetStreamCount() noexcept {
+                SynchronizedObjectScope scope(syncobj_);
+                return static_cast<int>(streams_.size());
+            }
+
+            void VirtualEthernetMux::Dispose() noexcept {
+                auto self = shared_from_this();
+                Executors::Post(GetContext(), strand_,
+                    [self, this]() noexcept {
+                        Finalize();
+                    });
+            }
+
+            void VirtualEthernetMux::Finalize() noexcept {
+                VirtualEthernetMuxStreamTable streams;
+                for (;;) {
+                    SynchronizedObjectScope scope(syncobj_);
+                    disposed_ = true;
+
+                    streams = std::move(streams_);
+                    streams_.clear();
+                    break;
+                }
+
+                ITransmissionPtr transmission = transmission_;
+                if (NULL != transmission) {
+                    transmission->Dispose();
+                }
+
+                for (auto&& [_, stream] : streams) {
+                    ppp::list<VirtualEthernetMuxStream::PendingWrite> pending = std::move(stream->pending_);
+                    stream->pending_.clear();
+
+                    stream->Fin();
+                    for (VirtualEthernetMuxStream::PendingWrite& message : pending) {
+                        if (message.cb) {
+                            message.cb(false);
+                        }
+                    }
+                }
+            }
+
+            bool VirtualEthernetMux::Handshake(YieldContext& y, bool& supported) noexcept {
+                supported = true;
+                if (server_ || IsHandshaked()) {
+                    return false;
+                }
+
+                ITransmissionPtr transmission = transmission_;
+                if (NULL == transmission) {
+                    return false;
+                }
+
+                // A server that never answers has the link closed under the read once the connect timeout is up.
+                AppConfigurationPtr configuration = GetConfiguration();
+                std::shared_ptr<Timer> timeout = Timer::Timeout(GetContext(), (int)configuration->tcp.connect.timeout * 1000,
+                    [transmission](Timer*) noexcept {
+                        transmission->Dispose();
+                    });
+                if (NULL == timeout) {
+                    return false;
+                }
+
+                bool ok = false;
+                if (DoMux(transmission, configuration->tcp.mux.window, y)) {
+                    int packet_length = 0;
+                    std::shared_ptr<Byte> packet = transmission->Read(y, packet_length);
+                    if (NULL == packet || packet_length < 1) {
+                        ok = false;
+                    }
+                    elif(IsMux(packet.get(), packet_length)) {
+                        ok = PacketInput(transmission, packet.get(), packet_length, y) && IsHandshaked();
+                    }
+                    else {
+                        supported = false;
+                    }
+                }
+
+                timeout->Stop();
+                timeout->Dispose();
+                return ok;
+            }
+
+            bool VirtualEthernetMux::Accept(Byte* packet, int packet_length, YieldContext& y) noexcept {
+                if (!server_ || IsHandshaked()) {
+                    return false;
+                }
+
+                if (!IsMux(packet, packet_length)) {
+                    return false;
+                }
+
+                ITransmissionPtr transmission = transmission_;
+                if (NULL == transmission) {
+                    return false;
+                }
+
+                return PacketInput(transmission, packet, packet_length, y) && IsHandshaked();
+            }
+
+            bool VirtualEthernetMux::Loopback(YieldContext& y) noexcept {
+                bool ok = false;
+                if (IsHandshaked()) {
+                    ITransmissionPtr transmission = transmission_;
+                    if (NULL != transmission) {
+                        ok = Run(transmission, y);
+                    }
+                }
+
+                Dispose();
+                return ok;
+            }
+
+            VirtualEthernetMux::VirtualEthernetMuxStreamPtr VirtualEthernetMux::NewStream(const ContextPtr& context, const StrandPtr& strand, int connection_id) noexcept {
+                auto self = std::static_pointer_cast<VirtualEthernetMux>(shared_from_this());
+                return make_shared_object<VirtualEthernetMuxStream>(self, context, strand, connection_id);
+            }
+
+            VirtualEthernetMux::VirtualEthernetMuxStreamPtr VirtualEthernetMux::Open(const ContextPtr& context, const StrandPtr& strand) noexcept {
+                if (NULL == context || server_) {
+                    return NULL;
+                }
+
+                int connection_id = 0;
+                for (;;) {
+                    SynchronizedObjectScope scope(syncobj_);
+                    if (disposed_ || !handshaked_ || last_id_ >= MAX_STREAM_ID) {
+                        return NULL;
+                    }
+
+                    connection_id = ++last_id_;
+                    break;
+                }
+
+                VirtualEthernetMuxStreamPtr stream = NewStream(context, strand, connection_id);
+                if (NULL == stream) {
+                    return NULL;
+                }
+
+                for (;;) {
+                    SynchronizedObjectScope scope(syncobj_);
+                    if (disposed_) {
+                        return NULL;
+                    }
+
+                    streams_[connection_id] = stream;
+                    break;
+                }
+
+                return stream;
+            }
+
+            bool VirtualEthernetMux::OnMux(const ITransmissionPtr& transmission, int window, YieldContext& y) noexcept {
+                if (IsHandshaked()) {
+                    return false;
+                }
+
+                window_ = window;
+                if (server_) {
+                    AppConfigurationPtr configuration = GetConfiguration();
+                    if (!DoMux(transmission, configuration->tcp.mux.window, y)) {
+                        return false;
+                    }
+                }
+
+                SynchronizedObjectScope scope(syncobj_);
+                handshaked_ = true;
+                return true;
+            }
+
+            bool VirtualEthernetMux::OnPush(const ITransmissionPtr& transmission, int connection_id, Byte* packet, int packet_length, YieldContext& y) noexcept {
+                VirtualEthernetMuxStreamPtr stream;
+                bool accept = false;
+                for (;;) {
+                    SynchronizedObjectScope scope(syncobj_);
+                    if (disposed_ || !handshaked_) {
+                        return false;
+                    }
+
+                    if (auto tail = streams_.find(connection_id); tail != streams_.end()) {
+                        stream = tail->second;
+                    }
+                    elif(server_ && connection_id > last_id_) {
+                        // Ids are handed out in ascending order, so an unknown id at or below the last one belongs to a
+                        // Stream that has already been closed here and its late frames are dropped.
+                        last_id_ = connection_id;
+                        accept = true;
+                    }
+                    break;
+                }
+
+                if (accept) {
+                    stream = NewStream(GetContext(), strand_, connection_id);
+                    if (NULL == stream) {
+                        return false;
+                    }
+                    else {
+                        SynchronizedObjectScope scope(syncobj_);
+                        streams_[connection_id] = stream;
+                    }
+                }
+
+                if (NULL == stream) {
+                    return true;
+                }
+
+                if (!stream->Input(packet, packet_length)) {
+                    stream->Dispose();
+                }
+                elif(accept && !OnAccept(stream)) {
+                    stream->Dispose();
+                }
+
+                return true;
+            }
+
+            bool VirtualEthernetMux::OnDisconnect(const ITransmissionPtr& transmission, int connection_id, YieldContext& y) noexcept {
+                VirtualEthernetMuxStreamPtr stream;
+                for (;;) {
+                    SynchronizedObjectScope scope(syncobj_);
+                    if (auto tail = streams_.find(connection_id); tail != streams_.end()) {
+                        stream = std::move(tail->second);
+                        streams_.erase(tail);
+                    }
+                    break;
+                }
+
+                if (NULL != stream) {
+                    stream->Fin();
+                }
+
+                return true;
+            }
+
+            bool VirtualEthernetMux::OnMuxAck(const ITransmissionPtr& transmission, int connection_id, int credit, YieldContext& y) noexcept {
+                VirtualEthernetMuxStreamPtr stream;
+                for (;;) {
+                    SynchronizedObjectScope scope(syncobj_);
+                    if (auto tail = streams_.find(connection_id); tail != streams_.end()) {
+                        stream = tail->second;
+                    }
+                    break;
+                }
+
+                if (NULL != stream) {
+                    stream->credit_ += credit;
+                    Flush(stream);
+                }
+
+                return true;
+            }
+
+            bool VirtualEthernetMux::Push(const VirtualEthernetMuxStreamPtr& stream, const std::shared_ptr<Byte>& packet, int packet_length, int payload_length, const AsynchronousWriteCallback& cb) noexcept {
+                if (IsDisposed()) {
+                    return false;
+                }
+
+                auto self = shared_from_this();
+                return Executors::Post(GetContext(), strand_,
+                    [self, this, stream, packet, packet_length, payload_length, cb]() noexcept {
+                        if (IsDisposed() || stream->IsClosed()) {
+                            if (cb) {
+                                cb(false);
+                            }
+                        }
+                        elif(stream->credit_ > 0 && stream->pending_.empty()) {
+                            Send(stream, packet, packet_length, payload_length, cb);
+                        }
+                        else {
+                            VirtualEthernetMuxStream::PendingWrite message;
+                            message.packet = packet;
+                            message.packet_length = packet_length;
+                            message.payload_length = payload_length;
+                            message.cb = cb;
+                            stream->pending_.emplace_back(std::move(message));
+                        }
+                    });
+            }
+
+            void VirtualEthernetMux::Flush(const VirtualEthernetMuxStreamPtr& stream) noexcept {
+                while (stream->credit_ > 0 && !stream->pending_.empty()) {
+                    VirtualEthernetMuxStream::PendingWrite message = std::move(stream->pending_.front());
+                    stream->pending_.pop_front();
+
+                    if (!Send(stream, message.packet, message.packet_length, message.payload_length, message.cb)) {
+                        break;
+                    }
+                }
+            }
+
+            bool VirtualEthernetMux::Send(const VirtualEthernetMuxStreamPtr& stream, const std::shared_ptr<Byte>& packet, int packet_length, int payload_length, const AsynchronousWriteCallback& cb) noexcept {
+                // The credit may run negative by the last frame, the receiver leaves room for one segment above its window.
+                stream->credit_ -= payload_length;
+
+                // A refused write may or may not have called back already, make sure the caller hears about it exactly once.
+                std::shared_ptr<AsynchronousWriteCallback> callback = make_shared_object<AsynchronousWriteCallback>(cb);
+                auto complete =
+                    [callback](bool ok) noexcept {
+                        AsynchronousWriteCallback f = std::move(*callback);
+                        *callback = NULL;
+
+                        if (f) {
+                            f(ok);
+                        }
+                    };
+
+                ITransmissionPtr transmission = transmission_;
+                if (NULL != transmission && transmission->Write(packet.get(), packet_length, complete)) {
+                    return true;
+                }
+
+                complete(false);
+                Dispose();
+                return false;
+            }
+
+            bool VirtualEthernetMux::Credit(int connection_id, int credit) noexcept {
+                if (IsDisposed()) {
+                    return false;
+                }
+
+                auto self = shared_from_this();
+                return Executors::Post(GetContext(), strand_,
+                    [self, this, connection_id, credit]() noexcept {
+                        ITransmissionPtr transmission = transmission_;
+                        if (!IsDisposed() && NULL != transmission) {
+                            DoMuxAck(transmission, connection_id, credit, nullof<YieldContext>());
+                        }
+                    });
+            }
+
+            void VirtualEthernetMux::Close(const VirtualEthernetMuxStreamPtr& stream, bool fin) noexcept {
+                for (;;) {
+                    SynchronizedObjectScope scope(syncobj_);
+                    if (auto tail = streams_.find(stream->id_); tail != streams_.end() && tail->second == stream) {
+                        streams_.erase(tail);
+                    }
+                    break;
+                }
+
+                auto self = shared_from_this();
+                Executors::Post(GetContext(), strand_,
+                    [self, this, stream, fin]() noexcept {
+                        ppp::list<VirtualEthernetMuxStream::PendingWrite> pending = std::move(stream->pending_);
+                        stream->pending_.clear();
+
+                        for (VirtualEthernetMuxStream::PendingWrite& message : pending) {
+                            if (message.cb) {
+                                message.cb(false);
+                            }
+                        }
+
+                        ITransmissionPtr transmission = transmission_;
+                        if (fin && !IsDisposed() && NULL != transmission) {
+                            DoDisconnect(transmission, stream->id_, nullof<YieldContext>());
+                        }
+                    });
+            }
+
+            VirtualEthernetMuxStream::VirtualEthernetMuxStream(const std::shared_ptr<VirtualEthernetMux>& mux, const ContextPtr& context, const StrandPtr& strand, int connection_id) noexcept
+                : ITransmission(context, strand, mux->GetConfiguration())
+                , closed_(false)
+                , fin_(false)
+                , id_(connection_id)
+                , window_(mux->GetConfiguration()->tcp.mux.window)
+                , received_(0)
+                , consumed_(0)
+                , reader_(NULL)
+                , mux_(mux)
+                , credit_(mux->window_) {
+
+                std::shared_ptr<ITransmission> transmission = mux->GetTransmission();
+                if (NULL != transmission) {
+                    Statistics = transmission->Statistics;
+                }
+            }
+
+            boost::asio::ip::tcp::endpoint VirtualEthernetMuxStream::GetRemoteEndPoint() noexcept {
+                std::shared_ptr<ITransmission> transmission = mux_->GetTransmission();
+                if (NULL == transmission) {
+                    return boost::asio::ip::tcp::endpoint();
+                }
+
+                return transmission->GetRemoteEndPoint();
+            }
+
+            bool VirtualEthernetMuxStream::IsClosed() noexcept {
+                SynchronizedObjectScope scope(syncobj_);
+                return closed_;
+            }
+
+            void VirtualEthernetMuxStream::Dispose() noexcept {
+                bool fin = false;
+                bool closing = false;
+                YieldContext* reader = NULL;
+                for (;;) {
+                    SynchronizedObjectScope scope(syncobj_);
+                    if (!closed_) {
+                        closed_ = true;
+                        closing = true;
+                        fin = !fin_;
+
+                        reader = reader_;
+                        reader_ = NULL;
+                        packets_.clear();
+                    }
+                    break;
+                }
+
+                if (closing) {
+                    if (NULL != reader) {
+                        reader->R();
+                    }
+
+                    auto self = std::static_pointer_cast<VirtualEthernetMuxStream>(GetReference());
+                    mux_->Close(self, fin);
+                }
+
+                ITransmission::Dispose();
+            }
+
+            void VirtualEthernetMuxStream::Fin() noexcept {
+                YieldContext* reader = NULL;
+                for (;;) {
+                    SynchronizedObjectScope scope(syncobj_);
+                    fin_ = true;
+
+                    reader = reader_;
+                    reader_ = NULL;
+                    break;
+                }
+
+                if (NULL != reader) {
+                    reader->R();
+                }
+            }
+
+            bool VirtualEthernetMuxStream::Input(Byte* packet, int packet_length) noexcept {
+                std::shared_ptr<Byte> chunk = Copy(BufferAllocator, packet, packet_length);
+                if (NULL == chunk) {
+                    return false;
+                }
+
+                YieldContext* reader = NULL;
+                for (;;) {
+                    SynchronizedObjectScope scope(syncobj_);
+                    if (closed_ || fin_) {
+                        return true;
+                    }
+
+                    // The sender ignored the window it was granted.
+                    if (received_ + packet_length > window_ + MAX_SEGMENT_SIZE) {
+                        return false;
+                    }
+
+                    received_ += packet_length;
+                    packets_.emplace_back(chunk, packet_length);
+
+                    reader = reader_;
+                    reader_ = NULL;
+                    break;
+                }
+
+                if (NULL != reader) {
+                    reader->R();
+                }
+
+                return true;
+            }
+
+            std::shared_ptr<Byte> VirtualEthernetMuxStream::Read(YieldContext& y, int& outlen) noexcept {
+                outlen = 0;
+                if (!y) {
+                    return NULL;
+                }
+
+                for (;;) {
+                    std::shared_ptr<Byte> packet;
+                    int credit = 0;
+                    for (;;) {
+                        SynchronizedObjectScope scope(syncobj_);
+                        if (!packets_.empty()) {
+                            Packet& front = packets_.front();
+                            packet = std::move(front.first);
+                            outlen = front.second;
+                            packets_.pop_front();
+
+                            // Hand the drained bytes back to the sender in batches of half a window.
+                            received_ -= outlen;
+                            consumed_ += outlen;
+                            if (consumed_ >= (window_ >> 1) && !fin_ && !closed_) {
+                                credit = consumed_;
+                                consumed_ = 0;
+                            }
+                        }
+                        elif(closed_ || fin_) {
+                            return NULL;
+                        }
+                        else {
+                            reader_ = y.GetPtr();
+                        }
+                        break;
+                    }
+
+                    if (NULL != packet) {
+                        if (credit > 0) {
+                            mux_->Credit(id_, credit);
+                        }
+
+                        return packet;
+                    }
+
+                    // Whoever fills the queue or closes the stream takes reader_ and resumes this coroutine once.
+                    if (!y.Suspend()) {
+                        SynchronizedObjectScope scope(syncobj_);
+                        reader_ = NULL;
+                        return NULL;
+                    }
+                }
+            }
+
+            bool VirtualEthernetMuxStream::Write(YieldContext& y, const void* packet, int packet_length) noexcept {
+                YieldContext* co = y.GetPtr();
+                if (NULL != co) {
+                    return DoWriteYield<AsynchronousWriteCallback>(*co, packet, packet_length,
+                        [this](const void* packet, int packet_length, const AsynchronousWriteCallback& cb) noexcept {
+                            return Write(packet, packet_length, cb);
+                        });
+                }
+
+                auto self = GetReference();
+                return Write(packet, packet_length,
+                    [self, this](bool ok) noexcept {
+                        if (!ok) {
+                            Dispose();
+                        }
+                    });
+            }
+
+            bool VirtualEthernetMuxStream::Write(const void* packet, int packet_length, const AsynchronousWriteCallback& cb) noexcept {
+                if (NULL == packet || packet_length < 1) {
+                    return false;
+                }
+
+                if (NULL == cb || IsClosed()) {
+                    return false;
+                }
+
+                auto self = std::static_pointer_cast<VirtualEthernetMuxStream>(GetReference());
+                for (int offset = 0; offset < packet_length;) {
+                    /* ACTION(1BYTE) CONNECT_ID(3BYTE) PAYLOAD */
+                    int payload_length = std::min<int>(packet_length - offset, MAX_SEGMENT_SIZE);
+                    int frame_length = payload_length + 4;
+
+                    std::shared_ptr<Byte> frame = BufferswapAllocator::MakeByteArray(BufferAllocator, frame_length);
+                    if (NULL == frame) {
+                        return false;
+                    }
+
+                    Byte* memory = frame.get();
+                    memory[0] = VirtualEthernetLinklayer::PacketAction_PSH;
+                    memory[1] = (Byte)(id_ >> 16);
+                    memory[2] = (Byte)(id_ >> 8);
+                    memory[3] = (Byte)(id_);
+                    memcpy(memory + 4, (Byte*)packet + offset, payload_length);
+
+                    offset += payload_length;
+                    if (!mux_->Push(self, frame, frame_length, payload_length, offset < packet_length ? AsynchronousWriteCallback() : cb)) {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+        }
+    }
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <ppp/stdafx.h>
+#include <ppp/threading/Executors.h>
+#include <ppp/coroutines/YieldContext.h>
+#include <ppp/transmissions/ITransmission.h>
+#include <ppp/app/protocol/VirtualEthernetLinklayer.h>
+
+namespace ppp {
+    namespace app {
+        namespace protocol {
+            class VirtualEthernetMuxStream;
+
+            // Multiplexes tcp flows as streams over one handshaked transmission, a stream is opened by the first PSH of a new id,
+            // Closed by FIN and may only have its peer's window in flight, the receiver grants more with MUXACK as it drains.
+            class VirtualEthernetMux : public VirtualEthernetLinklayer {
+                friend class                                                VirtualEthernetMuxStream;
+
+            public:
+                typedef ppp::threading::Executors::StrandPtr                StrandPtr;
+                typedef std::shared_ptr<VirtualEthernetMuxStream>           VirtualEthernetMuxStreamPtr;
+                typedef ppp::unordered_map<int, VirtualEthernetMuxStreamPtr> VirtualEthernetMuxStreamTable;
+                typedef ITransmission::AsynchronousWriteCallback            AsynchronousWriteCallback;
+                typedef std::mutex                                          SynchronizedObject;
+                typedef std::lock_guard<SynchronizedObject>                 SynchronizedObjectScope;
+
+            public:
+                static constexpr int                                        MAX_STREAM_ID = 0xFFFFFF;
+
+            public:
+                VirtualEthernetMux(const ITransmissionPtr& transmission, const Int128& id, bool server) noexcept;
+                virtual ~VirtualEthernetMux() noexcept;
+
+            public:
+                ITransmissionPtr                                            GetTransmission() noexcept { return transmission_; }
+                StrandPtr                                                   GetStrand()       noexcept { return strand_; }
+                bool                                                        IsAvailable() noexcept;
+                int                                                         GetStreamCount() noexcept;
+                static bool                                                 IsMux(const void* packet, int packet_length) noexcept;
+
+            public:
+                // Client side, advertises the local window and waits no longer than a connect for the server's, supported only turns false
+                // When the server answered with something other than MUX. A link that broke or timed out says nothing about the server.
+                bool                                                        Handshake(YieldContext& y, bool& supported) noexcept;
+                // Server side, answers the MUX frame the client opened the link with.
+                bool                                                        Accept(Byte* packet, int packet_length, YieldContext& y) noexcept;
+                // Reads the link until it breaks, must run on the transmission's context and strand.
+                bool                                                        Loopback(YieldContext& y) noexcept;
+                VirtualEthernetMuxStreamPtr                                 Open(const ContextPtr& context, const StrandPtr& strand) noexcept;
+                virtual void                                                Dispose() noexcept;
+
+            protected:
+                virtual bool                                                OnAccept(const VirtualEthernetMuxStreamPtr& stream) noexcept { return false; }
+                virtual bool                                                OnPush(const ITransmissionPtr& transmission, int connection_id, Byte* packet, int packet_length, YieldContext& y) noexcept override;
+                virtual bool                                                OnDisconnect(const ITransmissionPtr& transmission, int connection_id, YieldContext& y) noexcept override;
+                virtual bool                                                OnMux(const ITransmissionPtr& transmission, int window, YieldContext& y) noexcept override;
+                virtual bool                                                OnMuxAck(const ITransmissionPtr& transmission, int connection_id, int credit, YieldContext& y) noexcept override;
+
+            private:
+                void                                                        Finalize() noexcept;
+                bool                                                        Push(const VirtualEthernetMuxStreamPtr& stream, const std::shared_ptr<Byte>& packet, int packet_length, int payload_length, const AsynchronousWriteCallback& cb) noexcept;
+                bool                                                        Send(const VirtualEthernetMuxStreamPtr& stream, const std::shared_ptr<Byte>& packet, int packet_length, int payload_length, const AsynchronousWriteCallback& cb) noexcept;
+                void                                                        Flush(const VirtualEthernetMuxStreamPtr& stream) noexcept;
+                bool                                                        Credit(int connection_id, int credit) noexcept;
+                void                                                        Close(const VirtualEthernetMuxStreamPtr& stream, bool fin) noexcept;
+                VirtualEthernetMuxStreamPtr                                 NewStream(const ContextPtr& context, const StrandPtr& strand, int connection_id) noexcept;
+                bool                                                        IsDisposed() noexcept;
+                bool                                                        IsHandshaked() noexcept;
+
+            private:
+                SynchronizedObject                                          syncobj_;
+                struct {
+                    bool                                                    disposed_   : 1;
+                    bool                                                    handshaked_ : 7;
+                };
+                bool                                                        server_  = false;
+                int                                                         window_  = 0;
+                int                                                         last_id_ = 0;
+                StrandPtr                                                   strand_;
+                ITransmissionPtr                                            transmission_;
+                VirtualEthernetMuxStreamTable                               streams_;
+            };
+
+            // One flow riding a mux link, it reads and writes like the transmission a flow would otherwise open for itself.
+            class VirtualEthernetMuxStream : public ppp::transmissions::ITransmission {
+                friend class                                                VirtualEthernetMux;
+
+            public:
+                // Largest payload of one PSH frame, larger writes are cut into several frames.
+                static constexpr int                                        MAX_SEGMENT_SIZE = PPP_BUFFER_SIZE >> 1;
+
+            public:
+                VirtualEthernetMuxStream(const std::shared_ptr<VirtualEthernetMux>& mux, const ContextPtr& context, const StrandPtr& strand, int connection_id) noexcept;
+                virtual ~VirtualEthernetMuxStream() noexcept = default;
+
+            public:
+                int                                                         GetId()  noexcept { return id_; }
+                std::shared_ptr<VirtualEthernetMux>                         GetMux() noexcept { return mux_; }
+                virtual void                                                Dispose() noexcept override;
+                virtual bool                                                ShiftToScheduler() noexcept override { return false; }
+                virtual boost::asio::ip::tcp::endpoint                      GetRemoteEndPoint() noexcept override;
+
+            public:
+                virtual std::shared_ptr<Byte>                               Read(YieldContext& y, int& outlen) noexcept override;
+                virtual bool                                                Write(YieldContext& y, const void* packet, int packet_length) noexcept override;
+                virtual bool                                                Write(const void* packet, int packet_length, const AsynchronousWriteCallback& cb) noexcept override;
+
+            protected:
+                virtual std::shared_ptr<Byte>                               DoReadBytes(YieldContext& y, int length) noexcept override { return NULL; }
+                virtual bool                                                DoWriteBytes(std::shared_ptr<Byte> packet, int offset, int packet_length, const AsynchronousWriteBytesCallback& cb) noexcept override { return false; }
+
+            private:
+                bool                                                        IsClosed() noexcept;
+                bool                                                        Input(Byte* packet, int packet_length) noexcept;
+                void                                                        Fin() noexcept;
+
+            private:
+                typedef std::pair<std::shared_ptr<Byte>, int>               Packet;
+
+                struct PendingWrite {
+                    std::shared_ptr<Byte>                                   packet;
+                    int                                                     packet_length  = 0;
+                    int                                                     payload_length = 0;
+                    AsynchronousWriteCallback                               cb;
+                };
+
+            private:
+                SynchronizedObject                                          syncobj_;
+                struct {
+                    bool                                                    closed_ : 1;
+                    bool                                                    fin_    : 7;
+                };
+                int                                                         id_       = 0;
+                int                                                         window_   = 0;
+                int                                                         received_ = 0;
+                int                                                         consumed_ = 0;
+                YieldContext*                                               reader_   = NULL;
+                ppp::list<Packet>                                           packets_;
+                std::shared_ptr<VirtualEthernetMux>                         mux_;
+
+                // Owned by the link's executor.
+                int                                                         credit_   = 0;
+                ppp::list<PendingWrite>                                     pending_;
+            };
+        }
+    }
+}
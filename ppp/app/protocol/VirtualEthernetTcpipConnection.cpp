@@ -136,12 +136,36 @@ namespace ppp {
             }
 
             bool VirtualEthernetTcpipConnection::Accept(YieldContext& y, ITransmissionPtr& transmission, const VirtualEthernetLoggerPtr& logger) noexcept {
+                if (NULL == transmission) {
+                    return false;
+                }
+
+                if (disposed_) {
+                    return false;
+                }
+
+                Update();
+
+                int packet_size = -1;
+                std::shared_ptr<Byte> packet = transmission->Read(y, packet_size);
+                if (NULL == packet || packet_size < 1) {
+                    return false;
+                }
+
+                return Accept(y, transmission, packet.get(), packet_size, logger);
+            }
+
+            bool VirtualEthernetTcpipConnection::Accept(YieldContext& y, ITransmissionPtr& transmission, Byte* packet, int packet_size, const VirtualEthernetLoggerPtr& logger) noexcept {
                 typedef VirtualEthernetLinklayer::ERROR_CODES ERROR_CODES;
 
                 if (NULL == transmission) {
                     return false;
                 }
 
+                if (NULL == packet || packet_size < 1) {
+                    return false;
+                }
+
                 if (disposed_) {
                     return false;
                 }
@@ -156,18 +180,12 @@ namespace ppp {
 
                 Update();
 
-                int packet_size = -1;
-                std::shared_ptr<Byte> packet = transmission->Read(y, packet_size);
-                if (NULL == packet || packet_size < 1) {
-                    return false;
-                }
-
                 auto connector = make_shared_object<STATIC_VIRTUAL_ETHERNET_TCPIP_CONNECTOR_NEST>(this, configuration_, context_, id_);
                 if (NULL == connector) {
                     return false;
                 }
 
-                if (!connector->PacketInput(transmission, packet.get(), packet_size, y)) {
+                if (!connector->PacketInput(transmission, packet, packet_size, y)) {
                     return false;
                 }
 
@@ -61,6 +61,7 @@ namespace ppp {
             public:
                 virtual bool                                                    Connect(YieldContext& y, ITransmissionPtr& transmission, const ppp::string& host, int port) noexcept;
                 virtual bool                                                    Accept(YieldContext& y, ITransmissionPtr& transmission, const VirtualEthernetLoggerPtr& logger) noexcept;
+                virtual bool                                                    Accept(YieldContext& y, ITransmissionPtr& transmission, Byte* packet, int packet_length, const VirtualEthernetLoggerPtr& logger) noexcept;
                 virtual bool                                                    Run(YieldContext& y) noexcept;
                 virtual void                                                    Dispose() noexcept;
                 virtual std::shared_ptr<ppp::net::Firewall>                     GetFirewall() noexcept { return NULL; }
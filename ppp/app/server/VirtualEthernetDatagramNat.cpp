@@ -0,0 +1,281 @@
+#include <ppp/app/server/VirtualEthernetDatagramNat.h>
+#include <ppp/app/server/VirtualEthernetDatagramPort.h>
+#include <ppp/app/server/VirtualEthernetSwitcher.h>
+#include <ppp/app/protocol/VirtualEthernetPacket.h>
+#include <ppp/net/Socket.h>
+#include <ppp/net/Ipep.h>
+#include <ppp/net/IPEndPoint.h>
+
+typedef ppp::net::IPEndPoint                            IPEndPoint;
+typedef ppp::net::Ipep                                  Ipep;
+typedef ppp::app::protocol::VirtualEthernetPacket       VirtualEthernetPacket;
+
+namespace ppp {
+    namespace app {
+        namespace server {
+            VirtualEthernetDatagramNat::VirtualEthernetDatagramNat(const VirtualEthernetSwitcherPtr& switcher, const ContextPtr& context, int sockets) noexcept
+                : disposed_(false)
+                , switcher_(switcher)
+                , context_(context)
+                , configuration_(switcher->GetConfiguration())
+                , mappings_(0) {
+                for (int i = 0; i < sockets; i++) {
+                    SocketPtr socket = make_shared_object<Socket>(*context);
+                    if (NULL == socket) {
+                        break;
+                    }
+
+                    socket->Buffer = make_shared_alloc<Byte>(PPP_BUFFER_SIZE);
+                    if (NULL == socket->Buffer) {
+                        break;
+                    }
+
+                    socket->Batch = make_shared_object<ppp::net::asio::DatagramBatch>(socket->Handle, configuration_->udp.batch, socket->Buffer);
+                    if (NULL == socket->Batch) {
+                        break;
+                    }
+
+                    sockets_.emplace_back(socket);
+                }
+            }
+
+            VirtualEthernetDatagramNat::~VirtualEthernetDatagramNat() noexcept {
+                Finalize();
+            }
+
+            void VirtualEthernetDatagramNat::Finalize() noexcept {
+                ppp::vector<SocketPtr> sockets;
+                for (;;) {
+                    SynchronizedObjectScope scope(syncobj_);
+                    disposed_ = true;
+
+                    sockets = std::move(sockets_);
+                    sockets_.clear();
+
+                    ports_.clear();
+                    mappings_ = 0;
+                    break;
+                }
+
+                for (SocketPtr& socket : sockets) {
+                    ppp::net::Socket::Closesocket(socket->Handle);
+                    socket->Mappings.clear();
+                }
+            }
+
+            void VirtualEthernetDatagramNat::Dispose() noexcept {
+                auto self = shared_from_this();
+                boost::asio::post(*context_,
+                    [self, this]() noexcept {
+                        Finalize();
+                    });
+            }
+
+            bool VirtualEthernetDatagramNat::Open() noexcept {
+                if (disposed_ || sockets_.empty()) {
+                    return false;
+                }
+
+                // Dual stack when the server does not pin an interface address, so one pool reaches IPv4 and IPv6 destinations alike.
+                boost::asio::ip::address address = switcher_->GetInterfaceIP();
+                boost::asio::ip::udp::endpoint anyEP(boost::asio::ip::address_v6::any(), IPEndPoint::MinPort);
+
+                for (int i = 0, count = (int)sockets_.size(); i < count; i++) {
+                    SocketPtr& socket = sockets_[i];
+                    if (!VirtualEthernetPacket::OpenDatagramSocket(socket->Handle, address, IPEndPoint::MinPort, anyEP)) {
+                        return false;
+                    }
+
+                    boost::system::error_code ec;
+                    boost::asio::ip::udp::endpoint localEP = socket->Handle.local_endpoint(ec);
+                    if (ec) {
+                        return false;
+                    }
+
+                    socket->In = localEP.address().is_v4();
+
+                    int handle = socket->Handle.native_handle();
+                    ppp::net::Socket::AdjustDefaultSocketOptional(handle, socket->In);
+                    ppp::net::Socket::SetTypeOfService(handle);
+                    ppp::net::Socket::SetSignalPipeline(handle, false);
+                    ppp::net::Socket::ReuseSocketAddress(handle, true);
+
+                    if (!Loopback(i)) {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            UInt64 VirtualEthernetDatagramNat::GetTimeout(const boost::asio::ip::udp::endpoint& remoteEP) noexcept {
+                UInt64 now = ppp::threading::Executors::GetTickCount();
+                if (remoteEP.port() == PPP_DNS_SYS_PORT) {
+                    return now + (UInt64)configuration_->udp.dns.timeout * 1000;
+                }
+                else {
+                    return now + (UInt64)configuration_->udp.inactive.timeout * 1000;
+                }
+            }
+
+            bool VirtualEthernetDatagramNat::SendTo(const VirtualEthernetDatagramPortPtr& port, const void* packet, int packet_length, const boost::asio::ip::udp::endpoint& destinationEP) noexcept {
+                if (NULL == port || NULL == packet || packet_length < 1) {
+                    return false;
+                }
+
+                boost::asio::ip::udp::endpoint remoteEP = Ipep::V6ToV4(destinationEP);
+                SocketPtr socket;
+                for (;;) {
+                    SynchronizedObjectScope scope(syncobj_);
+                    if (disposed_) {
+                        return false;
+                    }
+
+                    int count = (int)sockets_.size();
+                    if (count < 1) {
+                        return false;
+                    }
+
+                    // Start at a socket derived from the flow, so a flow keeps the same public port for all of its destinations
+                    // Unless that port already talks to the destination on behalf of another flow.
+                    int first = (int)(std::hash<void*>()(port.get()) % count);
+                    for (int i = 0; i < count; i++) {
+                        int index = (first + i) % count;
+                        SocketPtr& candidate = sockets_[index];
+
+                        auto tail = candidate->Mappings.find(remoteEP);
+                        if (tail == candidate->Mappings.end()) {
+                            candidate->Mappings.emplace(remoteEP, Mapping{ port, GetTimeout(remoteEP) });
+                            ports_[port.get()].emplace_back(index, remoteEP);
+                            mappings_++;
+                        }
+                        elif(tail->second.Port != port) {
+                            continue;
+                        }
+                        else {
+                            tail->second.Timeout = GetTimeout(remoteEP);
+                        }
+
+                        socket = candidate;
+                        break;
+                    }
+                    break;
+                }
+
+                if (NULL == socket) {
+                    return false;
+                }
+
+                if (socket->In) {
+                    return socket->Batch->SendTo(shared_from_this(), packet, packet_length, remoteEP);
+                }
+                else {
+                    return socket->Batch->SendTo(shared_from_this(), packet, packet_length, Ipep::V4ToV6(remoteEP));
+                }
+            }
+
+            void VirtualEthernetDatagramNat::Release(VirtualEthernetDatagramPort* port) noexcept {
+                SynchronizedObjectScope scope(syncobj_);
+                auto tail = ports_.find(port);
+                if (tail == ports_.end()) {
+                    return;
+                }
+
+                for (auto&& [index, remoteEP] : tail->second) {
+                    if (index < (int)sockets_.size()) {
+                        MappingTable& mappings = sockets_[index]->Mappings;
+                        auto mapping = mappings.find(remoteEP);
+                        if (mapping != mappings.end() && mapping->second.Port.get() == port) {
+                            mappings.erase(mapping);
+                            mappings_--;
+                        }
+                    }
+                }
+
+                ports_.erase(tail);
+            }
+
+            void VirtualEthernetDatagramNat::Update(UInt64 now) noexcept {
+                SynchronizedObjectScope scope(syncobj_);
+                for (int index = 0, count = (int)sockets_.size(); index < count; index++) {
+                    MappingTable& mappings = sockets_[index]->Mappings;
+                    for (auto tail = mappings.begin(); tail != mappings.end();) {
+                        if (now < tail->second.Timeout) {
+                            tail++;
+                            continue;
+                        }
+
+                        // The remote endpoint went quiet, free the pair for other flows. The flow itself ages on its own clock.
+                        auto port = ports_.find(tail->second.Port.get());
+                        if (port != ports_.end()) {
+                            auto& pairs = port->second;
+                            for (auto pair = pairs.begin(); pair != pairs.end(); pair++) {
+                                if (pair->first == index && pair->second == tail->first) {
+                                    pairs.erase(pair);
+                                    break;
+                                }
+                            }
+
+                            if (pairs.empty()) {
+                                ports_.erase(port);
+                            }
+                        }
+
+                        tail = mappings.erase(tail);
+                        mappings_--;
+                    }
+                }
+            }
+
+            int VirtualEthernetDatagramNat::GetMappingCount() noexcept {
+                SynchronizedObjectScope scope(syncobj_);
+                return mappings_;
+            }
+
+            bool VirtualEthernetDatagramNat::Loopback(int index) noexcept {
+                if (disposed_ || index >= (int)sockets_.size()) {
+                    return false;
+                }
+
+                SocketPtr socket = sockets_[index];
+                if (!socket->Handle.is_open()) {
+                    return false;
+                }
+
+                auto self = shared_from_this();
+                return socket->Batch->ReceiveFrom(
+                    [self, this, socket](Byte* packet, int packet_length, const boost::asio::ip::udp::endpoint& sourceEP) noexcept {
+                        if (packet_length < 1) {
+                            return true;
+                        }
+
+                        boost::asio::ip::udp::endpoint remoteEP = Ipep::V6ToV4(sourceEP);
+                        VirtualEthernetDatagramPortPtr port;
+                        for (;;) {
+                            SynchronizedObjectScope scope(syncobj_);
+                            auto tail = socket->Mappings.find(remoteEP);
+                            if (tail != socket->Mappings.end()) {
+                                port = tail->second.Port;
+                                tail->second.Timeout = GetTimeout(remoteEP);
+                            }
+                            break;
+                        }
+
+                        // Datagrams from endpoints no flow has sent to are dropped, which is what makes this mode port restricted.
+                        if (NULL != port) {
+                            if (!port->OnMessage(packet, packet_length, remoteEP)) {
+                                port->Dispose();
+                            }
+                        }
+
+                        return true;
+                    },
+                    [self, this, socket, index](const boost::system::error_code& ec) noexcept {
+                        if (ec != boost::asio::error::operation_aborted) {
+                            Loopback(index);
+                        }
+                    });
+            }
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <ppp/net/Ipep.h>
+#include <ppp/net/asio/DatagramBatch.h>
+#include <ppp/configurations/AppConfiguration.h>
+#include <ppp/threading/Executors.h>
+
+namespace ppp {
+    namespace app {
+        namespace server {
+            class VirtualEthernetSwitcher;
+            class VirtualEthernetDatagramPort;
+
+            // Port multiplexed NAT for the UDP flows of one executor: a handful of sockets is shared by every datagram port of the executor,
+            // A flow is told apart by the (local socket, remote endpoint) pair it talks to. Each pair is owned by exactly one flow at a time,
+            // When every socket already carries the remote endpoint for another flow, the caller falls back to a dedicated socket.
+            class VirtualEthernetDatagramNat final : public std::enable_shared_from_this<VirtualEthernetDatagramNat> {
+            public:
+                typedef ppp::configurations::AppConfiguration           AppConfiguration;
+                typedef std::shared_ptr<AppConfiguration>               AppConfigurationPtr;
+                typedef std::shared_ptr<boost::asio::io_context>        ContextPtr;
+                typedef std::shared_ptr<VirtualEthernetSwitcher>        VirtualEthernetSwitcherPtr;
+                typedef std::shared_ptr<VirtualEthernetDatagramPort>    VirtualEthernetDatagramPortPtr;
+                typedef std::mutex                                      SynchronizedObject;
+                typedef std::lock_guard<SynchronizedObject>             SynchronizedObjectScope;
+
+            public:
+                VirtualEthernetDatagramNat(const VirtualEthernetSwitcherPtr& switcher, const ContextPtr& context, int sockets) noexcept;
+                ~VirtualEthernetDatagramNat() noexcept;
+
+            public:
+                ContextPtr                                              GetContext() noexcept { return context_; }
+                bool                                                    Open() noexcept;
+                void                                                    Dispose() noexcept;
+                void                                                    Update(UInt64 now) noexcept;
+                int                                                     GetMappingCount() noexcept;
+
+            public:
+                // False means no socket of the pool can carry the destination for this port (or the send itself failed).
+                bool                                                    SendTo(const VirtualEthernetDatagramPortPtr& port, const void* packet, int packet_length, const boost::asio::ip::udp::endpoint& destinationEP) noexcept;
+                void                                                    Release(VirtualEthernetDatagramPort* port) noexcept;
+
+            private:
+                typedef struct {
+                    VirtualEthernetDatagramPortPtr                      Port;
+                    UInt64                                              Timeout;
+                }                                                       Mapping;
+                typedef ppp::unordered_map<boost::asio::ip::udp::endpoint, Mapping> MappingTable;
+                class Socket final {
+                public:
+                    Socket(boost::asio::io_context& context) noexcept : Handle(context) {}
+
+                public:
+                    boost::asio::ip::udp::socket                        Handle;
+                    std::shared_ptr<Byte>                               Buffer;
+                    std::shared_ptr<ppp::net::asio::DatagramBatch>      Batch;
+                    bool                                                In = false;
+                    MappingTable                                        Mappings;
+                };
+                typedef std::shared_ptr<Socket>                         SocketPtr;
+                typedef ppp::vector<std::pair<int, boost::asio::ip::udp::endpoint>> PortMappings;
+                typedef ppp::unordered_map<VirtualEthernetDatagramPort*, PortMappings> PortTable;
+
+            private:
+                void                                                    Finalize() noexcept;
+                bool                                                    Loopback(int index) noexcept;
+                UInt64                                                  GetTimeout(const boost::asio::ip::udp::endpoint& remoteEP) noexcept;
+
+            private:
+                bool                                                    disposed_ = false;
+                SynchronizedObject                                      syncobj_;
+                VirtualEthernetSwitcherPtr                              switcher_;
+                ContextPtr                                              context_;
+                AppConfigurationPtr                                     configuration_;
+                ppp::vector<SocketPtr>                                  sockets_;
+                PortTable                                               ports_;
+                int                                                     mappings_ = 0;
+            };
+        }
+    }
+}
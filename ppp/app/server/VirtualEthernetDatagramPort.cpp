@@ -1,5 +1,6 @@
 #include <ppp/app/server/VirtualEthernetDatagramPortStatic.h>
 #include <ppp/app/server/VirtualEthernetDatagramPort.h>
+#include <ppp/app/server/VirtualEthernetDatagramNat.h>
 #include <ppp/app/server/VirtualEthernetExchanger.h>
 #include <ppp/app/server/VirtualEthernetSwitcher.h>
 #include <ppp/app/server/VirtualEthernetNamespaceCache.h>
@@ -34,6 +35,7 @@ namespace ppp {
                 , configuration_(exchanger->GetConfiguration())
                 , sourceEP_(sourceEP) {
                 buffer_ = Executors::GetCachedBuffer(context_);
+                batch_ = make_shared_object<ppp::net::asio::DatagramBatch>(socket_, configuration_->udp.batch, buffer_);
                 Update();
             }
 
@@ -58,6 +60,13 @@ namespace ppp {
                 finalize_ = true;
                 Socket::Closesocket(socket_);
 
+                std::shared_ptr<VirtualEthernetDatagramNat> nat = std::move(nat_);
+                nat_.reset();
+
+                if (NULL != nat) {
+                    nat->Release(this);
+                }
+
                 exchanger_->ReleaseDatagramPort(sourceEP_);
             }
 
@@ -83,7 +92,7 @@ namespace ppp {
                 std::shared_ptr<VirtualEthernetSwitcher> switcher = exchanger_->GetSwitcher();
                 boost::asio::ip::address address = switcher->GetInterfaceIP();
 
-                bool success = VirtualEthernetPacket::OpenDatagramSocket(socket_, address, IPEndPoint::MinPort, sourceEP_) && Loopback();
+                bool success = NULL != batch_ && VirtualEthernetPacket::OpenDatagramSocket(socket_, address, IPEndPoint::MinPort, sourceEP_) && Loopback();
                 if (success) {
                     boost::system::error_code ec;
                     localEP_ = socket_.local_endpoint(ec);
@@ -104,6 +113,36 @@ namespace ppp {
                 return success;
             }
 
+            bool VirtualEthernetDatagramPort::Open(const std::shared_ptr<VirtualEthernetDatagramNat>& nat) noexcept {
+                if (disposed_ || NULL == nat) {
+                    return false;
+                }
+
+                nat_ = nat;
+                return true;
+            }
+
+            bool VirtualEthernetDatagramPort::OnMessage(const void* packet, int packet_length, const boost::asio::ip::udp::endpoint& remoteEP) noexcept {
+                if (remoteEP.port() == PPP_DNS_SYS_PORT) {
+                    NamespaceQuery(exchanger_->GetSwitcher(), packet, packet_length);
+                }
+
+                std::shared_ptr<ITransmission> transmission = transmission_;
+                if (NULL == transmission) {
+                    return false;
+                }
+
+                if (exchanger_->DoSendTo(transmission, sourceEP_, Ipep::V6ToV4(remoteEP), (Byte*)packet, packet_length, nullof<YieldContext>())) {
+                    Update();
+                    return true;
+                }
+                else {
+                    transmission_.reset();
+                    transmission->Dispose();
+                    return false;
+                }
+            }
+
             bool VirtualEthernetDatagramPort::Loopback() noexcept {
                 if (disposed_) {
                     return false;
@@ -115,47 +154,23 @@ namespace ppp {
                 }
 
                 auto self = shared_from_this();
-                socket_.async_receive_from(boost::asio::buffer(buffer_.get(), PPP_BUFFER_SIZE), remoteEP_,
-                    [self, this](const boost::system::error_code& ec, std::size_t sz) noexcept {
-                        bool disposing = true;
-                        while (ec == boost::system::errc::success) {
-                            int bytes_transferred = static_cast<int>(sz);
-                            if (bytes_transferred < 1) {
-                                disposing = false;
-                                break;
-                            }
-
-                            int remotePort = remoteEP_.port();
-                            if (remotePort == PPP_DNS_SYS_PORT) {
-                                NamespaceQuery(exchanger_->GetSwitcher(), buffer_.get(), bytes_transferred);
-                            }
-
-                            std::shared_ptr<ITransmission> transmission = transmission_;
-                            if (NULL == transmission) {
-                                break;
-                            }
-
-                            boost::asio::ip::udp::endpoint remoteEP = Ipep::V6ToV4(remoteEP_);
-                            if (exchanger_->DoSendTo(transmission, sourceEP_, remoteEP, buffer_.get(), bytes_transferred, nullof<YieldContext>())) {
-                                Update();
-                                disposing = false;
-                            }
-                            else {
-                                transmission_.reset();
-                                transmission->Dispose();
-                            }
-
-                            break;
+                return batch_->ReceiveFrom(
+                    [self, this](Byte* packet, int packet_length, const boost::asio::ip::udp::endpoint& remoteEP) noexcept {
+                        if (packet_length < 1 || OnMessage(packet, packet_length, remoteEP)) {
+                            return true;
                         }
 
-                        if (disposing) {
+                        Dispose();
+                        return false;
+                    },
+                    [self, this](const boost::system::error_code& ec) noexcept {
+                        if (ec) {
                             Dispose();
                         }
                         else {
                             Loopback();
                         }
                     });
-                return true;
             }
 
             bool VirtualEthernetDatagramPort::NamespaceQuery(
@@ -212,27 +227,35 @@ namespace ppp {
                         if (NULL != cache) {
                             std::shared_ptr<Byte> response;
                             int response_length;
+                            bool refresh;
+
+                            uint16_t trans_id = ((dns_hdr*)packet)->usTransID;
+                            boost::asio::ip::udp::endpoint remoteEP = Ipep::V6ToV4(destinationEP);
+                            std::shared_ptr<boost::asio::io_context> context = exchanger->GetContext();
 
                             ppp::string queries_key = VirtualEthernetNamespaceCache::QueriesKey(queries_type, queries_clazz, domain);
-                            if (cache->Get(queries_key, response, response_length, ((dns_hdr*)packet)->usTransID)) {
-                                std::shared_ptr<ITransmission> transmission = exchanger->GetTransmission();
-                                if (NULL != transmission) {
-                                    boost::asio::ip::udp::endpoint remoteEP = Ipep::V6ToV4(destinationEP);
-                                    if (static_transit) {
-                                        if (VirtualEthernetDatagramPortStatic::Output(switcher.get(), exchanger, response.get(), response_length, sourceEP, remoteEP)) {
-                                            return 1;
-                                        }
-                                        else {
-                                            return -1;
-                                        }
-                                    }
-                                    elif(exchanger->DoSendTo(transmission, sourceEP, remoteEP, response.get(), response_length, nullof<YieldContext>())) {
-                                        return 1;
-                                    }
-                                    else {
-                                        transmission->Dispose();
-                                        return -1;
-                                    }
+                            if (cache->Get(queries_key, response, response_length, trans_id, refresh)) {
+                                if (refresh) {
+                                    NamespaceRefresh(switcher, context, queries_key, packet, packet_length, remoteEP);
+                                }
+
+                                return NamespaceOutput(switcher, exchanger, sourceEP, remoteEP, response.get(), response_length, static_transit) ? 1 : -1;
+                            }
+
+                            // The same question is already upstream for another client, answer this one from its response once it lands.
+                            std::shared_ptr<ppp::app::protocol::VirtualEthernetLinklayer> reference = exchanger->GetReference();
+                            if (NULL != context) {
+                                bool waiting = cache->Wait(queries_key, trans_id, 
+                                    [switcher, reference, context, exchanger, sourceEP, remoteEP, static_transit](const std::shared_ptr<Byte>& response, int response_length) noexcept {
+                                        boost::asio::post(*context, 
+                                            [switcher, reference, exchanger, sourceEP, remoteEP, static_transit, response, response_length]() noexcept {
+                                                if (!exchanger->IsDisposed()) {
+                                                    NamespaceOutput(switcher, exchanger, sourceEP, remoteEP, response.get(), response_length, static_transit);
+                                                }
+                                            });
+                                    });
+                                if (waiting) {
+                                    return 1;
                                 }
                             }
                         }
@@ -242,17 +265,62 @@ namespace ppp {
                 return 0;
             }
 
-            bool VirtualEthernetDatagramPort::SendTo(const void* packet, int packet_length, const boost::asio::ip::udp::endpoint& destinationEP) noexcept {
-                if (NULL == packet || packet_length < 1) {
+            bool VirtualEthernetDatagramPort::NamespaceRefresh(
+                const std::shared_ptr<VirtualEthernetSwitcher>&     switcher,
+                const std::shared_ptr<boost::asio::io_context>&     context,
+                const ppp::string&                                  queries_key,
+                const void*                                         packet,
+                int                                                 packet_length,
+                const boost::asio::ip::udp::endpoint&               remoteEP) noexcept {
+
+                auto cache = switcher->GetNamespaceCache();
+                if (NULL == cache) {
                     return false;
                 }
 
-                if (disposed_) {
+                boost::asio::ip::udp::endpoint serverEP = remoteEP;
+                if (auto configuration = switcher->GetConfiguration(); NULL != configuration && configuration->udp.dns.redirect.size() > 0) {
+                    boost::asio::ip::address dnsserverIP = switcher->GetDnsserverEndPoint().address();
+                    if (!dnsserverIP.is_unspecified()) {
+                        serverEP = boost::asio::ip::udp::endpoint(dnsserverIP, PPP_DNS_SYS_PORT);
+                    }
+                }
+
+                return cache->Refresh(context, queries_key, packet, packet_length, serverEP);
+            }
+
+            bool VirtualEthernetDatagramPort::NamespaceOutput(
+                const std::shared_ptr<VirtualEthernetSwitcher>&     switcher,
+                VirtualEthernetExchanger*                           exchanger, 
+                const boost::asio::ip::udp::endpoint&               sourceEP,
+                const boost::asio::ip::udp::endpoint&               remoteEP,
+                Byte*                                               response,
+                int                                                 response_length,
+                bool                                                static_transit) noexcept {
+
+                std::shared_ptr<ITransmission> transmission = exchanger->GetTransmission();
+                if (NULL == transmission) {
                     return false;
                 }
 
-                bool opened = socket_.is_open();
-                if (!opened) {
+                if (static_transit) {
+                    return VirtualEthernetDatagramPortStatic::Output(switcher.get(), exchanger, response, response_length, sourceEP, remoteEP);
+                }
+                elif(exchanger->DoSendTo(transmission, sourceEP, remoteEP, response, response_length, nullof<YieldContext>())) {
+                    return true;
+                }
+                else {
+                    transmission->Dispose();
+                    return false;
+                }
+            }
+
+            bool VirtualEthernetDatagramPort::SendTo(const void* packet, int packet_length, const boost::asio::ip::udp::endpoint& destinationEP) noexcept {
+                if (NULL == packet || packet_length < 1) {
+                    return false;
+                }
+
+                if (disposed_) {
                     return false;
                 }
 
@@ -261,17 +329,37 @@ namespace ppp {
                     return false;
                 }
 
-                boost::system::error_code ec;
-                if (in_) {
-                    socket_.send_to(boost::asio::buffer(packet, packet_length), 
-                        Ipep::V6ToV4(destinationEP), boost::asio::socket_base::message_end_of_record, ec);
+                // The socket is decided once per flow: once it has a dedicated socket everything it sends leaves through that one, so the
+                // Mapping STUN reported is the one every peer sees. Only flows that never needed one go out through the shared pool.
+                bool sent = false;
+                bool opened = socket_.is_open();
+                std::shared_ptr<VirtualEthernetDatagramNat> nat = nat_;
+                if (!opened && NULL != nat && !exchanger_->GetSwitcher()->IsFullConePort(destinationPort)) {
+                    sent = nat->SendTo(shared_from_this(), packet, packet_length, destinationEP);
                 }
-                else {
-                    socket_.send_to(boost::asio::buffer(packet, packet_length), 
-                        Ipep::V4ToV6(destinationEP), boost::asio::socket_base::message_end_of_record, ec);
+
+                if (!sent) {
+                    // A full cone destination, or every shared socket already talks to this destination for another flow,
+                    // The flow moves to a socket of its own for good.
+                    if (!opened) {
+                        if (NULL == nat || !Open()) {
+                            return false;
+                        }
+
+                        // Peers reached through the pool so far are answered from the dedicated socket from now on too.
+                        nat_.reset();
+                        nat->Release(this);
+                    }
+
+                    if (in_) {
+                        sent = batch_->SendTo(shared_from_this(), packet, packet_length, Ipep::V6ToV4(destinationEP));
+                    }
+                    else {
+                        sent = batch_->SendTo(shared_from_this(), packet, packet_length, Ipep::V4ToV6(destinationEP));
+                    }
                 }
 
-                if (ec) {
+                if (!sent) {
                     return false; // Failed to sendto the datagram packet. 
                 }
                 else {
@@ -3,15 +3,18 @@
 #include <ppp/configurations/AppConfiguration.h>
 #include <ppp/threading/Executors.h>
 #include <ppp/transmissions/ITransmission.h>
+#include <ppp/net/asio/DatagramBatch.h>
 
 namespace ppp {
     namespace app {
         namespace server {
             class VirtualEthernetSwitcher;
             class VirtualEthernetExchanger;
+            class VirtualEthernetDatagramNat;
 
             class VirtualEthernetDatagramPort : public std::enable_shared_from_this<VirtualEthernetDatagramPort> {
                 friend class                                            VirtualEthernetExchanger;
+                friend class                                            VirtualEthernetDatagramNat;
 
             public:
                 typedef ppp::configurations::AppConfiguration           AppConfiguration;
@@ -37,6 +40,8 @@ namespace ppp {
             public:
                 virtual void                                            Dispose() noexcept;
                 virtual bool                                            Open() noexcept;
+                // Egress through the shared sockets of the executor, a dedicated socket is only opened once the pool cannot carry a destination.
+                virtual bool                                            Open(const std::shared_ptr<VirtualEthernetDatagramNat>& nat) noexcept;
                 virtual bool                                            SendTo(const void* packet, int packet_length, const boost::asio::ip::udp::endpoint& destinationEP) noexcept;
                 bool                                                    IsPortAging(UInt64 now) noexcept { return disposed_ || now >= timeout_; }
 
@@ -56,10 +61,27 @@ namespace ppp {
                     uint16_t                                            queries_type,
                     uint16_t                                            queries_clazz,
                     bool                                                static_transit) noexcept;
+                // Sends a question the cache still answers to the redirect server if one is configured, otherwise where the client sent it.
+                static bool                                             NamespaceRefresh(
+                    const std::shared_ptr<VirtualEthernetSwitcher>&     switcher,
+                    const std::shared_ptr<boost::asio::io_context>&     context,
+                    const ppp::string&                                  queries_key,
+                    const void*                                         packet,
+                    int                                                 packet_length,
+                    const boost::asio::ip::udp::endpoint&               remoteEP) noexcept;
 
             private:
+                static bool                                             NamespaceOutput(
+                    const std::shared_ptr<VirtualEthernetSwitcher>&     switcher,
+                    VirtualEthernetExchanger*                           exchanger,
+                    const boost::asio::ip::udp::endpoint&               sourceEP,
+                    const boost::asio::ip::udp::endpoint&               remoteEP,
+                    Byte*                                               response,
+                    int                                                 response_length,
+                    bool                                                static_transit) noexcept;
                 void                                                    Finalize() noexcept;
                 bool                                                    Loopback() noexcept;
+                bool                                                    OnMessage(const void* packet, int packet_length, const boost::asio::ip::udp::endpoint& remoteEP) noexcept;
                 void                                                    Update() noexcept {
                     UInt64 now = Executors::GetTickCount();
                     if (onlydns_) {
@@ -86,6 +108,8 @@ namespace ppp {
                 ITransmissionPtr                                        transmission_;
                 AppConfigurationPtr                                     configuration_;
                 std::shared_ptr<Byte>                                   buffer_;
+                std::shared_ptr<ppp::net::asio::DatagramBatch>          batch_;
+                std::shared_ptr<VirtualEthernetDatagramNat>             nat_;
                 boost::asio::ip::udp::endpoint                          localEP_;
                 boost::asio::ip::udp::endpoint                          remoteEP_;
                 boost::asio::ip::udp::endpoint                          sourceEP_;
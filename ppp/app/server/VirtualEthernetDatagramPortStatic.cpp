@@ -33,6 +33,7 @@ namespace ppp {
                 , context_(context) {
                 switcher_ = exchanger->GetSwitcher();
                 buffer_ = Executors::GetCachedBuffer(context);
+                batch_ = make_shared_object<ppp::net::asio::DatagramBatch>(socket_, configuration_->udp.batch, buffer_);
                 Update();
             }
 
@@ -74,7 +75,7 @@ namespace ppp {
                 std::shared_ptr<VirtualEthernetSwitcher> switcher = exchanger_->GetSwitcher();
                 boost::asio::ip::address address = switcher->GetInterfaceIP();
 
-                bool success = VirtualEthernetPacket::OpenDatagramSocket(socket_, address, IPEndPoint::MinPort, sourceEP_) && Loopback();
+                bool success = NULL != batch_ && VirtualEthernetPacket::OpenDatagramSocket(socket_, address, IPEndPoint::MinPort, sourceEP_) && Loopback();
                 if (success) {
                     boost::system::error_code ec;
                     localEP_ = socket_.local_endpoint(ec);
@@ -106,27 +107,25 @@ namespace ppp {
                 }
 
                 auto self = shared_from_this();
-                socket_.async_receive_from(boost::asio::buffer(buffer_.get(), PPP_BUFFER_SIZE), sourceEP_,
-                    [self, this](const boost::system::error_code& ec, std::size_t sz) noexcept {
-                        if (ec == boost::system::errc::operation_canceled) {
-                            return false;
-                        }
-                        elif(ec == boost::system::errc::success) {
-                            int bytes_transferred = static_cast<int>(sz);
-                            if (bytes_transferred > 0) {
-                                boost::asio::ip::udp::endpoint remoteEP = Ipep::V6ToV4(sourceEP_);
-                                Output(buffer_.get(), bytes_transferred, remoteEP);
-
-                                int remotePort = remoteEP.port();
-                                if (remotePort == PPP_DNS_SYS_PORT) {
-                                    VirtualEthernetDatagramPort::NamespaceQuery(switcher_, buffer_.get(), bytes_transferred);
-                                }
+                return batch_->ReceiveFrom(
+                    [self, this](Byte* packet, int packet_length, const boost::asio::ip::udp::endpoint& sourceEP) noexcept {
+                        if (packet_length > 0) {
+                            boost::asio::ip::udp::endpoint remoteEP = Ipep::V6ToV4(sourceEP);
+                            Output(packet, packet_length, remoteEP);
+
+                            int remotePort = remoteEP.port();
+                            if (remotePort == PPP_DNS_SYS_PORT) {
+                                VirtualEthernetDatagramPort::NamespaceQuery(switcher_, packet, packet_length);
                             }
                         }
 
-                        return Loopback();
+                        return true;
+                    },
+                    [self, this](const boost::system::error_code& ec) noexcept {
+                        if (ec != boost::system::errc::operation_canceled) {
+                            Loopback();
+                        }
                     });
-                return true;
             }
 
             bool VirtualEthernetDatagramPortStatic::Output(
@@ -172,8 +171,8 @@ namespace ppp {
                     return false;
                 }
 
-                boost::asio::ip::udp::socket& socket = switcher->static_echo_socket_;
-                if (!socket.is_open()) {
+                VirtualEthernetSwitcher::StaticEchoShardPtr shard = switcher->GetStaticEchoShard();
+                if (NULL == shard || !shard->Socket.is_open()) {
                     return false;
                 }
 
@@ -203,11 +202,7 @@ namespace ppp {
                     return false;
                 }
 
-                boost::system::error_code ec;
-                socket.send_to(boost::asio::buffer(packet.get(), packet_length), 
-                    exchanger->static_echo_source_ep_, boost::asio::socket_base::message_end_of_record, ec);
-                
-                if (ec) {
+                if (!shard->Batch->SendTo(shard, packet.get(), packet_length, exchanger->StaticEchoGetSourceEP())) {
                     return false;
                 }
 
@@ -244,13 +239,41 @@ namespace ppp {
                     if (NULL != cache) {
                         std::shared_ptr<Byte> response;
                         int response_length;
+                        bool refresh;
+
+                        uint16_t queries_type = 0;
+                        uint16_t queries_clazz = 0;
+                        ppp::string domain = ppp::net::native::dns::ExtractHostY((Byte*)packet, packet_length,
+                            [&queries_type, &queries_clazz](dns_hdr* h, ppp::string& domain, uint16_t type, uint16_t clazz) noexcept -> bool {
+                                queries_type = type;
+                                queries_clazz = clazz;
+                                return true;
+                            });
 
-                        ppp::string domain = ppp::net::native::dns::ExtractHost((Byte*)packet, packet_length);
                         if (domain.size() > 0) {
-                            if (cache->Get(domain, response, response_length, ((dns_hdr*)packet)->usTransID)) {
-                                boost::asio::ip::udp::endpoint remoteEP = Ipep::V6ToV4(destinationEP);
+                            uint16_t trans_id = ((dns_hdr*)packet)->usTransID;
+                            boost::asio::ip::udp::endpoint remoteEP = Ipep::V6ToV4(destinationEP);
+
+                            ppp::string queries_key = VirtualEthernetNamespaceCache::QueriesKey(queries_type, queries_clazz, domain);
+                            if (cache->Get(queries_key, response, response_length, trans_id, refresh)) {
+                                if (refresh) {
+                                    VirtualEthernetDatagramPort::NamespaceRefresh(switcher_, context_, queries_key, packet, packet_length, remoteEP);
+                                }
+
                                 return Output(response.get(), response_length, remoteEP);
                             }
+
+                            auto self = shared_from_this();
+                            bool waiting = cache->Wait(queries_key, trans_id, 
+                                [self, this, remoteEP](const std::shared_ptr<Byte>& response, int response_length) noexcept {
+                                    boost::asio::post(*context_, 
+                                        [self, this, remoteEP, response, response_length]() noexcept {
+                                            Output(response.get(), response_length, remoteEP);
+                                        });
+                                });
+                            if (waiting) {
+                                return 1;
+                            }
                         }
                     }
                 }
@@ -277,7 +300,7 @@ namespace ppp {
                     return false;
                 }
 
-                boost::system::error_code ec;
+                bool sent = false;
                 if (destinationPort == PPP_DNS_SYS_PORT) {
                     int status = NamespaceQuery(destinationEP, packet, packet_length);
                     if (status > 0) {
@@ -289,15 +312,13 @@ namespace ppp {
                 }
 
                 if (in_) {
-                    socket_.send_to(boost::asio::buffer(packet, packet_length), 
-                        Ipep::V6ToV4(destinationEP), boost::asio::socket_base::message_end_of_record, ec);
+                    sent = batch_->SendTo(shared_from_this(), packet, packet_length, Ipep::V6ToV4(destinationEP));
                 }
                 else {
-                    socket_.send_to(boost::asio::buffer(packet, packet_length), 
-                        Ipep::V4ToV6(destinationEP), boost::asio::socket_base::message_end_of_record, ec);
+                    sent = batch_->SendTo(shared_from_this(), packet, packet_length, Ipep::V4ToV6(destinationEP));
                 }
 
-                if (ec) {
+                if (!sent) {
                     return false; // Failed to sendto the datagram packet. 
                 }
                 else {
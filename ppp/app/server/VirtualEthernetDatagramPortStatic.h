@@ -3,6 +3,7 @@
 #include <ppp/configurations/AppConfiguration.h>
 #include <ppp/threading/Executors.h>
 #include <ppp/transmissions/ITransmission.h>
+#include <ppp/net/asio/DatagramBatch.h>
 
 namespace ppp {
     namespace app {
@@ -85,6 +86,7 @@ namespace ppp {
                 VirtualEthernetExchangerPtr                             exchanger_;
                 AppConfigurationPtr                                     configuration_;
                 std::shared_ptr<Byte>                                   buffer_;
+                std::shared_ptr<ppp::net::asio::DatagramBatch>          batch_;
                 std::shared_ptr<boost::asio::io_context>                context_;
                 boost::asio::ip::udp::endpoint                          localEP_;
                 boost::asio::ip::udp::endpoint                          sourceEP_;
@@ -1,6 +1,7 @@
 #include <ppp/app/server/VirtualEthernetExchanger.h>
 #include <ppp/app/server/VirtualEthernetSwitcher.h>
 #include <ppp/app/server/VirtualEthernetDatagramPort.h>
+#include <ppp/app/server/VirtualEthernetDatagramNat.h>
 #include <ppp/app/server/VirtualEthernetManagedServer.h>
 #include <ppp/app/server/VirtualInternetControlMessageProtocol.h>
 #include <ppp/app/server/VirtualInternetControlMessageProtocolStatic.h>
@@ -93,6 +94,13 @@ namespace ppp {
                     Timer::ReleaseAllTimeouts(timeouts_);
                     timeouts_.clear();
 
+                    TimerPtr timeout = std::move(timeout_);
+                    timeout_.reset();
+
+                    if (NULL != timeout) {
+                        timeout->Dispose();
+                    }
+
                     VirtualInternetControlMessageProtocolPtr echo = std::move(echo_); 
                     echo_.reset();
 
@@ -336,7 +344,8 @@ namespace ppp {
                     if (NULL != datagram) {
                         bool ok = false;
                         if (auto r = datagrams_.emplace(sourceEP, datagram); r.second) {
-                            ok = datagram->Open();
+                            std::shared_ptr<VirtualEthernetDatagramNat> nat = switcher_->GetDatagramNat(transmission->GetContext());
+                            ok = NULL != nat ? datagram->Open(nat) : datagram->Open();
                             if (!ok) {
                                 datagrams_.erase(r.first);
                             }
@@ -535,20 +544,15 @@ namespace ppp {
                     return false;
                 }
 
-                auto self = shared_from_this();
-                std::shared_ptr<boost::asio::io_context> context = GetContext();
-                context->post(
-                    [self, this, now]() noexcept {
-                        int session_id = static_echo_session_id_.load();
-                        if (session_id != 0) {
-                            SynchronizedObjectScope scope(static_echo_syncobj_);
-                            Dictionary::UpdateAllObjects(static_echo_datagram_ports_, now);
-                        }
+                int session_id = static_echo_session_id_.load();
+                if (session_id != 0) {
+                    SynchronizedObjectScope scope(static_echo_syncobj_);
+                    Dictionary::UpdateAllObjects(static_echo_datagram_ports_, now);
+                }
 
-                        UploadTrafficToManagedServer();
-                        Dictionary::UpdateAllObjects(datagrams_, now);
-                        Dictionary::UpdateAllObjects2(mappings_, now);
-                    });
+                UploadTrafficToManagedServer();
+                Dictionary::UpdateAllObjects(datagrams_, now);
+                Dictionary::UpdateAllObjects2(mappings_, now);
                 return true;
             }
 
@@ -632,6 +636,27 @@ namespace ppp {
                     return false;
                 }
 
+                // Each exchanger ages its own ports once a second, the switcher no longer walks every session per tick.
+                TimerPtr timeout = make_shared_object<Timer>(context);
+                if (NULL == timeout) {
+                    return false;
+                }
+
+                std::weak_ptr<VirtualEthernetExchanger> weak = exchanger;
+                timeout->TickEvent = 
+                    [weak](Timer* sender, Timer::TickEventArgs& e) noexcept {
+                        std::shared_ptr<VirtualEthernetExchanger> exchanger = weak.lock();
+                        if (NULL != exchanger) {
+                            exchanger->Update(Executors::GetTickCount());
+                        }
+                    };
+
+                if (!timeout->SetInterval(1000) || !timeout->Start()) {
+                    timeout->Dispose();
+                    return false;
+                }
+
+                timeout_ = std::move(timeout);
                 echo_ = std::move(echo);
                 static_echo_ = std::move(static_echo);
                 return true;
@@ -884,6 +909,16 @@ namespace ppp {
                 return VirtualEthernetMappingPort::FindMappingPort(mappings_, in, tcp, remote_port);
             }
 
+            boost::asio::ip::udp::endpoint VirtualEthernetExchanger::StaticEchoGetSourceEP() noexcept {
+                SynchronizedObjectScope scope(static_echo_syncobj_);
+                return static_echo_source_ep_;
+            }
+
+            void VirtualEthernetExchanger::StaticEchoSetSourceEP(const boost::asio::ip::udp::endpoint& sourceEP) noexcept {
+                SynchronizedObjectScope scope(static_echo_syncobj_);
+                static_echo_source_ep_ = sourceEP;
+            }
+
             bool VirtualEthernetExchanger::StaticEchoEchoToDestination(const std::shared_ptr<ppp::app::protocol::VirtualEthernetPacket>& packet, const boost::asio::ip::udp::endpoint& sourceEP) noexcept {
                 if (disposed_) {
                     return false;
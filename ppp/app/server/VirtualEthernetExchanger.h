@@ -66,6 +66,7 @@ namespace ppp {
                 virtual ~VirtualEthernetExchanger() noexcept;   
     
             public: 
+                // Driven by the exchanger's own Timer on its context, which arms on the executor's timing wheel.
                 virtual bool                                                                Update(UInt64 now) noexcept;
                 virtual bool                                                                Open() noexcept;
                 virtual void                                                                Dispose() noexcept;
@@ -134,6 +135,9 @@ namespace ppp {
                 bool                                                                        StaticEchoReleasePort(uint32_t source_ip, int source_port) noexcept;
                 bool                                                                        StaticEchoSendToDestination(const std::shared_ptr<ppp::app::protocol::VirtualEthernetPacket>& packet) noexcept;
                 bool                                                                        StaticEchoEchoToDestination(const std::shared_ptr<ppp::app::protocol::VirtualEthernetPacket>& packet, const boost::asio::ip::udp::endpoint& sourceEP) noexcept;
+                // Written by whichever switcher shard received the client's last static packet and read by the senders, so both go through the lock.
+                boost::asio::ip::udp::endpoint                                              StaticEchoGetSourceEP() noexcept;
+                void                                                                        StaticEchoSetSourceEP(const boost::asio::ip::udp::endpoint& sourceEP) noexcept;
     
             private:    
                 VirtualEthernetMappingPortPtr                                               GetMappingPort(bool in, bool tcp, int remote_port) noexcept;
@@ -154,6 +158,7 @@ namespace ppp {
                 std::shared_ptr<Byte>                                                       buffer_;
                 FirewallPtr                                                                 firewall_;
                 TimeoutEventHandlerTable                                                    timeouts_;
+                TimerPtr                                                                    timeout_;
                 VirtualInternetControlMessageProtocolPtr                                    echo_;
                 VirtualEthernetDatagramPortTable                                            datagrams_;
                 ITransmissionPtr                                                            transmission_;
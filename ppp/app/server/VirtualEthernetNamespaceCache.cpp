@@ -1,146 +1,368 @@
-#include <ppp/app/server/VirtualEthernetNamespaceCache.h>
-#include <ppp/net/native/checksum.h>
-#include <ppp/threading/Executors.h>
-#include <ppp/collections/Dictionary.h>
-
-namespace ppp {
-    namespace app {
-        namespace server {
-            using ppp::threading::Executors;
-            using ppp::collections::Dictionary;
-
-            VirtualEthernetNamespaceCache::VirtualEthernetNamespaceCache(int ttl) noexcept {
-                if (ttl < 1) {
-                    ttl = 60;
-                }
-
-                uint64_t qw = static_cast<uint64_t>(ttl) * 1000ULL;
-                if (qw > INT32_MAX) {
-                    qw = INT32_MAX;
-                }
-
-                TTL_ = static_cast<int>(qw);
-            }
-
-            VirtualEthernetNamespaceCache::~VirtualEthernetNamespaceCache() noexcept {
-                NamespaceHashTable_.clear();
-                NamespaceLinkedList_.Clear();
-            }
-
-            ppp::string VirtualEthernetNamespaceCache::QueriesKey(uint16_t type, uint16_t clazz, const ppp::string& domain) noexcept {
-                ppp::string queries_key = "TYPE:" +
-                    stl::to_string<ppp::string>(type) + "|CLASS:" +
-                    stl::to_string<ppp::string>(clazz) + "|DOMAIN:" + domain;
-                return queries_key;
-            }
-
-            bool VirtualEthernetNamespaceCache::Add(const ppp::string& key, const std::shared_ptr<Byte>& response, int response_length) noexcept {
-                using dns_hdr = ppp::net::native::dns::dns_hdr;
-
-                if (key.empty()) { /* min heap. */
-                    return false;
-                }
-
-                if (NULL == response) {
-                    return false;
-                }
-
-                if (response_length < sizeof(dns_hdr)) {
-                    return false;
-                }
-
-                NamespaceRecordNodePtr node;
-                SynchronizedObjectScope scope(LockObj_);
-
-                if (Dictionary::TryRemove(NamespaceHashTable_, key, node)) {
-                    NamespaceLinkedList_.Remove(node);
-                }
-                else {
-                    node = make_shared_object<NamespaceRecordNode>();
-                    if (NULL == node) {
-                        return false;
-                    }
-                }
-
-                NamespaceRecord& record = node->Value;
-                record.queries_key      = key;
-                record.response         = response;
-                record.response_length  = response_length;
-                record.expired_time    = Executors::GetTickCount() + TTL_;
-
-                if (Dictionary::TryAdd(NamespaceHashTable_, key, node)) {
-                    bool b = NamespaceLinkedList_.AddLast(node);
-                    if (!b) {
-                        Dictionary::TryRemove(NamespaceHashTable_, key);
-                    }
-
-                    return b;
-                }
-
-                return false;
-            }
-
-            void VirtualEthernetNamespaceCache::Update() noexcept {
-                NamespaceRecordNodePtr node;
-                SynchronizedObjectScope scope(LockObj_);
-
-                node = NamespaceLinkedList_.First();
-                if (NULL != node) {
-                    uint64_t now = Executors::GetTickCount();
-                    do {
-                        NamespaceRecord& record = node->Value;
-                        if (now < record.expired_time) {
-                            break;
-                        }
-
-                        if (!Dictionary::TryRemove(NamespaceHashTable_, record.queries_key)) {
-                            break;
-                        }
-
-                        NamespaceRecordNodePtr next = node->Next;
-                        NamespaceLinkedList_.Remove(node);
-                        node = next;
-                    } while (NULL != node);
-                }
-            }
-
-            bool VirtualEthernetNamespaceCache::Get(const ppp::string& key, std::shared_ptr<Byte>& response, int& response_length, uint16_t trans_id) noexcept {
-                using dns_hdr = ppp::net::native::dns::dns_hdr;
-
-                if (key.empty()) {
-                    return false;
-                }
-                else {
-                    NamespaceRecordNodePtr node;
-                    SynchronizedObjectScope scope(LockObj_);
-
-                    if (!Dictionary::TryGetValue(NamespaceHashTable_, key, node)) {
-                        return false;
-                    }
-
-                    if (NULL == node) {
-                        Dictionary::TryRemove(NamespaceHashTable_, key);
-                        return false;
-                    }
-
-                    NamespaceRecord& record = node->Value;
-                    response        = record.response;
-                    response_length = record.response_length;
-                }
-
-                if (response_length < sizeof(dns_hdr)) {
-                    return false;
-                }
-
-                ((dns_hdr*)response.get())->usTransID = trans_id;
-                return true;
-            }
-
-            void VirtualEthernetNamespaceCache::Clear() noexcept {
-                SynchronizedObjectScope scope(LockObj_);
-                NamespaceHashTable_.clear();
-                NamespaceLinkedList_.Clear();
-            }
-        }
-    }
-}
\ No newline at end of file
+#include <ppp/app/server/VirtualEthernetNamespaceCache.h>
+#include <ppp/net/Socket.h>
+#include <ppp/net/native/checksum.h>
+#include <ppp/threading/Timer.h>
+#include <ppp/threading/Executors.h>
+
+namespace ppp {
+    namespace app {
+        namespace server {
+            using ppp::net::Socket;
+            using ppp::threading::Timer;
+            using ppp::threading::Executors;
+
+            VirtualEthernetNamespaceCache::VirtualEthernetNamespaceCache(int ttl) noexcept
+                : hits_(0)
+                , misses_(0)
+                , coalesced_(0)
+                , upstream_(0)
+                , refreshes_(0) {
+                if (ttl < 1) {
+                    ttl = 60;
+                }
+
+                uint64_t qw = static_cast<uint64_t>(ttl) * 1000ULL;
+                if (qw > INT32_MAX) {
+                    qw = INT32_MAX;
+                }
+
+                TTL_ = static_cast<int>(qw);
+            }
+
+            VirtualEthernetNamespaceCache::~VirtualEthernetNamespaceCache() noexcept {
+                Clear();
+            }
+
+            ppp::string VirtualEthernetNamespaceCache::QueriesKey(uint16_t type, uint16_t clazz, const ppp::string& domain) noexcept {
+                ppp::string queries_key;
+                queries_key.reserve(domain.size() + 6);
+                queries_key.push_back((char)(type >> 8));
+                queries_key.push_back((char)(type));
+                queries_key.push_back((char)(clazz >> 8));
+                queries_key.push_back((char)(clazz));
+
+                // Names compare case-insensitively, so the labels go in lower-cased and the root label ends the key.
+                std::size_t label = queries_key.size();
+                queries_key.push_back(0);
+                for (char ch : domain) {
+                    if (ch == '.') {
+                        if (queries_key.size() > label + 1) {
+                            label = queries_key.size();
+                            queries_key.push_back(0);
+                        }
+                        continue;
+                    }
+
+                    if (ch >= 'A' && ch <= 'Z') {
+                        ch = (char)(ch - 'A' + 'a');
+                    }
+
+                    queries_key.push_back(ch);
+                    queries_key[label]++;
+                }
+
+                if (queries_key.size() > label + 1) {
+                    queries_key.push_back(0);
+                }
+
+                return queries_key;
+            }
+
+            VirtualEthernetNamespaceCache::NamespaceShard& VirtualEthernetNamespaceCache::GetShard(const ppp::string& key) noexcept {
+                uint64_t h = static_cast<uint64_t>(std::hash<ppp::string>()(key)) * 0x9E3779B97F4A7C15ULL;
+                return shards_[static_cast<std::size_t>(h >> 32) & (SHARDS - 1)];
+            }
+
+            bool VirtualEthernetNamespaceCache::Add(const ppp::string& key, const std::shared_ptr<Byte>& response, int response_length) noexcept {
+                using dns_hdr = ppp::net::native::dns::dns_hdr;
+
+                if (key.empty()) {
+                    return false;
+                }
+
+                if (NULL == response) {
+                    return false;
+                }
+
+                if (response_length < sizeof(dns_hdr)) {
+                    return false;
+                }
+
+                NamespaceRecord record;
+                bool negative = false;
+
+                int ttl = ppp::net::native::dns::ExtractTTL(response.get(), response_length, NEGATIVE_TTL, &negative, &record.ttl_offsets);
+                if (ttl > -1) {
+                    ttl = negative ? std::min<int>(ttl, NEGATIVE_TTL) : std::max<int>(ttl, MIN_TTL);
+                    ttl = std::min<int>(ttl, TTL_ / 1000);
+                }
+
+                ppp::vector<NamespaceWaiter> waiters;
+                NamespaceShard& shard = GetShard(key);
+                for (SynchronizedObjectScope scope(shard.syncobj);;) {
+                    auto tail = shard.inflights.find(key);
+                    if (tail != shard.inflights.end()) {
+                        waiters = std::move(tail->second.waiters);
+                        shard.inflights.erase(tail);
+                    }
+
+                    if (ttl > 0) {
+                        uint64_t now = Executors::GetTickCount();
+                        record.expired_time    = now + static_cast<uint64_t>(ttl) * 1000ULL;
+                        record.refresh_time    = now + static_cast<uint64_t>(ttl) * 900ULL;
+                        record.refreshing      = false;
+                        record.response        = response;
+                        record.response_length = response_length;
+                        shard.records[key]     = std::move(record);
+                    }
+
+                    break;
+                }
+
+                // The queries that were held back get the answer even when it can not be cached, each with its own transaction id.
+                for (NamespaceWaiter& waiter : waiters) {
+                    std::shared_ptr<Byte> packet = make_shared_alloc<Byte>(response_length);
+                    if (NULL != packet) {
+                        memcpy(packet.get(), response.get(), response_length);
+                        ((dns_hdr*)packet.get())->usTransID = waiter.trans_id;
+                        waiter.handler(packet, response_length);
+                    }
+                }
+
+                return ttl > 0;
+            }
+
+            void VirtualEthernetNamespaceCache::Update() noexcept {
+                uint64_t now = Executors::GetTickCount();
+                ppp::vector<NamespaceInflight> inflights;
+
+                for (NamespaceShard& shard : shards_) {
+                    SynchronizedObjectScope scope(shard.syncobj);
+                    for (auto tail = shard.records.begin(); tail != shard.records.end();) {
+                        if (now < tail->second.expired_time) {
+                            tail++;
+                        }
+                        else {
+                            tail = shard.records.erase(tail);
+                        }
+                    }
+
+                    for (auto tail = shard.inflights.begin(); tail != shard.inflights.end();) {
+                        if (now < tail->second.expired_time) {
+                            tail++;
+                        }
+                        else {
+                            inflights.emplace_back(std::move(tail->second));
+                            tail = shard.inflights.erase(tail);
+                        }
+                    }
+                }
+            }
+
+            bool VirtualEthernetNamespaceCache::Get(const ppp::string& key, std::shared_ptr<Byte>& response, int& response_length, uint16_t trans_id, bool& refresh) noexcept {
+                using dns_hdr = ppp::net::native::dns::dns_hdr;
+
+                refresh = false;
+                if (key.empty()) {
+                    return false;
+                }
+
+                uint64_t now = Executors::GetTickCount();
+                uint64_t expired_time = 0;
+                std::shared_ptr<Byte> cached;
+                ppp::vector<uint16_t> ttl_offsets;
+
+                NamespaceShard& shard = GetShard(key);
+                for (SynchronizedObjectScope scope(shard.syncobj);;) {
+                    auto tail = shard.records.find(key);
+                    if (tail == shard.records.end()) {
+                        misses_++;
+                        return false;
+                    }
+
+                    NamespaceRecord& record = tail->second;
+                    if (now >= record.expired_time) {
+                        shard.records.erase(tail);
+                        misses_++;
+                        return false;
+                    }
+
+                    // A hot record close to its end is refreshed ahead of time by exactly one query, which is still answered from it.
+                    if (now >= record.refresh_time && !record.refreshing) {
+                        record.refreshing = true;
+                        refresh = true;
+                        refreshes_++;
+                    }
+
+                    expired_time    = record.expired_time;
+                    cached          = record.response;
+                    response_length = record.response_length;
+                    ttl_offsets     = record.ttl_offsets;
+                    break;
+                }
+
+                response = make_shared_alloc<Byte>(response_length);
+                if (NULL == response) {
+                    return false;
+                }
+
+                memcpy(response.get(), cached.get(), response_length);
+                ((dns_hdr*)response.get())->usTransID = trans_id;
+
+                uint32_t remaining = htonl(static_cast<uint32_t>((expired_time - now + 999) / 1000));
+                for (uint16_t offset : ttl_offsets) {
+                    memcpy(response.get() + offset, &remaining, sizeof(remaining));
+                }
+
+                hits_++;
+                return true;
+            }
+
+            bool VirtualEthernetNamespaceCache::Refresh(const std::shared_ptr<boost::asio::io_context>& context, const ppp::string& key, const void* packet, int packet_length, const boost::asio::ip::udp::endpoint& serverEP) noexcept {
+                if (key.empty()) {
+                    return false;
+                }
+
+                std::shared_ptr<boost::asio::ip::udp::socket> socket;
+                std::shared_ptr<Byte> buffer;
+                for (;;) {
+                    if (NULL == context || NULL == packet || packet_length < 1) {
+                        break;
+                    }
+
+                    buffer = make_shared_alloc<Byte>(PPP_BUFFER_SIZE);
+                    if (NULL == buffer) {
+                        break;
+                    }
+
+                    socket = make_shared_object<boost::asio::ip::udp::socket>(*context);
+                    if (NULL == socket) {
+                        break;
+                    }
+
+                    boost::system::error_code ec;
+                    socket->open(serverEP.protocol(), ec);
+                    if (ec) {
+                        socket.reset();
+                        break;
+                    }
+
+                    int handle = socket->native_handle();
+                    Socket::AdjustDefaultSocketOptional(handle, serverEP.protocol() == boost::asio::ip::udp::v4());
+                    Socket::SetTypeOfService(handle);
+                    Socket::SetSignalPipeline(handle, false);
+
+                    socket->send_to(boost::asio::buffer(packet, packet_length), serverEP, boost::asio::socket_base::message_end_of_record, ec);
+                    if (ec) {
+                        Socket::Closesocket(socket);
+                        socket.reset();
+                    }
+
+                    break;
+                }
+
+                if (NULL == socket) {
+                    Refreshed(key);
+                    return false;
+                }
+
+                // The socket is closed once the query is given up on, which completes the receive below with an error.
+                std::shared_ptr<Timer> timeout = Timer::Timeout(context, INFLIGHT_TTL * 1000,
+                    [socket](Timer*) noexcept {
+                        Socket::Closesocket(socket);
+                    });
+                if (NULL == timeout) {
+                    Socket::Closesocket(socket);
+                    Refreshed(key);
+                    return false;
+                }
+
+                auto self = shared_from_this();
+                socket->async_receive(boost::asio::buffer(buffer.get(), PPP_BUFFER_SIZE),
+                    [self, this, key, socket, buffer, timeout](const boost::system::error_code& ec, std::size_t sz) noexcept {
+                        int bytes_transferred = ec ? 0 : static_cast<int>(sz);
+                        if (bytes_transferred < 1 || !Add(key, buffer, bytes_transferred)) {
+                            Refreshed(key);
+                        }
+
+                        Socket::Closesocket(socket);
+                        timeout->Stop();
+                        timeout->Dispose();
+                    });
+                return true;
+            }
+
+            void VirtualEthernetNamespaceCache::Refreshed(const ppp::string& key) noexcept {
+                NamespaceShard& shard = GetShard(key);
+                SynchronizedObjectScope scope(shard.syncobj);
+
+                auto tail = shard.records.find(key);
+                if (tail != shard.records.end()) {
+                    tail->second.refreshing = false;
+                }
+            }
+
+            bool VirtualEthernetNamespaceCache::Wait(const ppp::string& key, uint16_t trans_id, const ResponseEventHandler& handler) noexcept {
+                if (key.empty() || NULL == handler) {
+                    return false;
+                }
+
+                uint64_t now = Executors::GetTickCount();
+                NamespaceInflight expired;
+
+                NamespaceShard& shard = GetShard(key);
+                SynchronizedObjectScope scope(shard.syncobj);
+
+                auto tail = shard.inflights.find(key);
+                if (tail != shard.inflights.end()) {
+                    NamespaceInflight& inflight = tail->second;
+                    if (now < inflight.expired_time) {
+                        if (inflight.waiters.size() >= MAX_WAITERS) {
+                            upstream_++;
+                            return false;
+                        }
+
+                        inflight.waiters.emplace_back(NamespaceWaiter{ trans_id, handler });
+                        coalesced_++;
+                        return true;
+                    }
+
+                    // The query in flight went unanswered, the caller takes over and the queries held behind it are left to retry.
+                    expired = std::move(inflight);
+                    shard.inflights.erase(tail);
+                }
+
+                NamespaceInflight& inflight = shard.inflights[key];
+                inflight.expired_time = now + INFLIGHT_TTL * 1000ULL;
+                upstream_++;
+                return false;
+            }
+
+            void VirtualEthernetNamespaceCache::Clear() noexcept {
+                for (NamespaceShard& shard : shards_) {
+                    ppp::unordered_map<ppp::string, NamespaceInflight> inflights;
+                    for (SynchronizedObjectScope scope(shard.syncobj);;) {
+                        shard.records.clear();
+                        inflights = std::move(shard.inflights);
+                        shard.inflights.clear();
+                        break;
+                    }
+                }
+            }
+
+            void VirtualEthernetNamespaceCache::GetStatistics(NamespaceStatistics& statistics) noexcept {
+                statistics.hits      = hits_.load();
+                statistics.misses    = misses_.load();
+                statistics.coalesced = coalesced_.load();
+                statistics.upstream  = upstream_.load();
+                statistics.refreshes = refreshes_.load();
+                statistics.count     = 0;
+
+                for (NamespaceShard& shard : shards_) {
+                    SynchronizedObjectScope scope(shard.syncobj);
+                    statistics.count += static_cast<int>(shard.records.size());
+                }
+            }
+        }
+    }
+}
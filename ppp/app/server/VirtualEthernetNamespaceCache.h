@@ -1,45 +1,101 @@
-#pragma once 
-
-#include <ppp/stdafx.h>
-#include <ppp/collections/LinkedList.h>
-
-namespace ppp {
-    namespace app {
-        namespace server {
-            class VirtualEthernetNamespaceCache : public std::enable_shared_from_this<VirtualEthernetNamespaceCache> {
-                typedef std::mutex                                          SynchronizedObject;
-                typedef std::lock_guard<SynchronizedObject>                 SynchronizedObjectScope;
-
-                typedef struct {        
-                    uint64_t                                                expired_time;
-                    ppp::string                                             queries_key;
-                    std::shared_ptr<Byte>                                   response;
-                    int                                                     response_length;
-                }                                                           NamespaceRecord;
-                typedef ppp::collections::LinkedListNode<NamespaceRecord>   NamespaceRecordNode;
-                typedef std::shared_ptr<NamespaceRecordNode>                NamespaceRecordNodePtr;
-
-            public:
-                VirtualEthernetNamespaceCache(int ttl)                      noexcept;
-                virtual ~VirtualEthernetNamespaceCache()                    noexcept;
-
-            public:
-                SynchronizedObject&                                         GetSynchronizedObject() noexcept { return LockObj_; }
-                int                                                         GetTTL() const noexcept          { return TTL_; }
-                static ppp::string                                          QueriesKey(uint16_t type, uint16_t clazz, const ppp::string& domain) noexcept;
-
-            public:
-                virtual bool                                                Add(const ppp::string& key, const std::shared_ptr<Byte>& response, int response_length) noexcept;
-                virtual bool                                                Get(const ppp::string& key, std::shared_ptr<Byte>& response, int& response_length, uint16_t trans_id) noexcept;
-                virtual void                                                Clear() noexcept;
-                virtual void                                                Update() noexcept;
-
-            private:    
-                int                                                         TTL_;
-                SynchronizedObject                                          LockObj_;
-                ppp::unordered_map<ppp::string, NamespaceRecordNodePtr>     NamespaceHashTable_;
-                ppp::collections::LinkedList<NamespaceRecord>               NamespaceLinkedList_;
-            };
-        }
-    }
-}
\ No newline at end of file
+#pragma once
+
+#include <ppp/stdafx.h>
+
+namespace ppp {
+    namespace app {
+        namespace server {
+            // Answers cached by (qtype, qclass, wire-format qname), split over independently locked shards. Each record lives for the
+            // Smallest TTL of its answers clamped to [MIN_TTL, configured ttl], NXDOMAIN and empty answers are cached negatively for at
+            // Most NEGATIVE_TTL. Concurrent misses of one key are coalesced behind a single upstream query.
+            class VirtualEthernetNamespaceCache : public std::enable_shared_from_this<VirtualEthernetNamespaceCache> {
+                typedef std::mutex                                          SynchronizedObject;
+                typedef std::lock_guard<SynchronizedObject>                 SynchronizedObjectScope;
+
+            public:
+                typedef ppp::function<void(const std::shared_ptr<Byte>&, int)>
+                                                                            ResponseEventHandler;
+
+            public:
+                static constexpr int                                        SHARDS       = 16;
+                static constexpr int                                        MIN_TTL      = 5;     /* seconds */
+                static constexpr int                                        NEGATIVE_TTL = 60;    /* seconds */
+                static constexpr int                                        INFLIGHT_TTL = 4;     /* seconds, an unanswered upstream query is given up after */
+                static constexpr int                                        MAX_WAITERS  = 64;
+
+            public:
+                typedef struct {
+                    uint64_t                                                hits;
+                    uint64_t                                                misses;
+                    uint64_t                                                coalesced;
+                    uint64_t                                                upstream;
+                    uint64_t                                                refreshes;
+                    int                                                     count;
+                }                                                           NamespaceStatistics;
+
+            private:
+                typedef struct {
+                    uint64_t                                                expired_time;
+                    uint64_t                                                refresh_time;
+                    bool                                                    refreshing;
+                    std::shared_ptr<Byte>                                   response;
+                    int                                                     response_length;
+                    ppp::vector<uint16_t>                                   ttl_offsets;
+                }                                                           NamespaceRecord;
+
+                typedef struct {
+                    uint16_t                                                trans_id;
+                    ResponseEventHandler                                    handler;
+                }                                                           NamespaceWaiter;
+
+                typedef struct {
+                    uint64_t                                                expired_time;
+                    ppp::vector<NamespaceWaiter>                            waiters;
+                }                                                           NamespaceInflight;
+
+                typedef struct {
+                    SynchronizedObject                                      syncobj;
+                    ppp::unordered_map<ppp::string, NamespaceRecord>        records;
+                    ppp::unordered_map<ppp::string, NamespaceInflight>      inflights;
+                }                                                           NamespaceShard;
+
+            public:
+                VirtualEthernetNamespaceCache(int ttl)                      noexcept;
+                virtual ~VirtualEthernetNamespaceCache()                    noexcept;
+
+            public:
+                int                                                         GetTTL() const noexcept          { return TTL_; }
+                void                                                        GetStatistics(NamespaceStatistics& statistics) noexcept;
+                // Compact binary key, the big-endian type and class followed by the lower-cased name in wire format.
+                static ppp::string                                          QueriesKey(uint16_t type, uint16_t clazz, const ppp::string& domain) noexcept;
+
+            public:
+                // Caches the response and hands a copy of it to every query coalesced behind the key, returns false for uncacheable answers.
+                virtual bool                                                Add(const ppp::string& key, const std::shared_ptr<Byte>& response, int response_length) noexcept;
+                // Returns a private copy carrying trans_id, the record TTLs are rewritten to what is left of them. Refresh is set for the
+                // One hit that found the record near its end, that caller sends the question upstream again through Refresh.
+                virtual bool                                                Get(const ppp::string& key, std::shared_ptr<Byte>& response, int& response_length, uint16_t trans_id, bool& refresh) noexcept;
+                // Asks the server again in the background, the response replaces the record, a timeout or failure leaves it to expire.
+                virtual bool                                                Refresh(const std::shared_ptr<boost::asio::io_context>& context, const ppp::string& key, const void* packet, int packet_length, const boost::asio::ip::udp::endpoint& serverEP) noexcept;
+                // Called after a miss, returns true if an identical query is already upstream and the handler was queued behind it,
+                // Otherwise the caller is now the one query in flight for the key and has to send it.
+                virtual bool                                                Wait(const ppp::string& key, uint16_t trans_id, const ResponseEventHandler& handler) noexcept;
+                virtual void                                                Clear() noexcept;
+                virtual void                                                Update() noexcept;
+
+            private:
+                NamespaceShard&                                             GetShard(const ppp::string& key) noexcept;
+                void                                                        Refreshed(const ppp::string& key) noexcept;
+
+            private:
+                int                                                         TTL_;
+                std::atomic<uint64_t>                                       hits_;
+                std::atomic<uint64_t>                                       misses_;
+                std::atomic<uint64_t>                                       coalesced_;
+                std::atomic<uint64_t>                                       upstream_;
+                std::atomic<uint64_t>                                       refreshes_;
+                NamespaceShard                                              shards_[SHARDS];
+            };
+        }
+    }
+}
@@ -37,13 +37,27 @@ namespace ppp {
                 std::shared_ptr<VirtualEthernetTcpipConnection> connection = std::move(connection_); 
                 connection_.reset();
 
+                std::shared_ptr<VirtualEthernetMux> mux = std::move(mux_); 
+                mux_.reset();
+
                 ITransmissionPtr transmission = std::move(transmission_); 
                 transmission_.reset();
 
+                std::shared_ptr<ppp::threading::Timer> timeout_timer = std::move(timeout_timer_);
+                timeout_timer_.reset();
+
+                if (NULL != timeout_timer) {
+                    timeout_timer->Dispose();
+                }
+
                 if (NULL != connection) {
                     connection->Dispose();
                 }
 
+                if (NULL != mux) {
+                    mux->Dispose();
+                }
+
                 if (NULL != transmission) {
                     transmission->Dispose();
                 }
@@ -53,7 +67,26 @@ namespace ppp {
             }
 
             bool VirtualEthernetNetworkTcpipConnection::Run(ppp::coroutines::YieldContext& y) noexcept {
-                std::shared_ptr<VirtualEthernetTcpipConnection> connection = AcceptConnection(y);
+                if (disposed_) {
+                    return false;
+                }
+
+                ITransmissionPtr transmission = transmission_;
+                if (NULL == transmission) {
+                    return false;
+                }
+
+                // The first frame tells a link that carries one flow apart from a link the client multiplexes its flows over.
+                int packet_length = 0;
+                std::shared_ptr<Byte> packet = transmission->Read(y, packet_length);
+                if (NULL == packet || packet_length < 1) {
+                    return false;
+                }
+                elif(VirtualEthernetMux::IsMux(packet.get(), packet_length)) {
+                    return AcceptMux(packet.get(), packet_length, y);
+                }
+
+                std::shared_ptr<VirtualEthernetTcpipConnection> connection = AcceptConnection(packet.get(), packet_length, y);
                 if (NULL == connection) {
                     return false;
                 }
@@ -66,7 +99,92 @@ namespace ppp {
                 }
             }
 
-            std::shared_ptr<VirtualEthernetNetworkTcpipConnection::VirtualEthernetTcpipConnection> VirtualEthernetNetworkTcpipConnection::AcceptConnection(ppp::coroutines::YieldContext& y) noexcept {
+            bool VirtualEthernetNetworkTcpipConnection::AcceptMux(Byte* packet, int packet_length, ppp::coroutines::YieldContext& y) noexcept {
+                class VirtualEthernetNetworkTcpipMux final : public VirtualEthernetMux {
+                public:
+                    VirtualEthernetNetworkTcpipMux(
+                        const std::shared_ptr<VirtualEthernetNetworkTcpipConnection>&   connection,
+                        const ITransmissionPtr&                                         transmission,
+                        const Int128&                                                   id) noexcept
+                        : VirtualEthernetMux(transmission, id, true)
+                        , connection_(connection) {
+
+                    }
+
+                protected:
+                    virtual bool                                                        OnAccept(const VirtualEthernetMuxStreamPtr& stream) noexcept override {
+                        std::shared_ptr<VirtualEthernetNetworkTcpipConnection> connection = connection_.lock();
+                        if (NULL == connection) {
+                            return false;
+                        }
+
+                        return connection->AcceptStream(stream);
+                    }
+                    virtual bool                                                        PacketInput(const ITransmissionPtr& transmission, Byte* p, int packet_length, YieldContext& y) noexcept override {
+                        std::shared_ptr<VirtualEthernetNetworkTcpipConnection> connection = connection_.lock();
+                        if (NULL != connection) {
+                            connection->Update();
+                        }
+
+                        return VirtualEthernetMux::PacketInput(transmission, p, packet_length, y);
+                    }
+
+                private:
+                    std::weak_ptr<VirtualEthernetNetworkTcpipConnection>                connection_;
+                };
+
+                ITransmissionPtr transmission = transmission_;
+                if (NULL == transmission) {
+                    return false;
+                }
+
+                auto self = shared_from_this();
+                std::shared_ptr<VirtualEthernetMux> mux = make_shared_object<VirtualEthernetNetworkTcpipMux>(self, transmission, id_);
+                if (NULL == mux) {
+                    return false;
+                }
+
+                if (!mux->Accept(packet, packet_length, y)) {
+                    mux->Dispose();
+                    return false;
+                }
+                elif(disposed_) {
+                    mux->Dispose();
+                    return false;
+                }
+
+                mux_ = mux;
+                Update();
+
+                bool ok = mux->Loopback(y);
+                Dispose();
+                return ok;
+            }
+
+            bool VirtualEthernetNetworkTcpipConnection::AcceptStream(const ITransmissionPtr& stream) noexcept {
+                using YieldContext = ppp::coroutines::YieldContext;
+
+                if (disposed_) {
+                    return false;
+                }
+
+                // Each stream is accepted as if it had come in on a link of its own.
+                std::shared_ptr<VirtualEthernetSwitcher> switcher = switcher_;
+                std::shared_ptr<ppp::threading::BufferswapAllocator> allocator = stream->BufferAllocator;
+                ppp::threading::Executors::ContextPtr context = stream->GetContext();
+                ppp::threading::Executors::StrandPtr strand = stream->GetStrand();
+                Int128 session_id = id_;
+
+                return YieldContext::Spawn(allocator.get(), *context, strand.get(),
+                    [switcher, stream, session_id](YieldContext& y) noexcept {
+                        std::shared_ptr<VirtualEthernetNetworkTcpipConnection> connection = switcher->AddNewConnection(stream, session_id);
+                        if (NULL == connection || !connection->Run(y)) {
+                            stream->Dispose();
+                        }
+                    });
+            }
+
+            std::shared_ptr<VirtualEthernetNetworkTcpipConnection::VirtualEthernetTcpipConnection> VirtualEthernetNetworkTcpipConnection::AcceptConnection(Byte* packet, int packet_length, ppp::coroutines::YieldContext& y) noexcept {
                 class VirtualEthernetTcpipConnection final : public ppp::app::protocol::templates::VEthernetTcpipConnection<VirtualEthernetNetworkTcpipConnection> {
                 public:
                     VirtualEthernetTcpipConnection(
@@ -118,7 +236,7 @@ namespace ppp {
                     return NULL;
                 }
 
-                bool ok = connection->Accept(y, transmission, switcher_->GetLogger());
+                bool ok = connection->Accept(y, transmission, packet, packet_length, switcher_->GetLogger());
                 if (!ok) {
                     connection->Dispose();
                     return NULL;
@@ -127,11 +245,60 @@ namespace ppp {
                 return connection;
             }
 
+            bool VirtualEthernetNetworkTcpipConnection::CreateAlwaysTimeout() noexcept {
+                using Executors = ppp::threading::Executors;
+                using Timer     = ppp::threading::Timer;
+
+                if (disposed_) {
+                    return false;
+                }
+
+                std::shared_ptr<Timer> timeout_timer = make_shared_object<Timer>(context_);
+                if (NULL == timeout_timer) {
+                    return false;
+                }
+
+                static constexpr auto remaining = 
+                    [](UInt64 timeout, UInt64 now) noexcept {
+                        return static_cast<int>(std::min<UInt64>(std::max<UInt64>(timeout > now ? timeout - now : 0, 1), INT32_MAX));
+                    };
+
+                std::weak_ptr<VirtualEthernetNetworkTcpipConnection> weak = shared_from_this();
+                timeout_timer->TickEvent = 
+                    [weak](Timer* sender, Timer::TickEventArgs& e) noexcept {
+                        std::shared_ptr<VirtualEthernetNetworkTcpipConnection> connection = weak.lock();
+                        if (NULL == connection) {
+                            sender->Stop();
+                            return;
+                        }
+
+                        UInt64 now = Executors::GetTickCount();
+                        if (connection->IsPortAging(now)) {
+                            sender->Stop();
+                            connection->switcher_->DeleteConnection(connection.get());
+                        }
+                        else {
+                            sender->SetInterval(remaining(connection->timeout_, now));
+                        }
+                    };
+
+                if (!timeout_timer->SetInterval(remaining(timeout_, Executors::GetTickCount())) || !timeout_timer->Start()) {
+                    timeout_timer->Dispose();
+                    return false;
+                }
+
+                timeout_timer_ = std::move(timeout_timer);
+                return true;
+            }
+
             void VirtualEthernetNetworkTcpipConnection::Update() noexcept {
                 using Executors = ppp::threading::Executors;
 
                 std::shared_ptr<VirtualEthernetTcpipConnection> connection = connection_;
-                if (NULL != connection && connection->IsLinked()) {
+                if (NULL != mux_) {
+                    timeout_ = Executors::GetTickCount() + (UInt64)configuration_->tcp.inactive.timeout * 1000;
+                }
+                elif(NULL != connection && connection->IsLinked()) {
                     timeout_ = Executors::GetTickCount() + (UInt64)configuration_->tcp.inactive.timeout * 1000;
                 }
                 else {
@@ -2,10 +2,12 @@
 
 #include <ppp/configurations/AppConfiguration.h>
 #include <ppp/threading/Executors.h>
+#include <ppp/threading/Timer.h>
 #include <ppp/coroutines/YieldContext.h>
 #include <ppp/transmissions/ITransmission.h>
 #include <ppp/app/protocol/VirtualEthernetInformation.h>
 #include <ppp/app/protocol/VirtualEthernetTcpipConnection.h>
+#include <ppp/app/protocol/VirtualEthernetMux.h>
 
 namespace ppp {
     namespace app {
@@ -15,6 +17,7 @@ namespace ppp {
             class VirtualEthernetNetworkTcpipConnection : public std::enable_shared_from_this<VirtualEthernetNetworkTcpipConnection> {
             public:
                 typedef ppp::app::protocol::VirtualEthernetTcpipConnection  VirtualEthernetTcpipConnection;
+                typedef ppp::app::protocol::VirtualEthernetMux              VirtualEthernetMux;
                 typedef ppp::configurations::AppConfiguration               AppConfiguration;
                 typedef std::shared_ptr<AppConfiguration>                   AppConfigurationPtr;
                 typedef ppp::transmissions::ITransmission                   ITransmission;
@@ -37,13 +40,18 @@ namespace ppp {
 
             public:
                 virtual bool                                                Run(ppp::coroutines::YieldContext& y) noexcept;
+                // Arms a timer for the current deadline instead of being polled by the switcher, when it fires early because the
+                // Connection saw traffic meanwhile it simply re-arms for the time that is left.
+                bool                                                        CreateAlwaysTimeout() noexcept;
                 virtual void                                                Update() noexcept;
                 virtual void                                                Dispose() noexcept;
                 bool                                                        IsPortAging(uint64_t now) noexcept { return disposed_ || now >= timeout_; }
 
             private:
                 void                                                        Finalize() noexcept;
-                std::shared_ptr<VirtualEthernetTcpipConnection>             AcceptConnection(ppp::coroutines::YieldContext& y) noexcept;
+                std::shared_ptr<VirtualEthernetTcpipConnection>             AcceptConnection(Byte* packet, int packet_length, ppp::coroutines::YieldContext& y) noexcept;
+                bool                                                        AcceptMux(Byte* packet, int packet_length, ppp::coroutines::YieldContext& y) noexcept;
+                bool                                                        AcceptStream(const ITransmissionPtr& stream) noexcept;
 
             private:
                 bool                                                        disposed_ = false;
@@ -54,6 +62,8 @@ namespace ppp {
                 std::shared_ptr<VirtualEthernetSwitcher>                    switcher_;
                 ITransmissionPtr                                            transmission_;
                 std::shared_ptr<VirtualEthernetTcpipConnection>             connection_;
+                std::shared_ptr<VirtualEthernetMux>                         mux_;
+                std::shared_ptr<ppp::threading::Timer>                      timeout_timer_;
                 AppConfigurationPtr                                         configuration_;
             };
         }
@@ -3,6 +3,7 @@
 #include <ppp/app/server/VirtualEthernetNetworkTcpipConnection.h>
 #include <ppp/app/server/VirtualEthernetManagedServer.h>
 #include <ppp/app/server/VirtualEthernetNamespaceCache.h>
+#include <ppp/app/server/VirtualEthernetDatagramNat.h>
 #include <ppp/IDisposable.h>
 #include <ppp/net/Ipep.h>
 #include <ppp/net/Socket.h>
@@ -32,7 +33,6 @@ namespace ppp {
                 : disposed_(false)
                 , configuration_(configuration)
                 , context_(Executors::GetDefault())
-                , static_echo_socket_(*context_)
                 , static_echo_bind_port_(IPEndPoint::MinPort) {
                 
                 boost::asio::ip::udp::udp::endpoint dnsserverEP = ParseDNSEndPoint(configuration_->udp.dns.redirect);
@@ -49,8 +49,6 @@ namespace ppp {
                         static_echo_transport_ = make_shared_object<Ciphertext>(configuration->key.transport, configuration->key.transport_key);
                     }
                 }
-
-                static_echo_buffers_ = ppp::threading::Executors::GetCachedBuffer(context_);
             }
 
             VirtualEthernetSwitcher::~VirtualEthernetSwitcher() noexcept {
@@ -183,12 +181,11 @@ namespace ppp {
             }
 
             VirtualEthernetSwitcher::VirtualEthernetExchangerPtr VirtualEthernetSwitcher::GetExchanger(const Int128& session_id) noexcept {
-                SynchronizedObjectScope scope(syncobj_);
                 if (disposed_) {
                     return NULL;
                 }
 
-                return Dictionary::FindObjectByKey(exchangers_, session_id);
+                return exchangers_.FindObjectByKey(session_id);
             }
 
             VirtualEthernetSwitcher::VirtualEthernetExchangerPtr VirtualEthernetSwitcher::AddNewExchanger(const ITransmissionPtr& transmission, const Int128& session_id) noexcept {
@@ -208,10 +205,14 @@ namespace ppp {
                     }
 
                     if (newExchanger->Open()) {
-                        VirtualEthernetExchangerPtr& tmpExchanger = exchangers_[session_id];
                         ok = true;
-                        oldExchanger = tmpExchanger;
-                        tmpExchanger = newExchanger;
+                        oldExchanger = exchangers_.Synchronized(session_id,
+                            [&session_id, &newExchanger](VirtualEthernetExchangerTable& exchangers) noexcept {
+                                VirtualEthernetExchangerPtr& tmpExchanger = exchangers[session_id];
+                                VirtualEthernetExchangerPtr oldExchanger = std::move(tmpExchanger);
+                                tmpExchanger = newExchanger;
+                                return oldExchanger;
+                            });
                     }
                 }
 
@@ -342,26 +343,35 @@ namespace ppp {
                         return NULL;
                     }
 
-                    if (Dictionary::TryAdd(connections_, connection.get(), connection)) {
-                        return connection;
+                    if (!connections_.TryAdd(connection.get(), connection)) {
+                        connection->Dispose();
+                        return NULL;
                     }
                 }
 
-                connection->Dispose();
+                if (connection->CreateAlwaysTimeout()) {
+                    return connection;
+                }
+
+                DeleteConnection(connection.get());
                 return NULL;
             }
 
             VirtualEthernetSwitcher::VirtualEthernetExchangerPtr VirtualEthernetSwitcher::DeleteExchanger(VirtualEthernetExchanger* exchanger) noexcept {
                 VirtualEthernetExchangerPtr channel;
                 if (NULL != exchanger) {
-                    SynchronizedObjectScope scope(syncobj_);
-                    if (auto tail = exchangers_.find(exchanger->GetId()); tail != exchangers_.end()) {
-                        const VirtualEthernetExchangerPtr& p = tail->second;
-                        if (p.get() == exchanger) {
-                            channel = std::move(tail->second);
-                            exchangers_.erase(tail);
-                        }
-                    }
+                    channel = exchangers_.Synchronized(exchanger->GetId(),
+                        [exchanger](VirtualEthernetExchangerTable& exchangers) noexcept {
+                            VirtualEthernetExchangerPtr channel;
+                            if (auto tail = exchangers.find(exchanger->GetId()); tail != exchangers.end()) {
+                                const VirtualEthernetExchangerPtr& p = tail->second;
+                                if (p.get() == exchanger) {
+                                    channel = std::move(tail->second);
+                                    exchangers.erase(tail);
+                                }
+                            }
+                            return channel;
+                        });
                 }
 
                 if (channel) {
@@ -504,59 +514,162 @@ namespace ppp {
                     return true;
                 }
 
+                // A single socket bottlenecks the static mode on one core, on Linux every executor gets its own socket in one SO_REUSEPORT group,
+                // The kernel spreads the datagrams over them and each executor unpacks what its socket received.
+                ppp::vector<ContextPtr> contexts;
+                contexts.emplace_back(context_);
+#if defined(_LINUX)
+                int shards = configuration_->udp.listen.shards;
+                if (shards != 1) {
+                    ppp::vector<ContextPtr> executors;
+                    Executors::GetAllContexts(executors);
+
+                    for (ContextPtr& context : executors) {
+                        if (shards > 0 && (int)contexts.size() >= shards) {
+                            break;
+                        }
+                        elif(NULL != context && context != context_) {
+                            contexts.emplace_back(context);
+                        }
+                    }
+                }
+#endif
+
                 boost::asio::ip::address interface_ip = GetInterfaceIP();
-                boost::asio::ip::udp::endpoint bind_endpoint(interface_ip, bind_port);
+                bool reuse = contexts.size() > 1;
 
-                bool ok = VirtualEthernetPacket::OpenDatagramSocket(static_echo_socket_, interface_ip, bind_port, bind_endpoint);
-                if (!ok) {
+                StaticEchoShardPtr first = OpenStaticEchoShard(context_, interface_ip, bind_port, reuse);
+                if (NULL == first) {
                     return false;
                 }
 
                 boost::system::error_code ec;
-                boost::asio::ip::udp::endpoint localEP = static_echo_socket_.local_endpoint(ec);
+                boost::asio::ip::udp::endpoint localEP = first->Socket.local_endpoint(ec);
                 if (ec) {
+                    Socket::Closesocket(first->Socket);
                     return false;
                 }
 
+                ppp::vector<StaticEchoShardPtr> static_echo_shards;
+                static_echo_shards.emplace_back(first);
+
                 static_echo_bind_port_ = localEP.port();
-                return LoopbackDatagramSocket();
+                for (std::size_t i = 1; i < contexts.size(); i++) {
+                    StaticEchoShardPtr shard = OpenStaticEchoShard(contexts[i], interface_ip, static_echo_bind_port_, reuse);
+                    if (NULL == shard) {
+                        break;
+                    }
+
+                    // Fell back to an ephemeral port, it is not part of the group and would never see a datagram.
+                    if (Socket::LocalPort(shard->Socket) != static_echo_bind_port_) {
+                        Socket::Closesocket(shard->Socket);
+                        break;
+                    }
+
+                    static_echo_shards.emplace_back(shard);
+                }
+
+                int count = (int)static_echo_shards.size();
+                if (count > 1 && configuration_->udp.listen.steering) {
+                    Socket::SteerReusePortBySourceAddress(first->Socket.native_handle(), count);
+                }
+
+                static_echo_shards_ = std::move(static_echo_shards);
+                for (StaticEchoShardPtr& shard : static_echo_shards_) {
+                    if (!LoopbackDatagramSocket(shard)) {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            VirtualEthernetSwitcher::StaticEchoShardPtr VirtualEthernetSwitcher::OpenStaticEchoShard(const ContextPtr& context, const boost::asio::ip::address& address, int port, bool reuse) noexcept {
+                StaticEchoShardPtr shard = make_shared_object<StaticEchoShard>(context);
+                if (NULL == shard) {
+                    return NULL;
+                }
+
+                bool ok = false;
+                if (reuse) {
+                    // SO_REUSEPORT has to be set between open and bind, so the socket is opened here and only bound by OpenSocket.
+                    boost::asio::ip::address address_ = address;
+                    if (!address_.is_unspecified() && IPEndPoint::IsInvalid(address_)) {
+                        address_ = boost::asio::ip::address_v6::any();
+                    }
+
+                    boost::system::error_code ec;
+                    shard->Socket.open(address_.is_v4() ? boost::asio::ip::udp::v4() : boost::asio::ip::udp::v6(), ec);
+                    if (!ec) {
+                        ok = Socket::ReuseSocketPort(shard->Socket.native_handle(), true) && Socket::OpenSocket(shard->Socket, address_, port, true);
+                    }
+                }
+                else {
+                    ok = VirtualEthernetPacket::OpenDatagramSocket(shard->Socket, address, port, boost::asio::ip::udp::endpoint(address, port));
+                }
+
+                if (ok) {
+                    shard->Buffer = Executors::GetCachedBuffer(context);
+                    if (NULL != shard->Buffer) {
+                        shard->Batch = make_shared_object<ppp::net::asio::DatagramBatch>(shard->Socket, configuration_->udp.batch, shard->Buffer);
+                        if (NULL != shard->Batch) {
+                            return shard;
+                        }
+                    }
+                }
+
+                Socket::Closesocket(shard->Socket);
+                return NULL;
             }
 
-            bool VirtualEthernetSwitcher::LoopbackDatagramSocket() noexcept {
+            VirtualEthernetSwitcher::StaticEchoShardPtr VirtualEthernetSwitcher::GetStaticEchoShard() noexcept {
+                if (static_echo_shards_.empty()) {
+                    return NULL;
+                }
+
+                ContextPtr context = Executors::GetCurrent();
+                for (StaticEchoShardPtr& shard : static_echo_shards_) {
+                    if (shard->Context == context) {
+                        return shard;
+                    }
+                }
+
+                return static_echo_shards_[0];
+            }
+
+            bool VirtualEthernetSwitcher::LoopbackDatagramSocket(const StaticEchoShardPtr& shard) noexcept {
                 if (disposed_) {
                     return false;
                 }
 
-                bool opened = static_echo_socket_.is_open();
+                bool opened = shard->Socket.is_open();
                 if (!opened) {
                     return false;
                 }
 
                 auto self = shared_from_this();
-                static_echo_socket_.async_receive_from(boost::asio::buffer(static_echo_buffers_.get(), PPP_BUFFER_SIZE), static_echo_source_ep_,
-                    [self, this](const boost::system::error_code& ec, std::size_t sz) noexcept {
-                        if (ec == boost::system::errc::operation_canceled) {
-                            return false;
-                        }
-
+                return shard->Batch->ReceiveFrom(
+                    [self, this](Byte* buffer, int buffer_length, const boost::asio::ip::udp::endpoint& sourceEP) noexcept {
                         if (disposed_) {
                             return false;
                         }
 
-                        if (ec == boost::system::errc::success) {
-                            if (sz > 0) {
-                                std::shared_ptr<ppp::threading::BufferswapAllocator> allocator = configuration_->GetBufferAllocator();
-                                std::shared_ptr<VirtualEthernetPacket> packet = 
-                                    VirtualEthernetPacket::Unpack(configuration_, allocator, static_echo_protocol_, static_echo_transport_, static_echo_buffers_.get(), sz);
-                                if (NULL != packet) {
-                                    StaticEchoPacketInput(allocator, packet, sz, static_echo_source_ep_);
-                                }
+                        if (buffer_length > 0) {
+                            std::shared_ptr<ppp::threading::BufferswapAllocator> allocator = configuration_->GetBufferAllocator();
+                            std::shared_ptr<VirtualEthernetPacket> packet = 
+                                VirtualEthernetPacket::Unpack(configuration_, allocator, static_echo_protocol_, static_echo_transport_, buffer, buffer_length);
+                            if (NULL != packet) {
+                                StaticEchoPacketInput(allocator, packet, buffer_length, sourceEP);
                             }
                         }
-                        
-                        return LoopbackDatagramSocket();
+
+                        return true;
+                    },
+                    [self, this, shard](const boost::system::error_code& ec) noexcept {
+                        if (ec != boost::system::errc::operation_canceled && !disposed_) {
+                            LoopbackDatagramSocket(shard);
+                        }
                     });
-                return true;
             }
 
             bool VirtualEthernetSwitcher::StaticEchoPacketInput(const std::shared_ptr<ppp::threading::BufferswapAllocator>& allocator, const std::shared_ptr<ppp::app::protocol::VirtualEthernetPacket>& packet, int packet_length, const boost::asio::ip::udp::endpoint& sourceEP) noexcept {
@@ -567,8 +680,7 @@ namespace ppp {
                         return false;
                     }
 
-                    SynchronizedObjectScope scope(syncobj_);
-                    if (!ppp::collections::Dictionary::TryGetValue(exchangers_, guid, exchanger)) {
+                    if (!exchangers_.TryGetValue(guid, exchanger)) {
                         return false;
                     }
                 }
@@ -581,7 +693,7 @@ namespace ppp {
                     statistics->AddIncomingTraffic(packet_length);
                 }
 
-                exchanger->static_echo_source_ep_ = sourceEP;
+                exchanger->StaticEchoSetSourceEP(sourceEP);
                 if (packet->Protocol == ppp::net::native::ip_hdr::IP_PROTO_UDP) {
                     return exchanger->StaticEchoSendToDestination(packet);
                 }
@@ -599,8 +711,7 @@ namespace ppp {
                 }
 
                 Int128 session_id;
-                SynchronizedObjectScope scope(syncobj_);
-                return Dictionary::TryRemove(static_echo_allocateds_, allocated_id, session_id) ? session_id : 0;
+                return static_echo_allocateds_.TryRemove(allocated_id, session_id) ? session_id : 0;
             }
 
             bool VirtualEthernetSwitcher::StaticEchoQuery(int allocated_id, Int128& session_id) noexcept {
@@ -613,8 +724,7 @@ namespace ppp {
                     return false;
                 }
 
-                SynchronizedObjectScope scope(syncobj_);
-                return Dictionary::TryGetValue(static_echo_allocateds_, allocated_id, session_id);
+                return static_echo_allocateds_.TryGetValue(allocated_id, session_id);
             }
 
             bool VirtualEthernetSwitcher::StaticEchoAllocated(Int128 session_id, int& allocated_id, int& remote_port) noexcept {
@@ -632,9 +742,8 @@ namespace ppp {
                     return false;
                 }
 
-                SynchronizedObjectScope scope(syncobj_);
                 if (allocated_id != 0) {
-                    if (!Dictionary::ContainsKey(static_echo_allocateds_, allocated_id)) {
+                    if (!static_echo_allocateds_.ContainsKey(allocated_id)) {
                         return false;
                     }
 
@@ -648,17 +757,11 @@ namespace ppp {
                         continue;
                     }
 
-                    if (Dictionary::ContainsKey(static_echo_allocateds_, generate_id)) {
-                        continue;
-                    }
-
-                    bool ok = Dictionary::TryAdd(static_echo_allocateds_, generate_id, session_id);
-                    if (ok) {
+                    if (static_echo_allocateds_.TryAdd(generate_id, session_id)) {
                         remote_port  = bind_port;
                         allocated_id = generate_id;
+                        return true;
                     }
-
-                    return ok;
                 }
 
                 return false;
@@ -804,6 +907,7 @@ namespace ppp {
                 VirtualEthernetLoggerPtr logger;
                 VirtualEthernetExchangerTable exchangers;
                 VirtualEthernetNetworkTcpipConnectionTable connections;
+                VirtualEthernetDatagramNatTable datagram_nats;
 
                 for (;;) {
                     SynchronizedObjectScope scope(syncobj_);
@@ -818,19 +922,18 @@ namespace ppp {
                     cache = std::move(namespace_cache_);
                     namespace_cache_.reset();
 
-                    nats = std::move(nats_);
-                    nats_.clear();
+                    nats_.MoveTo(nats);
 
                     logger = std::move(logger_);
                     logger_.reset();
 
-                    exchangers = std::move(exchangers_);
-                    exchangers_.clear();
+                    exchangers_.MoveTo(exchangers);
+                    connections_.MoveTo(connections);
 
-                    connections = std::move(connections_);
-                    connections_.clear();
+                    datagram_nats = std::move(datagram_nats_);
+                    datagram_nats_.clear();
 
-                    static_echo_allocateds_.clear();
+                    static_echo_allocateds_.Clear();
                     break;
                 }
 
@@ -842,6 +945,15 @@ namespace ppp {
 
                 Dictionary::ReleaseAllObjects(exchangers);
                 Dictionary::ReleaseAllObjects(connections);
+                Dictionary::ReleaseAllObjects(datagram_nats);
+
+                // The shards stay in place, replies look them up without a lock. Each socket is closed on its own executor to end its receive.
+                for (StaticEchoShardPtr& shard : static_echo_shards_) {
+                    boost::asio::post(*shard->Context,
+                        [shard]() noexcept {
+                            Socket::Closesocket(shard->Socket);
+                        });
+                }
 
                 if (NULL != cache) {
                     cache->Clear();
@@ -921,14 +1033,57 @@ namespace ppp {
                 return false;
             }
 
-            void VirtualEthernetSwitcher::TickAllExchangers(UInt64 now) noexcept {
-                SynchronizedObjectScope scope(syncobj_);
-                ppp::collections::Dictionary::UpdateAllObjects2(exchangers_, now);
+            void VirtualEthernetSwitcher::TickAllDatagramNats(UInt64 now) noexcept {
+                ppp::vector<VirtualEthernetDatagramNatPtr> datagram_nats;
+                for (;;) {
+                    SynchronizedObjectScope scope(syncobj_);
+                    for (auto&& kv : datagram_nats_) {
+                        datagram_nats.emplace_back(kv.second);
+                    }
+                    break;
+                }
+
+                for (VirtualEthernetDatagramNatPtr& nat : datagram_nats) {
+                    nat->Update(now);
+                }
             }
 
-            void VirtualEthernetSwitcher::TickAllConnections(UInt64 now) noexcept {
-                SynchronizedObjectScope scope(syncobj_);
-                Dictionary::UpdateAllObjects(connections_, now);
+            VirtualEthernetSwitcher::VirtualEthernetDatagramNatPtr VirtualEthernetSwitcher::GetDatagramNat(const ContextPtr& context) noexcept {
+                int pool = configuration_->udp.nat.pool;
+                if (pool < 1 || NULL == context) {
+                    return NULL;
+                }
+
+                VirtualEthernetDatagramNatPtr nat;
+                for (;;) {
+                    SynchronizedObjectScope scope(syncobj_);
+                    if (disposed_) {
+                        return NULL;
+                    }
+
+                    if (Dictionary::TryGetValue(datagram_nats_, context.get(), nat)) {
+                        return nat;
+                    }
+
+                    nat = make_shared_object<VirtualEthernetDatagramNat>(shared_from_this(), context, pool);
+                    if (NULL == nat) {
+                        return NULL;
+                    }
+
+                    if (nat->Open()) {
+                        datagram_nats_.emplace(context.get(), nat);
+                        return nat;
+                    }
+                    break;
+                }
+
+                nat->Dispose();
+                return NULL;
+            }
+
+            bool VirtualEthernetSwitcher::IsFullConePort(int port) noexcept {
+                auto& full_cone = configuration_->udp.nat.full_cone;
+                return full_cone.find(port) != full_cone.end();
             }
 
             bool VirtualEthernetSwitcher::OnTick(UInt64 now) noexcept {
@@ -936,8 +1091,7 @@ namespace ppp {
                     return false;
                 }
 
-                TickAllExchangers(now);
-                TickAllConnections(now);
+                TickAllDatagramNats(now);
 
                 VirtualEthernetNamespaceCachePtr cache = namespace_cache_;
                 if (NULL != cache) {
@@ -985,8 +1139,7 @@ namespace ppp {
             bool VirtualEthernetSwitcher::DeleteConnection(const VirtualEthernetNetworkTcpipConnection* connection) noexcept {
                 VirtualEthernetNetworkTcpipConnectionPtr ntcp;
                 if (connection) {
-                    SynchronizedObjectScope scope(syncobj_);
-                    Dictionary::RemoveValueByKey(connections_, (void*)connection, &ntcp);
+                    connections_.TryRemove((void*)connection, ntcp);
                 }
 
                 if (ntcp) {
@@ -1026,8 +1179,9 @@ namespace ppp {
             boost::asio::ip::tcp::endpoint VirtualEthernetSwitcher::GetLocalEndPoint(NetworkAcceptorCategories categories) noexcept {
                 boost::system::error_code ec;
                 if (categories == NetworkAcceptorCategories_Udpip) {
-                    if (static_echo_socket_.is_open()) {
-                        boost::asio::ip::udp::endpoint localEP = static_echo_socket_.local_endpoint(ec);
+                    StaticEchoShardPtr shard = static_echo_shards_.empty() ? NULL : static_echo_shards_[0];
+                    if (NULL != shard && shard->Socket.is_open()) {
+                        boost::asio::ip::udp::endpoint localEP = shard->Socket.local_endpoint(ec);
                         if (ec == boost::system::errc::success) {
                             return boost::asio::ip::tcp::endpoint(localEP.address(), localEP.port());
                         }
@@ -1053,8 +1207,7 @@ namespace ppp {
                     return NULL;
                 }
 
-                SynchronizedObjectScope scope(syncobj_);
-                return Dictionary::FindObjectByKey(nats_, ip);
+                return nats_.FindObjectByKey(ip);
             }
 
             VirtualEthernetSwitcher::NatInformationPtr VirtualEthernetSwitcher::AddNatInformation(const std::shared_ptr<VirtualEthernetExchanger>& exchanger, uint32_t ip, uint32_t mask) noexcept {
@@ -1087,26 +1240,29 @@ namespace ppp {
 
                 // If ip addresses conflict, do not directly conflict like traditional routers, 
                 // And abandon the mapping between IP and Ethernet electrical ports.
-                auto kv = nats_.emplace(ip, nat);
-                if (kv.second) {
-                    return nat;
-                }
+                return nats_.Synchronized(ip,
+                    [ip, &nat](NatInformationShardedTable::Table& nats) noexcept -> NatInformationPtr {
+                        auto kv = nats.emplace(ip, nat);
+                        if (kv.second) {
+                            return nat;
+                        }
 
-                NatInformationTable::iterator tail = kv.first;
-                NatInformationTable::iterator endl = nats_.end();
-                if (tail == endl) {
-                    return NULL;
-                }
+                        auto tail = kv.first;
+                        auto endl = nats.end();
+                        if (tail == endl) {
+                            return NULL;
+                        }
 
-                NatInformationPtr& raw = tail->second;
-                std::shared_ptr<VirtualEthernetExchanger>& raw_exchanger = raw->Exchanger;
-                if (raw_exchanger->IsDisposed()) {
-                    raw = nat;
-                    return nat;
-                }
-                else {
-                    return NULL;
-                }
+                        NatInformationPtr& raw = tail->second;
+                        std::shared_ptr<VirtualEthernetExchanger>& raw_exchanger = raw->Exchanger;
+                        if (raw_exchanger->IsDisposed()) {
+                            raw = nat;
+                            return nat;
+                        }
+                        else {
+                            return NULL;
+                        }
+                    });
             }
 
             bool VirtualEthernetSwitcher::DeleteNatInformation(VirtualEthernetExchanger* key, uint32_t ip) noexcept {
@@ -1118,30 +1274,31 @@ namespace ppp {
                     return false;
                 }
 
-                SynchronizedObjectScope scope(syncobj_);
                 if (disposed_) {
                     return false;
                 }
 
-                NatInformationTable::iterator tail = nats_.find(ip);
-                NatInformationTable::iterator endl = nats_.end();
-                if (tail == endl) {
-                    return false;
-                }
+                return nats_.Synchronized(ip,
+                    [key, ip](NatInformationShardedTable::Table& nats) noexcept {
+                        auto tail = nats.find(ip);
+                        auto endl = nats.end();
+                        if (tail == endl) {
+                            return false;
+                        }
 
-                NatInformationPtr& nat = tail->second;
-                std::shared_ptr<VirtualEthernetExchanger>& exchanger = nat->Exchanger;
-                if (key != exchanger.get()) {
-                    return false;
-                }
+                        NatInformationPtr& nat = tail->second;
+                        std::shared_ptr<VirtualEthernetExchanger>& exchanger = nat->Exchanger;
+                        if (key != exchanger.get()) {
+                            return false;
+                        }
 
-                nats_.erase(tail);
-                return true;
+                        nats.erase(tail);
+                        return true;
+                    });
             }
 
             int VirtualEthernetSwitcher::GetAllExchangerNumber() noexcept {
-                SynchronizedObjectScope scope(syncobj_);
-                return static_cast<int>(exchangers_.size());
+                return exchangers_.Count();
             }
         }
     }
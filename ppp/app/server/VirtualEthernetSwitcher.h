@@ -5,6 +5,7 @@
 #include <ppp/net/Firewall.h>
 #include <ppp/net/native/rib.h>
 #include <ppp/threading/Timer.h>
+#include <ppp/collections/ShardedDictionary.h>
 #include <ppp/cryptography/Ciphertext.h>
 #include <ppp/coroutines/YieldContext.h>
 #include <ppp/transmissions/ITransmission.h>
@@ -12,6 +13,7 @@
 #include <ppp/app/protocol/VirtualEthernetPacket.h>
 #include <ppp/app/protocol/VirtualEthernetLogger.h>
 #include <ppp/app/protocol/VirtualEthernetInformation.h>
+#include <ppp/net/asio/DatagramBatch.h>
 
 namespace ppp {
     namespace app {
@@ -21,6 +23,7 @@ namespace ppp {
             class VirtualEthernetExchanger;
             class VirtualEthernetNetworkTcpipConnection;
             class VirtualEthernetNamespaceCache;
+            class VirtualEthernetDatagramNat;
 
             /* 虚拟以太网交换机 */
             class VirtualEthernetSwitcher : public std::enable_shared_from_this<VirtualEthernetSwitcher> { 
@@ -35,7 +38,9 @@ namespace ppp {
                     std::shared_ptr<VirtualEthernetExchanger>           Exchanger;
                 }                                                       NatInformation;
                 typedef std::shared_ptr<NatInformation>                 NatInformationPtr;
-                typedef std::unordered_map<uint32_t, NatInformationPtr> NatInformationTable;
+                typedef ppp::unordered_map<uint32_t, NatInformationPtr> NatInformationTable;
+                typedef ppp::collections::ShardedDictionary<uint32_t,
+                    NatInformationPtr>                                  NatInformationShardedTable;
                 typedef ppp::cryptography::Ciphertext                   Ciphertext;
                 typedef std::shared_ptr<Ciphertext>                     CiphertextPtr;
 
@@ -45,6 +50,8 @@ namespace ppp {
                 typedef std::shared_ptr<VirtualEthernetExchanger>       VirtualEthernetExchangerPtr;
                 typedef ppp::unordered_map<Int128,
                     VirtualEthernetExchangerPtr>                        VirtualEthernetExchangerTable;
+                typedef ppp::collections::ShardedDictionary<Int128,
+                    VirtualEthernetExchangerPtr>                        VirtualEthernetExchangerShardedTable;
                 typedef std::shared_ptr<VirtualEthernetManagedServer>   VirtualEthernetManagedServerPtr;
                 typedef ppp::app::protocol::VirtualEthernetLogger       VirtualEthernetLogger;
                 typedef std::shared_ptr<VirtualEthernetLogger>          VirtualEthernetLoggerPtr;
@@ -66,9 +73,28 @@ namespace ppp {
                     VirtualEthernetNetworkTcpipConnection>              VirtualEthernetNetworkTcpipConnectionPtr;
                 typedef ppp::unordered_map<void*,
                     VirtualEthernetNetworkTcpipConnectionPtr>           VirtualEthernetNetworkTcpipConnectionTable;
-                typedef ppp::unordered_map<int, Int128>                 VirtualEthernetStaticEchoAllocatedTable;
+                typedef ppp::collections::ShardedDictionary<void*,
+                    VirtualEthernetNetworkTcpipConnectionPtr>           VirtualEthernetNetworkTcpipConnectionShardedTable;
+                typedef ppp::collections::ShardedDictionary<int, Int128> VirtualEthernetStaticEchoAllocatedTable;
                 typedef ppp::app::server::VirtualEthernetNamespaceCache VirtualEthernetNamespaceCache;
                 typedef std::shared_ptr<VirtualEthernetNamespaceCache>  VirtualEthernetNamespaceCachePtr;
+                typedef std::shared_ptr<VirtualEthernetDatagramNat>     VirtualEthernetDatagramNatPtr;
+                typedef ppp::unordered_map<boost::asio::io_context*,
+                    VirtualEthernetDatagramNatPtr>                      VirtualEthernetDatagramNatTable;
+
+            private:
+                // One SO_REUSEPORT socket of the static echo port, bound to the same port as its siblings and drained on its own executor.
+                class StaticEchoShard final {
+                public:
+                    StaticEchoShard(const ContextPtr& context) noexcept : Context(context), Socket(*context) {}
+
+                public:
+                    ContextPtr                                          Context;
+                    boost::asio::ip::udp::socket                        Socket;
+                    std::shared_ptr<Byte>                               Buffer;
+                    std::shared_ptr<ppp::net::asio::DatagramBatch>      Batch;
+                };
+                typedef std::shared_ptr<StaticEchoShard>                StaticEchoShardPtr;
 
             public:
                 VirtualEthernetSwitcher(const AppConfigurationPtr& configuration) noexcept;
@@ -98,6 +124,9 @@ namespace ppp {
                 std::shared_ptr<boost::asio::ip::tcp::resolver>&        GetTResolver() noexcept         { return tresolver_; }
                 std::shared_ptr<boost::asio::ip::udp::resolver>&        GetUResolver() noexcept         { return uresolver_; }
                 int                                                     GetAllExchangerNumber() noexcept;
+                // NULL when the udp egress pool is off, full cone destinations are decided per datagram by the port itself.
+                VirtualEthernetDatagramNatPtr                           GetDatagramNat(const ContextPtr& context) noexcept;
+                bool                                                    IsFullConePort(int port) noexcept;
 
             public:
                 typedef enum {
@@ -140,8 +169,7 @@ namespace ppp {
 
             private:
                 boost::asio::ip::udp::endpoint                          ParseDNSEndPoint(const ppp::string& dnserver_endpoint) noexcept;
-                void                                                    TickAllExchangers(UInt64 now) noexcept;
-                void                                                    TickAllConnections(UInt64 now) noexcept;
+                void                                                    TickAllDatagramNats(UInt64 now) noexcept;
                 bool                                                    OpenManagedServerIfNeed() noexcept;
 
             private:
@@ -158,7 +186,10 @@ namespace ppp {
                 bool                                                    CreateAlwaysTimeout() noexcept;
                 bool                                                    OpenDatagramSocket() noexcept;
                 bool                                                    OpenNamespaceCacheIfNeed() noexcept;
-                bool                                                    LoopbackDatagramSocket() noexcept;
+                bool                                                    LoopbackDatagramSocket(const StaticEchoShardPtr& shard) noexcept;
+                StaticEchoShardPtr                                      OpenStaticEchoShard(const ContextPtr& context, const boost::asio::ip::address& address, int port, bool reuse) noexcept;
+                // The shard of the calling executor, replies leave through the socket whose thread produced them.
+                StaticEchoShardPtr                                      GetStaticEchoShard() noexcept;
                 bool                                                    OpenLogger() noexcept;
                 bool                                                    DeleteNatInformation(VirtualEthernetExchanger* key, uint32_t ip) noexcept;
                 NatInformationPtr                                       FindNatInformation(uint32_t ip) noexcept;
@@ -190,25 +221,25 @@ namespace ppp {
                 std::shared_ptr<boost::asio::ip::tcp::resolver>         tresolver_;
                 std::shared_ptr<boost::asio::ip::udp::resolver>         uresolver_;
                 VirtualEthernetLoggerPtr                                logger_;
-                NatInformationTable                                     nats_;
+                // Sharded so that the packet path never takes syncobj_, which now only orders insertions against Finalize.
+                NatInformationShardedTable                              nats_;
                 FirewallPtr                                             firewall_;
-                VirtualEthernetExchangerTable                           exchangers_;
+                VirtualEthernetExchangerShardedTable                    exchangers_;
                 TimerPtr                                                timeout_;
                 AppConfigurationPtr                                     configuration_;
                 ContextPtr                                              context_;
                 boost::asio::ip::udp::endpoint                          dnsserverEP_;
                 boost::asio::ip::address                                interfaceIP_;
-                VirtualEthernetNetworkTcpipConnectionTable              connections_;
+                VirtualEthernetNetworkTcpipConnectionShardedTable       connections_;
                 ITransmissionStatisticsPtr                              statistics_;
                 VirtualEthernetManagedServerPtr                         managed_server_;
                 VirtualEthernetNamespaceCachePtr                        namespace_cache_;
+                VirtualEthernetDatagramNatTable                         datagram_nats_;
 
                 CiphertextPtr                                           static_echo_protocol_;
                 CiphertextPtr                                           static_echo_transport_;
-                boost::asio::ip::udp::socket                            static_echo_socket_;
                 int                                                     static_echo_bind_port_ = 0;
-                std::shared_ptr<Byte>                                   static_echo_buffers_;
-                boost::asio::ip::udp::endpoint                          static_echo_source_ep_;
+                ppp::vector<StaticEchoShardPtr>                         static_echo_shards_;
                 VirtualEthernetStaticEchoAllocatedTable                 static_echo_allocateds_;
 
                 std::shared_ptr<boost::asio::ip::tcp::acceptor>         acceptors_[NetworkAcceptorCategories_Max];
@@ -34,8 +34,8 @@ namespace ppp {
                     return false;
                 }
 
-                boost::asio::ip::udp::socket& socket = switcher_->static_echo_socket_;
-                if (!socket.is_open()) {
+                VirtualEthernetSwitcher::StaticEchoShardPtr shard = switcher_->GetStaticEchoShard();
+                if (NULL == shard || !shard->Socket.is_open()) {
                     return false;
                 }
 
@@ -48,11 +48,7 @@ namespace ppp {
                     return false;
                 }
 
-                boost::system::error_code ec;
-                socket.send_to(boost::asio::buffer(packet_output.get(), packet_length),
-                    exchanger_->static_echo_source_ep_, boost::asio::socket_base::message_end_of_record, ec);
-
-                if (ec) {
+                if (!shard->Batch->SendTo(shard, packet_output.get(), packet_length, exchanger_->StaticEchoGetSourceEP())) {
                     return false;
                 }
                 
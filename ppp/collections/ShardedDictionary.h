@@ -0,0 +1,108 @@
+#pragma once
+
+#include <ppp/stdafx.h>
+#include <ppp/collections/Dictionary.h>
+
+namespace ppp {
+    namespace collections {
+        // A hash table split into independently locked shards, an operation on one key only takes the lock of the shard the key
+        // Hashes to. Draining takes one shard at a time and leaves releasing the objects to the caller with no lock held.
+        template <typename TKey, typename TValue, int SHARDS = 64>
+        class ShardedDictionary final {
+            static_assert(SHARDS > 0 && (SHARDS & (SHARDS - 1)) == 0, "The number of shards must be a power of two.");
+
+        public:
+            typedef ppp::unordered_map<TKey, TValue>                Table;
+            typedef std::mutex                                      SynchronizedObject;
+            typedef std::lock_guard<SynchronizedObject>             SynchronizedObjectScope;
+
+        public:
+            // Runs the handler on the table of the key's shard while holding that shard's lock only.
+            template <typename Handler>
+            auto                                                    Synchronized(const TKey& key, Handler&& handler) noexcept -> decltype(handler(std::declval<Table&>())) {
+                Shard& shard = GetShard(key);
+                SynchronizedObjectScope scope(shard.syncobj);
+                return handler(shard.objects);
+            }
+
+            bool                                                    TryGetValue(const TKey& key, TValue& value) noexcept {
+                return Synchronized(key,
+                    [&key, &value](Table& objects) noexcept {
+                        return Dictionary::TryGetValue(objects, key, value);
+                    });
+            }
+
+            TValue                                                  FindObjectByKey(const TKey& key) noexcept {
+                return Synchronized(key,
+                    [&key](Table& objects) noexcept {
+                        return Dictionary::FindObjectByKey(objects, key);
+                    });
+            }
+
+            bool                                                    ContainsKey(const TKey& key) noexcept {
+                return Synchronized(key,
+                    [&key](Table& objects) noexcept {
+                        return Dictionary::ContainsKey(objects, key);
+                    });
+            }
+
+            bool                                                    TryAdd(const TKey& key, const TValue& value) noexcept {
+                return Synchronized(key,
+                    [&key, &value](Table& objects) noexcept {
+                        return Dictionary::TryAdd(objects, key, value);
+                    });
+            }
+
+            bool                                                    TryRemove(const TKey& key, TValue& value) noexcept {
+                return Synchronized(key,
+                    [&key, &value](Table& objects) noexcept {
+                        return Dictionary::TryRemove(objects, key, value);
+                    });
+            }
+
+            int                                                     Count() noexcept {
+                std::size_t count = 0;
+                for (Shard& shard : shards_) {
+                    SynchronizedObjectScope scope(shard.syncobj);
+                    count += shard.objects.size();
+                }
+
+                return static_cast<int>(count);
+            }
+
+            // Drains every shard into objects, the caller releases them with no lock held.
+            void                                                    MoveTo(Table& objects) noexcept {
+                for (Shard& shard : shards_) {
+                    SynchronizedObjectScope scope(shard.syncobj);
+                    for (auto&& kv : shard.objects) {
+                        objects[kv.first] = std::move(kv.second);
+                    }
+
+                    shard.objects.clear();
+                }
+            }
+
+            void                                                    Clear() noexcept {
+                for (Shard& shard : shards_) {
+                    SynchronizedObjectScope scope(shard.syncobj);
+                    shard.objects.clear();
+                }
+            }
+
+        private:
+            struct Shard {
+                SynchronizedObject                                  syncobj;
+                Table                                               objects;
+            };
+
+            Shard&                                                  GetShard(const TKey& key) noexcept {
+                // Fibonacci hashing, pointer keys keep their low bits zero and would otherwise crowd into a few shards.
+                uint64_t h = static_cast<uint64_t>(typename Table::hasher()(key)) * 0x9E3779B97F4A7C15ULL;
+                return shards_[static_cast<std::size_t>(h >> 32) & (SHARDS - 1)];
+            }
+
+        private:
+            Shard                                                   shards_[SHARDS];
+        };
+    }
+}
@@ -47,6 +47,9 @@ namespace ppp {
             config.udp.dns.ttl = PPP_DEFAULT_DNS_TTL;
             config.udp.inactive.timeout = PPP_UDP_INACTIVE_TIMEOUT;
             config.udp.listen.port = IPEndPoint::MinPort;
+            config.udp.listen.shards = 0;
+            config.udp.listen.steering = false;
+            config.udp.batch = PPP_UDP_BATCH_SIZE;
             config.udp.static_.dns = true;
             config.udp.static_.quic = true;
             config.udp.static_.icmp = true;
@@ -54,6 +57,10 @@ namespace ppp {
             config.udp.static_.servers.clear();
             config.udp.static_.keep_alived[0] = 0;
             config.udp.static_.keep_alived[1] = 0;
+            config.udp.nat.pool = 0;
+            config.udp.nat.full_cone.clear();
+            config.udp.nat.full_cone.emplace(PPP_STUN_SYS_PORT);
+            config.udp.nat.full_cone.emplace(PPP_STUN_GOOGLE_PORT);
 
             config.tcp.turbo = false;
             config.tcp.backlog = PPP_LISTEN_BACKLOG;
@@ -61,6 +68,8 @@ namespace ppp {
             config.tcp.listen.port = IPEndPoint::MinPort;
             config.tcp.connect.timeout = PPP_TCP_CONNECT_TIMEOUT;
             config.tcp.inactive.timeout = PPP_TCP_INACTIVE_TIMEOUT;
+            config.tcp.mux.connections = 0;
+            config.tcp.mux.window = PPP_MUX_WINDOW_SIZE;
 
             config.websocket.listen.ws = IPEndPoint::MinPort;
             config.websocket.listen.wss = IPEndPoint::MinPort;
@@ -269,6 +278,17 @@ namespace ppp {
                 config.udp.inactive.timeout = PPP_UDP_INACTIVE_TIMEOUT;
             }
 
+            if (config.udp.listen.shards < 0) {
+                config.udp.listen.shards = 0;
+            }
+
+            if (config.udp.batch < 1) {
+                config.udp.batch = PPP_UDP_BATCH_SIZE;
+            }
+            elif(config.udp.batch > PPP_UDP_BATCH_MAX) {
+                config.udp.batch = PPP_UDP_BATCH_MAX;
+            }
+
             if (config.tcp.backlog < 1) {
                 config.tcp.backlog = PPP_LISTEN_BACKLOG;
             }
@@ -281,10 +301,25 @@ namespace ppp {
                 config.tcp.inactive.timeout = PPP_TCP_INACTIVE_TIMEOUT;
             }
 
+            if (config.tcp.mux.connections < 0) {
+                config.tcp.mux.connections = 0;
+            }
+
+            if (config.tcp.mux.window < 1) {
+                config.tcp.mux.window = PPP_MUX_WINDOW_SIZE;
+            }
+            elif(config.tcp.mux.window < PPP_BUFFER_SIZE) {
+                config.tcp.mux.window = PPP_BUFFER_SIZE;
+            }
+
             if (config.udp.static_.aggligator < 0) {
                 config.udp.static_.aggligator = 0;
             }
 
+            if (config.udp.nat.pool < 0) {
+                config.udp.nat.pool = 0;
+            }
+
             LRTrim(config, 0);
             LRTrim(config, 1);
 
@@ -572,6 +607,23 @@ namespace ppp {
             return true;
         }
 
+        static bool ReadJsonAllPortsToSet(const Json::Value& json, ppp::unordered_set<int>& s) noexcept {
+            s.clear();
+
+            ppp::unordered_set<ppp::string> sets;
+            if (!ReadJsonAllTokensToSet(json, sets)) {
+                return false;
+            }
+
+            for (const ppp::string& port_string : sets) {
+                int port = atoi(port_string.data());
+                if (port > IPEndPoint::MinPort && port <= IPEndPoint::MaxPort) {
+                    s.emplace(port);
+                }
+            }
+            return true;
+        }
+
         /*
          * Author: Binjie09 (AI Assistant)
          *
@@ -603,6 +655,9 @@ namespace ppp {
             config.udp.dns.ttl = JsonAuxiliary::AsValue<int>(json["udp"]["dns"]["ttl"]);
             config.udp.dns.redirect = JsonAuxiliary::AsValue<ppp::string>(json["udp"]["dns"]["redirect"]);
             config.udp.listen.port = JsonAuxiliary::AsValue<int>(json["udp"]["listen"]["port"]);
+            config.udp.listen.shards = JsonAuxiliary::AsValue<int>(json["udp"]["listen"]["shards"]);
+            config.udp.listen.steering = JsonAuxiliary::AsValue<bool>(json["udp"]["listen"]["steering"]);
+            config.udp.batch = JsonAuxiliary::AsValue<int>(json["udp"]["batch"]);
             config.udp.static_.dns = JsonAuxiliary::AsValue<bool>(json["udp"]["static"]["dns"]);
             config.udp.static_.quic = JsonAuxiliary::AsValue<bool>(json["udp"]["static"]["quic"]);
             config.udp.static_.icmp = JsonAuxiliary::AsValue<bool>(json["udp"]["static"]["icmp"]);
@@ -610,6 +665,10 @@ namespace ppp {
             config.udp.static_.keep_alived[0] = JsonAuxiliary::AsValue<int>(json["udp"]["static"]["keep-alived"][0]);
             config.udp.static_.keep_alived[1] = JsonAuxiliary::AsValue<int>(json["udp"]["static"]["keep-alived"][1]);
             ReadJsonAllAddressStringToSet(json["udp"]["static"]["servers"], config.udp.static_.servers);
+            config.udp.nat.pool = JsonAuxiliary::AsValue<int>(json["udp"]["nat"]["pool"]);
+            if (Json::Value& full_cone = json["udp"]["nat"]["full-cone"]; !full_cone.isNull()) {
+                ReadJsonAllPortsToSet(full_cone, config.udp.nat.full_cone);
+            }
 
             config.tcp.inactive.timeout = JsonAuxiliary::AsValue<int>(json["tcp"]["inactive"]["timeout"]);
             config.tcp.connect.timeout = JsonAuxiliary::AsValue<int>(json["tcp"]["connect"]["timeout"]);
@@ -617,6 +676,8 @@ namespace ppp {
             config.tcp.turbo = JsonAuxiliary::AsValue<bool>(json["tcp"]["turbo"]);
             config.tcp.backlog = JsonAuxiliary::AsValue<int>(json["tcp"]["backlog"]);
             config.tcp.fast_open = JsonAuxiliary::AsValue<bool>(json["tcp"]["fast-open"]);
+            config.tcp.mux.connections = JsonAuxiliary::AsValue<int>(json["tcp"]["mux"]["connections"]);
+            config.tcp.mux.window = JsonAuxiliary::AsValue<int>(json["tcp"]["mux"]["window"]);
 
             config.websocket.listen.ws = JsonAuxiliary::AsValue<int>(json["websocket"]["listen"]["ws"]);
             config.websocket.listen.wss = JsonAuxiliary::AsValue<int>(json["websocket"]["listen"]["wss"]);
@@ -710,6 +771,9 @@ namespace ppp {
             udp["dns"]["ttl"] = config.udp.dns.ttl;
             udp["dns"]["redirect"] = config.udp.dns.redirect;
             udp["listen"]["port"] = config.udp.listen.port;
+            udp["listen"]["shards"] = config.udp.listen.shards;
+            udp["listen"]["steering"] = config.udp.listen.steering;
+            udp["batch"] = config.udp.batch;
 
             // Set keep-alived structure
             Json::Value keep_alived(Json::arrayValue);
@@ -730,6 +794,15 @@ namespace ppp {
             udp["static"]["quic"] = config.udp.static_.quic;
             udp["static"]["icmp"] = config.udp.static_.icmp;
             udp["static"]["aggligator"] = config.udp.static_.aggligator;
+
+            // Set nat structure
+            Json::Value full_cone(Json::arrayValue);
+            for (int port : config.udp.nat.full_cone) {
+                full_cone.append(port);
+            }
+
+            udp["nat"]["pool"] = config.udp.nat.pool;
+            udp["nat"]["full-cone"] = full_cone;
             root["udp"] = udp;
 
             // Set tcp structure
@@ -740,6 +813,8 @@ namespace ppp {
             tcp["turbo"] = config.tcp.turbo;
             tcp["backlog"] = config.tcp.backlog;
             tcp["fast-open"] = config.tcp.fast_open;
+            tcp["mux"]["connections"] = config.tcp.mux.connections;
+            tcp["mux"]["window"] = config.tcp.mux.window;
             root["tcp"] = tcp;
 
             // Set websocket structure
@@ -35,7 +35,10 @@ namespace ppp {
                 }                                                           dns;
                 struct {
                     int                                                     port;
+                    int                                                     shards;   // SO_REUSEPORT sockets of the static echo port, 0 is one per executor.
+                    bool                                                    steering; // Pin a client address to one of those sockets.
                 }                                                           listen;
+                int                                                         batch;
                 struct {
                     int                                                     keep_alived[2];
                     bool                                                    dns;
@@ -44,6 +47,10 @@ namespace ppp {
                     int                                                     aggligator;
                     ppp::unordered_set<ppp::string>                         servers;
                 }                                                           static_;
+                struct {
+                    int                                                     pool;
+                    ppp::unordered_set<int>                                 full_cone;
+                }                                                           nat;
             }                                                               udp;
             struct {
                 struct {
@@ -58,6 +65,10 @@ namespace ppp {
                 bool                                                        turbo;
                 int                                                         backlog;
                 bool                                                        fast_open;
+                struct {
+                    int                                                     connections; // Pooled links the client multiplexes its tcp flows over, 0 is one link per flow.
+                    int                                                     window;      // Bytes a stream may have in flight before the receiver grants more.
+                }                                                           mux;
             }                                                               tcp;
             struct {
                 struct {
@@ -0,0 +1,513 @@
+#include <ppp/coroutines/StackAllocator.h>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#include <stdio.h>
+#endif
+
+namespace ppp
+{
+    namespace coroutines
+    {
+        static std::atomic<int64_t>                                             StackAllocator_Live      = 0;
+        static std::atomic<int64_t>                                             StackAllocator_Peak      = 0;
+        static std::atomic<int64_t>                                             StackAllocator_Pooled    = 0;
+        static std::atomic<int64_t>                                             StackAllocator_Guarded   = 0;
+        static std::atomic<int64_t>                                             StackAllocator_Refused   = 0;
+        static std::atomic<int64_t>                                             StackAllocator_Mapped    = 0;
+        static std::atomic<int64_t>                                             StackAllocator_HighWater = 0;
+        static std::atomic<uint64_t>                                            StackAllocator_Frees     = 0;
+
+        static int StackAllocator_GetDefaultSize() noexcept
+        {
+            int pagesize = GetMemoryPageSize();
+            return (PPP_COROUTINE_STACK_SIZE + pagesize - 1) / pagesize * pagesize;
+        }
+
+        // Address space only, nothing is committed until a stack is prepared in it and touched.
+        static Byte* StackAllocator_Reserve(std::size_t length) noexcept
+        {
+#if defined(_WIN32)
+            Byte* memory = (Byte*)VirtualAlloc(NULL, length, MEM_RESERVE, PAGE_NOACCESS);
+            if (NULL == memory)
+            {
+                return NULL;
+            }
+#else
+            int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#if defined(MAP_NORESERVE)
+            flags |= MAP_NORESERVE;
+#endif
+
+            Byte* memory = (Byte*)mmap(NULL, length, PROT_READ | PROT_WRITE, flags, -1, 0);
+            if (MAP_FAILED == (void*)memory)
+            {
+                return NULL;
+            }
+#endif
+
+            StackAllocator_Mapped += (int64_t)length;
+            return memory;
+        }
+
+        static void StackAllocator_Release(Byte* memory, std::size_t length) noexcept
+        {
+#if defined(_WIN32)
+            VirtualFree(memory, 0, MEM_RELEASE);
+#else
+            munmap(memory, length);
+#endif
+
+            StackAllocator_Mapped -= (int64_t)length;
+        }
+
+#if defined(_LINUX)
+        static int64_t StackAllocator_ReadMapCount() noexcept
+        {
+            long long max_map_count = 0;
+            FILE* f = fopen("/proc/sys/vm/max_map_count", "r");
+            if (NULL != f)
+            {
+                if (fscanf(f, "%lld", &max_map_count) != 1)
+                {
+                    max_map_count = 0;
+                }
+
+                fclose(f);
+            }
+
+            return max_map_count;
+        }
+#endif
+
+        // Stacks that may be mapped at once, on linux every guard page splits its mapping so each stack costs two map entries.
+        // Worked out once: vm.max_map_count is raised to MAP_COUNT when it is lower and the process may, RESERVE_MAPS stay for the rest.
+        static int64_t StackAllocator_GetGuardBudget() noexcept
+        {
+#if defined(_LINUX)
+            static const int64_t budget = []() noexcept -> int64_t
+                {
+                    int64_t max_map_count = StackAllocator_ReadMapCount();
+                    if (max_map_count > 0 && max_map_count < StackAllocator::MAP_COUNT)
+                    {
+                        FILE* f = fopen("/proc/sys/vm/max_map_count", "w");
+                        if (NULL != f)
+                        {
+                            fprintf(f, "%d", StackAllocator::MAP_COUNT);
+                            fclose(f);
+                            max_map_count = StackAllocator_ReadMapCount();
+                        }
+                    }
+
+                    if (max_map_count < 1)
+                    {
+                        return INT64_MAX;
+                    }
+
+                    return std::max<int64_t>(max_map_count - StackAllocator::RESERVE_MAPS, 0) / 2;
+                }();
+            return budget;
+#else
+            return INT64_MAX;
+#endif
+        }
+
+        // Every stack gets a guard page, a stack that would run the process out of map entries is refused instead of carved without one.
+        static bool StackAllocator_TakeGuard() noexcept
+        {
+            int64_t budget = StackAllocator_GetGuardBudget();
+            int64_t guarded = StackAllocator_Guarded.load();
+            while (guarded < budget)
+            {
+                if (StackAllocator_Guarded.compare_exchange_weak(guarded, guarded + 1))
+                {
+                    return true;
+                }
+            }
+
+            if (StackAllocator_Refused++ == 0)
+            {
+                LOG_ERROR("Coroutine stacks reached the vm.max_map_count budget of %lld guarded stacks, new coroutines are refused, "
+                    "raise it for instance with \"sysctl -w vm.max_map_count=%d\".", (long long)budget, StackAllocator::MAP_COUNT * 2);
+            }
+
+            return false;
+        }
+
+#if defined(_WIN32)
+        // Laid out like a thread stack: the top is committed, the page under it is committed as PAGE_GUARD and the rest is only reserved.
+        // The context switch publishes the stack bounds in the thread information block, so the system grows it on demand.
+        static bool StackAllocator_Commit(Byte* stack, int stack_size, int keep_size) noexcept
+        {
+            int pagesize = GetMemoryPageSize();
+            keep_size = std::min<int>(std::max<int>(keep_size, pagesize), stack_size);
+
+            Byte* top = stack + stack_size - keep_size;
+            if (NULL == VirtualAlloc(top, keep_size, MEM_COMMIT, PAGE_READWRITE))
+            {
+                return false;
+            }
+
+            if (top > stack && NULL == VirtualAlloc(top - pagesize, pagesize, MEM_COMMIT, PAGE_READWRITE | PAGE_GUARD))
+            {
+                return false;
+            }
+
+            return true;
+        }
+#endif
+
+        // Sets up a stack freshly carved out of reserved memory, the page right below it is the guard.
+        static bool StackAllocator_Prepare(Byte* stack, int stack_size) noexcept
+        {
+#if defined(_WIN32)
+            return StackAllocator_Commit(stack, stack_size, StackAllocator::KEEP_SIZE);
+#else
+            int pagesize = GetMemoryPageSize();
+            return mprotect(stack - pagesize, pagesize, PROT_NONE) == 0;
+#endif
+        }
+
+        // Hands the pages below the top keep_size bytes of the stack back to the system, they read as zero the next time they are touched.
+        static void StackAllocator_Trim(Byte* stack, int stack_size, int keep_size) noexcept
+        {
+            int length = stack_size - keep_size;
+            if (length < 1)
+            {
+                return;
+            }
+
+#if defined(_WIN32)
+            VirtualFree(stack, length, MEM_DECOMMIT);
+            StackAllocator_Commit(stack, stack_size, keep_size);
+#else
+            madvise(stack, length, MADV_DONTNEED);
+#endif
+        }
+
+        // The resident pages of a stack tell how deep it went, probed on one free in 64 since mincore is a system call.
+        static void StackAllocator_Sample(Byte* stack, int stack_size) noexcept
+        {
+#if defined(_LINUX)
+            if ((StackAllocator_Frees++ & 63) != 0)
+            {
+                return;
+            }
+
+            int pagesize = GetMemoryPageSize();
+            int pages = stack_size / pagesize;
+
+            unsigned char vec[256];
+            if (pages < 1 || pages > (int)sizeof(vec) || mincore(stack, stack_size, vec) < 0)
+            {
+                return;
+            }
+
+            int page = 0;
+            while (page < pages && (vec[page] & 1) == 0)
+            {
+                page++;
+            }
+
+            int64_t depth = (int64_t)(pages - page) * pagesize;
+            int64_t high_water = StackAllocator_HighWater.load();
+            while (depth > high_water && !StackAllocator_HighWater.compare_exchange_weak(high_water, depth))
+            {
+            }
+#endif
+        }
+
+        class StackDepot final
+        {
+        public:
+            std::mutex                                                          Lock;
+            ppp::vector<Byte*>                                                  Stacks;             /* Trimmed down to KEEP_SIZE. */
+            ppp::vector<Byte*>                                                  Colds;              /* Trimmed down to their top page. */
+            ppp::map<Byte*, int>                                                Slabs;              /* Base of every slab and how many of its stacks are cold. */
+            Byte*                                                               Slab     = NULL;
+            int                                                                 SlabNext = 0;
+        };
+
+        // Never destroyed, the thread caches flush into it from thread-exit destructors that may run after static destruction.
+        static StackDepot* StackAllocator_GetDepot() noexcept
+        {
+            static StackDepot* depot = new StackDepot();
+            return depot;
+        }
+
+        static std::size_t StackAllocator_GetSlotSize() noexcept
+        {
+            return (std::size_t)StackAllocator_GetDefaultSize() + GetMemoryPageSize();
+        }
+
+        // Slots of a slab alternate a guard page and a stack, the slab is unmapped again once all of its stacks went cold in the depot.
+        static Byte* StackAllocator_Carve(int stack_size) noexcept
+        {
+            if (!StackAllocator_TakeGuard())
+            {
+                return NULL;
+            }
+
+            int pagesize = GetMemoryPageSize();
+            std::size_t slot = StackAllocator_GetSlotSize();
+
+            Byte* stack = NULL;
+            for (StackDepot* depot = StackAllocator_GetDepot();;)
+            {
+                std::lock_guard<std::mutex> scope(depot->Lock);
+                if (NULL == depot->Slab || depot->SlabNext >= StackAllocator::SLAB_STACKS)
+                {
+                    Byte* slab = StackAllocator_Reserve(slot * StackAllocator::SLAB_STACKS);
+                    if (NULL == slab)
+                    {
+                        StackAllocator_Guarded--;
+                        return NULL;
+                    }
+
+                    depot->Slab = slab;
+                    depot->SlabNext = 0;
+                    depot->Slabs[slab] = 0;
+                }
+
+                stack = depot->Slab + slot * depot->SlabNext++ + pagesize;
+                break;
+            }
+
+            // A slot that cannot be prepared stays behind in the slab, it is only address space and keeps the slab mapped.
+            if (!StackAllocator_Prepare(stack, stack_size))
+            {
+                StackAllocator_Guarded--;
+                return NULL;
+            }
+
+            return stack;
+        }
+
+        // Counts a stack of the default size in or out of the cold stacks of its slab, the caller holds the lock of the depot.
+        // Returns the base of the slab once every one of its stacks is cold, it has then been taken out of the depot.
+        static Byte* StackAllocator_Cold(StackDepot* depot, Byte* stack, int cold) noexcept
+        {
+            auto tail = depot->Slabs.upper_bound(stack);
+            if (tail == depot->Slabs.begin())
+            {
+                return NULL;
+            }
+
+            --tail;
+            tail->second += cold;
+            if (tail->second < StackAllocator::SLAB_STACKS)
+            {
+                return NULL;
+            }
+
+            Byte* slab = tail->first;
+            Byte* slab_end = slab + StackAllocator_GetSlotSize() * StackAllocator::SLAB_STACKS;
+            depot->Colds.erase(std::remove_if(depot->Colds.begin(), depot->Colds.end(),
+                [slab, slab_end](Byte* p) noexcept
+                {
+                    return p >= slab && p < slab_end;
+                }), depot->Colds.end());
+
+            depot->Slabs.erase(tail);
+            if (depot->Slab == slab)
+            {
+                depot->Slab = NULL;
+            }
+
+            return slab;
+        }
+
+        static Byte* StackAllocator_Map(int stack_size) noexcept
+        {
+            int pagesize = GetMemoryPageSize();
+            std::size_t length = (std::size_t)stack_size + pagesize;
+
+            Byte* memory = StackAllocator_Reserve(length);
+            if (NULL == memory)
+            {
+                return NULL;
+            }
+
+            Byte* stack = memory + pagesize;
+            if (!StackAllocator_Prepare(stack, stack_size))
+            {
+                StackAllocator_Guarded--;
+                StackAllocator_Release(memory, length);
+                return NULL;
+            }
+
+            return stack;
+        }
+
+        static void StackAllocator_Unmap(Byte* stack, int stack_size) noexcept
+        {
+            int pagesize = GetMemoryPageSize();
+            StackAllocator_Guarded--;
+            StackAllocator_Release(stack - pagesize, (std::size_t)stack_size + pagesize);
+        }
+
+        // Stacks leaving a thread are trimmed first, the depot keeps DEPOT_STACKS of them warm and the rest down to a single page.
+        static void StackAllocator_Deposit(Byte* stack, int stack_size) noexcept
+        {
+            bool warm = false;
+            StackDepot* depot = StackAllocator_GetDepot();
+            for (std::lock_guard<std::mutex> scope(depot->Lock);;)
+            {
+                warm = depot->Stacks.size() < StackAllocator::DEPOT_STACKS;
+                break;
+            }
+
+            StackAllocator_Trim(stack, stack_size, warm ? StackAllocator::KEEP_SIZE : GetMemoryPageSize());
+
+            Byte* slab = NULL;
+            for (std::lock_guard<std::mutex> scope(depot->Lock);;)
+            {
+                if (warm)
+                {
+                    depot->Stacks.emplace_back(stack);
+                }
+                else
+                {
+                    depot->Colds.emplace_back(stack);
+                    slab = StackAllocator_Cold(depot, stack, 1);
+                }
+
+                break;
+            }
+
+            // Nothing of an idle slab is in use any more, its stacks and guards go back to the system in one piece.
+            if (NULL != slab)
+            {
+                StackAllocator_Guarded -= StackAllocator::SLAB_STACKS;
+                StackAllocator_Pooled -= StackAllocator::SLAB_STACKS;
+                StackAllocator_Release(slab, StackAllocator_GetSlotSize() * StackAllocator::SLAB_STACKS);
+            }
+        }
+
+        class StackCache final
+        {
+        public:
+            ppp::vector<Byte*>                                                  Stacks;
+
+        public:
+            ~StackCache() noexcept
+            {
+                int stack_size = StackAllocator_GetDefaultSize();
+                for (Byte* stack : Stacks)
+                {
+                    StackAllocator_Deposit(stack, stack_size);
+                }
+
+                Stacks.clear();
+            }
+        };
+
+        static thread_local StackCache                                          StackAllocator_Cache;
+
+        Byte* StackAllocator::Allocate(int& stack_size) noexcept
+        {
+            int pagesize = GetMemoryPageSize();
+            stack_size = (std::max<int>(stack_size, pagesize) + pagesize - 1) / pagesize * pagesize;
+
+            Byte* stack = NULL;
+            if (stack_size == StackAllocator_GetDefaultSize())
+            {
+                ppp::vector<Byte*>& stacks = StackAllocator_Cache.Stacks;
+                if (stacks.size() > 0)
+                {
+                    stack = stacks.back();
+                    stacks.pop_back();
+                }
+                else
+                {
+                    StackDepot* depot = StackAllocator_GetDepot();
+                    std::lock_guard<std::mutex> scope(depot->Lock);
+                    if (depot->Stacks.size() > 0)
+                    {
+                        stack = depot->Stacks.back();
+                        depot->Stacks.pop_back();
+                    }
+                    else if (depot->Colds.size() > 0)
+                    {
+                        stack = depot->Colds.back();
+                        depot->Colds.pop_back();
+                        StackAllocator_Cold(depot, stack, -1);
+                    }
+                }
+
+                if (NULL != stack)
+                {
+                    StackAllocator_Pooled--;
+                }
+                else
+                {
+                    stack = StackAllocator_Carve(stack_size);
+                    if (NULL == stack)
+                    {
+                        return NULL;
+                    }
+                }
+            }
+            else
+            {
+                stack = StackAllocator_Map(stack_size);
+                if (NULL == stack)
+                {
+                    return NULL;
+                }
+            }
+
+            int64_t live = ++StackAllocator_Live;
+            int64_t peak = StackAllocator_Peak.load();
+            while (live > peak && !StackAllocator_Peak.compare_exchange_weak(peak, live))
+            {
+            }
+
+            return stack;
+        }
+
+        void StackAllocator::Free(Byte* stack, int stack_size) noexcept
+        {
+            if (NULL == stack)
+            {
+                return;
+            }
+
+            StackAllocator_Live--;
+            StackAllocator_Sample(stack, stack_size);
+
+            if (stack_size != StackAllocator_GetDefaultSize())
+            {
+                StackAllocator_Unmap(stack, stack_size);
+                return;
+            }
+
+            // Only the stacks leaving the thread are trimmed, the ones cached for reuse on the thread stay warm.
+            StackAllocator_Pooled++;
+
+            ppp::vector<Byte*>& stacks = StackAllocator_Cache.Stacks;
+            if (stacks.size() < CACHE_STACKS)
+            {
+                stacks.emplace_back(stack);
+            }
+            else
+            {
+                StackAllocator_Deposit(stack, stack_size);
+            }
+        }
+
+        void StackAllocator::GetStatistics(StackStatistics& statistics) noexcept
+        {
+            statistics.Live      = StackAllocator_Live.load();
+            statistics.Peak      = StackAllocator_Peak.load();
+            statistics.Pooled    = StackAllocator_Pooled.load();
+            statistics.Guarded   = StackAllocator_Guarded.load();
+            statistics.Refused   = StackAllocator_Refused.load();
+            statistics.Mapped    = StackAllocator_Mapped.load();
+            statistics.HighWater = StackAllocator_HighWater.load();
+        }
+    }
+}
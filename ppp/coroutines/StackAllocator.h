@@ -0,0 +1,46 @@
+#pragma once
+
+#include <ppp/stdafx.h>
+
+namespace ppp
+{
+    namespace coroutines
+    {
+        // Coroutine stacks mapped straight from the system with a guard page below them, their pages are only committed once the
+        // Coroutine touches them. Stacks of the default size are carved out of large slabs and recycled through a cache of the
+        // Executor thread that released them and, past that, through a shared depot where they are kept trimmed down to their top pages.
+        //
+        // Every stack has a guard page. On linux each guard splits its mapping in two, so a stack costs two entries of vm.max_map_count
+        // (65530 by default): the limit is raised to MAP_COUNT on first use when the process may, and stacks past what it leaves room for
+        // Are refused with an error rather than carved unguarded. Slabs whose stacks all went cold are unmapped again.
+        class StackAllocator final
+        {
+        public:
+            static constexpr int                                                CACHE_STACKS = 32;
+            static constexpr int                                                DEPOT_STACKS = 1024;   /* Stacks the depot keeps warm, the rest are trimmed completely. */
+            static constexpr int                                                SLAB_STACKS  = 64;     /* Stacks of the default size carved out of one mapping. */
+            static constexpr int                                                MAP_COUNT    = 262144; /* vm.max_map_count asked for when it is lower. */
+            static constexpr int                                                RESERVE_MAPS = 16384;  /* Map entries left to the rest of the process. */
+            static constexpr int                                                KEEP_SIZE    = 8192;   /* Top of a stack left resident when it goes to the depot. */
+
+        public:
+            class StackStatistics
+            {
+            public:
+                int64_t                                                         Live      = 0; /* Stacks held by running coroutines. */
+                int64_t                                                         Peak      = 0; /* Most stacks ever live at once. */
+                int64_t                                                         Pooled    = 0; /* Stacks kept in the thread caches and the depot. */
+                int64_t                                                         Guarded   = 0; /* Stacks carved with a guard page below them. */
+                int64_t                                                         Refused   = 0; /* Stacks refused for want of map entries. */
+                int64_t                                                         Mapped    = 0; /* Bytes of address space reserved for all of them. */
+                int64_t                                                         HighWater = 0; /* Deepest stack use seen, sampled, linux only. */
+            };
+
+        public:
+            // Returns the lowest usable address, stack_size is rounded up to whole pages.
+            static Byte*                                                        Allocate(int& stack_size) noexcept;
+            static void                                                         Free(Byte* stack, int stack_size) noexcept;
+            static void                                                         GetStatistics(StackStatistics& statistics) noexcept;
+        };
+    }
+}
@@ -1,4 +1,5 @@
 #include <ppp/coroutines/YieldContext.h>
+#include <ppp/coroutines/StackAllocator.h>
 
 namespace ppp
 {
@@ -12,31 +13,18 @@ namespace ppp
             , context_(context)
             , strand_(strand)
             , stack_size_(stack_size)
+            , stack_(NULL)
             , allocator_(allocator)
         {
-            if (allocator)
-            {
-                Byte* stack = (Byte*)allocator->Alloc(stack_size);
-                if (stack)
-                {
-                    stack_ = std::shared_ptr<Byte>(stack, /* std::bind(&ppp::threading::BufferswapAllocator::Free, allocator, std::placeholders::_1)); */
-                        [allocator](Byte* p) noexcept 
-                        {
-                            allocator->Free(p);
-                        });
-                }
-            }
-
-            /* boost::context::stack_traits::minimum_size(); */
-            if (!stack_)
-            {
-                stack_ = make_shared_alloc<Byte>(stack_size);
-            }
+            // Stacks no longer come from the buffer allocator, an idle coroutine only keeps the pages it actually touched resident.
+            stack_ = StackAllocator::Allocate(stack_size_);
         }
 
         YieldContext::~YieldContext() noexcept
         {
             YieldContext* y = this;
+            StackAllocator::Free(y->stack_, y->stack_size_);
+
             y->h_          = NULL;
             y->stack_      = NULL;
             y->stack_size_ = 0;
@@ -78,7 +66,7 @@ namespace ppp
         void YieldContext::Invoke() noexcept
         {
             YieldContext* y = this;
-            if (Byte* stack = stack_.get(); stack)
+            if (Byte* stack = stack_; stack)
             {
                 boost::context::detail::fcontext_t callee =
                     boost::context::detail::make_fcontext(stack + stack_size_, stack_size_, &YieldContext::Handle);
@@ -153,6 +141,11 @@ namespace ppp
             {
                 return false;
             }
+            else if (NULL == y->stack_)
+            {
+                YieldContext::Release(y);
+                return false;
+            }
 
             // By default the C/C++ compiler optimizes the context delegate event call, and strand is usually multi-core driven if it occurs.
             auto invoked =
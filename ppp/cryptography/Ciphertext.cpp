@@ -39,6 +39,28 @@ namespace ppp {
             return NULL;
         }
 
+        bool Ciphertext::Encrypt(Byte* data, int datalen, Byte* output) noexcept {
+            if (NULL != evp_) {
+                return evp_->Encrypt(data, datalen, output);
+            }
+
+            if (NULL != rc4_) {
+                return rc4_->Encrypt(data, datalen, output);
+            }
+            return false;
+        }
+
+        bool Ciphertext::Decrypt(Byte* data, int datalen, Byte* output) noexcept {
+            if (NULL != evp_) {
+                return evp_->Decrypt(data, datalen, output);
+            }
+
+            if (NULL != rc4_) {
+                return rc4_->Decrypt(data, datalen, output);
+            }
+            return false;
+        }
+
         bool Ciphertext::Support(const ppp::string& method) noexcept {
             if (method.empty()) {
                 return false;
@@ -16,6 +16,11 @@ namespace ppp {
             std::shared_ptr<Ciphertext>                         GetReference() noexcept { return this->shared_from_this(); }
             static bool                                         Support(const ppp::string& method) noexcept;
 
+        public:
+            // Writes exactly datalen bytes into output, which may be the input buffer itself (in-place).
+            bool                                                Encrypt(Byte* data, int datalen, Byte* output) noexcept;
+            bool                                                Decrypt(Byte* data, int datalen, Byte* output) noexcept;
+
         private:
             std::shared_ptr<RC4>                                rc4_;
             std::shared_ptr<EVP>                                evp_;
@@ -60,8 +60,9 @@ namespace ppp {
             }
 
             // INIT-CTX
-            SynchronizedObjectScope scope(_syncobj);
-            if (EVP_CipherInit_ex(_encryptCTX.get(), _cipher, NULL, _key.get(), _iv.get(), 1) < 1) {
+            SynchronizedObjectScope scope(_encryptSyncobj);
+            EVP_CIPHER_CTX* context = resetCipher(1);
+            if (NULL == context) {
                 return NULL;
             }
 
@@ -72,7 +73,7 @@ namespace ppp {
                 return NULL;
             }
 
-            if (EVP_CipherUpdate(_encryptCTX.get(),
+            if (EVP_CipherUpdate(context,
                 cipherText.get(), &feedbacklen, data, datalen) < 1) {
                 outlen = ~0;
                 return NULL;
@@ -98,8 +99,9 @@ namespace ppp {
             }
 
             // INIT-CTX
-            SynchronizedObjectScope scope(_syncobj);
-            if (EVP_CipherInit_ex(_decryptCTX.get(), _cipher, NULL, _key.get(), _iv.get(), 0) < 1) {
+            SynchronizedObjectScope scope(_decryptSyncobj);
+            EVP_CIPHER_CTX* context = resetCipher(0);
+            if (NULL == context) {
                 return NULL;
             }
 
@@ -110,7 +112,7 @@ namespace ppp {
                 return NULL;
             }
 
-            if (EVP_CipherUpdate(_decryptCTX.get(),
+            if (EVP_CipherUpdate(context,
                 cipherText.get(), &feedbacklen, data, datalen) < 1) {
                 feedbacklen = ~0;
                 return NULL;
@@ -120,6 +122,59 @@ namespace ppp {
             return cipherText;
         }
 
+        bool EVP::Encrypt(Byte* data, int datalen, Byte* output) noexcept {
+            return updateCipher(1, data, datalen, output);
+        }
+
+        bool EVP::Decrypt(Byte* data, int datalen, Byte* output) noexcept {
+            return updateCipher(0, data, datalen, output);
+        }
+
+        EVP_CIPHER_CTX* EVP::resetCipher(int enc) noexcept {
+            EVP_CIPHER_CTX* context = enc ? _encryptCTX.get() : _decryptCTX.get();
+            if (NULL == context) {
+                return NULL;
+            }
+
+            // The key schedule stays in the context, rewinding the IV is all a packet needs. Ciphers without an IV (RC4) 
+            // Keep their whole state in the keystream and are keyed again instead.
+            if (EVP_CIPHER_iv_length(_cipher) > 0) {
+                if (EVP_CipherInit_ex(context, NULL, NULL, NULL, _iv.get(), enc) < 1) {
+                    return NULL;
+                }
+            }
+            else if (EVP_CipherInit_ex(context, NULL, NULL, _key.get(), NULL, enc) < 1) {
+                return NULL;
+            }
+
+            return context;
+        }
+
+        bool EVP::updateCipher(int enc, Byte* data, int datalen, Byte* output) noexcept {
+            if (NULL == data || NULL == output || datalen < 1) {
+                return false;
+            }
+
+            // Only stream-like modes (CFB, OFB, CTR, GCM...) emit exactly one byte per input byte, 
+            // Which is what allows the output to be a caller sized buffer or the input buffer itself.
+            if (NULL == _cipher || EVP_CIPHER_block_size(_cipher) != 1) {
+                return false;
+            }
+
+            SynchronizedObjectScope scope(enc ? _encryptSyncobj : _decryptSyncobj);
+            EVP_CIPHER_CTX* context = resetCipher(enc);
+            if (NULL == context) {
+                return false;
+            }
+
+            int feedbacklen = datalen;
+            if (EVP_CipherUpdate(context, output, &feedbacklen, data, datalen) < 1) {
+                return false;
+            }
+
+            return feedbacklen == datalen;
+        }
+
         bool EVP::initCipher(std::shared_ptr<EVP_CIPHER_CTX>& context, int enc) noexcept {
             bool exception = false;
             while (!context) {
@@ -148,6 +203,10 @@ namespace ppp {
                 if ((exception = EVP_CIPHER_CTX_set_padding(context.get(), 1) < 1)) {
                     break;
                 }
+
+                if ((exception = EVP_CipherInit_ex(context.get(), NULL, NULL, _key.get(), _iv.get(), enc) < 1)) {
+                    break;
+                }
             }
 
             if (exception) {
@@ -175,7 +234,7 @@ namespace ppp {
 
             // INIT-IVV
             int ivLen = EVP_CIPHER_iv_length(_cipher);
-            _iv = make_shared_alloc<Byte>(ivLen); // RAND_bytes(iv.get(), ivLen);
+            _iv = make_shared_alloc<Byte>(std::max<int>(ivLen, 1)); // RAND_bytes(iv.get(), ivLen); Stream ciphers such as RC4 have no IV at all.
             if (NULL == _iv) {
                 return false;
             }
@@ -16,6 +16,8 @@ namespace ppp {
         public:
             std::shared_ptr<Byte>                               Encrypt(const std::shared_ptr<ppp::threading::BufferswapAllocator>& allocator, Byte* data, int datalen, int& outlen) noexcept;
             std::shared_ptr<Byte>                               Decrypt(const std::shared_ptr<ppp::threading::BufferswapAllocator>& allocator, Byte* data, int datalen, int& outlen) noexcept;
+            bool                                                Encrypt(Byte* data, int datalen, Byte* output) noexcept;
+            bool                                                Decrypt(Byte* data, int datalen, Byte* output) noexcept;
             std::shared_ptr<EVP>                                GetReference() noexcept { return this->shared_from_this(); }
             SynchronizedObject&                                 GetSynchronizedObject() noexcept { return _syncobj; }
             static bool                                         Support(const ppp::string& method) noexcept;
@@ -23,15 +25,19 @@ namespace ppp {
         private:
             bool                                                initCipher(std::shared_ptr<EVP_CIPHER_CTX>& context, int enc) noexcept;
             bool                                                initKey(const ppp::string& method, const ppp::string password) noexcept;
+            bool                                                updateCipher(int enc, Byte* data, int datalen, Byte* output) noexcept;
+            EVP_CIPHER_CTX*                                     resetCipher(int enc) noexcept;
 
         private:
             SynchronizedObject                                  _syncobj;
+            SynchronizedObject                                  _encryptSyncobj; // One keyed context per direction, the packet path only rewinds its IV.
+            SynchronizedObject                                  _decryptSyncobj;
             const EVP_CIPHER*                                   _cipher = NULL;
             std::shared_ptr<Byte>                               _key; // _cipher->key_len
             std::shared_ptr<Byte>                               _iv;
             ppp::string                                         _method;
             ppp::string                                         _password;
-            std::shared_ptr<EVP_CIPHER_CTX>                     _encryptCTX;
+            std::shared_ptr<EVP_CIPHER_CTX>                     _encryptCTX; // Keyed once.
             std::shared_ptr<EVP_CIPHER_CTX>                     _decryptCTX;
         };
 
@@ -137,9 +137,7 @@ namespace ppp {
                 return NULL;
             }
 
-            memcpy(plaintext.get(), data, datalen);
-            if (!rc4_crypt_sbox_c((unsigned char*)_password.data(), _password.size(),
-                (unsigned char*)_sbox.get(), RC4_MAXBIT, (unsigned char*)plaintext.get(), datalen, _subtract, _E)) {
+            if (!Encrypt(data, datalen, plaintext.get())) {
                 return NULL;
             }
 
@@ -151,6 +149,23 @@ namespace ppp {
             return Encrypt(allocator, data, datalen, outlen);
         }
 
+        bool RC4::Encrypt(Byte* data, int datalen, Byte* output) noexcept {
+            if (NULL == data || NULL == output || datalen < 1) {
+                return false;
+            }
+
+            if (output != data) {
+                memcpy(output, data, datalen);
+            }
+
+            return rc4_crypt_sbox_c((unsigned char*)_password.data(), _password.size(),
+                (unsigned char*)_sbox.get(), RC4_MAXBIT, (unsigned char*)output, datalen, _subtract, _E);
+        }
+
+        bool RC4::Decrypt(Byte* data, int datalen, Byte* output) noexcept {
+            return Encrypt(data, datalen, output);
+        }
+
         bool RC4::Support(const ppp::string& method) noexcept {
             if (method.empty()) {
                 return false;
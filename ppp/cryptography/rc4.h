@@ -25,6 +25,8 @@ namespace ppp {
         public:
             std::shared_ptr<Byte>                                               Encrypt(const std::shared_ptr<ppp::threading::BufferswapAllocator>& allocator, Byte* data, int datalen, int& outlen) noexcept;
             std::shared_ptr<Byte>                                               Decrypt(const std::shared_ptr<ppp::threading::BufferswapAllocator>& allocator, Byte* data, int datalen, int& outlen) noexcept;
+            bool                                                                Encrypt(Byte* data, int datalen, Byte* output) noexcept;
+            bool                                                                Decrypt(Byte* data, int datalen, Byte* output) noexcept;
             std::shared_ptr<RC4>                                                GetReference() noexcept { return this->shared_from_this(); }
             static bool                                                         Support(const ppp::string& method) noexcept;
             static std::shared_ptr<RC4>                                         Create(const ppp::string& method, const ppp::string& password) noexcept;
@@ -1,5 +1,21 @@
 #include <ppp/cryptography/ssea.h>
 
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SSEA_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define SSEA_TARGET_SSE2
+#define SSEA_TARGET_AVX2
+#else
+#define SSEA_TARGET_SSE2 __attribute__((target("sse2")))
+#define SSEA_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define SSEA_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
 /* 96 printable characters(include tab)  */
 /* remove \ for compatibility            */
 /* remove tab for uniformity             */
@@ -16,14 +32,275 @@ namespace ppp
 {
     namespace cryptography
     {
+        // The vector kernels below must stay bit-exact with the scalar loops, which remain the reference implementation.
+        enum
+        {
+            SSEA_SIMD_SCALAR,
+            SSEA_SIMD_SSE2,
+            SSEA_SIMD_AVX2,
+            SSEA_SIMD_NEON,
+        };
+
+        static int ssea_simd_detect() noexcept
+        {
+#if defined(SSEA_SIMD_X86)
+#if defined(_MSC_VER) && !defined(__clang__)
+            int regs[4] = { 0 };
+            __cpuid(regs, 0);
+
+            int max_leaf = regs[0];
+            __cpuid(regs, 1);
+
+            bool sse2 = (regs[3] & (1 << 26)) != 0;
+            bool osxsave = (regs[2] & (1 << 27)) != 0;
+            bool avx = (regs[2] & (1 << 28)) != 0;
+            if (max_leaf >= 7 && osxsave && avx && (_xgetbv(0) & 0x6) == 0x6)
+            {
+                __cpuidex(regs, 7, 0);
+                if (regs[1] & (1 << 5))
+                {
+                    return SSEA_SIMD_AVX2;
+                }
+            }
+
+            return sse2 ? SSEA_SIMD_SSE2 : SSEA_SIMD_SCALAR;
+#else
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2"))
+            {
+                return SSEA_SIMD_AVX2;
+            }
+
+            return __builtin_cpu_supports("sse2") ? SSEA_SIMD_SSE2 : SSEA_SIMD_SCALAR;
+#endif
+#elif defined(SSEA_SIMD_NEON)
+            return SSEA_SIMD_NEON;
+#else
+            return SSEA_SIMD_SCALAR;
+#endif
+        }
+
+        static int ssea_simd_level() noexcept
+        {
+            static const int level = ssea_simd_detect();
+            return level;
+        }
+
+        static void ssea_masked_data_scalar(const Byte* data, Byte* output, int data_size, Byte key) noexcept
+        {
+            for (int i = 0; i < data_size; i++)
+            {
+                output[i] = data[i] ^ key;
+            }
+        }
+
+        static void ssea_delta_encode_scalar(Byte* data, int data_size) noexcept
+        {
+            for (int i = data_size - 1; i > 0; i--)
+            {
+                data[i] = data[i] - data[i - 1];
+            }
+        }
+
+        static void ssea_delta_decode_scalar(Byte* data, int data_size) noexcept
+        {
+            for (int i = 1; i < data_size; i++)
+            {
+                data[i] = data[i - 1] + data[i];
+            }
+        }
+
+#if defined(SSEA_SIMD_X86)
+        SSEA_TARGET_SSE2 static void ssea_masked_data_sse2(const Byte* data, Byte* output, int data_size, Byte key) noexcept
+        {
+            __m128i k = _mm_set1_epi8((char)key);
+            int i = 0;
+            for (; i + 16 <= data_size; i += 16)
+            {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), _mm_xor_si128(v, k));
+            }
+
+            ssea_masked_data_scalar(data + i, output + i, data_size - i, key);
+        }
+
+        SSEA_TARGET_AVX2 static void ssea_masked_data_avx2(const Byte* data, Byte* output, int data_size, Byte key) noexcept
+        {
+            __m256i k = _mm256_set1_epi8((char)key);
+            int i = 0;
+            for (; i + 32 <= data_size; i += 32)
+            {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), _mm256_xor_si256(v, k));
+            }
+
+            ssea_masked_data_scalar(data + i, output + i, data_size - i, key);
+        }
+
+        // Walks backwards one vector at a time, the preceding bytes of each vector are still unmodified when it is loaded.
+        SSEA_TARGET_SSE2 static void ssea_delta_encode_sse2(Byte* data, int data_size) noexcept
+        {
+            int i = data_size;
+            for (; i - 16 >= 1; i -= 16)
+            {
+                __m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i - 16));
+                __m128i previous = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i - 17));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i - 16), _mm_sub_epi8(current, previous));
+            }
+
+            ssea_delta_encode_scalar(data, i);
+        }
+
+        SSEA_TARGET_AVX2 static void ssea_delta_encode_avx2(Byte* data, int data_size) noexcept
+        {
+            int i = data_size;
+            for (; i - 32 >= 1; i -= 32)
+            {
+                __m256i current = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i - 32));
+                __m256i previous = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i - 33));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i - 32), _mm256_sub_epi8(current, previous));
+            }
+
+            ssea_delta_encode_scalar(data, i);
+        }
+
+        // Inclusive prefix sum modulo 256, log-step shifts inside a vector plus the running carry of the previous one.
+        SSEA_TARGET_SSE2 static void ssea_delta_decode_sse2(Byte* data, int data_size) noexcept
+        {
+            __m128i carry = _mm_setzero_si128();
+            int i = 0;
+            for (; i + 16 <= data_size; i += 16)
+            {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+                v = _mm_add_epi8(v, _mm_slli_si128(v, 1));
+                v = _mm_add_epi8(v, _mm_slli_si128(v, 2));
+                v = _mm_add_epi8(v, _mm_slli_si128(v, 4));
+                v = _mm_add_epi8(v, _mm_slli_si128(v, 8));
+                v = _mm_add_epi8(v, carry);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), v);
+                carry = _mm_set1_epi8((char)data[i + 15]);
+            }
+
+            if (i > 0 && i < data_size)
+            {
+                ssea_delta_decode_scalar(data + i - 1, data_size - i + 1);
+            }
+            elif(i == 0)
+            {
+                ssea_delta_decode_scalar(data, data_size);
+            }
+        }
+#elif defined(SSEA_SIMD_NEON)
+        static void ssea_masked_data_neon(const Byte* data, Byte* output, int data_size, Byte key) noexcept
+        {
+            uint8x16_t k = vdupq_n_u8(key);
+            int i = 0;
+            for (; i + 16 <= data_size; i += 16)
+            {
+                vst1q_u8(output + i, veorq_u8(vld1q_u8(data + i), k));
+            }
+
+            ssea_masked_data_scalar(data + i, output + i, data_size - i, key);
+        }
+
+        static void ssea_delta_encode_neon(Byte* data, int data_size) noexcept
+        {
+            int i = data_size;
+            for (; i - 16 >= 1; i -= 16)
+            {
+                uint8x16_t current = vld1q_u8(data + i - 16);
+                uint8x16_t previous = vld1q_u8(data + i - 17);
+                vst1q_u8(data + i - 16, vsubq_u8(current, previous));
+            }
+
+            ssea_delta_encode_scalar(data, i);
+        }
+
+        static void ssea_delta_decode_neon(Byte* data, int data_size) noexcept
+        {
+            uint8x16_t zero = vdupq_n_u8(0);
+            uint8x16_t carry = zero;
+            int i = 0;
+            for (; i + 16 <= data_size; i += 16)
+            {
+                uint8x16_t v = vld1q_u8(data + i);
+                v = vaddq_u8(v, vextq_u8(zero, v, 15));
+                v = vaddq_u8(v, vextq_u8(zero, v, 14));
+                v = vaddq_u8(v, vextq_u8(zero, v, 12));
+                v = vaddq_u8(v, vextq_u8(zero, v, 8));
+                v = vaddq_u8(v, carry);
+                vst1q_u8(data + i, v);
+                carry = vdupq_n_u8(data[i + 15]);
+            }
+
+            if (i > 0 && i < data_size)
+            {
+                ssea_delta_decode_scalar(data + i - 1, data_size - i + 1);
+            }
+            elif(i == 0)
+            {
+                ssea_delta_decode_scalar(data, data_size);
+            }
+        }
+#endif
+
+        // The swaps are sequential and cannot be vectorized, but (i ^ key) usually lands below 2 * data_size for the frame sizes in use, 
+        // So a conditional subtraction replaces the division in the common case while producing the same permutation.
+        static inline uint32_t ssea_shuffle_index(uint32_t p, uint32_t key, uint32_t data_size) noexcept
+        {
+            uint32_t j = p ^ key;
+            if (j >= data_size)
+            {
+                j -= data_size;
+                if (j >= data_size)
+                {
+                    j %= data_size;
+                }
+            }
+            return j;
+        }
+
+        void ssea::masked_data(const void* data, void* output, int data_size, Byte key) noexcept
+        {
+            if (NULL == data || NULL == output || data_size < 1)
+            {
+                return;
+            }
+
+            const Byte* src = (const Byte*)data;
+            Byte* dst = (Byte*)output;
+            switch (ssea_simd_level())
+            {
+#if defined(SSEA_SIMD_X86)
+            case SSEA_SIMD_AVX2:
+                ssea_masked_data_avx2(src, dst, data_size, key);
+                break;
+            case SSEA_SIMD_SSE2:
+                ssea_masked_data_sse2(src, dst, data_size, key);
+                break;
+#elif defined(SSEA_SIMD_NEON)
+            case SSEA_SIMD_NEON:
+                ssea_masked_data_neon(src, dst, data_size, key);
+                break;
+#endif
+            default:
+                ssea_masked_data_scalar(src, dst, data_size, key);
+                break;
+            }
+        }
+
+        void ssea::masked_data(void* data, int data_size, Byte key) noexcept
+        {
+            masked_data(data, data, data_size, key);
+        }
+
         void ssea::shuffle_data(char* encoded_data, int data_size, uint32_t key) noexcept
         {
             if (NULL != encoded_data && data_size > 0)
             {
                 for (int i = 0; i < data_size; i++)
                 {
-                    uint32_t p = (uint32_t)i;
-                    uint32_t j = (uint32_t)((p ^ key) % data_size);
+                    uint32_t j = ssea_shuffle_index((uint32_t)i, key, (uint32_t)data_size);
                     std::swap(encoded_data[i], encoded_data[j]);
                 }
             }
@@ -35,8 +312,7 @@ namespace ppp
             {
                 for (int i = data_size - 1; i > -1; i--)
                 {
-                    uint32_t p = (uint32_t)i;
-                    uint32_t j = (uint32_t)((p ^ key) % data_size);
+                    uint32_t j = ssea_shuffle_index((uint32_t)i, key, (uint32_t)data_size);
                     std::swap(encoded_data[i], encoded_data[j]);
                 }
             }
@@ -94,6 +370,62 @@ namespace ppp
             return data_size;
         }
 
+        int ssea::delta_encode(void* data, int data_size) noexcept
+        {
+            if (NULL == data || data_size < 1)
+            {
+                return 0;
+            }
+
+            Byte* head = (Byte*)data;
+            switch (ssea_simd_level())
+            {
+#if defined(SSEA_SIMD_X86)
+            case SSEA_SIMD_AVX2:
+                ssea_delta_encode_avx2(head, data_size);
+                break;
+            case SSEA_SIMD_SSE2:
+                ssea_delta_encode_sse2(head, data_size);
+                break;
+#elif defined(SSEA_SIMD_NEON)
+            case SSEA_SIMD_NEON:
+                ssea_delta_encode_neon(head, data_size);
+                break;
+#endif
+            default:
+                ssea_delta_encode_scalar(head, data_size);
+                break;
+            }
+            return data_size;
+        }
+
+        int ssea::delta_decode(void* data, int data_size) noexcept
+        {
+            if (NULL == data || data_size < 1)
+            {
+                return 0;
+            }
+
+            Byte* head = (Byte*)data;
+            switch (ssea_simd_level())
+            {
+#if defined(SSEA_SIMD_X86)
+            case SSEA_SIMD_AVX2:
+            case SSEA_SIMD_SSE2:
+                ssea_delta_decode_sse2(head, data_size);
+                break;
+#elif defined(SSEA_SIMD_NEON)
+            case SSEA_SIMD_NEON:
+                ssea_delta_decode_neon(head, data_size);
+                break;
+#endif
+            default:
+                ssea_delta_decode_scalar(head, data_size);
+                break;
+            }
+            return data_size;
+        }
+
         std::shared_ptr<Byte> ssea::base94_encode(const std::shared_ptr<ppp::threading::BufferswapAllocator>& allocator, const void* data, int datalen, int& outlen) noexcept
         {
             static constexpr int BASE94_RADIX = BASE94_SYMBOL_COUNT;
@@ -14,6 +14,10 @@ namespace ppp
             static void                     unshuffle_data(char* encoded_data, int data_size, uint32_t key) noexcept;
             static int                      delta_encode(const std::shared_ptr<ppp::threading::BufferswapAllocator>& allocator, const void* data, int data_size, std::shared_ptr<Byte>& output) noexcept;
             static int                      delta_decode(const std::shared_ptr<ppp::threading::BufferswapAllocator>& allocator, const void* data, int data_size, std::shared_ptr<Byte>& output) noexcept;
+            static int                      delta_encode(void* data, int data_size) noexcept;
+            static int                      delta_decode(void* data, int data_size) noexcept;
+            static void                     masked_data(void* data, int data_size, Byte key) noexcept;
+            static void                     masked_data(const void* data, void* output, int data_size, Byte key) noexcept;
             static std::shared_ptr<Byte>    base94_encode(const std::shared_ptr<ppp::threading::BufferswapAllocator>& allocator, const void* data, int datalen, int& outlen) noexcept;
             static std::shared_ptr<Byte>    base94_decode(const std::shared_ptr<ppp::threading::BufferswapAllocator>& allocator, const void* data, int datalen, int& outlen) noexcept;
             static ppp::string              base94_decimal(uint64_t v) noexcept;
@@ -499,7 +499,7 @@ namespace ppp
                 sssmt_.clear();
             }
 
-            for (std::shared_ptr<boost::asio::io_context>& i : sssmt_)
+            for (std::shared_ptr<boost::asio::io_context>& i : ssmts)
             {
                 i->stop();
             }
@@ -0,0 +1,392 @@
+#include <ppp/net/DomainTrie.h>
+
+namespace ppp
+{
+    namespace net
+    {
+        static inline void DomainTrie_Trim(const char*& begin, const char*& end) noexcept
+        {
+            while (begin < end && isspace((unsigned char)*begin))
+            {
+                begin++;
+            }
+
+            while (end > begin && isspace((unsigned char)end[-1]))
+            {
+                end--;
+            }
+        }
+
+        bool DomainTrie::Add(const ppp::string& domain, int value) noexcept
+        {
+            if (value < 0)
+            {
+                return false;
+            }
+
+            ppp::string host = LTrim(RTrim(ToLower(domain)));
+            if (host.empty())
+            {
+                return false;
+            }
+
+            ppp::vector<ppp::string> labels;
+            bool canonical = true;
+            for (std::size_t offset = 0;;)
+            {
+                std::size_t index = host.find('.', offset);
+                ppp::string label = host.substr(offset, index == ppp::string::npos ? ppp::string::npos : index - offset);
+                if (label.empty() || LTrim(RTrim(label)) != label)
+                {
+                    canonical = false;
+                    break;
+                }
+
+                labels.emplace_back(label);
+                if (index == ppp::string::npos)
+                {
+                    break;
+                }
+
+                offset = index + 1;
+            }
+
+            if (!canonical)
+            {
+                auto r = exact_.emplace(host, value);
+                if (r.second)
+                {
+                    count_++;
+                }
+                else
+                {
+                    r.first->second = value;
+                }
+                return true;
+            }
+
+            if (builder_.empty())
+            {
+                builder_.emplace_back(BuildNode{ {}, NONE });
+            }
+
+            uint32_t node = 0;
+            for (auto tail = labels.rbegin(); tail != labels.rend(); tail++)
+            {
+                auto& children = builder_[node].Children;
+                auto child = children.find(*tail);
+                if (child != children.end())
+                {
+                    node = child->second;
+                    continue;
+                }
+
+                uint32_t next = (uint32_t)builder_.size();
+                children.emplace(*tail, next);
+                builder_.emplace_back(BuildNode{ {}, NONE });
+                node = next;
+            }
+
+            int& now = builder_[node].Value;
+            if (now < 0)
+            {
+                count_++;
+            }
+
+            now = value;
+            return true;
+        }
+
+        void DomainTrie::Compile() noexcept
+        {
+            nodes_.clear();
+            labels_.clear();
+            exacts_.clear();
+
+            exacts_.reserve(exact_.size());
+            for (auto&& kv : exact_)
+            {
+                exacts_.emplace_back(kv);
+            }
+
+            std::sort(exacts_.begin(), exacts_.end());
+            exact_.clear();
+
+            if (builder_.empty())
+            {
+                return;
+            }
+
+            // Breadth first, so the children of every node are contiguous and stay sorted by label for the binary search.
+            ppp::vector<uint32_t> order;
+            order.reserve(builder_.size());
+            order.emplace_back(0);
+            nodes_.reserve(builder_.size());
+            nodes_.emplace_back(Node{ 0, 0, 0, 0, builder_[0].Value });
+
+            for (std::size_t i = 0; i < order.size(); i++)
+            {
+                BuildNode& current = builder_[order[i]];
+                nodes_[i].FirstChild = (uint32_t)nodes_.size();
+                nodes_[i].ChildCount = (uint32_t)current.Children.size();
+
+                for (auto&& [label, child] : current.Children)
+                {
+                    nodes_.emplace_back(Node{ (uint32_t)labels_.size(), (uint32_t)label.size(), 0, 0, builder_[child].Value });
+                    labels_.append(label);
+                    order.emplace_back(child);
+                }
+            }
+
+            builder_.clear();
+            builder_.shrink_to_fit();
+            nodes_.shrink_to_fit();
+            labels_.shrink_to_fit();
+        }
+
+        int DomainTrie::FindChild(const Node& node, const char* label, std::size_t label_length) const noexcept
+        {
+            int low = (int)node.FirstChild;
+            int high = low + (int)node.ChildCount - 1;
+            while (low <= high)
+            {
+                int middle = low + ((high - low) >> 1);
+                const Node& child = nodes_[middle];
+                const Byte* stored = (const Byte*)labels_.data() + child.Label;
+
+                int diff = 0;
+                std::size_t length = std::min<std::size_t>(child.LabelLength, label_length);
+                for (std::size_t i = 0; i < length && diff == 0; i++)
+                {
+                    diff = (int)stored[i] - (int)(Byte)tolower((Byte)label[i]);
+                }
+
+                if (diff == 0)
+                {
+                    diff = child.LabelLength < label_length ? -1 : (child.LabelLength > label_length ? 1 : 0);
+                    if (diff == 0)
+                    {
+                        return middle;
+                    }
+                }
+
+                if (diff < 0)
+                {
+                    low = middle + 1;
+                }
+                else
+                {
+                    high = middle - 1;
+                }
+            }
+            return NONE;
+        }
+
+        int DomainTrie::FindExact(const char* host, std::size_t host_length) const noexcept
+        {
+            int low = 0;
+            int high = (int)exacts_.size() - 1;
+            while (low <= high)
+            {
+                int middle = low + ((high - low) >> 1);
+                const ppp::string& stored = exacts_[middle].first;
+
+                int diff = 0;
+                std::size_t length = std::min<std::size_t>(stored.size(), host_length);
+                for (std::size_t i = 0; i < length && diff == 0; i++)
+                {
+                    diff = (int)(Byte)stored[i] - (int)(Byte)tolower((Byte)host[i]);
+                }
+
+                if (diff == 0)
+                {
+                    diff = stored.size() < host_length ? -1 : (stored.size() > host_length ? 1 : 0);
+                    if (diff == 0)
+                    {
+                        return exacts_[middle].second;
+                    }
+                }
+
+                if (diff < 0)
+                {
+                    low = middle + 1;
+                }
+                else
+                {
+                    high = middle - 1;
+                }
+            }
+            return NONE;
+        }
+
+        std::string_view DomainTrie::Trim(const std::string_view& host) noexcept
+        {
+            const char* begin = host.data();
+            const char* end = begin + host.size();
+            DomainTrie_Trim(begin, end);
+            return std::string_view(begin, end - begin);
+        }
+
+        bool DomainTrie::TryParseAddress(const std::string_view& host, boost::asio::ip::address& address) noexcept
+        {
+            char buffer[64];
+            if (host.empty() || host.size() >= sizeof(buffer))
+            {
+                return false;
+            }
+
+            for (char ch : host)
+            {
+                if (!isxdigit((unsigned char)ch) && ch != '.' && ch != ':')
+                {
+                    return false;
+                }
+            }
+
+            memcpy(buffer, host.data(), host.size());
+            buffer[host.size()] = '\x0';
+
+            boost::system::error_code ec;
+            address = StringToAddress(buffer, ec);
+            return ec == boost::system::errc::success;
+        }
+
+        int DomainTrie::Lookup(const std::string_view& host) const noexcept
+        {
+            const char* begin = host.data();
+            const char* end = begin + host.size();
+            DomainTrie_Trim(begin, end);
+            if (begin == end)
+            {
+                return NONE;
+            }
+
+            if (!exacts_.empty())
+            {
+                int value = FindExact(begin, end - begin);
+                if (value >= 0)
+                {
+                    return value;
+                }
+            }
+
+            // Count the labels first, empty tokens between dots are skipped and surrounding white spaces do not count,
+            // An all blank label makes the whole host malformed. Only a host without either can hit a rule verbatim.
+            int labels = 0;
+            bool malformed = false;
+            bool canonical = true;
+            for (const char* p = begin; p <= end;)
+            {
+                const char* q = (const char*)memchr(p, '.', end - p);
+                if (NULL == q)
+                {
+                    q = end;
+                }
+
+                if (p == q)
+                {
+                    canonical = false;
+                }
+                else
+                {
+                    const char* label_begin = p;
+                    const char* label_end = q;
+                    DomainTrie_Trim(label_begin, label_end);
+                    if (label_begin == label_end)
+                    {
+                        malformed = true;
+                    }
+                    elif(label_begin != p || label_end != q)
+                    {
+                        canonical = false;
+                    }
+
+                    labels++;
+                }
+
+                p = q + 1;
+            }
+
+            int verbatim = NONE;
+            int best = NONE;
+            if (!nodes_.empty())
+            {
+                const Node* node = &nodes_[0];
+                int depth = 0;
+                for (const char* q = end;;)
+                {
+                    const char* p = q;
+                    while (p > begin && p[-1] != '.')
+                    {
+                        p--;
+                    }
+
+                    const char* label_begin = p;
+                    const char* label_end = q;
+                    if (label_begin == label_end)
+                    {
+                        if (p == begin)
+                        {
+                            break;
+                        }
+
+                        q = p - 1;
+                        continue;
+                    }
+
+                    DomainTrie_Trim(label_begin, label_end);
+                    if (++depth >= labels && !(canonical && depth == labels))
+                    {
+                        break;
+                    }
+
+                    int child = FindChild(*node, label_begin, label_end - label_begin);
+                    if (child < 0)
+                    {
+                        break;
+                    }
+
+                    node = &nodes_[child];
+                    if (depth == labels)
+                    {
+                        verbatim = node->Value;
+                    }
+                    elif(depth > 1 && node->Value >= 0)
+                    {
+                        best = node->Value;
+                    }
+
+                    if (p == begin)
+                    {
+                        break;
+                    }
+
+                    q = p - 1;
+                }
+            }
+
+            if (verbatim >= 0)
+            {
+                return verbatim;
+            }
+
+            if (labels < 2 || malformed)
+            {
+                return MALFORMED;
+            }
+
+            return best;
+        }
+
+        std::size_t DomainTrie::GetMemorySize() const noexcept
+        {
+            std::size_t size = nodes_.capacity() * sizeof(Node) + labels_.capacity();
+            size += exacts_.capacity() * sizeof(std::pair<ppp::string, int>);
+            for (auto&& kv : exacts_)
+            {
+                size += kv.first.capacity();
+            }
+            return size;
+        }
+    }
+}
\ No newline at end of file
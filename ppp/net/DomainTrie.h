@@ -0,0 +1,63 @@
+#pragma once
+
+#include <ppp/stdafx.h>
+
+namespace ppp
+{
+    namespace net
+    {
+        // Immutable suffix index over domain names, stored as a trie of reversed labels ("www.example.com" -> com, example, www).
+        // Lookups walk the labels of the queried host in place and follow the matching rules of Firewall::IsSameNetworkDomains,
+        // Without building a string for every parent domain.
+        class DomainTrie final
+        {
+        public:
+            static constexpr int                                    NONE      = -1; // No rule matches the host.
+            static constexpr int                                    MALFORMED = -2; // The host has less than two labels or an empty label.
+
+        public:
+            DomainTrie() noexcept = default;
+
+        public:
+            // Values are caller supplied indexes (>= 0), a domain added twice keeps the last value.
+            bool                                                    Add(const ppp::string& domain, int value) noexcept;
+            void                                                    Compile() noexcept;
+            // Case and surrounding white spaces of host do not matter, both are dealt with while walking it.
+            int                                                     Lookup(const std::string_view& host) const noexcept;
+            std::size_t                                             GetCount() const noexcept { return count_; }
+            std::size_t                                             GetMemorySize() const noexcept;
+
+        public:
+            static std::string_view                                 Trim(const std::string_view& host) noexcept;
+            // An IPv4 or IPv6 literal, parsed from a stack copy so that domain names never cost an allocation.
+            static bool                                             TryParseAddress(const std::string_view& host, boost::asio::ip::address& address) noexcept;
+
+        private:
+            typedef struct
+            {
+                uint32_t                                            Label;
+                uint32_t                                            LabelLength;
+                uint32_t                                            FirstChild;
+                uint32_t                                            ChildCount;
+                int                                                 Value;
+            }                                                       Node;
+            typedef struct
+            {
+                ppp::map<ppp::string, uint32_t>                     Children;
+                int                                                 Value;
+            }                                                       BuildNode;
+
+        private:
+            int                                                     FindChild(const Node& node, const char* label, std::size_t label_length) const noexcept;
+            int                                                     FindExact(const char* host, std::size_t host_length) const noexcept;
+
+        private:
+            std::size_t                                             count_ = 0;
+            ppp::vector<Node>                                       nodes_;
+            ppp::string                                             labels_;
+            ppp::vector<BuildNode>                                  builder_;
+            ppp::unordered_map<ppp::string, int>                    exact_; // Rules that are not a plain dotted name can only ever match verbatim.
+            ppp::vector<std::pair<ppp::string, int>/**/>            exacts_; // The same once compiled, sorted for a case insensitive binary search.
+        };
+    }
+}
\ No newline at end of file
@@ -20,8 +20,20 @@ namespace ppp
                 return false;
             }
 
-            SynchronizedObjectScope scope(syncobj_);
-            return ports_.emplace(port).second;
+            for (SynchronizedObjectScope scope(syncobj_);;)
+            {
+                if (ports_.test(port))
+                {
+                    return false;
+                }
+
+                ports_.set(port);
+                dirty_ = true;
+                break;
+            }
+
+            Commit();
+            return true;
         }
 
         bool Firewall::DropNetworkPort(int port, bool tcp_or_udp) noexcept
@@ -31,15 +43,21 @@ namespace ppp
                 return false;
             }
 
-            SynchronizedObjectScope scope(syncobj_);
-            if (tcp_or_udp)
+            for (SynchronizedObjectScope scope(syncobj_);;)
             {
-                return ports_tcp_.emplace(port).second;
-            }
-            else
-            {
-                return ports_udp_.emplace(port).second;
+                NetworkPortTable& ports = tcp_or_udp ? ports_tcp_ : ports_udp_;
+                if (ports.test(port))
+                {
+                    return false;
+                }
+
+                ports.set(port);
+                dirty_ = true;
+                break;
             }
+
+            Commit();
+            return true;
         }
 
         bool Firewall::DropNetworkSegment(const boost::asio::ip::address& ip, int prefix) noexcept
@@ -67,6 +85,7 @@ namespace ppp
                     }
                 };
 
+            bool dropped = false;
             if (ip.is_v4())
             {
                 if (prefix < 0 || prefix > 32)
@@ -79,7 +98,8 @@ namespace ppp
                 UInt32 __networkIP = __ip & __mask;
 
                 SynchronizedObjectScope scope(syncobj_);
-                return set_network_segments(network_segments_, __networkIP, prefix);
+                dirty_ = true;
+                dropped = set_network_segments(network_segments_, __networkIP, prefix);
             }
             elif(ip.is_v6())
             {
@@ -93,12 +113,16 @@ namespace ppp
                 Int128 __networkIP = __ip & __mask;
 
                 SynchronizedObjectScope scope(syncobj_);
-                return set_network_segments(network_segments_, __networkIP, prefix);
+                dirty_ = true;
+                dropped = set_network_segments(network_segments_v6_, __networkIP, prefix);
             }
-            else
+
+            if (dropped)
             {
-                return false;
+                Commit();
             }
+
+            return dropped;
         }
 
         bool Firewall::DropNetworkDomains(const ppp::string& host) noexcept
@@ -109,25 +133,38 @@ namespace ppp
             }
 
             ppp::string host_lower = LTrim(RTrim(ToLower(host)));
-            if (host.empty())
+            if (host_lower.empty())
             {
                 return false;
             }
-            else
+
+            bool dropped = false;
+            for (SynchronizedObjectScope scope(syncobj_);;)
             {
-                SynchronizedObjectScope scope(syncobj_);
-                return network_domains_.emplace(host_lower).second;
+                dirty_ = true;
+                dropped = network_domains_.emplace(host_lower).second;
+                break;
+            }
+
+            if (dropped)
+            {
+                Commit();
             }
+
+            return dropped;
         }
 
         void Firewall::Clear() noexcept
         {
             SynchronizedObjectScope scope(syncobj_);
-            ports_.clear();
-            ports_tcp_.clear();
-            ports_udp_.clear();
+            ports_.reset();
+            ports_tcp_.reset();
+            ports_udp_.reset();
             network_domains_.clear();
             network_segments_.clear();
+            network_segments_v6_.clear();
+            dirty_ = false;
+            std::atomic_store(&rules_, NetworkRulesPtr());
         }
 
         bool Firewall::IsDropNetworkPort(int port, bool tcp_or_udp) noexcept
@@ -137,73 +174,101 @@ namespace ppp
                 return false;
             }
 
-            SynchronizedObjectScope scope(syncobj_);
-            ppp::unordered_set<int>* lists[] =
-            {
-                &ports_,
-                tcp_or_udp ? &ports_tcp_ : &ports_udp_
-            };
-            for (auto* list : lists)
+            NetworkRulesPtr rules = GetNetworkRules();
+            if (NULL == rules)
             {
-                auto tail = list->find(port);
-                auto endl = list->end();
-                if (tail != endl)
-                {
-                    return true;
-                }
+                return false;
             }
-            return false;
+
+            return rules->Ports.test(port) || (tcp_or_udp ? rules->PortsTcp : rules->PortsUdp).test(port);
         }
 
         template <typename T>
-        static bool Firewall_IsDropNetworkSegment(const boost::asio::ip::address& ip, T __ip, int max_prefix, Firewall::NetworkSegmentTable& network_segments) noexcept
+        static Firewall::PrefixMatchTablePtr Firewall_CompileNetworkSegments(Firewall::NetworkSegmentTable& network_segments) noexcept
         {
-            static constexpr int MIN_PREFIX_VALUE = ppp::net::native::MIN_PREFIX_VALUE;
             if (network_segments.empty())
             {
-                return false;
+                return NULL;
             }
 
-            for (int prefix = max_prefix; prefix >= MIN_PREFIX_VALUE; prefix--)
-            {
-                T __mask = prefix ? -1 << (max_prefix - prefix) : 0L;
-                T __networkIP = __ip & __mask;
+            Firewall::PrefixMatchTable::EntryList entries;
+            entries.reserve(network_segments.size());
 
-                auto tail = network_segments.find(__networkIP);
-                auto endl = network_segments.end();
-                if (tail == endl)
+            for (auto&& kv : network_segments)
+            {
+                T __networkIP = Ipep::HostToNetworkOrder<T>((T)kv.first);
+                Firewall::PrefixMatchTable::Entry entry;
+                if (ppp::net::native::PrefixMatchTableEntry(entry, reinterpret_cast<const Byte*>(&__networkIP), sizeof(__networkIP), kv.second, 1))
                 {
-                    continue;
+                    entries.emplace_back(entry);
                 }
+            }
 
-                if (prefix >= tail->second)
-                {
-                    return true;
-                }
+            return Firewall::PrefixMatchTable::Compile(sizeof(T), entries);
+        }
+
+        Firewall::NetworkRulesPtr Firewall::Commit() noexcept
+        {
+            SynchronizedObjectScope scope(syncobj_);
+            if (!dirty_ || loading_ > 0)
+            {
+                return std::atomic_load(&rules_);
             }
-            return false;
+
+            NetworkRulesPtr rules = make_shared_object<NetworkRules>();
+            if (NULL == rules)
+            {
+                return std::atomic_load(&rules_);
+            }
+
+            rules->Ports = ports_;
+            rules->PortsTcp = ports_tcp_;
+            rules->PortsUdp = ports_udp_;
+            for (const ppp::string& domain : network_domains_)
+            {
+                rules->Domains.Add(domain, 0);
+            }
+
+            rules->Domains.Compile();
+            rules->Segments = Firewall_CompileNetworkSegments<UInt32>(network_segments_);
+            rules->SegmentsV6 = Firewall_CompileNetworkSegments<Int128>(network_segments_v6_);
+
+            dirty_ = false;
+            std::atomic_store(&rules_, rules);
+            return rules;
+        }
+
+        Firewall::NetworkRulesPtr Firewall::GetNetworkRules() noexcept
+        {
+            // Readers never compile, every writer publishes its snapshot itself (a rules load once it is complete), so the packet path
+            // Only pays for the atomic load.
+            return std::atomic_load(&rules_);
         }
 
         bool Firewall::IsDropNetworkSegment(const boost::asio::ip::address& ip) noexcept
         {
+            NetworkRulesPtr rules = GetNetworkRules();
+            if (NULL == rules)
+            {
+                return false;
+            }
+
+            uint32_t value;
             if (ip.is_v4())
             {
-                UInt32 __ip = ip.to_v4().to_uint();
-                {
-                    SynchronizedObjectScope scope(syncobj_);
-                    return Firewall_IsDropNetworkSegment<UInt32>(ip, __ip, 32, network_segments_);
-                }
+                const PrefixMatchTablePtr& lpm = rules->Segments;
+                return NULL != lpm && lpm->Lookup(ip.to_v4().to_uint(), value);
             }
             elif(ip.is_v6())
             {
-                boost::asio::ip::address_v6::bytes_type __bytes_ip = ip.to_v6().to_bytes();
+                const PrefixMatchTablePtr& lpm = rules->SegmentsV6;
+                if (NULL == lpm)
                 {
-                    Int128 __ip = Ipep::NetworkToHostOrder(*(Int128*)__bytes_ip.data());
-                    {
-                        SynchronizedObjectScope scope(syncobj_);
-                        return Firewall_IsDropNetworkSegment<Int128>(ip, __ip, 128, network_segments_);
-                    }
+                    return false;
                 }
+
+                boost::asio::ip::address_v6::bytes_type __bytes_ip = ip.to_v6().to_bytes();
+                return lpm->Lookup(__bytes_ip.data(), value);
             }
             else
             {
@@ -218,27 +283,25 @@ namespace ppp
                 return false;
             }
 
-            ppp::string host_lower = LTrim(RTrim(ToLower(host)));
-            if (host_lower.empty())
+            // Trimming and case folding happen while the trie walks the host, nothing is copied for a domain name.
+            std::string_view host_view = DomainTrie::Trim(host);
+            if (host_view.empty())
             {
                 return false;
             }
 
-            boost::system::error_code ec;
-            boost::asio::ip::address ip = StringToAddress(host_lower.data(), ec);
-            if (ec == boost::system::errc::success)
+            boost::asio::ip::address ip;
+            if (DomainTrie::TryParseAddress(host_view, ip))
             {
                 return IsDropNetworkSegment(ip);
             }
 
-            auto contains = [this](const ppp::string& s) noexcept
-                {
-                    SynchronizedObjectScope scope(syncobj_);
-                    auto tail = network_domains_.find(s);
-                    auto endl = network_domains_.end();
-                    return tail != endl;
-                };
-            return IsSameNetworkDomains(host_lower, contains);
+            // Hosts that are not a domain name at all are dropped whether or not any domain rules are loaded.
+            static const DomainTrie empty;
+
+            NetworkRulesPtr rules = GetNetworkRules();
+            const DomainTrie& domains = NULL != rules ? rules->Domains : empty;
+            return domains.Lookup(host_view) != DomainTrie::NONE;
         }
 
         bool Firewall::IsSameNetworkDomains(const ppp::string& host, const ppp::function<bool(const ppp::string& s)>& contains) noexcept
@@ -415,7 +478,34 @@ namespace ppp
             return LoadWithRules(rules);
         }
 
+        bool Firewall::ReloadWithFile(const ppp::string& path) noexcept
+        {
+            if (path.empty())
+            {
+                return false;
+            }
+
+            ppp::string file_path = File::GetFullPath(File::RewritePath(path.data()).data());
+            if (file_path.empty())
+            {
+                return false;
+            }
+
+            ppp::string rules = File::ReadAllText(file_path.data());
+            return ReloadWithRules(rules);
+        }
+
         bool Firewall::LoadWithRules(const ppp::string& rules) noexcept
+        {
+            return LoadWithRules(rules, false);
+        }
+
+        bool Firewall::ReloadWithRules(const ppp::string& rules) noexcept
+        {
+            return LoadWithRules(rules, true);
+        }
+
+        static bool LoadWithRulesAll(Firewall* fw, const ppp::string& rules) noexcept
         {
             typedef bool(*DropProc)(Firewall* fw, ppp::string& line);
 
@@ -500,9 +590,62 @@ namespace ppp
                         break;
                     }
 
-                    any |= i.drop_proc(this, line);
+                    any |= i.drop_proc(fw, line);
+                }
+            }
+            return any;
+        }
+
+        void Firewall::GetLoadStatistics(LoadStatistics& statistics) noexcept
+        {
+            SynchronizedObjectScope scope(syncobj_);
+            statistics = load_statistics_;
+        }
+
+        bool Firewall::LoadWithRules(const ppp::string& rules, bool reload) noexcept
+        {
+            UInt64 load_begin = ppp::GetTickCount(true);
+
+            // The staging tables are only published once the whole configuration has been applied, a reload starts from empty tables 
+            // While readers keep evaluating the previous snapshot, so the rules can be swapped without a restart.
+            {
+                SynchronizedObjectScope scope(syncobj_);
+                loading_++;
+                if (reload)
+                {
+                    ports_.reset();
+                    ports_tcp_.reset();
+                    ports_udp_.reset();
+                    network_domains_.clear();
+                    network_segments_.clear();
+                    network_segments_v6_.clear();
+                    dirty_ = true;
+                }
+            }
+
+            bool any = LoadWithRulesAll(this, rules);
+            {
+                SynchronizedObjectScope scope(syncobj_);
+                loading_--;
+            }
+
+            NetworkRulesPtr snapshot = Commit();
+            for (SynchronizedObjectScope scope(syncobj_);;)
+            {
+                load_statistics_.Rules = (int64_t)(ports_.count() + ports_tcp_.count() + ports_udp_.count() + 
+                    network_segments_.size() + network_segments_v6_.size() + network_domains_.size());
+                load_statistics_.MemorySize = 0;
+                load_statistics_.Elapsed = (int64_t)(ppp::GetTickCount(true) - load_begin);
+
+                if (NULL != snapshot)
+                {
+                    load_statistics_.MemorySize = (int64_t)(sizeof(NetworkRules) + snapshot->Domains.GetMemorySize() +
+                        (NULL != snapshot->Segments ? snapshot->Segments->GetMemorySize() : 0) + 
+                        (NULL != snapshot->SegmentsV6 ? snapshot->SegmentsV6->GetMemorySize() : 0));
                 }
+                break;
             }
+
             return any;
         }
     }
@@ -1,8 +1,12 @@
 #pragma once
 
+#include <bitset>
+
 #include <ppp/stdafx.h>
 #include <ppp/Int128.h>
 #include <ppp/net/native/rib.h>
+#include <ppp/net/native/lpm.h>
+#include <ppp/net/DomainTrie.h>
 
 namespace ppp 
 {
@@ -15,6 +19,32 @@ namespace ppp
             typedef std::lock_guard<SynchronizedObject>             SynchronizedObjectScope;
             typedef ppp::unordered_map<Int128, int>                 NetworkSegmentTable;
             typedef ppp::unordered_set<ppp::string>                 NetworkDomainsTable;
+            typedef ppp::net::native::PrefixMatchTable              PrefixMatchTable;
+            typedef std::shared_ptr<PrefixMatchTable>               PrefixMatchTablePtr;
+            typedef std::bitset<65536>                              NetworkPortTable;
+
+            // Compiled, immutable rule set. Readers reach the current one through an atomic shared pointer and never take syncobj_, 
+            // Writers stage their changes in the tables below and publish a whole new snapshot.
+            class NetworkRules final
+            {
+            public:
+                NetworkPortTable                                    Ports;
+                NetworkPortTable                                    PortsTcp;
+                NetworkPortTable                                    PortsUdp;
+                DomainTrie                                          Domains;
+                PrefixMatchTablePtr                                 Segments;
+                PrefixMatchTablePtr                                 SegmentsV6;
+            };
+            typedef std::shared_ptr<NetworkRules>                   NetworkRulesPtr;
+
+            // What the last rules load produced, for the console.
+            class LoadStatistics final
+            {
+            public:
+                int64_t                                             Rules      = 0; /* Ports, segments and domains dropped. */
+                int64_t                                             MemorySize = 0; /* Bytes held by the compiled snapshot. */
+                int64_t                                             Elapsed    = 0; /* Microseconds to parse and compile the rules. */
+            };
 
         public:
             Firewall() noexcept = default;
@@ -28,6 +58,10 @@ namespace ppp
             virtual void                                            Clear() noexcept;
             bool                                                    LoadWithFile(const ppp::string& path) noexcept;
             virtual bool                                            LoadWithRules(const ppp::string& configuration) noexcept;
+            bool                                                    ReloadWithFile(const ppp::string& path) noexcept;
+            virtual bool                                            ReloadWithRules(const ppp::string& configuration) noexcept;
+            NetworkRulesPtr                                         GetNetworkRules() noexcept;
+            void                                                    GetLoadStatistics(LoadStatistics& statistics) noexcept;
 
         public:
             virtual bool                                            IsDropNetworkPort(int port, bool tcp_or_udp) noexcept;
@@ -37,13 +71,22 @@ namespace ppp
         public:
             static bool                                             IsSameNetworkDomains(const ppp::string& host, const ppp::function<bool(const ppp::string& s)>& contains) noexcept;
 
+        private:
+            bool                                                    LoadWithRules(const ppp::string& configuration, bool reload) noexcept;
+            NetworkRulesPtr                                         Commit() noexcept;
+
         private:
             SynchronizedObject                                      syncobj_;
-            ppp::unordered_set<int>                                 ports_;
-            ppp::unordered_set<int>                                 ports_tcp_;
-            ppp::unordered_set<int>                                 ports_udp_;
+            NetworkPortTable                                        ports_;
+            NetworkPortTable                                        ports_tcp_;
+            NetworkPortTable                                        ports_udp_;
             NetworkDomainsTable                                     network_domains_;
             NetworkSegmentTable                                     network_segments_;
+            NetworkSegmentTable                                     network_segments_v6_;
+            std::atomic<int>                                        loading_ = 0;
+            std::atomic<bool>                                       dirty_   = false;
+            NetworkRulesPtr                                         rules_;
+            LoadStatistics                                          load_statistics_;
         };
     }
 }
\ No newline at end of file
@@ -36,6 +36,10 @@
 #include <ppp/net/IPEndPoint.h>
 #include <ppp/threading/Executors.h>
 
+#if defined(_LINUX)
+#include <linux/filter.h>
+#endif
+
 #if defined(__MUSL__)
 #include <err.h>
 #include <poll.h>
@@ -486,6 +490,46 @@ namespace ppp {
             return ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, (char*)&flag, sizeof(flag)) == 0;
         }
 
+        bool Socket::ReuseSocketPort(int fd, bool reuse) noexcept {
+            if (fd == -1) {
+                return false;
+            }
+
+#if defined(SO_REUSEPORT)
+            int flag = reuse ? 1 : 0;
+            return ::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, (char*)&flag, sizeof(flag)) == 0;
+#else
+            return false;
+#endif
+        }
+
+        bool Socket::SteerReusePortBySourceAddress(int fd, int sockets) noexcept {
+            if (fd == -1 || sockets < 1) {
+                return false;
+            }
+
+#if defined(_LINUX) && defined(SO_ATTACH_REUSEPORT_CBPF)
+            // The program sees the datagram behind its udp header, the source address is read relative to the network header.
+            struct sock_filter code[] = {
+                { BPF_LD  | BPF_B   | BPF_ABS, 0, 0, (uint32_t)(SKF_NET_OFF + 0)  },    /* A = version << 4 | ihl */
+                { BPF_ALU | BPF_RSH | BPF_K,   0, 0, 4                            },
+                { BPF_JMP | BPF_JEQ | BPF_K,   0, 2, 6                            },
+                { BPF_LD  | BPF_W   | BPF_ABS, 0, 0, (uint32_t)(SKF_NET_OFF + 20) },    /* A = low word of the ipv6 source */
+                { BPF_JMP | BPF_JA,            0, 0, 1                            },
+                { BPF_LD  | BPF_W   | BPF_ABS, 0, 0, (uint32_t)(SKF_NET_OFF + 12) },    /* A = ipv4 source */
+                { BPF_ALU | BPF_MOD | BPF_K,   0, 0, (uint32_t)sockets            },
+                { BPF_RET | BPF_A,             0, 0, 0                            },
+            };
+
+            struct sock_fprog program;
+            program.len = arraysizeof(code);
+            program.filter = code;
+            return ::setsockopt(fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, (char*)&program, sizeof(program)) == 0;
+#else
+            return false;
+#endif
+        }
+
         /* TCP MSS values – what’s changed?
          * https://blog.apnic.net/2019/07/31/tcp-mss-values-whats-changed/ 
          */
@@ -131,6 +131,10 @@ namespace ppp {
             static bool                                                                                 SetTypeOfService(int fd, int tos = ~0) noexcept;
             static bool                                                                                 SetSignalPipeline(int fd, bool sigpipe) noexcept;
             static bool                                                                                 ReuseSocketAddress(int fd, bool reuse) noexcept;
+            static bool                                                                                 ReuseSocketPort(int fd, bool reuse) noexcept;
+            // Attaches a classic BPF program to the SO_REUSEPORT group of fd that picks socket (source address % sockets),
+            // So every flow of one client lands on the same socket no matter which source port it uses. Linux only.
+            static bool                                                                                 SteerReusePortBySourceAddress(int fd, int sockets) noexcept;
 
         public:
             static int                                                                                  GetHandle(const boost::asio::ip::tcp::acceptor& acceptor) noexcept;
@@ -0,0 +1,450 @@
+#include <ppp/net/asio/DatagramBatch.h>
+
+#if defined(_LINUX)
+#include <errno.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+
+// Older userspace headers lack the offload options, the kernel tells whether it knows them.
+#if !defined(SOL_UDP)
+#define SOL_UDP 17
+#endif
+
+#if !defined(UDP_SEGMENT)
+#define UDP_SEGMENT 103
+#endif
+
+#if !defined(UDP_GRO)
+#define UDP_GRO 104
+#endif
+#endif
+
+namespace ppp {
+    namespace net {
+        namespace asio {
+            static std::atomic<UInt64>                                  DatagramBatch_Receives        = 0;
+            static std::atomic<UInt64>                                  DatagramBatch_ReceivedPackets = 0;
+            static std::atomic<UInt64>                                  DatagramBatch_Sends           = 0;
+            static std::atomic<UInt64>                                  DatagramBatch_SentPackets     = 0;
+            static std::atomic<UInt64>                                  DatagramBatch_Coalesced       = 0;
+            static std::atomic<UInt64>                                  DatagramBatch_Segmented       = 0;
+            static std::atomic<UInt64>                                  DatagramBatch_Dropped         = 0;
+
+#if defined(_LINUX)
+            static constexpr int                                        DatagramBatch_MaxSegments     = 64;    // UDP_MAX_SEGMENTS
+            static constexpr int                                        DatagramBatch_MaxSegmentSize  = 1452;  // Fits a 1500 bytes path over IPv6.
+            static constexpr int                                        DatagramBatch_MaxSegmentBytes = 65000;
+            static std::atomic<bool>                                    DatagramBatch_Segmentation    = true;
+#endif
+
+            DatagramBatch::DatagramBatch(boost::asio::ip::udp::socket& socket, int batch, const std::shared_ptr<Byte>& buffer) noexcept
+                : socket_(socket)
+                , batch_(std::max<int>(1, std::min<int>(batch, PPP_UDP_BATCH_MAX)))
+                , gro_(false)
+                , gso_(true)
+                , flushing_(false)
+                , buffer_(buffer) {
+
+            }
+
+            void DatagramBatch::GetStatistics(Statistics& statistics) noexcept {
+                statistics.Receives = DatagramBatch_Receives.load(std::memory_order_relaxed);
+                statistics.ReceivedPackets = DatagramBatch_ReceivedPackets.load(std::memory_order_relaxed);
+                statistics.Sends = DatagramBatch_Sends.load(std::memory_order_relaxed);
+                statistics.SentPackets = DatagramBatch_SentPackets.load(std::memory_order_relaxed);
+                statistics.Coalesced = DatagramBatch_Coalesced.load(std::memory_order_relaxed);
+                statistics.Segmented = DatagramBatch_Segmented.load(std::memory_order_relaxed);
+                statistics.Dropped = DatagramBatch_Dropped.load(std::memory_order_relaxed);
+            }
+
+            bool DatagramBatch::ReceiveFrom(const ReceiveHandler& handler, const ReceiveCompletion& completion) noexcept {
+                if (NULL == handler || NULL == completion) {
+                    return false;
+                }
+
+                bool opened = socket_.is_open();
+                if (!opened) {
+                    return false;
+                }
+
+#if defined(_LINUX)
+                socket_.async_wait(boost::asio::ip::udp::socket::wait_read,
+                    [this, handler, completion](const boost::system::error_code& ec) noexcept {
+                        if (ec) {
+                            completion(ec);
+                            return;
+                        }
+
+                        boost::system::error_code error;
+                        if (Drain(handler, error) > -1) {
+                            completion(error);
+                        }
+                    });
+#else
+                if (NULL == buffer_) {
+                    return false;
+                }
+
+                socket_.async_receive_from(boost::asio::buffer(buffer_.get(), PPP_BUFFER_SIZE), remoteEP_,
+                    [this, handler, completion](const boost::system::error_code& ec, std::size_t sz) noexcept {
+                        if (ec) {
+                            completion(ec);
+                            return;
+                        }
+
+                        DatagramBatch_Receives++;
+                        DatagramBatch_ReceivedPackets++;
+                        if (!handler(buffer_.get(), static_cast<int>(sz), remoteEP_)) {
+                            return;
+                        }
+
+                        boost::system::error_code error;
+                        if (Drain(handler, error) > -1) {
+                            completion(error);
+                        }
+                    });
+#endif
+                return true;
+            }
+
+            int DatagramBatch::Drain(const ReceiveHandler& handler, boost::system::error_code& ec) noexcept {
+#if defined(_LINUX)
+                // Handlers run to completion before the next wait is armed, so every socket served by a thread can share one arena.
+                static thread_local std::shared_ptr<Byte> arena;
+                static thread_local int arena_slots = 0;
+
+                if (arena_slots < batch_) {
+                    arena = make_shared_alloc<Byte>((std::size_t)batch_ * PPP_BUFFER_SIZE);
+                    if (NULL == arena) {
+                        arena_slots = 0;
+                        ec = boost::asio::error::no_buffer_space;
+                        return 0;
+                    }
+
+                    arena_slots = batch_;
+                }
+
+                int fd = socket_.native_handle();
+                if (!gro_) {
+                    int on = 1;
+                    gro_ = true;
+                    ::setsockopt(fd, SOL_UDP, UDP_GRO, (char*)&on, sizeof(on));
+                }
+
+                typedef union {
+                    char                                                Data[CMSG_SPACE(sizeof(int))];
+                    struct cmsghdr                                      Align;
+                }                                                       Control;
+
+                struct mmsghdr messages[PPP_UDP_BATCH_MAX];
+                struct iovec iovs[PPP_UDP_BATCH_MAX];
+                struct sockaddr_storage addresses[PPP_UDP_BATCH_MAX];
+                Control controls[PPP_UDP_BATCH_MAX];
+
+                Byte* slots = arena.get();
+                memset(messages, 0, sizeof(*messages) * batch_);
+                for (int i = 0; i < batch_; i++) {
+                    struct msghdr& hdr = messages[i].msg_hdr;
+                    iovs[i].iov_base = slots + (std::size_t)i * PPP_BUFFER_SIZE;
+                    iovs[i].iov_len = PPP_BUFFER_SIZE;
+                    hdr.msg_name = &addresses[i];
+                    hdr.msg_namelen = sizeof(addresses[i]);
+                    hdr.msg_iov = &iovs[i];
+                    hdr.msg_iovlen = 1;
+                    hdr.msg_control = controls[i].Data;
+                    hdr.msg_controllen = sizeof(controls[i].Data);
+                }
+
+                int received = ::recvmmsg(fd, messages, batch_, MSG_DONTWAIT, NULL);
+                if (received < 0) {
+                    int err = errno;
+                    if (err != EAGAIN && err != EWOULDBLOCK && err != EINTR) {
+                        ec = boost::system::error_code(err, boost::system::system_category());
+                    }
+
+                    return 0;
+                }
+
+                DatagramBatch_Receives++;
+
+                int count = 0;
+                for (int i = 0; i < received; i++) {
+                    struct msghdr& hdr = messages[i].msg_hdr;
+                    if (hdr.msg_flags & MSG_TRUNC) {
+                        DatagramBatch_Dropped++;
+                        continue;
+                    }
+
+                    boost::asio::ip::udp::endpoint remoteEP;
+                    if (hdr.msg_namelen > remoteEP.capacity()) {
+                        DatagramBatch_Dropped++;
+                        continue;
+                    }
+
+                    memcpy(remoteEP.data(), &addresses[i], hdr.msg_namelen);
+                    remoteEP.resize(hdr.msg_namelen);
+
+                    int length = static_cast<int>(messages[i].msg_len);
+                    int segment = length;
+                    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr); NULL != cmsg; cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
+                        if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+                            int size = 0;
+                            memcpy(&size, CMSG_DATA(cmsg), sizeof(size));
+                            if (size > 0 && size < length) {
+                                segment = size;
+                                DatagramBatch_Coalesced += (length + size - 1) / size;
+                            }
+                            break;
+                        }
+                    }
+
+                    Byte* packet = (Byte*)iovs[i].iov_base;
+                    int offset = 0;
+                    do {
+                        int size = std::min<int>(segment, length - offset);
+                        count++;
+                        DatagramBatch_ReceivedPackets++;
+
+                        if (!handler(packet + offset, size, remoteEP)) {
+                            return -1;
+                        }
+
+                        offset += size;
+                    } while (offset < length);
+                }
+
+                return count;
+#else
+                int count = 0;
+                for (int i = 1; i < batch_; i++) {
+                    boost::system::error_code error;
+                    std::size_t available = socket_.available(error);
+                    if (error || available < 1) {
+                        break;
+                    }
+
+                    std::size_t sz = socket_.receive_from(boost::asio::buffer(buffer_.get(), PPP_BUFFER_SIZE), remoteEP_, 0, error);
+                    if (error) {
+                        break;
+                    }
+
+                    count++;
+                    DatagramBatch_Receives++;
+                    DatagramBatch_ReceivedPackets++;
+
+                    if (!handler(buffer_.get(), static_cast<int>(sz), remoteEP_)) {
+                        return -1;
+                    }
+                }
+
+                return count;
+#endif
+            }
+
+            bool DatagramBatch::SendTo(const std::shared_ptr<void>& owner, const void* packet, int packet_length, const boost::asio::ip::udp::endpoint& destinationEP) noexcept {
+                if (NULL == packet || packet_length < 1 || packet_length > PPP_BUFFER_SIZE) {
+                    return false;
+                }
+
+                bool opened = socket_.is_open();
+                if (!opened) {
+                    return false;
+                }
+
+                if (batch_ < 2 || NULL == owner) {
+                    boost::system::error_code ec;
+                    socket_.send_to(boost::asio::buffer(packet, packet_length), destinationEP, boost::asio::socket_base::message_end_of_record, ec);
+
+                    if (ec) {
+                        DatagramBatch_Dropped++;
+                        return false;
+                    }
+
+                    DatagramBatch_Sends++;
+                    DatagramBatch_SentPackets++;
+                    return true;
+                }
+
+                bool post = false;
+                for (;;) {
+                    SynchronizedObjectScope scope(syncobj_);
+                    if ((int)datagrams_.size() >= batch_ || packets_.size() + packet_length > PPP_BUFFER_SIZE) {
+                        FlushUnsafe();
+                    }
+
+                    int offset = static_cast<int>(packets_.size());
+                    packets_.insert(packets_.end(), (Byte*)packet, (Byte*)packet + packet_length);
+                    datagrams_.emplace_back(Datagram{ offset, packet_length, destinationEP });
+
+                    if (!flushing_) {
+                        flushing_ = true;
+                        post = true;
+                    }
+                    break;
+                }
+
+                if (post) {
+                    boost::asio::post(socket_.get_executor(),
+                        [this, owner]() noexcept {
+                            Flush();
+                        });
+                }
+
+                return true;
+            }
+
+            int DatagramBatch::Flush() noexcept {
+                SynchronizedObjectScope scope(syncobj_);
+                flushing_ = false;
+                return FlushUnsafe();
+            }
+
+            int DatagramBatch::FlushUnsafe() noexcept {
+                int count = static_cast<int>(datagrams_.size());
+                if (count < 1) {
+                    return 0;
+                }
+
+                int sent = 0;
+                if (socket_.is_open()) {
+#if defined(_LINUX)
+                    typedef union {
+                        char                                            Data[CMSG_SPACE(sizeof(uint16_t))];
+                        struct cmsghdr                                  Align;
+                    }                                                   Control;
+
+                    struct mmsghdr messages[PPP_UDP_BATCH_MAX];
+                    struct iovec iovs[PPP_UDP_BATCH_MAX];
+                    Control controls[PPP_UDP_BATCH_MAX];
+                    int segments[PPP_UDP_BATCH_MAX];
+
+                    int fd = socket_.native_handle();
+                    Byte* packets = packets_.data();
+
+                    for (int index = 0; index < count;) {
+                        bool gso = gso_ && DatagramBatch_Segmentation.load(std::memory_order_relaxed);
+                        int message_count = 0;
+
+                        for (int i = index; i < count && message_count < PPP_UDP_BATCH_MAX; message_count++) {
+                            Datagram& datagram = datagrams_[i];
+                            int length = datagram.Length;
+                            int n = 1;
+
+                            // Equal sized datagrams to one destination leave as a single super packet, only the last one may be shorter.
+                            if (gso && datagram.Length <= DatagramBatch_MaxSegmentSize) {
+                                while (i + n < count && n < DatagramBatch_MaxSegments) {
+                                    Datagram& next = datagrams_[i + n];
+                                    if (next.Length > datagram.Length || next.DestinationEP != datagram.DestinationEP || length + next.Length > DatagramBatch_MaxSegmentBytes) {
+                                        break;
+                                    }
+
+                                    n++;
+                                    length += next.Length;
+                                    if (next.Length < datagram.Length) {
+                                        break;
+                                    }
+                                }
+                            }
+
+                            struct mmsghdr& message = messages[message_count];
+                            memset(&message, 0, sizeof(message));
+
+                            iovs[message_count].iov_base = packets + datagram.Offset;
+                            iovs[message_count].iov_len = length;
+
+                            struct msghdr& hdr = message.msg_hdr;
+                            hdr.msg_name = datagram.DestinationEP.data();
+                            hdr.msg_namelen = datagram.DestinationEP.size();
+                            hdr.msg_iov = &iovs[message_count];
+                            hdr.msg_iovlen = 1;
+
+                            if (n > 1) {
+                                Control& control = controls[message_count];
+                                memset(&control, 0, sizeof(control));
+
+                                hdr.msg_control = control.Data;
+                                hdr.msg_controllen = sizeof(control.Data);
+
+                                struct cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr);
+                                cmsg->cmsg_level = SOL_UDP;
+                                cmsg->cmsg_type = UDP_SEGMENT;
+                                cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+
+                                uint16_t segment_size = static_cast<uint16_t>(datagram.Length);
+                                memcpy(CMSG_DATA(cmsg), &segment_size, sizeof(segment_size));
+                            }
+
+                            segments[message_count] = n;
+                            i += n;
+                        }
+
+                        int n = ::sendmmsg(fd, messages, message_count, 0);
+                        if (n < 0) {
+                            int err = errno;
+                            if (err == EINTR) {
+                                continue;
+                            }
+
+                            // The socket buffer is full, retrying datagram by datagram would only burn syscalls, the rest of the batch is dropped at once.
+                            if (err == EAGAIN || err == EWOULDBLOCK || err == ENOBUFS) {
+                                DatagramBatch_Dropped += count - index;
+                                break;
+                            }
+
+                            // The route or the kernel refused the super packet, this socket sends datagrams one by one from now on.
+                            if (segments[0] > 1 && (err == EIO || err == ENOPROTOOPT || err == EOPNOTSUPP || err == EINVAL)) {
+                                gso_ = false;
+                                if (err == ENOPROTOOPT || err == EOPNOTSUPP) {
+                                    DatagramBatch_Segmentation = false;
+                                }
+
+                                continue;
+                            }
+
+                            // Only the first message failed, the datagrams it carried are dropped and the batch goes on with the next one.
+                            DatagramBatch_Dropped += segments[0];
+                            index += segments[0];
+                            continue;
+                        }
+
+                        DatagramBatch_Sends++;
+                        for (int i = 0; i < n; i++) {
+                            int segment_count = segments[i];
+                            if (segment_count > 1) {
+                                DatagramBatch_Segmented += segment_count;
+                            }
+
+                            sent += segment_count;
+                            index += segment_count;
+                        }
+                    }
+#else
+                    for (int i = 0; i < count; i++) {
+                        Datagram& datagram = datagrams_[i];
+                        boost::system::error_code ec;
+                        socket_.send_to(boost::asio::buffer(packets_.data() + datagram.Offset, datagram.Length),
+                            datagram.DestinationEP, boost::asio::socket_base::message_end_of_record, ec);
+
+                        if (ec) {
+                            DatagramBatch_Dropped++;
+                        }
+                        else {
+                            sent++;
+                            DatagramBatch_Sends++;
+                        }
+                    }
+#endif
+                }
+                else {
+                    DatagramBatch_Dropped += count;
+                }
+
+                DatagramBatch_SentPackets += sent;
+                packets_.clear();
+                datagrams_.clear();
+                return sent;
+            }
+        }
+    }
+}
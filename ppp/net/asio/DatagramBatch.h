@@ -0,0 +1,68 @@
+#pragma once
+
+#include <ppp/stdafx.h>
+
+namespace ppp {
+    namespace net {
+        namespace asio {
+            // Moves several datagrams per system call on a udp socket owned by the caller: recvmmsg/sendmmsg on Linux, with UDP_GRO and
+            // UDP_SEGMENT when the kernel offers them. Other platforms receive the first datagram asynchronously and drain what is queued behind it.
+            class DatagramBatch final {
+            public:
+                typedef ppp::function<bool(Byte*, int, const boost::asio::ip::udp::endpoint&)> ReceiveHandler;
+                typedef ppp::function<void(const boost::system::error_code&)>                  ReceiveCompletion;
+                typedef std::mutex                                      SynchronizedObject;
+                typedef std::lock_guard<SynchronizedObject>             SynchronizedObjectScope;
+
+                // Process wide counters of all batches, pps is the delta of the packet counters between two samples.
+                typedef struct {
+                    UInt64                                              Receives;
+                    UInt64                                              ReceivedPackets;
+                    UInt64                                              Sends;
+                    UInt64                                              SentPackets;
+                    UInt64                                              Coalesced;  // Datagrams that arrived inside a UDP_GRO super packet.
+                    UInt64                                              Segmented;  // Datagrams that left inside a UDP_SEGMENT super packet.
+                    UInt64                                              Dropped;
+                }                                                       Statistics;
+
+            public:
+                DatagramBatch(boost::asio::ip::udp::socket& socket, int batch, const std::shared_ptr<Byte>& buffer) noexcept;
+
+            public:
+                int                                                     GetBatch() noexcept { return batch_; }
+                // Waits until the socket is readable, hands at most GetBatch() datagrams to handler and then calls completion once.
+                // A handler returning false stops the drain without calling completion, the owner has taken over (it is disposing).
+                // The buffer given to the constructor receives the datagrams on platforms without recvmmsg.
+                bool                                                    ReceiveFrom(const ReceiveHandler& handler, const ReceiveCompletion& completion) noexcept;
+                // Queues the datagram for a flush posted to the socket's executor, or sends it at once when the batch size is 1.
+                // Owner is captured by the posted flush and has to keep this batch and its socket alive.
+                bool                                                    SendTo(const std::shared_ptr<void>& owner, const void* packet, int packet_length, const boost::asio::ip::udp::endpoint& destinationEP) noexcept;
+                int                                                     Flush() noexcept;
+                static void                                             GetStatistics(Statistics& statistics) noexcept;
+
+            private:
+                typedef struct {
+                    int                                                 Offset;
+                    int                                                 Length;
+                    boost::asio::ip::udp::endpoint                      DestinationEP;
+                }                                                       Datagram;
+
+            private:
+                int                                                     Drain(const ReceiveHandler& handler, boost::system::error_code& ec) noexcept;
+                int                                                     FlushUnsafe() noexcept;
+
+            private:
+                boost::asio::ip::udp::socket&                           socket_;
+                int                                                     batch_    = 0;
+                bool                                                    gro_      = false;
+                bool                                                    gso_      = true;
+                bool                                                    flushing_ = false;
+                std::shared_ptr<Byte>                                   buffer_;
+                boost::asio::ip::udp::endpoint                          remoteEP_;
+                SynchronizedObject                                      syncobj_;
+                ppp::vector<Byte>                                       packets_;
+                ppp::vector<Datagram>                                   datagrams_;
+            };
+        }
+    }
+}
@@ -4,6 +4,39 @@
 namespace ppp {
     namespace net {
         namespace asio {
+            static std::atomic<UInt64>                                  IAsynchronousWriteIoQueue_Writes  = 0;
+            static std::atomic<UInt64>                                  IAsynchronousWriteIoQueue_Packets = 0;
+            static std::atomic<UInt64>                                  IAsynchronousWriteIoQueue_Bytes   = 0;
+            static std::atomic<UInt64>                                  IAsynchronousWriteIoQueue_PacketsPerWrite[IAsynchronousWriteIoQueue::WRITE_HISTOGRAM_BUCKETS];
+            static std::atomic<UInt64>                                  IAsynchronousWriteIoQueue_BytesPerWrite[IAsynchronousWriteIoQueue::WRITE_HISTOGRAM_BUCKETS];
+
+            static inline int IAsynchronousWriteIoQueue_Bucket(UInt64 value, int shift) noexcept {
+                int bucket = 0;
+                for (value = (value - 1) >> shift; value > 0 && bucket < IAsynchronousWriteIoQueue::WRITE_HISTOGRAM_BUCKETS - 1; value >>= 1) {
+                    bucket++;
+                }
+
+                return bucket;
+            }
+
+            static void IAsynchronousWriteIoQueue_AddWrite(int packets, int bytes) noexcept {
+                IAsynchronousWriteIoQueue_Writes++;
+                IAsynchronousWriteIoQueue_Packets += packets;
+                IAsynchronousWriteIoQueue_Bytes += bytes;
+                IAsynchronousWriteIoQueue_PacketsPerWrite[IAsynchronousWriteIoQueue_Bucket(packets, 0)]++;
+                IAsynchronousWriteIoQueue_BytesPerWrite[IAsynchronousWriteIoQueue_Bucket(bytes, 8)]++;
+            }
+
+            void IAsynchronousWriteIoQueue::GetWriteStatistics(WriteStatistics& statistics) noexcept {
+                statistics.Writes = IAsynchronousWriteIoQueue_Writes.load(std::memory_order_relaxed);
+                statistics.Packets = IAsynchronousWriteIoQueue_Packets.load(std::memory_order_relaxed);
+                statistics.Bytes = IAsynchronousWriteIoQueue_Bytes.load(std::memory_order_relaxed);
+                for (int i = 0; i < WRITE_HISTOGRAM_BUCKETS; i++) {
+                    statistics.PacketsPerWrite[i] = IAsynchronousWriteIoQueue_PacketsPerWrite[i].load(std::memory_order_relaxed);
+                    statistics.BytesPerWrite[i] = IAsynchronousWriteIoQueue_BytesPerWrite[i].load(std::memory_order_relaxed);
+                }
+            }
+
             IAsynchronousWriteIoQueue::IAsynchronousWriteIoQueue(const std::shared_ptr<BufferswapAllocator>& allocator) noexcept
                 : BufferAllocator(allocator)
                 , disposed_(false)
@@ -109,44 +142,108 @@ namespace ppp {
             }
 
             bool IAsynchronousWriteIoQueue::DoWriteBytes(AsynchronousWriteIoContextPtr message) noexcept {
+                AsynchronousWriteIoContextBatchPtr messages = make_shared_object<AsynchronousWriteIoContextBatch>();
+                if (NULL == messages) {
+                    return false;
+                }
+
+                messages->emplace_back(message);
+                return DoWriteBatch(messages);
+            }
+
+            bool IAsynchronousWriteIoQueue::DoWriteBatch(const AsynchronousWriteIoContextBatchPtr& messages) noexcept {
                 if (disposed_) {
                     return false;
                 }
 
                 auto self = shared_from_this();
-                auto evtf = [self, this, message](bool ok) noexcept {
-                        if (message) {
+                auto evtf = [self, this, messages](bool ok) noexcept {
+                        for (AsynchronousWriteIoContextPtr& message : *messages) {
                             (*message)(ok);
                         }
 
-                        std::shared_ptr<AsynchronousWriteIoContext> context;
+                        AsynchronousWriteIoContextBatchPtr next;
                         if (ok) {
                             SynchronizedObjectScope scope(syncobj_);
                             sending_ = false;
 
-                            auto tail = queues_.begin();
-                            auto endl = queues_.end();
-                            if (tail != endl) {
-                                context = std::move(*tail);
-                                queues_.erase(tail);
+                            // Everything queued up while the previous write was pending goes out in one gather write,
+                            // Bounded by the number of buffers and bytes a single write is allowed to carry.
+                            if (!queues_.empty()) {
+                                next = make_shared_object<AsynchronousWriteIoContextBatch>();
+                                if (NULL == next) {
+                                    ok = false;
+                                }
+                                else {
+                                    int bytes = 0;
+                                    while (!queues_.empty() && next->size() < WRITE_GATHER_MAX_BUFFERS) {
+                                        AsynchronousWriteIoContextPtr& context = queues_.front();
+                                        if (!next->empty() && bytes + context->packet_length > WRITE_GATHER_MAX_BYTES) {
+                                            break;
+                                        }
 
-                                ok = DoWriteBytes(context);
+                                        bytes += context->packet_length;
+                                        next->emplace_back(std::move(context));
+                                        queues_.pop_front();
+                                    }
+
+                                    ok = DoWriteBatch(next);
+                                }
                             }
                         }
 
-                        if (context) {
-                            (*context)(ok);
+                        if (!ok && NULL != next) {
+                            for (AsynchronousWriteIoContextPtr& message : *next) {
+                                (*message)(false);
+                            }
                         }
                     };
 
-                bool ok = DoWriteBytes(message->packet, 0, message->packet_length, evtf);
+                bool ok = false;
+                int packets = (int)messages->size();
+                int bytes = 0;
+                if (packets == 1) {
+                    AsynchronousWriteIoContextPtr& message = (*messages)[0];
+                    bytes = message->packet_length;
+                    ok = DoWriteBytes(message->packet, 0, bytes, evtf);
+                }
+                else {
+                    ConstBufferSequencePtr buffers = make_shared_object<ConstBufferSequence>();
+                    if (NULL == buffers) {
+                        return false;
+                    }
+
+                    buffers->reserve(packets);
+                    for (AsynchronousWriteIoContextPtr& message : *messages) {
+                        buffers->emplace_back(message->packet.get(), message->packet_length);
+                        bytes += message->packet_length;
+                    }
+
+                    ok = DoWriteBuffers(buffers, bytes, evtf);
+                }
+
                 if (ok) {
                     sending_ = true;
+                    IAsynchronousWriteIoQueue_AddWrite(packets, bytes);
                 }
 
                 return ok;
             }
 
+            bool IAsynchronousWriteIoQueue::DoWriteBuffers(const ConstBufferSequencePtr& buffers, int buffers_length, const AsynchronousWriteBytesCallback& cb) noexcept {
+                if (NULL == buffers || buffers_length < 1) {
+                    return false;
+                }
+
+                std::shared_ptr<Byte> packet = BufferswapAllocator::MakeByteArray(BufferAllocator, buffers_length);
+                if (NULL == packet) {
+                    return false;
+                }
+
+                std::size_t length = boost::asio::buffer_copy(boost::asio::buffer(packet.get(), buffers_length), *buffers);
+                return DoWriteBytes(packet, 0, (int)length, cb);
+            }
+
             void IAsynchronousWriteIoQueue::AwaitInitiateAfterYieldCoroutine(YieldContext& y, std::atomic<int>& initiate) noexcept {
                 int initiate_state = initiate.load();
                 if (initiate_state > -1) {
@@ -14,6 +14,23 @@ namespace ppp {
                 typedef ppp::threading::BufferswapAllocator             BufferswapAllocator;
                 typedef std::mutex                                      SynchronizedObject;
                 typedef std::lock_guard<SynchronizedObject>             SynchronizedObjectScope;
+                typedef ppp::vector<boost::asio::const_buffer>          ConstBufferSequence;
+                typedef std::shared_ptr<ConstBufferSequence>            ConstBufferSequencePtr;
+
+            public:
+                static constexpr int                                    WRITE_GATHER_MAX_BUFFERS = 64;
+                static constexpr int                                    WRITE_GATHER_MAX_BYTES   = PPP_BUFFER_SIZE;
+                static constexpr int                                    WRITE_HISTOGRAM_BUCKETS  = 8;
+
+                // Process wide counters of the writes issued by all queues, the histograms are log2 buckets:
+                // PacketsPerWrite 1, 2, <= 4 ... > 64 and BytesPerWrite <= 256, <= 512 ... > 16 KB.
+                typedef struct {
+                    UInt64                                              Writes;
+                    UInt64                                              Packets;
+                    UInt64                                              Bytes;
+                    UInt64                                              PacketsPerWrite[WRITE_HISTOGRAM_BUCKETS];
+                    UInt64                                              BytesPerWrite[WRITE_HISTOGRAM_BUCKETS];
+                }                                                       WriteStatistics;
 
             public:
                 const std::shared_ptr<BufferswapAllocator>              BufferAllocator;
@@ -29,6 +46,7 @@ namespace ppp {
                 bool                                                    Y(YieldContext& y) noexcept;
                 bool                                                    R(YieldContext& y) noexcept;
                 static std::shared_ptr<Byte>                            Copy(const std::shared_ptr<ppp::threading::BufferswapAllocator>& allocator, const void* data, int datalen) noexcept;
+                static void                                             GetWriteStatistics(WriteStatistics& statistics) noexcept;
 
             private:
                 class AsynchronousWriteIoContext final {
@@ -65,9 +83,12 @@ namespace ppp {
                 };
                 typedef std::shared_ptr<AsynchronousWriteIoContext>     AsynchronousWriteIoContextPtr;
                 typedef ppp::list<AsynchronousWriteIoContextPtr>        AsynchronousWriteIoContextQueue;
+                typedef ppp::vector<AsynchronousWriteIoContextPtr>      AsynchronousWriteIoContextBatch;
+                typedef std::shared_ptr<AsynchronousWriteIoContextBatch> AsynchronousWriteIoContextBatchPtr;
 
             private:
                 bool                                                    DoWriteBytes(AsynchronousWriteIoContextPtr message) noexcept;
+                bool                                                    DoWriteBatch(const AsynchronousWriteIoContextBatchPtr& messages) noexcept;
                 void                                                    Finalize() noexcept;
                 void                                                    AwaitInitiateAfterYieldCoroutine(YieldContext& y, std::atomic<int>& initiate) noexcept;
 
@@ -97,6 +118,10 @@ namespace ppp {
                 bool                                                    WriteBytes(YieldContext& y, const std::shared_ptr<Byte>& packet, int packet_length) noexcept;
                 virtual bool                                            DoWriteBytes(std::shared_ptr<Byte> packet, int offset, int packet_length, const AsynchronousWriteBytesCallback& cb) noexcept = 0;
                 
+                // Sends the packets queued up behind a pending write in one go, the buffers stay valid until cb is invoked.
+                // The default joins them into a single packet for DoWriteBytes, sockets override it with a gather write.
+                virtual bool                                            DoWriteBuffers(const ConstBufferSequencePtr& buffers, int buffers_length, const AsynchronousWriteBytesCallback& cb) noexcept;
+                
             private:
                 struct {
                     bool                                                disposed_  : 1;
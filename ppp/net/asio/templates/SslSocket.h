@@ -58,13 +58,13 @@ namespace ppp {
                         }
 
                         if (handshaked_client) {
-                            ssl_context_ = ppp::ssl::SSL::CreateClientSslContext(ppp::ssl::SSL::SSL_METHOD::tlsv13, verify_peer_, ciphersuites_);
+                            ssl_context_ = ppp::ssl::SSL::GetClientSslContext(ppp::ssl::SSL::SSL_METHOD::tlsv13, verify_peer_, ciphersuites_);
                         }
                         elif(certificate_file_.empty() || certificate_key_file_.empty() || certificate_chain_file_.empty()) {
                             return false;
                         }
                         else {
-                            ssl_context_ = ppp::ssl::SSL::CreateServerSslContext(ppp::ssl::SSL::SSL_METHOD::tlsv13, certificate_file_, certificate_key_file_, certificate_chain_file_, certificate_key_password_, ciphersuites_);
+                            ssl_context_ = ppp::ssl::SSL::GetServerSslContext(ppp::ssl::SSL::SSL_METHOD::tlsv13, certificate_file_, certificate_key_file_, certificate_chain_file_, certificate_key_password_, ciphersuites_);
                         }
 
                         boost::system::error_code ec;
@@ -82,6 +82,11 @@ namespace ppp {
                             if (!SSL_set_tlsext_host_name(GetSslHandle(), host_.data())) {
                                 return false; /* throw boost::system::system_error{ { static_cast<int>(::ERR_get_error()), boost::asio::error::get_ssl_category() } }; */
                             }
+
+                            // Offer the session ticket of the last connection to this host, a resumed handshake skips the certificate exchange.
+                            if (handshaked_client) {
+                                ppp::ssl::SSL::SetClientSslSession(GetSslHandle(), host_);
+                            }
                         }
 
                         return PerformSslHandshake(handshaked_client, y);
@@ -537,7 +537,18 @@ namespace ppp
 
             uint32_t ForwardInformationTable::GetNextHop(uint32_t ip) noexcept
             {
-                return GetNextHop(ip, routes);
+                std::shared_ptr<PrefixMatchTable> lpm = std::atomic_load(&table);
+                if (NULL == lpm)
+                {
+                    return GetNextHop(ip, routes);
+                }
+
+                uint32_t next_hop;
+                if (lpm->Lookup(ntohl(ip), next_hop))
+                {
+                    return next_hop;
+                }
+                return IPEndPoint::NoneAddress;
             }
 
             RouteEntriesTable& ForwardInformationTable::GetAllRoutes() noexcept
@@ -547,20 +558,35 @@ namespace ppp
 
             void ForwardInformationTable::Fill(RouteInformationTable& rib) noexcept
             {
+                PrefixMatchTable::EntryList entries;
                 routes = rib.GetAllRoutes();
                 for (auto&& kv : routes)
                 {
-                    auto& entries = kv.second;
-                    std::sort(entries.begin(), entries.end(),
+                    auto& route_entries = kv.second;
+                    std::sort(route_entries.begin(), route_entries.end(),
                         [](RouteEntry& x, RouteEntry& y) noexcept
                         {
                             return x.Prefix > y.Prefix;
                         });
+
+                    for (RouteEntry& route : route_entries)
+                    {
+                        PrefixMatchTable::Entry entry;
+                        if (PrefixMatchTableEntry(entry, reinterpret_cast<const Byte*>(&route.Destination), sizeof(route.Destination), route.Prefix, route.NextHop))
+                        {
+                            entries.emplace_back(entry);
+                        }
+                    }
                 }
+
+                // Compiled here, off the packet path, and published in one step so concurrent lookups never see a partial table.
+                std::shared_ptr<PrefixMatchTable> lpm = PrefixMatchTable::Compile(sizeof(uint32_t), entries);
+                std::atomic_store(&table, lpm);
             }
 
             void ForwardInformationTable::Clear() noexcept
             {
+                std::atomic_store(&table, std::shared_ptr<PrefixMatchTable>());
                 routes.clear();
             }
 
@@ -744,6 +770,117 @@ namespace ppp
 
                     return strDomianStr.data();
                 }
+
+                static int SkipName(const Byte* szPacketStartPos, int nPacketLength, int nOffset) noexcept
+                {
+                    while (nOffset < nPacketLength)
+                    {
+                        int nLabelDataLen = szPacketStartPos[nOffset];
+                        if (nLabelDataLen == 0)
+                        {
+                            return nOffset + 1;
+                        }
+                        elif((nLabelDataLen & 0xc0) == 0xc0)
+                        {
+                            return nOffset + 2 > nPacketLength ? -1 : nOffset + 2;
+                        }
+                        elif((nLabelDataLen & 0xc0) != 0)
+                        {
+                            return -1;
+                        }
+
+                        nOffset += nLabelDataLen + 1;
+                    }
+
+                    return -1;
+                }
+
+                static uint32_t ReadUInt32(const Byte* p) noexcept
+                {
+                    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | (uint32_t)p[3];
+                }
+
+                int ExtractTTL(const Byte* szPacketStartPos, int nPacketLength, int nNegativeTTL, bool* pNegative, ppp::vector<uint16_t>* pTTLOffsets) noexcept
+                {
+                    static constexpr int DNS_TYPE_SOA = 0x0006;
+                    static constexpr int DNS_RR_FIXED_SIZE = DNS_TYPE_SIZE + DNS_CLASS_SIZE + DNS_TTL_SIZE + DNS_DATALEN_SIZE;
+
+                    struct dns_hdr* pDNSHeader = (struct dns_hdr*)szPacketStartPos;
+                    if (NULL == pDNSHeader || nPacketLength < sizeof(struct dns_hdr))
+                    {
+                        return -1;
+                    }
+
+                    // Only whole responses, a truncated one is retried over tcp and every failure but NXDOMAIN may be transient.
+                    uint16_t usFlags = ntohs(pDNSHeader->usFlags);
+                    if ((usFlags & 0x8000) == 0 || (usFlags & 0x0200) != 0)
+                    {
+                        return -1;
+                    }
+
+                    int nRCode = usFlags & 0x000f;
+                    if (nRCode != 0 && nRCode != 3)
+                    {
+                        return -1;
+                    }
+
+                    int nOffset = sizeof(struct dns_hdr);
+                    for (int i = 0, nQuestionCount = ntohs(pDNSHeader->usQuestionCount); i < nQuestionCount; i++)
+                    {
+                        nOffset = SkipName(szPacketStartPos, nPacketLength, nOffset);
+                        if (nOffset < 0 || (nOffset += DNS_TYPE_SIZE + DNS_CLASS_SIZE) > nPacketLength)
+                        {
+                            return -1;
+                        }
+                    }
+
+                    int64_t nAnswerTTL = INT32_MAX;
+                    int64_t nSoaTTL = nNegativeTTL;
+                    int nAnswerCount = ntohs(pDNSHeader->usAnswerCount);
+                    for (int i = 0, nRecordCount = nAnswerCount + ntohs(pDNSHeader->usAuthorityCount); i < nRecordCount; i++)
+                    {
+                        nOffset = SkipName(szPacketStartPos, nPacketLength, nOffset);
+                        if (nOffset < 0 || nOffset + DNS_RR_FIXED_SIZE > nPacketLength)
+                        {
+                            return -1;
+                        }
+
+                        const Byte* pRR = szPacketStartPos + nOffset;
+                        int nType = pRR[0] << 8 | pRR[1];
+                        int nDataLen = pRR[8] << 8 | pRR[9];
+                        int64_t nTTL = ReadUInt32(pRR + DNS_TYPE_SIZE + DNS_CLASS_SIZE);
+                        if (nOffset + DNS_RR_FIXED_SIZE + nDataLen > nPacketLength)
+                        {
+                            return -1;
+                        }
+
+                        if (NULL != pTTLOffsets)
+                        {
+                            pTTLOffsets->emplace_back((uint16_t)(nOffset + DNS_TYPE_SIZE + DNS_CLASS_SIZE));
+                        }
+
+                        if (i < nAnswerCount)
+                        {
+                            nAnswerTTL = std::min<int64_t>(nAnswerTTL, nTTL);
+                        }
+                        elif(nType == DNS_TYPE_SOA && nDataLen >= 20)
+                        {
+                            // The SOA MINIMUM is the last field of its rdata.
+                            int64_t nMinimum = ReadUInt32(pRR + DNS_RR_FIXED_SIZE + nDataLen - 4);
+                            nSoaTTL = std::min<int64_t>(nTTL, nMinimum);
+                        }
+
+                        nOffset += DNS_RR_FIXED_SIZE + nDataLen;
+                    }
+
+                    bool bNegative = nRCode == 3 || nAnswerCount == 0;
+                    if (NULL != pNegative)
+                    {
+                        *pNegative = bNegative;
+                    }
+
+                    return static_cast<int>(std::min<int64_t>(bNegative ? nSoaTTL : nAnswerTTL, INT32_MAX));
+                }
             }
         }
     }
@@ -55,6 +55,16 @@ namespace ppp {
                     int                                                                     nPacketLength, 
                     const ppp::function<bool(dns_hdr*)>&                                    fPredicateB, 
                     const ppp::function<bool(dns_hdr*, ppp::string&, uint16_t, uint16_t)>&  fPredicateE) noexcept;
+
+                // Seconds a response may be cached for, the smallest answer TTL or, for NXDOMAIN and empty answers, the negative caching time
+                // Of the SOA in the authority section (RFC 2308) and nNegativeTTL without one. Returns -1 for truncated, failed or malformed
+                // Responses. pTTLOffsets receives the offsets of the answer and authority TTL fields.
+                int                                                                         ExtractTTL(
+                    const Byte*                                                             szPacketStartPos, 
+                    int                                                                     nPacketLength,
+                    int                                                                     nNegativeTTL,
+                    bool*                                                                   pNegative,
+                    ppp::vector<uint16_t>*                                                  pTTLOffsets) noexcept;
             }
 
             inline Byte                                                                     GetBitValueAt(Byte b, Byte offset, Byte length) noexcept {
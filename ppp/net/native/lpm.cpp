@@ -0,0 +1,219 @@
+#include <ppp/net/native/lpm.h>
+
+namespace ppp
+{
+    namespace net
+    {
+        namespace native
+        {
+            static constexpr int                                        PREFIX_MATCH_ROOT_STRIDE = 16;
+            static constexpr int                                        PREFIX_MATCH_V4_STRIDE   = 8;
+            static constexpr int                                        PREFIX_MATCH_V6_STRIDE   = 4;
+            static constexpr uint32_t                                   PREFIX_MATCH_CHILD       = 0x80000000u;
+
+            static inline uint32_t PrefixMatchIndex(const Byte* address, int bit, int stride) noexcept
+            {
+                if (stride == PREFIX_MATCH_ROOT_STRIDE)
+                {
+                    return address[0] << 8 | address[1];
+                }
+                elif(stride == PREFIX_MATCH_V4_STRIDE)
+                {
+                    return address[bit >> 3];
+                }
+                else
+                {
+                    return address[bit >> 3] >> (4 - (bit & 4)) & 0x0f;
+                }
+            }
+
+            bool PrefixMatchTableEntry(PrefixMatchTable::Entry& entry, const Byte* address, int address_length, int prefix, uint32_t value) noexcept
+            {
+                if (NULL == address || (address_length != 4 && address_length != PrefixMatchTable::MAX_ADDRESS_LENGTH))
+                {
+                    return false;
+                }
+
+                if (prefix < 0 || prefix > (address_length << 3))
+                {
+                    return false;
+                }
+
+                memset(entry.Address, 0, sizeof(entry.Address));
+                memcpy(entry.Address, address, address_length);
+
+                int bytes = prefix >> 3;
+                int bits = prefix & 7;
+                if (bits)
+                {
+                    entry.Address[bytes++] &= (Byte)(0xff << (8 - bits));
+                }
+
+                if (bytes < address_length)
+                {
+                    memset(entry.Address + bytes, 0, address_length - bytes);
+                }
+
+                entry.Prefix = prefix;
+                entry.Value = value;
+                return true;
+            }
+
+            std::shared_ptr<PrefixMatchTable> PrefixMatchTable::Compile(int address_length, EntryList& entries) noexcept
+            {
+                if (address_length != 4 && address_length != MAX_ADDRESS_LENGTH)
+                {
+                    return NULL;
+                }
+
+                std::shared_ptr<PrefixMatchTable> table = make_shared_object<PrefixMatchTable>();
+                if (NULL == table)
+                {
+                    return NULL;
+                }
+
+                table->address_length_ = address_length;
+                table->node_stride_ = address_length == 4 ? PREFIX_MATCH_V4_STRIDE : PREFIX_MATCH_V6_STRIDE;
+                table->NewNode(1 << PREFIX_MATCH_ROOT_STRIDE, 0);
+
+                // Shorter prefixes go first, so a range filled at one level never has to be pushed below an existing child:
+                // Children are only created by longer prefixes, which are inserted later and inherit the value they split.
+                std::stable_sort(entries.begin(), entries.end(),
+                    [](const Entry& x, const Entry& y) noexcept
+                    {
+                        return x.Prefix < y.Prefix;
+                    });
+
+                for (const Entry& entry : entries)
+                {
+                    if (entry.Prefix < 0 || entry.Prefix > (address_length << 3))
+                    {
+                        continue;
+                    }
+
+                    if (!table->Add(entry))
+                    {
+                        return NULL;
+                    }
+                }
+
+                table->nodes_.shrink_to_fit();
+                table->values_.shrink_to_fit();
+                return table;
+            }
+
+            uint32_t PrefixMatchTable::NewNode(int node_size, uint32_t fill) noexcept
+            {
+                uint32_t offset = (uint32_t)nodes_.size();
+                nodes_.resize(nodes_.size() + node_size, fill);
+                return offset;
+            }
+
+            bool PrefixMatchTable::Add(const Entry& entry) noexcept
+            {
+                uint32_t leaf = 0;
+                for (std::size_t i = values_.size(); i > 0; i--)
+                {
+                    if (values_[i - 1] == entry.Value)
+                    {
+                        leaf = (uint32_t)i;
+                        break;
+                    }
+                }
+
+                if (leaf == 0)
+                {
+                    values_.emplace_back(entry.Value);
+                    leaf = (uint32_t)values_.size();
+                }
+
+                const Byte* address = entry.Address;
+                uint32_t node = 0;
+                int bit = 0;
+                int stride = PREFIX_MATCH_ROOT_STRIDE;
+                for (;;)
+                {
+                    int end = bit + stride;
+                    uint32_t index = PrefixMatchIndex(address, bit, stride);
+                    if (entry.Prefix <= end)
+                    {
+                        uint32_t span = 1u << (end - entry.Prefix);
+                        uint32_t first = index & ~(span - 1);
+                        for (uint32_t i = 0; i < span; i++)
+                        {
+                            nodes_[node + first + i] = leaf;
+                        }
+                        return true;
+                    }
+
+                    uint32_t slot = nodes_[node + index];
+                    if ((slot & PREFIX_MATCH_CHILD) == 0)
+                    {
+                        uint32_t child = NewNode(1 << node_stride_, slot);
+                        if (child & PREFIX_MATCH_CHILD)
+                        {
+                            return false;
+                        }
+
+                        slot = PREFIX_MATCH_CHILD | child;
+                        nodes_[node + index] = slot;
+                    }
+
+                    node = slot & ~PREFIX_MATCH_CHILD;
+                    bit = end;
+                    stride = node_stride_;
+                }
+            }
+
+            bool PrefixMatchTable::Lookup(const Byte* address, uint32_t& value) const noexcept
+            {
+                if (NULL == address || nodes_.empty())
+                {
+                    return false;
+                }
+
+                const uint32_t* nodes = nodes_.data();
+                uint32_t slot = nodes[address[0] << 8 | address[1]];
+                for (int bit = PREFIX_MATCH_ROOT_STRIDE; slot & PREFIX_MATCH_CHILD; bit += node_stride_)
+                {
+                    slot = nodes[(slot & ~PREFIX_MATCH_CHILD) + PrefixMatchIndex(address, bit, node_stride_)];
+                }
+
+                if (slot == 0)
+                {
+                    return false;
+                }
+
+                value = values_[slot - 1];
+                return true;
+            }
+
+            bool PrefixMatchTable::Lookup(uint32_t ip, uint32_t& value) const noexcept
+            {
+                if (address_length_ != 4 || nodes_.empty())
+                {
+                    return false;
+                }
+
+                const uint32_t* nodes = nodes_.data();
+                uint32_t slot = nodes[ip >> 16];
+                if (slot & PREFIX_MATCH_CHILD)
+                {
+                    slot = nodes[(slot & ~PREFIX_MATCH_CHILD) + (ip >> 8 & 0xff)];
+                    if (slot & PREFIX_MATCH_CHILD)
+                    {
+                        slot = nodes[(slot & ~PREFIX_MATCH_CHILD) + (ip & 0xff)];
+                    }
+                }
+
+                if (slot == 0)
+                {
+                    return false;
+                }
+
+                value = values_[slot - 1];
+                return true;
+            }
+        }
+    }
+}
\ No newline at end of file
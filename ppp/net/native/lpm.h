@@ -0,0 +1,54 @@
+#pragma once
+
+#include <ppp/stdafx.h>
+
+namespace ppp
+{
+    namespace net
+    {
+        namespace native
+        {
+            // Immutable longest-prefix-match table, compiled once from a prefix set and then only read.
+            // It is a leaf-pushed multibit trie with a 16-bit root stride, followed by 8-bit strides for IPv4 (DIR-16-8-8) and 
+            // 4-bit strides for IPv6 to keep sparse long prefixes small, so a lookup costs one array access per stride 
+            // Instead of one hash probe per prefix length.
+            class PrefixMatchTable final
+            {
+            public:
+                static constexpr int                                    MAX_ADDRESS_LENGTH = 16;
+
+                typedef struct
+                {
+                    Byte                                                Address[MAX_ADDRESS_LENGTH]; // Network byte order.
+                    int                                                 Prefix;
+                    uint32_t                                            Value;
+                }                                                       Entry;
+                typedef ppp::vector<Entry>                              EntryList;
+
+            public:
+                PrefixMatchTable() noexcept = default;
+
+            public:
+                // Later entries with the same address and prefix override earlier ones.
+                static std::shared_ptr<PrefixMatchTable>                Compile(int address_length, EntryList& entries) noexcept;
+                bool                                                    Lookup(const Byte* address, uint32_t& value) const noexcept;
+                bool                                                    Lookup(uint32_t ip, uint32_t& value) const noexcept; // Host byte order, IPv4 tables only.
+                int                                                     GetAddressLength() const noexcept { return address_length_; }
+                std::size_t                                             GetMemorySize() const noexcept { return (nodes_.size() + values_.size()) * sizeof(uint32_t); }
+
+            private:
+                bool                                                    Add(const Entry& entry) noexcept;
+                uint32_t                                                NewNode(int node_size, uint32_t fill) noexcept;
+
+            private:
+                int                                                     address_length_ = 0;
+                int                                                     node_stride_    = 0;
+                ppp::vector<uint32_t>                                   nodes_;
+                ppp::vector<uint32_t>                                   values_;
+            };
+
+            // Builds a prefix entry, the address is masked down to its prefix.
+            bool                                                        PrefixMatchTableEntry(PrefixMatchTable::Entry& entry, const Byte* address, int address_length, int prefix, uint32_t value) noexcept;
+        }
+    }
+}
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include <ppp/stdafx.h>
 #include <ppp/net/IPEndPoint.h>
+#include <ppp/net/native/lpm.h>
 
 namespace ppp
 {
@@ -47,7 +48,7 @@ namespace ppp
                 RouteEntriesTable                                       routes;
             };
 
-            // FIB
+            // FIB, Fill compiles the routes into an immutable prefix match table that GetNextHop uses on the packet path.
             class ForwardInformationTable
             {
             public:
@@ -62,9 +63,11 @@ namespace ppp
                 void                                                    Clear() noexcept;
                 RouteEntriesTable&                                      GetAllRoutes() noexcept;
                 bool                                                    IsAvailable() noexcept { return routes.begin() != routes.end(); }
+                std::shared_ptr<PrefixMatchTable>                       GetPrefixMatchTable() noexcept { return std::atomic_load(&table); }
 
             private:
                 RouteEntriesTable                                       routes;
+                std::shared_ptr<PrefixMatchTable>                       table;
             };
         }
     }
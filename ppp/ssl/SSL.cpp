@@ -5,6 +5,37 @@
 
 namespace ppp {
     namespace ssl {
+        typedef std::mutex                                                      SynchronizedObject;
+        typedef std::lock_guard<SynchronizedObject>                             SynchronizedObjectScope;
+        typedef std::shared_ptr<boost::asio::ssl::context>                      SslContextPtr;
+        typedef std::shared_ptr<SSL_SESSION>                                    SslSessionPtr;
+
+        static constexpr std::size_t                                            SSL_CLIENT_SESSION_CACHE_SIZE = 1024;
+
+        static struct {
+            SynchronizedObject                                                  syncobj;
+            std::atomic<int>                                                    generation = 0;
+            ppp::unordered_map<ppp::string, std::pair<int, SslContextPtr>>      servers;
+            ppp::unordered_map<ppp::string, SslContextPtr>                      clients;
+            ppp::unordered_map<ppp::string, SslSessionPtr>                      sessions;
+        }                                                                       SSL_CACHE;
+
+        static int SSL_NewClientSession(::SSL* ssl, SSL_SESSION* session) noexcept {
+            const char* host = SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name);
+            if (NULL == host || *host == '\x0') {
+                return 0;
+            }
+
+            SslSessionPtr value = SslSessionPtr(session, SSL_SESSION_free);
+            SynchronizedObjectScope scope(SSL_CACHE.syncobj);
+            if (SSL_CACHE.sessions.size() >= SSL_CLIENT_SESSION_CACHE_SIZE && SSL_CACHE.sessions.find(host) == SSL_CACHE.sessions.end()) {
+                SSL_CACHE.sessions.erase(SSL_CACHE.sessions.begin());
+            }
+
+            SSL_CACHE.sessions[host] = std::move(value);
+            return 1; /* The cache owns the reference. */
+        }
+
         boost::asio::ssl::context::method SSL::SSL_S_METHOD(int method) noexcept {
             switch (method) {
             case SSL_METHOD::tlsv13:
@@ -184,6 +215,121 @@ namespace ppp {
             return ssl_context;
         }
 
+        std::shared_ptr<boost::asio::ssl::context> SSL::GetServerSslContext(
+            int                                         method,
+            const std::string&                          certificate_file,
+            const std::string&                          certificate_key_file,
+            const std::string&                          certificate_chain_file,
+            const std::string&                          certificate_key_password,
+            const std::string&                          ciphersuites) noexcept {
+
+            ppp::string key = stl::to_string<ppp::string>(method);
+            for (const std::string* s : { &certificate_file, &certificate_key_file, &certificate_chain_file, &certificate_key_password, &ciphersuites }) {
+                key.append(1, '\x0');
+                key.append(s->data(), s->size());
+            }
+
+            int generation = SSL_CACHE.generation.load();
+            SslContextPtr previous;
+            for (;;) {
+                SynchronizedObjectScope scope(SSL_CACHE.syncobj);
+                auto tail = SSL_CACHE.servers.find(key);
+                if (tail != SSL_CACHE.servers.end()) {
+                    if (tail->second.first == generation) {
+                        return tail->second.second;
+                    }
+
+                    previous = tail->second.second;
+                }
+                break;
+            }
+
+            // Built outside of the lock, handshakes of other listeners do not wait on the disk.
+            SslContextPtr ssl_context = CreateServerSslContext(method, certificate_file, certificate_key_file, certificate_chain_file, certificate_key_password, ciphersuites);
+            if (NULL == ssl_context) {
+                return previous;
+            }
+
+            SSL_CTX* ctx = ssl_context->native_handle();
+            SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_SERVER);
+            SSL_CTX_set_session_id_context(ctx, (const Byte*)key.data(), (unsigned int)std::min<std::size_t>(key.size(), SSL_MAX_SID_CTX_LENGTH));
+            if (NULL != previous) {
+                Byte ticket_keys[80];
+                if (SSL_CTX_get_tlsext_ticket_keys(previous->native_handle(), ticket_keys, sizeof(ticket_keys)) > 0) {
+                    SSL_CTX_set_tlsext_ticket_keys(ctx, ticket_keys, sizeof(ticket_keys));
+                }
+
+                OPENSSL_cleanse(ticket_keys, sizeof(ticket_keys));
+            }
+
+            SynchronizedObjectScope scope(SSL_CACHE.syncobj);
+            auto& entry = SSL_CACHE.servers[key];
+            if (NULL != entry.second && entry.first == generation) {
+                return entry.second; /* Another handshake was faster. */
+            }
+
+            entry = std::make_pair(generation, ssl_context);
+            return ssl_context;
+        }
+
+        std::shared_ptr<boost::asio::ssl::context> SSL::GetClientSslContext(
+            int                                         method,
+            bool                                        verify_peer,
+            const std::string&                          ciphersuites) noexcept {
+
+            ppp::string key = stl::to_string<ppp::string>(method) + (verify_peer ? "+" : "-") + ppp::string(ciphersuites.data(), ciphersuites.size());
+            for (;;) {
+                SynchronizedObjectScope scope(SSL_CACHE.syncobj);
+                auto tail = SSL_CACHE.clients.find(key);
+                if (tail != SSL_CACHE.clients.end()) {
+                    return tail->second;
+                }
+                break;
+            }
+
+            SslContextPtr ssl_context = CreateClientSslContext(method, verify_peer, ciphersuites);
+            if (NULL == ssl_context) {
+                return NULL;
+            }
+
+            // Sessions are kept by host in the process wide cache, the context's own cache is keyed by session id only.
+            SSL_CTX* ctx = ssl_context->native_handle();
+            SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+            SSL_CTX_sess_set_new_cb(ctx, SSL_NewClientSession);
+
+            SynchronizedObjectScope scope(SSL_CACHE.syncobj);
+            auto r = SSL_CACHE.clients.emplace(key, ssl_context);
+            return r.first->second;
+        }
+
+        void SSL::ReloadSslContexts() noexcept {
+            SSL_CACHE.generation++;
+        }
+
+        bool SSL::SetClientSslSession(::SSL* ssl, const ppp::string& host) noexcept {
+            if (NULL == ssl || host.empty()) {
+                return false;
+            }
+
+            SslSessionPtr session;
+            for (;;) {
+                SynchronizedObjectScope scope(SSL_CACHE.syncobj);
+                auto tail = SSL_CACHE.sessions.find(host);
+                if (tail == SSL_CACHE.sessions.end()) {
+                    return false;
+                }
+
+                session = tail->second;
+                break;
+            }
+
+            if (!SSL_SESSION_is_resumable(session.get())) {
+                return false;
+            }
+
+            return SSL_set_session(ssl, session.get()) == 1;
+        }
+
         const char* SSL::GetSslCiphersuites() noexcept {
 #if !(defined(__aarch64__) || defined(_M_ARM64))
             if (strstr(GetPlatformCode(), "ARM")) {
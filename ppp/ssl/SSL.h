@@ -38,6 +38,27 @@ namespace ppp {
                 int                                                         method,
                 bool                                                        verify_peer,
                 const std::string&                                          ciphersuites) noexcept;
+
+        public:
+            // Contexts shared by every connection with the same settings: certificates are loaded from disk once per listener,
+            // And tickets the server issues stay valid for all of its connections. A reload drops the server contexts (ticket keys
+            // Are carried over), they are rebuilt from disk by the next handshake.
+            static std::shared_ptr<boost::asio::ssl::context>               GetServerSslContext(
+                int                                                         method,
+                const std::string&                                          certificate_file,
+                const std::string&                                          certificate_key_file,
+                const std::string&                                          certificate_chain_file,
+                const std::string&                                          certificate_key_password,
+                const std::string&                                          ciphersuites) noexcept;
+            static std::shared_ptr<boost::asio::ssl::context>               GetClientSslContext(
+                int                                                         method,
+                bool                                                        verify_peer,
+                const std::string&                                          ciphersuites) noexcept;
+            static void                                                     ReloadSslContexts() noexcept; /* Not async-signal-safe, SIGHUP reaches it on the default executor through a signal_set. */
+
+        public:
+            // Resumes the last session the server host issued to this process, if any, sessions are remembered per SNI host name.
+            static bool                                                     SetClientSslSession(::SSL* ssl, const ppp::string& host) noexcept;
         };
     }
 }
\ No newline at end of file
@@ -304,9 +304,14 @@ static constexpr int                                                        PPP_
 static constexpr int                                                        PPP_LISTEN_BACKLOG           = 511;
 static constexpr int                                                        PPP_TCP_CONNECT_TIMEOUT      = 5;
 static constexpr int                                                        PPP_TCP_INACTIVE_TIMEOUT     = 300;
+static constexpr int                                                        PPP_MUX_WINDOW_SIZE          = 262144;
 static constexpr int                                                        PPP_UDP_INACTIVE_TIMEOUT     = 72; 
 static constexpr int                                                        PPP_DNS_SYS_PORT             = 53;
+static constexpr int                                                        PPP_STUN_SYS_PORT            = 3478;
+static constexpr int                                                        PPP_STUN_GOOGLE_PORT         = 19302;
 static constexpr int                                                        PPP_UDP_TIMER_INTERVAL       = 10;
+static constexpr int                                                        PPP_UDP_BATCH_SIZE           = 16;
+static constexpr int                                                        PPP_UDP_BATCH_MAX            = 64;
 static constexpr int                                                        PPP_COROUTINE_STACK_SIZE     = 65536; /* boost::context::stack_traits::default_size() */
 static constexpr const char*                                                PPP_PUBLIC_DNS_SERVER_LIST[] = {
     "1.0.0.1",
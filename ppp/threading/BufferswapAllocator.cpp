@@ -10,10 +10,103 @@ namespace ppp
 {
     namespace threading
     {
+        // Thread magazine size classes, the common packet buffer sizes: small control frames, MTU-sized frames and 64KB frames.
+        // Note that the underlying blocks align every allocation to the page size, so the first two classes cost one page each.
+        static constexpr struct
+        {
+            uint32_t                                                    MinSize;
+            uint32_t                                                    MaxSize;
+            int                                                         Capacity;
+        }                                                               BUFFERSWAP_MAGAZINE_SIZE_CLASSES[] =
+        {
+            { 1,        64,     32 },
+            { 65,       1536,   32 },
+            { 32769,    65536,  4  },
+        };
+        static constexpr int                                            BUFFERSWAP_MAGAZINE_SIZE_CLASS_COUNT = arraysizeof(BUFFERSWAP_MAGAZINE_SIZE_CLASSES);
+        static constexpr int                                            BUFFERSWAP_MAGAZINE_MAX_CAPACITY     = 32;
+        static std::atomic<uint64_t>                                    BUFFERSWAP_ALLOCATOR_ID              = 0;
+
+        class BufferswapAllocator::ThreadMagazine final
+        {
+        public:
+            std::atomic<bool>                                           Disposed = false;
+            int                                                         Counts[BUFFERSWAP_MAGAZINE_SIZE_CLASS_COUNT] = { 0 };
+            void*                                                       Buffers[BUFFERSWAP_MAGAZINE_SIZE_CLASS_COUNT][BUFFERSWAP_MAGAZINE_MAX_CAPACITY];
+
+        public:
+            // Only written by the owning thread, read by GetMagazineStatistics.
+            std::atomic<uint64_t>                                       Hits    = 0;
+            std::atomic<uint64_t>                                       Misses  = 0;
+            std::atomic<uint64_t>                                       Refills = 0;
+            std::atomic<uint64_t>                                       Spills  = 0;
+        };
+
+        // Outlives the allocator, the allocator clears Allocator under Lock before it goes away so an exiting thread never retires into freed memory.
+        class BufferswapAllocator::ThreadMagazineOwner final
+        {
+        public:
+            std::mutex                                                  Lock;
+            BufferswapAllocator*                                        Allocator = NULL;
+        };
+
+        class BufferswapAllocator::ThreadMagazineCache final
+        {
+        public:
+            struct Entry
+            {
+                ThreadMagazineOwnerPtr                                  Owner;
+                uint64_t                                                Id;
+                ThreadMagazinePtr                                       Magazine;
+            };
+            ppp::vector<Entry>                                          Entries;
+
+        public:
+            ~ThreadMagazineCache() noexcept
+            {
+                // The thread is exiting, hand the cached buffers back to the allocators that are still alive.
+                for (Entry& entry : Entries)
+                {
+                    std::lock_guard<std::mutex> scope(entry.Owner->Lock);
+                    BufferswapAllocator* allocator = entry.Owner->Allocator;
+                    if (NULL != allocator && !entry.Magazine->Disposed.load(std::memory_order_acquire))
+                    {
+                        allocator->RetireThreadMagazine(entry.Magazine);
+                    }
+                }
+            }
+        };
+
+        static inline int BufferswapAllocator_GetSizeClass(uint32_t allocated_size) noexcept
+        {
+            for (int i = 0; i < BUFFERSWAP_MAGAZINE_SIZE_CLASS_COUNT; i++)
+            {
+                auto& size_class = BUFFERSWAP_MAGAZINE_SIZE_CLASSES[i];
+                if (allocated_size >= size_class.MinSize && allocated_size <= size_class.MaxSize)
+                {
+                    return i;
+                }
+            }
+            return -1;
+        }
+
+        static inline void BufferswapAllocator_Increment(std::atomic<uint64_t>& counter) noexcept
+        {
+            // Single writer, a plain load/store pair avoids a locked read-modify-write on the packet path.
+            counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
         BufferswapAllocator::BufferswapAllocator(const ppp::string& path, uint64_t memory_size) noexcept
             : block_count_(0)
             , memory_size_(0)
+            , id_(++BUFFERSWAP_ALLOCATOR_ID)
+            , owner_(make_shared_object<ThreadMagazineOwner>())
         {
+            if (NULL != owner_)
+            {
+                owner_->Allocator = this;
+            }
+
 #if defined(_WIN32)
             if (memory_size > 0)
             {
@@ -78,12 +171,27 @@ namespace ppp
 
         BufferswapAllocator::~BufferswapAllocator() noexcept
         {
+            // Waits for a thread that is retiring its magazine right now, later ones see the allocator gone.
+            if (NULL != owner_)
+            {
+                std::lock_guard<std::mutex> scope(owner_->Lock);
+                owner_->Allocator = NULL;
+            }
+
             BufferblockAllocatorList blocks;
             do
             {
                 SynchronizedObjectScope scope(syncobj_);
                 blocks = std::move(blocks_);
                 blocks_.clear();
+
+                // The cached buffers live inside the blocks being released, the owning threads simply drop them.
+                for (ThreadMagazinePtr& magazine : magazines_)
+                {
+                    magazine->Disposed.store(true, std::memory_order_release);
+                }
+
+                magazines_.clear();
             } while (false);
 
             for (BufferblockAllocatorPtr& i : blocks)
@@ -99,8 +207,13 @@ namespace ppp
                 return NULL;
             }
 
-            int block_length = 0;
             SynchronizedObjectScope scope(syncobj_);
+            return AllocUnsafe(allocated_size);
+        }
+
+        void* BufferswapAllocator::AllocUnsafe(uint32_t allocated_size) noexcept
+        {
+            int block_length = 0;
             BufferblockAllocatorList::iterator tail = blocks_.begin();
             BufferblockAllocatorList::iterator endl = blocks_.end();
             while (tail != endl)
@@ -133,6 +246,11 @@ namespace ppp
             }
 
             SynchronizedObjectScope scope(syncobj_);
+            return FreeUnsafe(allocated_memory);
+        }
+
+        bool BufferswapAllocator::FreeUnsafe(const void* allocated_memory) noexcept
+        {
             for (auto&& block : blocks_)
             {
                 if (block->Free(allocated_memory))
@@ -143,6 +261,185 @@ namespace ppp
             return false;
         }
 
+        BufferswapAllocator::ThreadMagazine* BufferswapAllocator::GetThreadMagazine() noexcept
+        {
+            if (block_count_ < 1 || NULL == owner_)
+            {
+                return NULL;
+            }
+
+            static thread_local ThreadMagazineCache cache;
+
+            ppp::vector<ThreadMagazineCache::Entry>& entries = cache.Entries;
+            for (auto tail = entries.begin(); tail != entries.end(); tail++)
+            {
+                ThreadMagazineCache::Entry& entry = *tail;
+                if (entry.Magazine->Disposed.load(std::memory_order_acquire))
+                {
+                    // The owner was released, another allocator may since have been constructed at the same address.
+                    entries.erase(tail);
+                    return GetThreadMagazine();
+                }
+                elif(entry.Owner == owner_ && entry.Id == id_)
+                {
+                    return entry.Magazine.get();
+                }
+            }
+
+            ThreadMagazinePtr magazine = make_shared_object<ThreadMagazine>();
+            if (NULL == magazine)
+            {
+                return NULL;
+            }
+
+            do
+            {
+                SynchronizedObjectScope scope(syncobj_);
+                magazines_.emplace_back(magazine);
+            } while (false);
+
+            entries.emplace_back(ThreadMagazineCache::Entry{ owner_, id_, magazine });
+            return magazine.get();
+        }
+
+        void BufferswapAllocator::RetireThreadMagazine(const ThreadMagazinePtr& magazine) noexcept
+        {
+            SynchronizedObjectScope scope(syncobj_);
+            if (magazine->Disposed.exchange(true))
+            {
+                return;
+            }
+
+            for (int i = 0; i < BUFFERSWAP_MAGAZINE_SIZE_CLASS_COUNT; i++)
+            {
+                for (int j = 0, count = magazine->Counts[i]; j < count; j++)
+                {
+                    FreeUnsafe(magazine->Buffers[i][j]);
+                }
+
+                magazine->Counts[i] = 0;
+            }
+
+            magazines_retired_.Hits += magazine->Hits.load(std::memory_order_relaxed);
+            magazines_retired_.Misses += magazine->Misses.load(std::memory_order_relaxed);
+            magazines_retired_.Refills += magazine->Refills.load(std::memory_order_relaxed);
+            magazines_retired_.Spills += magazine->Spills.load(std::memory_order_relaxed);
+
+            auto tail = std::find(magazines_.begin(), magazines_.end(), magazine);
+            if (tail != magazines_.end())
+            {
+                magazines_.erase(tail);
+            }
+        }
+
+        void* BufferswapAllocator::AllocCached(uint32_t allocated_size) noexcept
+        {
+            int size_class = BufferswapAllocator_GetSizeClass(allocated_size);
+            if (size_class < 0)
+            {
+                return Alloc(allocated_size);
+            }
+
+            ThreadMagazine* magazine = GetThreadMagazine();
+            if (NULL == magazine)
+            {
+                return Alloc(allocated_size);
+            }
+
+            int& count = magazine->Counts[size_class];
+            if (count > 0)
+            {
+                BufferswapAllocator_Increment(magazine->Hits);
+                return magazine->Buffers[size_class][--count];
+            }
+
+            // Refill half of the magazine under a single acquisition of the shared lock.
+            auto& size_class_info = BUFFERSWAP_MAGAZINE_SIZE_CLASSES[size_class];
+            int batch = std::max<int>(1, size_class_info.Capacity >> 1);
+
+            BufferswapAllocator_Increment(magazine->Misses);
+            do
+            {
+                SynchronizedObjectScope scope(syncobj_);
+                while (count < batch)
+                {
+                    void* memory = AllocUnsafe(size_class_info.MaxSize);
+                    if (NULL == memory)
+                    {
+                        break;
+                    }
+
+                    magazine->Buffers[size_class][count++] = memory;
+                }
+            } while (false);
+
+            if (count < 1)
+            {
+                return NULL;
+            }
+
+            BufferswapAllocator_Increment(magazine->Refills);
+            return magazine->Buffers[size_class][--count];
+        }
+
+        bool BufferswapAllocator::FreeCached(const void* allocated_memory, uint32_t allocated_size) noexcept
+        {
+            if (NULL == allocated_memory)
+            {
+                return false;
+            }
+
+            int size_class = BufferswapAllocator_GetSizeClass(allocated_size);
+            if (size_class < 0)
+            {
+                return Free(allocated_memory);
+            }
+
+            ThreadMagazine* magazine = GetThreadMagazine();
+            if (NULL == magazine)
+            {
+                return Free(allocated_memory);
+            }
+
+            int& count = magazine->Counts[size_class];
+            int capacity = BUFFERSWAP_MAGAZINE_SIZE_CLASSES[size_class].Capacity;
+            if (count >= capacity)
+            {
+                // Spill the older half back to the blocks under a single acquisition of the shared lock.
+                void** buffers = magazine->Buffers[size_class];
+                int batch = std::max<int>(1, capacity >> 1);
+                do
+                {
+                    SynchronizedObjectScope scope(syncobj_);
+                    for (int i = 0; i < batch; i++)
+                    {
+                        FreeUnsafe(buffers[i]);
+                    }
+                } while (false);
+
+                count -= batch;
+                memmove(buffers, buffers + batch, count * sizeof(void*));
+                BufferswapAllocator_Increment(magazine->Spills);
+            }
+
+            magazine->Buffers[size_class][count++] = constantof(allocated_memory);
+            return true;
+        }
+
+        void BufferswapAllocator::GetMagazineStatistics(MagazineStatistics& statistics) noexcept
+        {
+            SynchronizedObjectScope scope(syncobj_);
+            statistics = magazines_retired_;
+
+            for (ThreadMagazinePtr& magazine : magazines_)
+            {
+                statistics.Hits += magazine->Hits.load(std::memory_order_relaxed);
+                statistics.Misses += magazine->Misses.load(std::memory_order_relaxed);
+                statistics.Refills += magazine->Refills.load(std::memory_order_relaxed);
+                statistics.Spills += magazine->Spills.load(std::memory_order_relaxed);
+            }
+        }
+
         bool BufferswapAllocator::IsVaild() noexcept
         {
             SynchronizedObjectScope scope(syncobj_);
@@ -13,11 +13,27 @@ namespace ppp
             typedef ppp::list<BufferblockAllocatorPtr>                  BufferblockAllocatorList;
             typedef std::mutex                                          SynchronizedObject;
             typedef std::lock_guard<SynchronizedObject>                 SynchronizedObjectScope;
+            class                                                       ThreadMagazine;
+            class                                                       ThreadMagazineCache;
+            class                                                       ThreadMagazineOwner;
+            typedef std::shared_ptr<ThreadMagazine>                     ThreadMagazinePtr;
+            typedef std::shared_ptr<ThreadMagazineOwner>                ThreadMagazineOwnerPtr;
+            typedef ppp::list<ThreadMagazinePtr>                        ThreadMagazineList;
 
         public:
             /* FAT32 file-system maxsize ≈ 4GB ~ 2B */
             static constexpr uint64_t                                   MAX_MEMORY_BLOCK_SIZE = 1073741824; /* 4294967280 */
 
+        public:
+            class MagazineStatistics
+            {
+            public:
+                uint64_t                                                Hits    = 0; /* Served from the thread magazine without taking the shared lock. */
+                uint64_t                                                Misses  = 0; /* The magazine was empty and had to be refilled from the blocks. */
+                uint64_t                                                Refills = 0; /* Batches moved from the blocks into the thread magazines. */
+                uint64_t                                                Spills  = 0; /* Batches moved from full thread magazines back to the blocks. */
+            };
+
         public:
             BufferswapAllocator(const ppp::string& path, uint64_t memory_size) noexcept;
             virtual ~BufferswapAllocator() noexcept;
@@ -31,6 +47,12 @@ namespace ppp
             uint64_t                                                    GetMemorySize() noexcept;
             uint64_t                                                    GetAvailableSize() noexcept;
 
+        public:
+            // Size-class cached variants, memory returned by AllocCached must be released by FreeCached with the same size.
+            void*                                                       AllocCached(uint32_t allocated_size) noexcept;
+            bool                                                        FreeCached(const void* allocated_memory, uint32_t allocated_size) noexcept;
+            void                                                        GetMagazineStatistics(MagazineStatistics& statistics) noexcept;
+
         public:
             template <typename T>
             std::shared_ptr<T>                                          MakeArray(int length) noexcept {
@@ -40,14 +62,15 @@ namespace ppp
                     return NULL;
                 }
 
-                T* memory = (T*)Alloc(length * sizeof(T));
+                uint32_t allocated_size = length * sizeof(T);
+                T* memory = (T*)AllocCached(allocated_size);
                 if (NULL == memory) {
                     return make_shared_alloc<T>(length);
                 }
 
                 return std::shared_ptr<T>(memory,
-                    [this](void* allocated_memory) noexcept {
-                        Free(allocated_memory);
+                    [this, allocated_size](void* allocated_memory) noexcept {
+                        FreeCached(allocated_memory, allocated_size);
                     });
             }
 
@@ -55,7 +78,7 @@ namespace ppp
             std::shared_ptr<T>                                          MakeObject(A&&... args) noexcept {
                 static_assert(sizeof(T) > 0, "can't make pointer to incomplete type");
 
-                void* memory = Alloc(sizeof(T));
+                void* memory = AllocCached(sizeof(T));
                 if (NULL == memory) {
                     return make_shared_object<T>(std::forward<A&&>(args)...);
                 }
@@ -65,7 +88,7 @@ namespace ppp
                     [this](T* p) noexcept {
                         if (NULL != p) {
                             p->~T();
-                            Free(p);
+                            FreeCached(p, sizeof(T));
                         }
                     });
             }
@@ -79,11 +102,21 @@ namespace ppp
                 }
             }
 
+        private:
+            void*                                                       AllocUnsafe(uint32_t allocated_size) noexcept;
+            bool                                                        FreeUnsafe(const void* allocated_memory) noexcept;
+            ThreadMagazine*                                             GetThreadMagazine() noexcept;
+            void                                                        RetireThreadMagazine(const ThreadMagazinePtr& magazine) noexcept;
+
         private:
             SynchronizedObject                                          syncobj_;
             BufferblockAllocatorList                                    blocks_;
             int                                                         block_count_     = 0;
             uint64_t                                                    memory_size_     = 0;
+            uint64_t                                                    id_              = 0;
+            ThreadMagazineOwnerPtr                                      owner_;
+            ThreadMagazineList                                          magazines_;
+            MagazineStatistics                                          magazines_retired_;
         };
     }
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include <ppp/threading/Executors.h>
 #include <ppp/threading/Timer.h>
+#include <ppp/threading/TimingWheel.h>
 #include <ppp/threading/Thread.h>
 #include <common/libtcpip/netstack.h>
 
@@ -20,6 +21,20 @@ namespace ppp
         typedef std::shared_ptr<Thread>                                         ExecutorThreadPtr;
         typedef ppp::unordered_map<boost::asio::io_context*, ExecutorThreadPtr> ExecutorThreadTable;
         typedef ppp::unordered_map<boost::asio::io_context*, BufferArray>       ExecutorBufferArrayTable;
+        typedef std::shared_ptr<TimingWheel>                                    ExecutorTimingWheelPtr;
+        typedef ppp::unordered_map<boost::asio::io_context*, ExecutorTimingWheelPtr> ExecutorTimingWheelTable;
+
+        // Selection counter of one worker context, shared between successive snapshots so the 
+        // Counts survive threads being added or removed.
+        class ExecutorLoadCounter final
+        {
+        public:
+            ExecutorContextPtr                                                  Context;
+            std::atomic<uint64_t>                                               Assigned = 0;
+        };
+        typedef std::shared_ptr<ExecutorLoadCounter>                            ExecutorLoadCounterPtr;
+        typedef ppp::vector<ExecutorLoadCounterPtr>                             ExecutorLoadArray;
+        typedef std::shared_ptr<ExecutorLoadArray>                              ExecutorLoadArrayPtr;
 
         class ExecutorsInternal final
         {
@@ -35,7 +50,11 @@ namespace ppp
             ExecutorTable                                                       ContextTable;
             ExecutorThreadTable                                                 Threads;
             ExecutorBufferArrayTable                                            Buffers;
+            ExecutorTimingWheelTable                                            Wheels;
             std::shared_ptr<Executors::Awaitable>                               NetstackExitAwaitable;
+            ExecutorLoadArrayPtr                                                Loads;          // Immutable snapshot, std::atomic_load/std::atomic_store only.
+            std::atomic<uint64_t>                                               LoadsCursor   = 0;
+            std::atomic<uint64_t>                                               DefaultAssigned = 0;
 
         public:
             ExecutorsInternal() noexcept;
@@ -154,6 +173,92 @@ namespace ppp
             }
         }
 
+        static void Executors_AddTimingWheel(const std::shared_ptr<boost::asio::io_context>& context) noexcept
+        {
+            ExecutorTimingWheelPtr wheel = make_shared_object<TimingWheel>(context);
+            if (NULL != wheel)
+            {
+                Internal->Wheels[context.get()] = wheel;
+            }
+        }
+
+        // Disposed outside of Internal->Lock, dropping the pending timeouts runs arbitrary destructors.
+        static void Executors_DeleteTimingWheel(const boost::asio::io_context* context) noexcept
+        {
+            ExecutorTimingWheelPtr wheel;
+            for (SynchronizedObjectScope scope(Internal->Lock);;)
+            {
+                ExecutorTimingWheelTable& wheels = Internal->Wheels;
+                ExecutorTimingWheelTable::iterator tail = wheels.find(constantof(context));
+                ExecutorTimingWheelTable::iterator endl = wheels.end();
+                if (tail != endl)
+                {
+                    wheel = std::move(tail->second);
+                    wheels.erase(tail);
+                }
+
+                break;
+            }
+
+            if (NULL != wheel)
+            {
+                // The cancelled sleeps post their resumption to a context that has already left run(), so it is polled once more
+                // To let those coroutines unwind and release their stacks.
+                int pending = wheel->GetCount();
+                wheel->Dispose();
+
+                if (pending > 0)
+                {
+                    boost::system::error_code ec;
+                    boost::asio::io_context* executor = constantof(context);
+                    executor->restart();
+                    executor->poll(ec);
+                }
+            }
+        }
+
+        // Rebuilds the worker context snapshot read by GetExecutor, must be called while holding Internal->Lock.
+        static void Executors_UpdateLoadsSnapshot() noexcept
+        {
+            ExecutorLoadArrayPtr previous = std::atomic_load(&Internal->Loads);
+            ExecutorLoadArrayPtr loads = make_shared_object<ExecutorLoadArray>();
+            if (NULL == loads)
+            {
+                return;
+            }
+
+            for (const ExecutorContextPtr& context : Internal->ContextFifo)
+            {
+                ExecutorLoadCounterPtr load;
+                if (NULL != previous)
+                {
+                    for (const ExecutorLoadCounterPtr& i : *previous)
+                    {
+                        if (i->Context == context)
+                        {
+                            load = i;
+                            break;
+                        }
+                    }
+                }
+
+                if (NULL == load)
+                {
+                    load = make_shared_object<ExecutorLoadCounter>();
+                    if (NULL == load)
+                    {
+                        continue;
+                    }
+
+                    load->Context = context;
+                }
+
+                loads->emplace_back(load);
+            }
+
+            std::atomic_store(&Internal->Loads, loads);
+        }
+
         static std::shared_ptr<boost::asio::io_context> Executors_AttachDefaultContext(const std::shared_ptr<BufferswapAllocator>& allocator) noexcept
         {
             SynchronizedObjectScope scope(Internal->Lock);
@@ -172,6 +277,7 @@ namespace ppp
             Internal->DefaultThreadId = GetCurrentThreadId();
             Internal->Buffers[context.get()] = BufferswapAllocator::MakeByteArray(allocator, PPP_BUFFER_SIZE);
 
+            Executors_AddTimingWheel(context);
             Executors_AddTickByDefaultContext();
             return context;
         }
@@ -191,6 +297,9 @@ namespace ppp
             Internal->ContextTable[threadId] = context;
             Internal->Threads[key] = Thread::GetCurrentThread();
             Internal->Buffers[key] = BufferswapAllocator::MakeByteArray(allocator, PPP_BUFFER_SIZE);
+
+            Executors_AddTimingWheel(context);
+            Executors_UpdateLoadsSnapshot();
             return context;
         }
 
@@ -199,6 +308,8 @@ namespace ppp
             ExecutorLinkedList& fifo = Internal->ContextFifo;
             ExecutorTable& contexts = Internal->ContextTable;
             ExecutorThreadTable& threads = Internal->Threads;
+            Executors_DeleteTimingWheel(context.get());
+
             SynchronizedObjectScope scope(Internal->Lock);
 
             auto CONTEXT_TABLE_TAIL = contexts.find(threadId);
@@ -223,10 +334,13 @@ namespace ppp
             }
 
             Executors_DeleteCachedBuffer(context.get());
+            Executors_UpdateLoadsSnapshot();
         }
 
         static void Executors_UnattachDefaultContext(const std::shared_ptr<boost::asio::io_context>& context) noexcept
         {
+            Executors_DeleteTimingWheel(context.get());
+
             SynchronizedObjectScope scope(Internal->Lock);
             Internal->DefaultThreadId = 0;
             Internal->Default.reset();
@@ -320,6 +434,46 @@ namespace ppp
             return tail != endl ? tail->second : NULL;
         }
 
+        std::shared_ptr<TimingWheel> Executors::GetTimingWheel(const boost::asio::io_context* context) noexcept
+        {
+            if (NULL == context)
+            {
+                return NULL;
+            }
+
+            // Almost every caller asks for the wheel of the context it runs on, the last answer is kept per thread so that arming a
+            // Timer does not take the global lock.
+            static thread_local const boost::asio::io_context* cached_context = NULL;
+            static thread_local std::weak_ptr<TimingWheel> cached_wheel;
+
+            if (cached_context == context)
+            {
+                std::shared_ptr<TimingWheel> wheel = cached_wheel.lock();
+                if (NULL != wheel && !wheel->IsDisposed())
+                {
+                    return wheel;
+                }
+            }
+
+            std::shared_ptr<TimingWheel> wheel;
+            for (SynchronizedObjectScope scope(Internal->Lock);;)
+            {
+                ExecutorTimingWheelTable& wheels = Internal->Wheels;
+                ExecutorTimingWheelTable::iterator tail = wheels.find(constantof(context));
+                ExecutorTimingWheelTable::iterator endl = wheels.end();
+                if (tail != endl)
+                {
+                    wheel = tail->second;
+                }
+
+                break;
+            }
+
+            cached_context = context;
+            cached_wheel = wheel;
+            return wheel;
+        }
+
         std::shared_ptr<boost::asio::io_context> Executors::GetCurrent() noexcept
         {
             int64_t threadId = GetCurrentThreadId();
@@ -338,31 +492,49 @@ namespace ppp
             return Internal->Default;
         }
 
-        std::shared_ptr<boost::asio::io_context> Executors::GetExecutor() noexcept
+        void Executors::GetExecutorLoads(ppp::vector<ExecutorLoad>& loads) noexcept
         {
-            std::shared_ptr<boost::asio::io_context> context;
-            do
+            ExecutorLoadArrayPtr snapshot = std::atomic_load(&Internal->Loads);
+            if (NULL != snapshot && !snapshot->empty())
             {
-                ExecutorLinkedList& fifo = Internal->ContextFifo;
-                ExecutorTable& contexts = Internal->ContextTable;
-                SynchronizedObjectScope scope(Internal->Lock);
-                if (contexts.size() == 1)
+                for (const ExecutorLoadCounterPtr& load : *snapshot)
                 {
-                    ExecutorTable::iterator tail = contexts.begin();
-                    context = tail->second;
+                    ExecutorLoad item;
+                    item.Context = load->Context;
+                    item.Assigned = load->Assigned.load(std::memory_order_relaxed);
+                    loads.emplace_back(item);
                 }
-                else
+            }
+            else
+            {
+                ExecutorContextPtr context = Internal->Default;
+                if (NULL != context)
                 {
-                    ExecutorLinkedList::iterator tail = fifo.begin();
-                    ExecutorLinkedList::iterator endl = fifo.end();
-                    if (tail != endl)
-                    {
-                        context = std::move(*tail);
-                        fifo.erase(tail);
-                        fifo.emplace_back(context);
-                    }
+                    ExecutorLoad item;
+                    item.Context = context;
+                    item.Assigned = Internal->DefaultAssigned.load(std::memory_order_relaxed);
+                    loads.emplace_back(item);
                 }
-            } while (false);
+            }
+        }
+
+        std::shared_ptr<boost::asio::io_context> Executors::GetExecutor() noexcept
+        {
+            // Lock-free round-robin over the worker contexts, the snapshot is only rebuilt when threads are added or removed.
+            ExecutorLoadArrayPtr loads = std::atomic_load(&Internal->Loads);
+            if (NULL != loads)
+            {
+                std::size_t count = loads->size();
+                if (count > 0)
+                {
+                    uint64_t index = Internal->LoadsCursor.fetch_add(1, std::memory_order_relaxed);
+                    const ExecutorLoadCounterPtr& load = (*loads)[index % count];
+                    load->Assigned.fetch_add(1, std::memory_order_relaxed);
+                    return load->Context;
+                }
+            }
+
+            Internal->DefaultAssigned.fetch_add(1, std::memory_order_relaxed);
             return Internal->Default;
         }
 
@@ -565,6 +737,8 @@ namespace ppp
 
                     releases.emplace_back(context);
                 }
+
+                Executors_UpdateLoadsSnapshot();
             }
 
             for (auto&& context : releases)
@@ -693,6 +867,8 @@ namespace ppp
 #endif
 
             Internal->Scheduler = scheduler;
+            Executors_AddTimingWheel(scheduler);
+
             for (int i = 0; i < completionPortThreads; i++)
             {
                 std::shared_ptr<Thread> t = make_shared_object<Thread>(
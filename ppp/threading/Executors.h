@@ -9,6 +9,8 @@ namespace ppp
 {
     namespace threading
     {
+        class TimingWheel;
+
         class Executors
         {
         public:
@@ -37,6 +39,11 @@ namespace ppp
                 std::condition_variable                                                             cv;
             };
             typedef ppp::function<void(int)>                                                        ApplicationExitEventHandler;
+            struct ExecutorLoad
+            {
+                ContextPtr                                                                          Context;
+                uint64_t                                                                            Assigned = 0;
+            };
 
         public:
             static ApplicationExitEventHandler                                                      ApplicationExit;
@@ -47,7 +54,9 @@ namespace ppp
             static std::shared_ptr<boost::asio::io_context>                                         GetCurrent() noexcept;
             static std::shared_ptr<boost::asio::io_context>                                         GetDefault() noexcept;
             static std::shared_ptr<Byte>                                                            GetCachedBuffer(const std::shared_ptr<boost::asio::io_context>& context) noexcept;
+            static std::shared_ptr<TimingWheel>                                                     GetTimingWheel(const boost::asio::io_context* context) noexcept;
             static void                                                                             GetAllContexts(ppp::vector<ContextPtr>& contexts) noexcept;
+            static void                                                                             GetExecutorLoads(ppp::vector<ExecutorLoad>& loads) noexcept;
 
         public:
             static DateTime                                                                         Now() noexcept;
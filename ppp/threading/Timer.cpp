@@ -49,8 +49,13 @@ namespace ppp {
                 Stop();
             }
 
+            // Executor contexts arm on their timing wheel, any other context keeps a deadline timer of its own.
             _last = 0;
-            _deadline_timer = make_shared_object<boost::asio::deadline_timer>(*_context);
+            _wheel = Executors::GetTimingWheel(_context.get());
+            if (NULL == _wheel) {
+                _deadline_timer = make_shared_object<boost::asio::deadline_timer>(*_context);
+            }
+
             return Next();
         }
 
@@ -59,6 +64,25 @@ namespace ppp {
                 return false;
             }
 
+            std::shared_ptr<TimingWheel> wheel = _wheel;
+            if (NULL != wheel) {
+                _last = Executors::GetTickCount();
+
+                std::shared_ptr<Timer> self = GetReference();
+                _wheel_entry = wheel->Schedule(_interval,
+                    [self, this](bool expired) noexcept {
+                        if (!expired) {
+                            _last = 0;
+                        }
+                        else if (NULL != _wheel) {
+                            TickEventArgs e(Executors::GetTickCount() - _last);
+                            OnTick(e);
+                            Next();
+                        }
+                    });
+                return NULL != _wheel_entry;
+            }
+
             std::shared_ptr<boost::asio::deadline_timer> t = _deadline_timer;
             if (NULL == t) {
                 return false;
@@ -90,9 +114,17 @@ namespace ppp {
                 ppp::net::Socket::Cancel(*t);
             }
 
+            std::shared_ptr<TimingWheel> wheel = std::move(_wheel);
+            TimingWheel::EntryPtr entry = std::move(_wheel_entry);
+            if (wheel) {
+                wheel->Cancel(entry);
+            }
+
             _last = 0;
             _deadline_timer = NULL;
-            return NULL != t;
+            _wheel = NULL;
+            _wheel_entry = NULL;
+            return NULL != t || NULL != wheel;
         }
 
         void Timer::Dispose() noexcept {
@@ -121,7 +153,7 @@ namespace ppp {
         }
 
         bool Timer::IsEnabled() noexcept {
-            return NULL != _deadline_timer;
+            return NULL != _deadline_timer || NULL != _wheel;
         }
 
         bool Timer::SetEnabled(bool value) noexcept {
@@ -203,6 +235,25 @@ namespace ppp {
                 return false;
             }
 
+            if (milliseconds >= 0) {
+                std::shared_ptr<TimingWheel> wheel = Executors::GetTimingWheel(&y.GetContext());
+                if (NULL != wheel) {
+                    bool ok = false;
+                    TimingWheel::EntryPtr entry = wheel->Schedule(milliseconds,
+                        [&y, &ok](bool expired) noexcept {
+                            ok = expired;
+                            y.R();
+                        });
+
+                    if (NULL == entry) {
+                        return false;
+                    }
+
+                    y.Suspend();
+                    return ok;
+                }
+            }
+
             boost::asio::strand<boost::asio::io_context::executor_type>* strand = y.GetStrand();
             std::shared_ptr<boost::asio::deadline_timer> deadlineTimer = strand ? 
                 make_shared_object<boost::asio::deadline_timer>(*strand) : 
@@ -3,6 +3,7 @@
 #include <ppp/stdafx.h>
 #include <ppp/Int128.h>
 #include <ppp/coroutines/YieldContext.h>
+#include <ppp/threading/TimingWheel.h>
 
 #include <boost/asio.hpp>
 #include <boost/asio/deadline_timer.hpp>
@@ -73,6 +74,8 @@ namespace ppp {
             int                                                                                             _interval  = 0;
             std::shared_ptr<boost::asio::io_context>                                                        _context;
             std::shared_ptr<boost::asio::deadline_timer>                                                    _deadline_timer;                                                                 
+            std::shared_ptr<TimingWheel>                                                                    _wheel;
+            TimingWheel::EntryPtr                                                                           _wheel_entry;
         };
     }
 }
\ No newline at end of file
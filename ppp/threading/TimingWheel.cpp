@@ -0,0 +1,323 @@
+#include <ppp/threading/TimingWheel.h>
+
+namespace ppp {
+    namespace threading {
+        TimingWheel::TimingWheel(const ContextPtr& context) noexcept
+            : disposed_(false)
+            , count_(0)
+            , current_(ppp::GetTickCount())
+            , deadline_(0)
+            , context_(context)
+            , timer_(*context) {
+            memset(bitmap_, 0, sizeof(bitmap_));
+            memset(root_, 0, sizeof(root_));
+            memset(levels_, 0, sizeof(levels_));
+        }
+
+        TimingWheel::~TimingWheel() noexcept {
+            Dispose();
+        }
+
+        int TimingWheel::GetCount() noexcept {
+            SynchronizedObjectScope scope(syncobj_);
+            return count_;
+        }
+
+        void TimingWheel::Link(Entry* entry) noexcept {
+            uint64_t expires = entry->expires_;
+            if (expires <= current_) {
+                expires = current_ + 1;
+            }
+
+            Entry** head = NULL;
+            uint64_t delta = expires - current_;
+            if (delta < ROOT_SIZE) {
+                int slot = (int)(expires & (ROOT_SIZE - 1));
+                entry->level_ = 0;
+                entry->slot_ = slot;
+                head = &root_[slot];
+                bitmap_[slot >> 6] |= 1ULL << (slot & 63);
+            }
+            else {
+                if (delta >= MAX_TICKS) {
+                    expires = current_ + MAX_TICKS - 1;
+                    delta = MAX_TICKS - 1;
+                }
+
+                for (int level = 1; level < LEVELS; level++) {
+                    int shift = ROOT_BITS + LEVEL_BITS * (level - 1);
+                    if (level == LEVELS - 1 || delta < (1ULL << (shift + LEVEL_BITS))) {
+                        int slot = (int)((expires >> shift) & (LEVEL_SIZE - 1));
+                        entry->level_ = level;
+                        entry->slot_ = slot;
+                        head = &levels_[level - 1][slot];
+                        break;
+                    }
+                }
+            }
+
+            entry->prev_ = NULL;
+            entry->next_ = *head;
+            if (NULL != *head) {
+                (*head)->prev_ = entry;
+            }
+
+            *head = entry;
+        }
+
+        void TimingWheel::Unlink(Entry* entry) noexcept {
+            int slot = entry->slot_;
+            Entry** head = entry->level_ == 0 ? &root_[slot] : &levels_[entry->level_ - 1][slot];
+            if (NULL != entry->prev_) {
+                entry->prev_->next_ = entry->next_;
+            }
+            else {
+                *head = entry->next_;
+            }
+
+            if (NULL != entry->next_) {
+                entry->next_->prev_ = entry->prev_;
+            }
+
+            if (entry->level_ == 0 && NULL == *head) {
+                bitmap_[slot >> 6] &= ~(1ULL << (slot & 63));
+            }
+
+            entry->prev_ = NULL;
+            entry->next_ = NULL;
+            entry->level_ = -1;
+        }
+
+        void TimingWheel::Cascade(int level, int slot) noexcept {
+            Entry* entry = levels_[level - 1][slot];
+            levels_[level - 1][slot] = NULL;
+
+            while (NULL != entry) {
+                Entry* next = entry->next_;
+                Link(entry);
+                entry = next;
+            }
+        }
+
+        void TimingWheel::Advance(uint64_t now, ppp::vector<EntryPtr>& expired) noexcept {
+            while (current_ < now) {
+                int index = (int)(++current_ & (ROOT_SIZE - 1));
+                if (index == 0) {
+                    for (int level = 1; level < LEVELS; level++) {
+                        int slot = (int)((current_ >> (ROOT_BITS + LEVEL_BITS * (level - 1))) & (LEVEL_SIZE - 1));
+                        Cascade(level, slot);
+                        if (slot != 0) {
+                            break;
+                        }
+                    }
+                }
+
+                // Detach the whole slot at once, every entry in it is due.
+                Entry* entry = root_[index];
+                if (NULL != entry) {
+                    root_[index] = NULL;
+                    bitmap_[index >> 6] &= ~(1ULL << (index & 63));
+
+                    while (NULL != entry) {
+                        Entry* next = entry->next_;
+                        entry->prev_ = NULL;
+                        entry->next_ = NULL;
+                        entry->level_ = -1;
+                        count_--;
+                        expired.emplace_back(std::move(entry->self_));
+                        entry = next;
+                    }
+                }
+
+                if (count_ < 1) {
+                    current_ = now;
+                    break;
+                }
+            }
+        }
+
+        void TimingWheel::Arm() noexcept {
+            if (disposed_ || count_ < 1) {
+                if (deadline_ != 0) {
+                    deadline_ = 0;
+
+                    boost::system::error_code ec;
+                    timer_.cancel(ec);
+                }
+                return;
+            }
+
+            // The next occupied slot before the first level wraps, otherwise the wrap itself where the upper levels cascade.
+            int index = (int)(current_ & (ROOT_SIZE - 1));
+            uint64_t next = (current_ | (ROOT_SIZE - 1)) + 1;
+            for (int i = index + 1; i < ROOT_SIZE;) {
+                uint64_t bits = bitmap_[i >> 6] >> (i & 63);
+                if (bits != 0) {
+                    for (; (bits & 1) == 0; bits >>= 1) {
+                        i++;
+                    }
+
+                    next = current_ - index + i;
+                    break;
+                }
+
+                i = (i | 63) + 1;
+            }
+
+            if (next == deadline_) {
+                return;
+            }
+
+            uint64_t now = ppp::GetTickCount();
+            deadline_ = next;
+
+            std::shared_ptr<TimingWheel> self = shared_from_this();
+            timer_.expires_from_now(boost::posix_time::milliseconds(next > now ? next - now : 0));
+            timer_.async_wait(
+                [self, this](const boost::system::error_code& ec) noexcept {
+                    if (ec != boost::system::errc::operation_canceled) {
+                        OnTick();
+                    }
+                });
+        }
+
+        void TimingWheel::OnTick() noexcept {
+            ppp::vector<EntryPtr> expired;
+            ppp::vector<TimeoutEventHandler> handlers;
+            for (SynchronizedObjectScope scope(syncobj_);;) {
+                if (disposed_) {
+                    return;
+                }
+
+                deadline_ = 0;
+                Advance(ppp::GetTickCount(), expired);
+                Arm();
+
+                // Take every handler out in the same critical section, a late batch may hold hundreds of thousands of them.
+                handlers.reserve(expired.size());
+                for (EntryPtr& entry : expired) {
+                    handlers.emplace_back(std::move(entry->handler_));
+                    entry->handler_ = NULL;
+                }
+                break;
+            }
+
+            for (TimeoutEventHandler& handler : handlers) {
+                if (NULL != handler) {
+                    handler(true);
+                }
+            }
+        }
+
+        TimingWheel::EntryPtr TimingWheel::Schedule(int milliseconds, const TimeoutEventHandler& handler) noexcept {
+            if (NULL == handler) {
+                return NULL;
+            }
+
+            EntryPtr entry = make_shared_object<Entry>();
+            if (NULL == entry) {
+                return NULL;
+            }
+
+            SynchronizedObjectScope scope(syncobj_);
+            if (disposed_) {
+                return NULL;
+            }
+
+            // An empty wheel may have slept for long, skip ahead instead of walking every tick it missed.
+            uint64_t now = ppp::GetTickCount();
+            if (count_ < 1 && current_ < now) {
+                current_ = now;
+            }
+
+            entry->expires_ = now + (uint64_t)std::max<int>(milliseconds, 0);
+            entry->handler_ = handler;
+            entry->self_ = entry;
+
+            Link(entry.get());
+            count_++;
+
+            if (deadline_ == 0 || entry->expires_ < deadline_) {
+                Arm();
+            }
+
+            return entry;
+        }
+
+        bool TimingWheel::Cancel(const EntryPtr& entry, bool notify) noexcept {
+            if (NULL == entry) {
+                return false;
+            }
+
+            TimeoutEventHandler handler;
+            EntryPtr reference;
+            for (SynchronizedObjectScope scope(syncobj_);;) {
+                if (entry->level_ >= 0) {
+                    Unlink(entry.get());
+                    count_--;
+                }
+
+                handler = std::move(entry->handler_);
+                reference = std::move(entry->self_);
+                entry->handler_ = NULL;
+                break;
+            }
+
+            if (NULL == handler) {
+                return false;
+            }
+
+            if (notify) {
+                handler(false);
+            }
+
+            return true;
+        }
+
+        void TimingWheel::Dispose() noexcept {
+            ppp::vector<EntryPtr> entries;
+            ppp::vector<TimeoutEventHandler> handlers;
+            for (SynchronizedObjectScope scope(syncobj_);;) {
+                if (disposed_) {
+                    return;
+                }
+
+                disposed_ = true;
+                for (int slot = 0; slot < ROOT_SIZE; slot++) {
+                    while (Entry* entry = root_[slot]) {
+                        Unlink(entry);
+                        entries.emplace_back(std::move(entry->self_));
+                    }
+                }
+
+                for (int level = 1; level < LEVELS; level++) {
+                    for (int slot = 0; slot < LEVEL_SIZE; slot++) {
+                        while (Entry* entry = levels_[level - 1][slot]) {
+                            Unlink(entry);
+                            entries.emplace_back(std::move(entry->self_));
+                        }
+                    }
+                }
+
+                for (EntryPtr& entry : entries) {
+                    handlers.emplace_back(std::move(entry->handler_));
+                    entry->handler_ = NULL;
+                }
+
+                count_ = 0;
+                deadline_ = 0;
+
+                boost::system::error_code ec;
+                timer_.cancel(ec);
+                break;
+            }
+
+            // Sleeping coroutines suspend until their handler resumes them, dropping the handlers would strand them for good.
+            for (TimeoutEventHandler& handler : handlers) {
+                if (NULL != handler) {
+                    handler(false);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <ppp/stdafx.h>
+
+#include <boost/asio.hpp>
+#include <boost/asio/deadline_timer.hpp>
+
+namespace ppp {
+    namespace threading {
+        // Hierarchical timing wheel of one executor, four levels of 256/64/64/64 slots at one millisecond per tick cover about 18 hours,
+        // Longer timeouts are re-cascaded until due. Arming and cancelling are O(1), the single deadline timer behind the wheel only
+        // Wakes up for the next occupied slot of the first level or for the next cascade, not once per tick.
+        class TimingWheel final : public std::enable_shared_from_this<TimingWheel> {
+        public:
+            // expired is false when the entry is dropped without reaching its deadline, the wheel was disposed or the entry was
+            // Cancelled with notify, so a parked coroutine still gets resumed and can tell the two apart.
+            typedef ppp::function<void(bool expired)>                                                       TimeoutEventHandler;
+            typedef std::shared_ptr<boost::asio::io_context>                                                ContextPtr;
+            typedef std::mutex                                                                              SynchronizedObject;
+            typedef std::lock_guard<SynchronizedObject>                                                     SynchronizedObjectScope;
+
+        public:
+            static constexpr int                                                                            ROOT_BITS  = 8;
+            static constexpr int                                                                            LEVEL_BITS = 6;
+            static constexpr int                                                                            LEVELS     = 4;
+            static constexpr int                                                                            ROOT_SIZE  = 1 << ROOT_BITS;
+            static constexpr int                                                                            LEVEL_SIZE = 1 << LEVEL_BITS;
+            static constexpr uint64_t                                                                       MAX_TICKS  = 1ULL << (ROOT_BITS + LEVEL_BITS * (LEVELS - 1));
+
+        public:
+            class Entry final {
+                friend class                                                                                TimingWheel;
+
+            public:
+                bool                                                                                        IsArmed() noexcept { return level_ >= 0; }
+
+            private:
+                Entry*                                                                                      prev_    = NULL;
+                Entry*                                                                                      next_    = NULL;
+                int                                                                                         level_   = -1;
+                int                                                                                         slot_    = 0;
+                uint64_t                                                                                    expires_ = 0;
+                TimeoutEventHandler                                                                         handler_;
+                std::shared_ptr<Entry>                                                                      self_;
+            };
+            typedef std::shared_ptr<Entry>                                                                  EntryPtr;
+
+        public:
+            TimingWheel(const ContextPtr& context) noexcept;
+            ~TimingWheel() noexcept;
+
+        public:
+            ContextPtr                                                                                      GetContext() noexcept { return context_; }
+            bool                                                                                            IsDisposed() noexcept { return disposed_; }
+            int                                                                                             GetCount() noexcept;
+            // The handler runs on the wheel's context, never inside Schedule.
+            EntryPtr                                                                                        Schedule(int milliseconds, const TimeoutEventHandler& handler) noexcept;
+            bool                                                                                            Cancel(const EntryPtr& entry, bool notify = false) noexcept;
+            // Every pending handler is called with expired = false once the lock is released.
+            void                                                                                            Dispose() noexcept;
+
+        private:
+            void                                                                                            Link(Entry* entry) noexcept;
+            void                                                                                            Unlink(Entry* entry) noexcept;
+            void                                                                                            Cascade(int level, int slot) noexcept;
+            void                                                                                            Advance(uint64_t now, ppp::vector<EntryPtr>& expired) noexcept;
+            void                                                                                            Arm() noexcept;
+            void                                                                                            OnTick() noexcept;
+
+        private:
+            SynchronizedObject                                                                              syncobj_;
+            std::atomic<bool>                                                                               disposed_ = false;
+            int                                                                                             count_    = 0;
+            uint64_t                                                                                        current_  = 0;
+            uint64_t                                                                                        deadline_ = 0;
+            uint64_t                                                                                        bitmap_[ROOT_SIZE >> 6];
+            Entry*                                                                                          root_[ROOT_SIZE];
+            Entry*                                                                                          levels_[LEVELS - 1][LEVEL_SIZE];
+            ContextPtr                                                                                      context_;
+            boost::asio::deadline_timer                                                                     timer_;
+        };
+    }
+}
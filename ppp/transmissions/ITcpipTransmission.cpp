@@ -11,6 +11,10 @@ using ppp::net::IPEndPoint;
 
 namespace ppp {
     namespace transmissions {
+        static std::atomic<UInt64>                                  ITcpipTransmission_Receives = 0;
+        static std::atomic<UInt64>                                  ITcpipTransmission_Bytes    = 0;
+        static std::atomic<UInt64>                                  ITcpipTransmission_Frames   = 0;
+
         ITcpipTransmission::ITcpipTransmission(
             const ContextPtr&                                       context, 
             const StrandPtr&                                        strand,
@@ -107,16 +111,43 @@ namespace ppp {
                 return NULL;
             }
 
-            std::shared_ptr<BufferswapAllocator> allocator = this->BufferAllocator;
-            std::shared_ptr<Byte> packet = BufferswapAllocator::MakeByteArray(allocator, length);
-            if (NULL == packet) {
-                return NULL;
+            std::shared_ptr<Byte> packet;
+            if (length > PPP_BUFFER_SIZE || length - rx_length_ >= (PPP_BUFFER_SIZE >> 1)) {
+                std::shared_ptr<BufferswapAllocator> allocator = this->BufferAllocator;
+                packet = BufferswapAllocator::MakeByteArray(allocator, length);
+                if (NULL == packet) {
+                    return NULL;
+                }
+
+                Byte* memory = packet.get();
+                int offset = rx_length_;
+                if (offset > 0) {
+                    memcpy(memory, rx_buffer_.get() + rx_offset_, offset);
+                    rx_offset_ += offset;
+                    rx_length_ = 0;
+                }
+
+                // Large payloads are received in place, staging them would only add a copy.
+                int remainder = length - offset;
+                ITcpipTransmission_Receives++;
+                if (!ppp::coroutines::asio::async_read(*socket, boost::asio::buffer(memory + offset, remainder), y)) {
+                    Dispose();
+                    return NULL;
+                }
+
+                ITcpipTransmission_Bytes += remainder;
             }
+            else {
+                // Serve the request from what the previous socket reads left over, a burst of small frames is then decoded
+                // Header and payload alike without going back to the socket, the frame is handed out in place of the buffer.
+                if (rx_length_ < length && ReceiveSome(y, socket, length) < length) {
+                    Dispose();
+                    return NULL;
+                }
 
-            bool ok = ppp::coroutines::asio::async_read(*socket, boost::asio::buffer(packet.get(), length), y);
-            if (!ok) {
-                Dispose();
-                return NULL;
+                packet = std::shared_ptr<Byte>(rx_buffer_, rx_buffer_.get() + rx_offset_);
+                rx_offset_ += length;
+                rx_length_ -= length;
             }
 
             std::shared_ptr<ITransmissionStatistics> statistics = this->Statistics;
@@ -127,6 +158,68 @@ namespace ppp {
             return packet;
         }
 
+        int ITcpipTransmission::ReceiveSome(YieldContext& y, const std::shared_ptr<boost::asio::ip::tcp::socket>& socket, int length) noexcept {
+            if (NULL == rx_buffer_) {
+                rx_buffer_ = BufferswapAllocator::MakeByteArray(this->BufferAllocator, PPP_BUFFER_SIZE);
+                if (NULL == rx_buffer_) {
+                    return -1;
+                }
+            }
+
+            // Frames handed out earlier point into the buffer, rewinding it while any of them is still held would overwrite them,
+            // So in that case the unread bytes move to a fresh buffer, when the frames are released in time the buffer is simply reused.
+            Byte* buffer = rx_buffer_.get();
+            bool shared = rx_buffer_.use_count() > 1;
+            if (rx_offset_ + length > PPP_BUFFER_SIZE || (rx_length_ < 1 && !shared)) {
+                if (shared) {
+                    std::shared_ptr<Byte> rx_buffer = BufferswapAllocator::MakeByteArray(this->BufferAllocator, PPP_BUFFER_SIZE);
+                    if (NULL == rx_buffer) {
+                        return -1;
+                    }
+
+                    memcpy(rx_buffer.get(), buffer + rx_offset_, rx_length_);
+                    rx_buffer_ = rx_buffer;
+                    buffer = rx_buffer.get();
+                }
+                elif(rx_length_ > 0) {
+                    memmove(buffer, buffer + rx_offset_, rx_length_);
+                }
+
+                rx_offset_ = 0;
+            }
+
+            // Ask for all the free space rather than the missing bytes, so one read pulls in every frame already queued on the socket.
+            while (rx_length_ < length) {
+                int tail = rx_offset_ + rx_length_;
+                ITcpipTransmission_Receives++;
+
+                int bytes_transferred = ppp::coroutines::asio::async_read_some(*socket, boost::asio::buffer(buffer + tail, PPP_BUFFER_SIZE - tail), y);
+                if (bytes_transferred < 1) {
+                    return -1;
+                }
+
+                rx_length_ += bytes_transferred;
+                ITcpipTransmission_Bytes += bytes_transferred;
+            }
+
+            return rx_length_;
+        }
+
+        std::shared_ptr<Byte> ITcpipTransmission::Read(YieldContext& y, int& outlen) noexcept {
+            std::shared_ptr<Byte> packet = ITransmission::Read(y, outlen);
+            if (NULL != packet) {
+                ITcpipTransmission_Frames++;
+            }
+
+            return packet;
+        }
+
+        void ITcpipTransmission::GetReceiveStatistics(UInt64& receives, UInt64& bytes, UInt64& frames) noexcept {
+            receives = ITcpipTransmission_Receives.load(std::memory_order_relaxed);
+            bytes    = ITcpipTransmission_Bytes.load(std::memory_order_relaxed);
+            frames   = ITcpipTransmission_Frames.load(std::memory_order_relaxed);
+        }
+
         bool ITcpipTransmission::DoWriteBytes(std::shared_ptr<Byte> packet, int offset, int packet_length, const AsynchronousWriteBytesCallback& cb) noexcept {
             std::shared_ptr<boost::asio::ip::tcp::socket> socket = socket_;
             if (!socket || !socket->is_open()) {
@@ -160,5 +253,39 @@ namespace ppp {
 
             return ppp::threading::Executors::Post(GetContext(), GetStrand(), complete_do_write_bytes_async_callback);
         }
+
+        bool ITcpipTransmission::DoWriteBuffers(const ConstBufferSequencePtr& buffers, int buffers_length, const AsynchronousWriteBytesCallback& cb) noexcept {
+            std::shared_ptr<boost::asio::ip::tcp::socket> socket = socket_;
+            if (!socket || !socket->is_open()) {
+                return false;
+            }
+
+            if (disposed_) {
+                return false;
+            }
+
+            std::shared_ptr<IAsynchronousWriteIoQueue> self = shared_from_this();
+            auto complete_do_write_buffers_async_callback = [self, this, socket, buffers, buffers_length, cb]() noexcept {
+                boost::asio::async_write(*socket, *buffers,
+                    [self, this, buffers, buffers_length, cb](const boost::system::error_code& ec, std::size_t sz) noexcept {
+                        bool ok = ec == boost::system::errc::success;
+                        if (ok) {
+                            std::shared_ptr<ITransmissionStatistics> statistics = this->Statistics;
+                            if (statistics) {
+                                statistics->AddOutgoingTraffic(buffers_length);
+                            }
+                        }
+                        else {
+                            Dispose();
+                        }
+
+                        if (cb) {
+                            cb(ok);
+                        }
+                    });
+                };
+
+            return ppp::threading::Executors::Post(GetContext(), GetStrand(), complete_do_write_buffers_async_callback);
+        }
     }
 }
\ No newline at end of file
@@ -23,14 +23,22 @@ namespace ppp {
             virtual void                                                                        Dispose() noexcept override;
             virtual boost::asio::ip::tcp::endpoint                                              GetRemoteEndPoint() noexcept override;
             virtual std::shared_ptr<Byte>                                                       ReadBytes(YieldContext& y, int length) noexcept;
+            virtual std::shared_ptr<Byte>                                                       Read(YieldContext& y, int& outlen) noexcept override;
+
+        public:
+            // Receive side counters of the read-ahead buffers of all the tcp transmissions: socket reads issued, bytes they returned and frames decoded,
+            // Bytes / frames is the mean frame size and frames / receives the number of frames served per socket read.
+            static void                                                                         GetReceiveStatistics(UInt64& receives, UInt64& bytes, UInt64& frames) noexcept;
 
         protected:
             virtual std::shared_ptr<Byte>                                                       DoReadBytes(YieldContext& y, int length) noexcept;
             virtual bool                                                                        DoWriteBytes(std::shared_ptr<Byte> packet, int offset, int packet_length, const AsynchronousWriteBytesCallback& cb) noexcept;
+            virtual bool                                                                        DoWriteBuffers(const ConstBufferSequencePtr& buffers, int buffers_length, const AsynchronousWriteBytesCallback& cb) noexcept override;
         
         private:
             void                                                                                Finalize() noexcept;
             virtual bool                                                                        ShiftToScheduler() noexcept override;
+            int                                                                                 ReceiveSome(YieldContext& y, const std::shared_ptr<boost::asio::ip::tcp::socket>& socket, int length) noexcept;
 
         private:
 #if defined(_WIN32)
@@ -39,6 +47,9 @@ namespace ppp {
             bool                                                                                disposed_ = false;
             std::shared_ptr<boost::asio::ip::tcp::socket>                                       socket_;
             boost::asio::ip::tcp::endpoint                                                      remoteEP_;
+            std::shared_ptr<Byte>                                                               rx_buffer_;
+            int                                                                                 rx_offset_   = 0;
+            int                                                                                 rx_length_   = 0;
         };
     }
 }
\ No newline at end of file
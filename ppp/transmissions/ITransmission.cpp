@@ -328,67 +328,56 @@ namespace ppp {
             }
         };
 
-        static std::shared_ptr<Byte>                    Transmission_Header_Encrypt(
+        static bool                                     Transmission_Header_Encrypt(
             const AppConfigurationPtr&                  APP,
-            const std::shared_ptr<BufferswapAllocator>& allocator,
             const CiphertextPtr&                        EVP_protocol,
             int                                         EVP_payload_length,
-            int&                                        EVP_header_length,
+            Byte*                                       EVP_header,
             int&                                        EVP_header_kf) noexcept {
 
             // Packet Alignment: 65536 -> 65535   
             if (--EVP_payload_length < 0) {
-                return NULL;
+                return false;
             }
 
-            Byte EVP_payload_length_array[EVP_HEADER_MSS] = {
-                (Byte)(RandomNext(0x01, 0xff)),     // Variable frame word.
-                (Byte)(EVP_payload_length >> 0x08), // High-order
-                (Byte)(EVP_payload_length & 0xff),  // Low-order
-            };
-
-            int EVP_header_datalen = sizeof(EVP_payload_length_array);
-            EVP_header_kf = APP->key.kf ^ *EVP_payload_length_array;
+            EVP_header[0] = (Byte)(RandomNext(0x01, 0xff));     // Variable frame word.
+            EVP_header[1] = (Byte)(EVP_payload_length >> 0x08); // High-order
+            EVP_header[2] = (Byte)(EVP_payload_length & 0xff);  // Low-order
+            EVP_header_kf = APP->key.kf ^ *EVP_header;
 
             // Byte encryption.
             if (EVP_protocol) {
-                std::shared_ptr<Byte> EVP_header_length_buff = EVP_protocol->Encrypt(allocator, EVP_payload_length_array + 1, EVP_HEADER_TSS, EVP_header_length);
-                if (NULL == EVP_header_length_buff || EVP_header_length != EVP_HEADER_TSS) {
-                    return NULL;
+                if (!EVP_protocol->Encrypt(EVP_header + 1, EVP_HEADER_TSS, EVP_header + 1)) {
+                    return false;
                 }
-
-                memcpy(EVP_payload_length_array + 1, EVP_header_length_buff.get(), EVP_HEADER_TSS);
             }
 
             // Mask encryption.
             for (int i = 1; i < EVP_HEADER_MSS; i++) {
-                EVP_payload_length_array[i] ^= EVP_header_kf;
+                EVP_header[i] ^= EVP_header_kf;
             }
 
             // Shuffle datas.
-            EVP_header_length = sizeof(EVP_payload_length_array);
-            ssea::shuffle_data(reinterpret_cast<char*>(EVP_payload_length_array + 1), EVP_HEADER_TSS, EVP_header_kf);
+            ssea::shuffle_data(reinterpret_cast<char*>(EVP_header + 1), EVP_HEADER_TSS, EVP_header_kf);
 
             // Delta encode.
-            std::shared_ptr<Byte> output;
-            return ssea::delta_encode(allocator, EVP_payload_length_array, EVP_header_datalen, output) != EVP_header_length ? NULL : output;
+            return ssea::delta_encode(EVP_header, EVP_HEADER_MSS) == EVP_HEADER_MSS;
         }
 
         static int                                      Transmission_Header_Decrypt(
             const AppConfigurationPtr&                  APP,
-            const std::shared_ptr<BufferswapAllocator>& allocator,
             const CiphertextPtr&                        EVP_protocol,
             Byte*                                       EVP_header_array,
             int&                                        EVP_header_kf) noexcept {
 
-            // Delta encode.
-            std::shared_ptr<Byte> EVP_payload_length_array_managed;
-            if (ssea::delta_decode(allocator, EVP_header_array, EVP_HEADER_MSS, EVP_payload_length_array_managed) != EVP_HEADER_MSS) {
+            // Delta decode, on a copy so the caller's header bytes stay untouched.
+            Byte EVP_payload_length_array[EVP_HEADER_MSS];
+            memcpy(EVP_payload_length_array, EVP_header_array, EVP_HEADER_MSS);
+            if (ssea::delta_decode(EVP_payload_length_array, EVP_HEADER_MSS) != EVP_HEADER_MSS) {
                 return 0;
             }
 
             // Unshuffle data.
-            Byte* EVP_payload_length_array = EVP_payload_length_array_managed.get();
             EVP_header_kf = APP->key.kf ^ *EVP_payload_length_array;
             ssea::unshuffle_data(reinterpret_cast<char*>(EVP_payload_length_array + 1), EVP_HEADER_TSS, EVP_header_kf);
 
@@ -398,76 +387,56 @@ namespace ppp {
             }
 
             // Byte decode.
-            int EVP_header_length = 0;
             if (EVP_protocol) {
-                std::shared_ptr<Byte> EVP_header_length_buff = EVP_protocol->Decrypt(allocator, EVP_payload_length_array + 1, EVP_HEADER_TSS, EVP_header_length);
-                if (NULL == EVP_header_length_buff || EVP_header_length != EVP_HEADER_TSS) {
+                if (!EVP_protocol->Decrypt(EVP_payload_length_array + 1, EVP_HEADER_TSS, EVP_payload_length_array + 1)) {
                     return 0;
                 }
-
-                memcpy(EVP_payload_length_array + 1, EVP_header_length_buff.get(), EVP_HEADER_TSS);
             }
 
-            EVP_header_length = EVP_payload_length_array[1] << 0x08 | EVP_payload_length_array[2];
+            int EVP_header_length = EVP_payload_length_array[1] << 0x08 | EVP_payload_length_array[2];
             return EVP_header_length + 1;
         }
 
-        static void                                     Transmission_Payload_Encrypt_Partial(
+        static void                                     Transmission_Payload_Encrypt(
             const AppConfigurationPtr&                  APP,
             int                                         kf,
-            Byte*                                       data,
+            const Byte*                                 data,
+            Byte*                                       output,
             int                                         datalen,
             bool                                        safest) noexcept {
 
-            // Mask encryption.
-            if (safest || APP->key.masked) {
-                for (int i = 0; i < datalen; i++) {
-                    data[i] ^= kf;
-                }
+            // Mask encryption, fused with the copy into the packet when the source is a separate buffer.
+            bool masked = safest || APP->key.masked;
+            if (masked) {
+                ssea::masked_data(data, output, datalen, (Byte)kf);
+            }
+            elif(data != output) {
+                memcpy(output, data, datalen);
             }
 
             // Shuffle datas.
             if (safest || APP->key.shuffle_data) {
-                ssea::shuffle_data(reinterpret_cast<char*>(data), datalen, kf);
+                ssea::shuffle_data(reinterpret_cast<char*>(output), datalen, kf);
             }
-        }
-
-        static std::shared_ptr<Byte>                    Transmission_Payload_Encrypt(
-            const AppConfigurationPtr&                  APP,
-            const std::shared_ptr<BufferswapAllocator>& allocator,
-            int                                         kf,
-            Byte*                                       data,
-            int                                         datalen,
-            int&                                        outlen,
-            bool                                        safest) noexcept {
-
-            outlen = datalen;
-            Transmission_Payload_Encrypt_Partial(APP, kf, data, datalen, safest);
 
             // Delta encode.
-            std::shared_ptr<Byte> output;
             if (safest || APP->key.delta_encode) {
-                return ssea::delta_encode(allocator, data, datalen, output) != datalen ? NULL : output;
-            }
-            else {
-                output = BufferswapAllocator::MakeByteArray(allocator, datalen);
-                if (NULL == output) {
-                    return NULL;
-                }
-                else {
-                    memcpy(output.get(), data, datalen);
-                    return output;
-                }
+                ssea::delta_encode(output, datalen);
             }
         }
 
-        static void                                     Transmission_Payload_Decrypt_Partial(
+        static void                                     Transmission_Payload_Decrypt(
             const AppConfigurationPtr&                  APP,
             int                                         kf,
             Byte*                                       data,
             int                                         datalen,
             bool                                        safest) noexcept {
 
+            // Delta decode.
+            if (safest || APP->key.delta_encode) {
+                ssea::delta_decode(data, datalen);
+            }
+
             // Unshuffle data.
             if (safest || APP->key.shuffle_data) {
                 ssea::unshuffle_data(reinterpret_cast<char*>(data), datalen, kf);
@@ -475,112 +444,63 @@ namespace ppp {
 
             // Mask decode data.
             if (safest || APP->key.masked) {
-                for (int i = 0; i < datalen; i++) {
-                    data[i] ^= kf;
-                }
+                ssea::masked_data(data, datalen, (Byte)kf);
             }
         }
 
-        static std::shared_ptr<Byte>                    Transmission_Payload_Decrypt(
+        // Builds the whole frame in a single buffer: the header is written into the reserved headroom and the payload 
+        // Is transformed in place behind it, so a frame costs one allocation instead of one per stage.
+        static std::shared_ptr<Byte>                    Transmission_Packet_Encrypt(
             const AppConfigurationPtr&                  APP,
             const std::shared_ptr<BufferswapAllocator>& allocator,
-            int                                         kf,
-            const std::shared_ptr<Byte>&                data,
+            const CiphertextPtr&                        EVP_protocol,
+            const CiphertextPtr&                        EVP_transport,
+            Byte*                                       data,
             int                                         datalen,
             int&                                        outlen,
             bool                                        safest) noexcept {
 
-            outlen = datalen;
-            if (safest || APP->key.delta_encode) {
-                std::shared_ptr<Byte> EVP_payload_array_managed; // Delta encode.
-                if (ssea::delta_decode(allocator, data.get(), datalen, EVP_payload_array_managed) != datalen) {
-                    return NULL;
-                }
+            int EVP_header_kf = 0;
+            outlen = 0;
 
-                Transmission_Payload_Decrypt_Partial(APP, kf, EVP_payload_array_managed.get(), datalen, safest);
-                return EVP_payload_array_managed;
-            }
-            else {
-                Transmission_Payload_Decrypt_Partial(APP, kf, data.get(), datalen, safest);
-                return data;
+            if (NULL == data || datalen < 1) {
+                return NULL;
             }
-        }
-
-        static std::shared_ptr<Byte>                    Transmission_Packet_Pack(
-            const std::shared_ptr<BufferswapAllocator>& allocator,
-            const std::shared_ptr<Byte>&                EVP_header,
-            int                                         EVP_header_length,
-            const std::shared_ptr<Byte>&                EVP_payload,
-            int                                         EVP_payload_length,
-            int&                                        EVP_packet_length) noexcept {
-
-            EVP_packet_length =
-                EVP_header_length + EVP_payload_length;
 
+            int EVP_packet_length = EVP_HEADER_MSS + datalen;
             std::shared_ptr<Byte> packet = BufferswapAllocator::MakeByteArray(allocator, EVP_packet_length);
             if (NULL == packet) {
                 return NULL;
             }
 
-            Byte* memory = packet.get();
-            memcpy(memory, EVP_header.get(), EVP_header_length);
-            memcpy(memory + EVP_header_length, EVP_payload.get(), EVP_payload_length);
-            return packet;
-        }
-
-        static std::shared_ptr<Byte>                    Transmission_Packet_Encrypt(
-            const AppConfigurationPtr&                  APP,
-            const std::shared_ptr<BufferswapAllocator>& allocator,
-            const CiphertextPtr&                        EVP_protocol,
-            const CiphertextPtr&                        EVP_transport,
-            Byte*                                       data,
-            int                                         datalen,
-            int&                                        outlen,
-            bool                                        safest) noexcept {
-
-            int EVP_payload_length = 0;
-            int EVP_header_kf = 0;
-            int EVP_header_length = 0;
-
-            outlen = 0;
+            Byte* EVP_header = packet.get();
+            Byte* EVP_payload = EVP_header + EVP_HEADER_MSS;
             if (EVP_protocol && EVP_transport) {
-                // Encrypt payload data (A).
-                std::shared_ptr<Byte> EVP_payload = EVP_transport->Encrypt(allocator, data, datalen, EVP_payload_length);
-                if (NULL == EVP_payload || EVP_payload_length != datalen) {
+                // Encrypt payload data (A), straight into the packet.
+                if (!EVP_transport->Encrypt(data, datalen, EVP_payload)) {
                     return NULL;
                 }
 
                 // Encrypt header data.
-                std::shared_ptr<Byte> EVP_header = Transmission_Header_Encrypt(APP, allocator, EVP_protocol, EVP_payload_length, EVP_header_length, EVP_header_kf);
-                if (NULL == EVP_header) {
+                if (!Transmission_Header_Encrypt(APP, EVP_protocol, datalen, EVP_header, EVP_header_kf)) {
                     return NULL;
                 }
 
                 // Encrypt payload data (B).
-                EVP_payload = Transmission_Payload_Encrypt(APP, allocator, EVP_header_kf, EVP_payload.get(), datalen, EVP_payload_length, safest);
-                if (NULL == EVP_payload) {
-                    return NULL;
-                }
-                else {
-                    return Transmission_Packet_Pack(allocator, EVP_header, EVP_header_length, EVP_payload, EVP_payload_length, outlen);
-                }
+                Transmission_Payload_Encrypt(APP, EVP_header_kf, EVP_payload, EVP_payload, datalen, safest);
             }
             else {
                 // Encrypt header data.
-                std::shared_ptr<Byte> EVP_header = Transmission_Header_Encrypt(APP, allocator, EVP_protocol, datalen, EVP_header_length, EVP_header_kf);
-                if (NULL == EVP_header) {
+                if (!Transmission_Header_Encrypt(APP, EVP_protocol, datalen, EVP_header, EVP_header_kf)) {
                     return NULL;
                 }
 
                 // Encrypt payload data.
-                std::shared_ptr<Byte> EVP_payload = Transmission_Payload_Encrypt(APP, allocator, EVP_header_kf, data, datalen, EVP_payload_length, safest);
-                if (NULL == EVP_payload) {
-                    return NULL;
-                }
-                else {
-                    return Transmission_Packet_Pack(allocator, EVP_header, EVP_header_length, EVP_payload, EVP_payload_length, outlen);
-                }
+                Transmission_Payload_Encrypt(APP, EVP_header_kf, data, EVP_payload, datalen, safest);
             }
+
+            outlen = EVP_packet_length;
+            return packet;
         }
 
         static std::shared_ptr<Byte>                    Transmission_Packet_Decrypt(
@@ -600,7 +520,7 @@ namespace ppp {
                 return NULL;
             }
 
-            int EVP_payload_length = Transmission_Header_Decrypt(APP, allocator, EVP_protocol, data, EVP_header_kf);
+            int EVP_payload_length = Transmission_Header_Decrypt(APP, EVP_protocol, data, EVP_header_kf);
             if (EVP_payload_length < 1) {
                 return NULL;
             }
@@ -618,18 +538,14 @@ namespace ppp {
                 memcpy(EVP_payload.get(), data + EVP_HEADER_MSS, EVP_payload_length);
             }
 
-            EVP_payload = Transmission_Payload_Decrypt(APP, allocator, EVP_header_kf, EVP_payload, EVP_payload_length, outlen, safest);
-            if (NULL == EVP_payload) {
-                return NULL;
-            }
-
+            Transmission_Payload_Decrypt(APP, EVP_header_kf, EVP_payload.get(), EVP_payload_length, safest);
             if (EVP_protocol && EVP_transport) {
-                EVP_payload = EVP_transport->Decrypt(allocator, EVP_payload.get(), EVP_payload_length, outlen);
-                if (NULL == EVP_payload || EVP_payload_length != outlen) {
+                if (!EVP_transport->Decrypt(EVP_payload.get(), EVP_payload_length, EVP_payload.get())) {
                     return NULL;
                 }
             }
 
+            outlen = EVP_payload_length;
             return EVP_payload;
         }
 
@@ -651,28 +567,29 @@ namespace ppp {
                 return NULL;
             }
 
-            int EVP_payload_length = Transmission_Header_Decrypt(APP, allocator, EVP_protocol, EVP_header.get(), EVP_header_kf);
+            int EVP_payload_length = Transmission_Header_Decrypt(APP, EVP_protocol, EVP_header.get(), EVP_header_kf);
             if (EVP_payload_length < 1) {
                 return NULL;
             }
-
-            std::shared_ptr<Byte> EVP_payload = ITransmissionBridge::ReadBytes(transmission, y, EVP_payload_length);
-            if (NULL == EVP_payload) {
-                return NULL;
+            else {
+                // Let go of the header before the payload is read, it may point into the receive buffer of the transmission.
+                EVP_header.reset();
             }
 
-            EVP_payload = Transmission_Payload_Decrypt(APP, allocator, EVP_header_kf, EVP_payload, EVP_payload_length, outlen, safest);
+            // The payload buffer is owned by this frame, so every stage is undone in place.
+            std::shared_ptr<Byte> EVP_payload = ITransmissionBridge::ReadBytes(transmission, y, EVP_payload_length);
             if (NULL == EVP_payload) {
                 return NULL;
             }
 
+            Transmission_Payload_Decrypt(APP, EVP_header_kf, EVP_payload.get(), EVP_payload_length, safest);
             if (EVP_protocol && EVP_transport) {
-                EVP_payload = EVP_transport->Decrypt(allocator, EVP_payload.get(), EVP_payload_length, outlen);
-                if (NULL == EVP_payload || EVP_payload_length != outlen) {
+                if (!EVP_transport->Decrypt(EVP_payload.get(), EVP_payload_length, EVP_payload.get())) {
                     return NULL;
                 }
             }
 
+            outlen = EVP_payload_length;
             return EVP_payload;
         }
 
@@ -731,9 +648,7 @@ namespace ppp {
             int kf = APP->key.kf;
             for (int i = 0; i < arraysizeof(kfs); i++) {
                 kf ^= kfs[i];
-                for (int j = 0; j < packet_length; j++) {
-                    packet[j] ^= kf;
-                }
+                ssea::masked_data(packet, packet_length, (Byte)kf);
             }
 
             std::shared_ptr<Byte> messages = BufferswapAllocator::MakeByteArray(allocator, packet_length += sizeof(kfs));
@@ -780,9 +695,7 @@ namespace ppp {
             int kf = APP->key.kf;
             for (int i = 0; i < arraysizeof(kfs); i++) {
                 kf ^= kfs[i];
-                for (int j = 0; j < packet_length; j++) {
-                    packet[j] ^= kf;
-                }
+                ssea::masked_data(packet, packet_length, (Byte)kf);
             }
 
             // GUID is an INT128 integer and cannot be 0.
@@ -879,17 +792,12 @@ namespace ppp {
         }
 
         void ITransmission::Finalize() noexcept {
-            DeadlineTimerPtr timeout = std::move(timeout_);
-            timeout_.reset();
+            InternalHandshakeTimeoutClear();
 
             disposed_ = false;
             handshaked_ = false;
             QoS.reset();
             Statistics.reset();
-
-            if (NULL != timeout) {
-                Socket::Cancel(*timeout);
-            }
         }
 
         std::shared_ptr<Byte> ITransmission::Read(YieldContext& y, int& outlen) noexcept {
@@ -1039,6 +947,15 @@ namespace ppp {
             if (NULL != timeout) {
                 Socket::Cancel(*timeout);
             }
+
+            TimingWheelPtr wheel = std::move(timeout_wheel_);
+            ppp::threading::TimingWheel::EntryPtr entry = std::move(timeout_entry_);
+            timeout_wheel_.reset();
+            timeout_entry_.reset();
+
+            if (NULL != wheel) {
+                wheel->Cancel(entry);
+            }
         }
 
         bool ITransmission::InternalHandshakeTimeoutSet() noexcept {
@@ -1047,7 +964,7 @@ namespace ppp {
             }
 
             DeadlineTimerPtr timeout = timeout_;
-            if (NULL != timeout) {
+            if (NULL != timeout || NULL != timeout_entry_) {
                 return false;
             }
 
@@ -1057,6 +974,25 @@ namespace ppp {
                 return false;
             }
 
+            // Dispose posts itself onto the strand, so the wheel of the context can fire it directly.
+            TimingWheelPtr wheel = ppp::threading::Executors::GetTimingWheel(context.get());
+            if (NULL != wheel) {
+                auto self = shared_from_this();
+                timeout_entry_ = wheel->Schedule(configuration_->tcp.connect.timeout * 1000,
+                    [self, this](bool expired) noexcept {
+                        if (expired) {
+                            Dispose();
+                        }
+                    });
+
+                if (NULL == timeout_entry_) {
+                    return false;
+                }
+
+                timeout_wheel_ = std::move(wheel);
+                return true;
+            }
+
             timeout = strand ?
                 make_shared_object<DeadlineTimer>(*strand) :
                 make_shared_object<DeadlineTimer>(*context);
@@ -19,6 +19,7 @@ namespace ppp {
 
             typedef boost::asio::deadline_timer                                                     DeadlineTimer;
             typedef std::shared_ptr<DeadlineTimer>                                                  DeadlineTimerPtr;
+            typedef std::shared_ptr<ppp::threading::TimingWheel>                                    TimingWheelPtr;
 
         public:
             typedef ppp::configurations::AppConfiguration                                           AppConfiguration;
@@ -77,6 +78,8 @@ namespace ppp {
             ContextPtr                                                                              context_;
             StrandPtr                                                                               strand_;
             DeadlineTimerPtr                                                                        timeout_;
+            TimingWheelPtr                                                                          timeout_wheel_;
+            ppp::threading::TimingWheel::EntryPtr                                                   timeout_entry_;
             CiphertextPtr                                                                           protocol_;
             CiphertextPtr                                                                           transport_;
             AppConfigurationPtr                                                                     configuration_;
@@ -158,6 +158,7 @@ namespace ppp
                         return false;
                     }
 
+                    UInt64 connect_begin = ppp::GetTickCount(true);
                     std::shared_ptr<ppp::transmissions::ITransmission> transmission = exchanger->ConnectTransmission(context, strand_, y);
                     if (NULL == transmission)
                     {
@@ -180,6 +181,8 @@ namespace ppp
                         return NULL;
                     }
 
+                    exchanger->AddConnectLatency(transmission, connect_begin);
+
                     this->connection_ = std::move(connection);
                     return true;
                 }